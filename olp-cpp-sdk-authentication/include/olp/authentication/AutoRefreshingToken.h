@@ -113,7 +113,9 @@ class AUTHENTICATION_API OLP_SDK_DEPRECATED("Will be removed by 10.2020.")
    *
    * If no token has been retrieved yet or the current token is expired or
    * expires within five minutes, a new token is requested. Otherwise,
-   * the cached token is returned. This method is thread-safe.
+   * the cached token is returned. The new token is requested on the task
+   * scheduler of the token endpoint settings, if there is one. This method is
+   * thread-safe.
    *
    * @param callback The callback that contains the `TokenResponse` instance.
    * @param minimum_validity (Optional) Sets the minimum validity period of
@@ -131,11 +133,23 @@ class AUTHENTICATION_API OLP_SDK_DEPRECATED("Will be removed by 10.2020.")
   /**
    * @brief Creates the `AutoRefreshingToken` instance.
    *
+   * When `refresh_ahead` is positive, a token that needs to be refreshed
+   * within this period is refreshed on the task scheduler of the token
+   * endpoint settings, and the still valid token is returned meanwhile.
+   * Without a task scheduler, the refresh blocks the calling thread. Only one
+   * token request is in flight at a time, the callers that need a new token
+   * wait for it. The request is cancelled once all its callers cancelled.
+   *
    * @param token_endpoint The token endpoint against which the token is
    * refreshed.
    * @param token_request The token request that is sent to the token endpoint.
+   * @param refresh_ahead (Optional) The period before the refresh time in
+   * which the token is refreshed in the background. The default is 0, which
+   * disables the background refresh.
    */
-  AutoRefreshingToken(TokenEndpoint token_endpoint, TokenRequest token_request);
+  AutoRefreshingToken(
+      TokenEndpoint token_endpoint, TokenRequest token_request,
+      std::chrono::seconds refresh_ahead = std::chrono::seconds(0));
 
   PORTING_POP_WARNINGS()
 
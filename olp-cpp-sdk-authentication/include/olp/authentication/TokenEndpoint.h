@@ -19,6 +19,7 @@
 
 #pragma once
 
+#include <chrono>
 #include <future>
 #include <memory>
 
@@ -108,12 +109,16 @@ class AUTHENTICATION_API OLP_SDK_DEPRECATED("Will be removed in 10.2020")
    * token and refreshes it when needed.
    *
    * @param token_request The `TokenRequest` instance.
+   * @param refresh_ahead (Optional) The period before the refresh time in
+   * which the token is refreshed in the background. The default is 0, which
+   * disables the background refresh.
    *
    * @return The `AutoRefreshingToken` instance that caches the requested
    * token and refreshes it when needed.
    */
   AutoRefreshingToken RequestAutoRefreshingToken(
-      const TokenRequest& token_request = TokenRequest());
+      const TokenRequest& token_request = TokenRequest(),
+      std::chrono::seconds refresh_ahead = std::chrono::seconds(0));
 
   PORTING_POP_WARNINGS()
 
@@ -127,6 +132,11 @@ class AUTHENTICATION_API OLP_SDK_DEPRECATED("Will be removed in 10.2020")
   explicit TokenEndpoint(Settings settings);
 
  private:
+  friend class AutoRefreshingToken;
+
+  /// Gets the task scheduler of the settings, which the sign-in ignores.
+  std::shared_ptr<thread::TaskScheduler> GetTaskScheduler() const;
+
   class Impl;
   std::shared_ptr<Impl> impl_;
 };
@@ -20,16 +20,24 @@
 #include "olp/authentication/AutoRefreshingToken.h"
 
 #include <chrono>
+#include <future>
 #include <iostream>
+#include <map>
+#include <memory>
+#include <mutex>
 
 #include "olp/authentication/TokenEndpoint.h"
 #include "olp/core/client/CancellationToken.h"
 #include "olp/core/logging/Log.h"
 #include "olp/core/porting/warning_disable.h"
+#include "olp/core/thread/TaskScheduler.h"
 
 namespace {
 constexpr auto kLogTag = "authentication::AutoRefreshingToken";
 
+// The delay before the next refresh ahead when one fails.
+constexpr auto kRefreshAheadRetryInterval = std::chrono::seconds(10);
+
 std::chrono::steady_clock::time_point ComputeRefreshTime(
     std::chrono::seconds expires_in,
     const std::chrono::seconds& minimum_validity) {
@@ -45,123 +53,262 @@ namespace authentication {
 PORTING_PUSH_WARNINGS()
 PORTING_CLANG_GCC_DISABLE_WARNING("-Wdeprecated-declarations")
 
-struct AutoRefreshingToken::Impl {
-  Impl(TokenEndpoint token_endpoint, TokenRequest token_request)
+struct AutoRefreshingToken::Impl
+    : public std::enable_shared_from_this<AutoRefreshingToken::Impl> {
+  Impl(TokenEndpoint token_endpoint, TokenRequest token_request,
+       std::chrono::seconds refresh_ahead,
+       std::shared_ptr<thread::TaskScheduler> task_scheduler)
       : token_endpoint_(std::move(token_endpoint)),
         token_request_(std::move(token_request)),
+        refresh_ahead_(refresh_ahead),
+        task_scheduler_(std::move(task_scheduler)),
         current_token_(),
-        token_refresh_time_() {}
+        token_refresh_time_(),
+        refresh_ahead_time_() {}
 
   TokenEndpoint::TokenResponse GetToken(
       client::CancellationToken& cancellation_token,
       std::chrono::seconds minimum_validity) {
-    if (ForceRefresh(minimum_validity) || ShouldRefreshNow()) {
-      OLP_SDK_LOG_INFO_F(kLogTag, "Time to refresh token");
-      TryRefreshCurrentToken(cancellation_token, minimum_validity);
+    TokenEndpoint::TokenResponse token;
+    if (GetValidToken(minimum_validity, token)) {
+      return token;
     }
 
-    // Return existing still valid token
-    return current_token_;
+    OLP_SDK_LOG_INFO_F(kLogTag, "Time to refresh token");
+    auto promise =
+        std::make_shared<std::promise<TokenEndpoint::TokenResponse>>();
+    auto future = promise->get_future();
+    cancellation_token = Refresh(
+        [promise](const TokenEndpoint::TokenResponse& response) {
+          promise->set_value(response);
+        },
+        minimum_validity, true);
+    return future.get();
   }
 
   client::CancellationToken GetToken(const GetTokenCallback& callback,
                                      std::chrono::seconds minimum_validity) {
-    if (ForceRefresh(minimum_validity) || ShouldRefreshNow()) {
-      OLP_SDK_LOG_INFO_F(kLogTag, "Time to refresh token");
-      return TryRefreshCurrentToken(callback, minimum_validity);
+    TokenEndpoint::TokenResponse token;
+    if (GetValidToken(minimum_validity, token)) {
+      callback(token);
+      return {};
     }
 
-    // Return existing still valid token
-    callback(current_token_);
-    return {};
+    OLP_SDK_LOG_INFO_F(kLogTag, "Time to refresh token");
+    return Refresh(callback, minimum_validity, false);
   }
 
  private:
-  bool ShouldRefreshNow() const {
-    return std::chrono::steady_clock::now() >= token_refresh_time_;
-  }
+  /// The token request shared by the callers that need a new token.
+  struct RefreshRequest {
+    explicit RefreshRequest(bool in_background)
+        : in_background(in_background) {}
+
+    const bool in_background;
+    bool started{false};
+    bool cancelled{false};
+    size_t next_waiter_id{0};
+    std::map<size_t, GetTokenCallback> waiters;
+  };
 
   bool ForceRefresh(const std::chrono::seconds& minimum_validity) const {
     return minimum_validity <= std::chrono::seconds(0);
   }
 
-  void TryRefreshCurrentToken(client::CancellationToken& cancellation_token,
-                              const std::chrono::seconds& minimum_validity) {
-    std::lock_guard<std::mutex> guard(token_mutex_);
-    current_token_ =
-        token_endpoint_.RequestToken(cancellation_token, token_request_).get();
-
-    if (!current_token_.IsSuccessful()) {
-      OLP_SDK_LOG_INFO_F(
-          kLogTag, "Token NOK, code=%d, error=%s",
-          static_cast<int>(current_token_.GetError().GetErrorCode()),
-          current_token_.GetError().GetMessage().c_str());
-    } else if (current_token_.GetResult().GetErrorResponse().code != 0) {
-      const auto& result = current_token_.GetResult();
+  static bool IsCancelled(const TokenEndpoint::TokenResponse& response) {
+    return !response.IsSuccessful() &&
+           response.GetError().GetErrorCode() == client::ErrorCode::Cancelled;
+  }
+
+  /// Gets the current token if it does not need a refresh yet, and starts a
+  /// refresh in the background when it is close to the refresh time.
+  bool GetValidToken(const std::chrono::seconds& minimum_validity,
+                     TokenEndpoint::TokenResponse& token) {
+    bool refresh_ahead = false;
+    {
+      std::lock_guard<std::mutex> guard(token_mutex_);
+      const auto now = std::chrono::steady_clock::now();
+      if (ForceRefresh(minimum_validity) || now >= token_refresh_time_) {
+        return false;
+      }
+
+      token = current_token_;
+      refresh_ahead = refresh_ahead_ > std::chrono::seconds(0) &&
+                      now >= refresh_ahead_time_ && !refresh_;
+    }
+
+    if (refresh_ahead) {
+      OLP_SDK_LOG_INFO_F(kLogTag, "Refreshing token ahead of expiry");
+      Refresh(nullptr, minimum_validity, false);
+    }
+    return true;
+  }
+
+  /// Requests a new token, or joins the request already in flight. The
+  /// callback is invoked with the response when it is not empty.
+  ///
+  /// The request runs on the task scheduler, or on the calling thread when
+  /// there is no scheduler or the caller blocks anyway. A blocking caller
+  /// runs the request that no task started yet, so it does not wait for a
+  /// task queued behind it.
+  client::CancellationToken Refresh(GetTokenCallback callback,
+                                    std::chrono::seconds minimum_validity,
+                                    bool blocking) {
+    const bool has_waiter = static_cast<bool>(callback);
+    std::shared_ptr<RefreshRequest> request;
+    size_t waiter_id = 0;
+    bool start = false;
+    {
+      std::lock_guard<std::mutex> guard(token_mutex_);
+      if (!refresh_) {
+        refresh_ = std::make_shared<RefreshRequest>(!has_waiter);
+        start = true;
+      }
+      request = refresh_;
+      if (has_waiter) {
+        waiter_id = request->next_waiter_id++;
+        request->waiters.emplace(waiter_id, std::move(callback));
+      }
+    }
+
+    // The request keeps this instance alive until it completes.
+    auto self = shared_from_this();
+    if (blocking || (start && !task_scheduler_)) {
+      Execute(request, minimum_validity);
+    } else if (start) {
+      task_scheduler_->ScheduleTask([self, request, minimum_validity]() {
+        self->Execute(request, minimum_validity);
+      });
+    }
+
+    if (!has_waiter) {
+      return {};
+    }
+
+    std::weak_ptr<Impl> weak_self = self;
+    return client::CancellationToken([weak_self, request, waiter_id]() {
+      if (auto self = weak_self.lock()) {
+        self->CancelWaiter(request, waiter_id);
+      }
+    });
+  }
+
+  /// Removes the waiter, and cancels the request once no waiter is left. The
+  /// token endpoint completes the request on the calling thread, so a request
+  /// in flight is abandoned, and its response is not stored.
+  void CancelWaiter(const std::shared_ptr<RefreshRequest>& request,
+                    size_t waiter_id) {
+    GetTokenCallback callback;
+    {
+      std::lock_guard<std::mutex> guard(token_mutex_);
+      auto it = request->waiters.find(waiter_id);
+      if (it == request->waiters.end()) {
+        return;
+      }
+
+      callback = std::move(it->second);
+      request->waiters.erase(it);
+      if (request->waiters.empty() && !request->in_background) {
+        request->cancelled = true;
+        if (refresh_ == request) {
+          refresh_.reset();
+        }
+      }
+    }
+
+    callback(client::ApiError::Cancelled());
+  }
+
+  void Execute(const std::shared_ptr<RefreshRequest>& request,
+               std::chrono::seconds minimum_validity) {
+    {
+      std::lock_guard<std::mutex> guard(token_mutex_);
+      if (request->started || request->cancelled) {
+        return;
+      }
+      request->started = true;
+    }
+
+    auto self = shared_from_this();
+    token_endpoint_.RequestToken(
+        token_request_, [self, request, minimum_validity](
+                            TokenEndpoint::TokenResponse response) {
+          self->OnRefreshed(request, response, minimum_validity);
+        });
+  }
+
+  void OnRefreshed(const std::shared_ptr<RefreshRequest>& request,
+                   const TokenEndpoint::TokenResponse& response,
+                   const std::chrono::seconds& minimum_validity) {
+    LogTokenResponse(response);
+
+    std::map<size_t, GetTokenCallback> waiters;
+    {
+      std::lock_guard<std::mutex> guard(token_mutex_);
+      if (refresh_ == request) {
+        refresh_.reset();
+      }
+      waiters.swap(request->waiters);
+
+      const auto now = std::chrono::steady_clock::now();
+      const bool succeeded = response.IsSuccessful() &&
+                             response.GetResult().GetErrorResponse().code == 0;
+      if (request->cancelled || IsCancelled(response)) {
+        // The cancelled request does not replace the current token.
+      } else if (succeeded || now >= token_refresh_time_) {
+        current_token_ = response;
+        token_refresh_time_ = ComputeRefreshTime(
+            response.GetResult().GetExpiresIn(), minimum_validity);
+        refresh_ahead_time_ = token_refresh_time_ - refresh_ahead_;
+      } else {
+        // Keep serving the still valid token.
+        refresh_ahead_time_ = now + kRefreshAheadRetryInterval;
+      }
+    }
+
+    for (const auto& waiter : waiters) {
+      waiter.second(response);
+    }
+  }
+
+  static void LogTokenResponse(const TokenEndpoint::TokenResponse& response) {
+    if (!response.IsSuccessful()) {
+      OLP_SDK_LOG_INFO_F(kLogTag, "Token NOK, code=%d, error=%s",
+                         static_cast<int>(response.GetError().GetErrorCode()),
+                         response.GetError().GetMessage().c_str());
+    } else if (response.GetResult().GetErrorResponse().code != 0) {
+      const auto& result = response.GetResult();
       OLP_SDK_LOG_INFO_F(kLogTag, "Token NOK, status=%d, code=%d, error=%s",
                          static_cast<int>(result.GetHttpStatus()),
                          static_cast<int>(result.GetErrorResponse().code),
                          result.GetErrorResponse().message.c_str());
     } else {
-      auto expiry_time = current_token_.GetResult().GetExpiryTime();
+      auto expiry_time = response.GetResult().GetExpiryTime();
       OLP_SDK_LOG_INFO_F(kLogTag, "Token OK, expires=%s",
                          std::asctime(std::gmtime(&expiry_time)));
     }
-
-    token_refresh_time_ = ComputeRefreshTime(
-        current_token_.GetResult().GetExpiresIn(), minimum_validity);
-  }
-
-  client::CancellationToken TryRefreshCurrentToken(
-      const GetTokenCallback& callback,
-      const std::chrono::seconds& minimum_validity) {
-    std::lock_guard<std::mutex> guard(token_mutex_);
-
-    // Avoid capturing this, but very risky as updating without lock
-    auto& current_token = current_token_;
-    auto& token_refresh_time = token_refresh_time_;
-
-    return token_endpoint_.RequestToken(
-        token_request_,
-        [&, callback, minimum_validity](TokenEndpoint::TokenResponse response) {
-          current_token = response;
-
-          if (!current_token.IsSuccessful()) {
-            OLP_SDK_LOG_INFO_F(
-                kLogTag, "Token NOK, code=%d, error=%s",
-                static_cast<int>(current_token.GetError().GetErrorCode()),
-                current_token.GetError().GetMessage().c_str());
-          } else if (current_token.GetResult().GetErrorResponse().code != 0) {
-            const auto& result = current_token.GetResult();
-            OLP_SDK_LOG_INFO_F(kLogTag,
-                               "Token NOK, status=%d code=%d, error=%s",
-                               static_cast<int>(result.GetHttpStatus()),
-                               static_cast<int>(result.GetErrorResponse().code),
-                               result.GetErrorResponse().message.c_str());
-          } else {
-            auto expiry_time = current_token.GetResult().GetExpiryTime();
-            OLP_SDK_LOG_INFO_F(kLogTag, "Token OK, expires=%s",
-                               std::asctime(std::gmtime(&expiry_time)));
-          }
-
-          token_refresh_time = ComputeRefreshTime(
-              current_token.GetResult().GetExpiresIn(), minimum_validity);
-          callback(response);
-        });
   }
 
  private:
   TokenEndpoint token_endpoint_;
   TokenRequest token_request_;
+  const std::chrono::seconds refresh_ahead_;
+  const std::shared_ptr<thread::TaskScheduler> task_scheduler_;
   TokenEndpoint::TokenResponse current_token_;
   std::chrono::steady_clock::time_point token_refresh_time_;
+  std::chrono::steady_clock::time_point refresh_ahead_time_;
+  std::shared_ptr<RefreshRequest> refresh_;
   std::mutex token_mutex_;
 };
 
 AutoRefreshingToken::AutoRefreshingToken(TokenEndpoint token_endpoint,
-                                         TokenRequest token_request)
-    : impl_(std::make_shared<AutoRefreshingToken::Impl>(
-          std::move(token_endpoint), std::move(token_request))) {}
+                                         TokenRequest token_request,
+                                         std::chrono::seconds refresh_ahead) {
+  auto task_scheduler = token_endpoint.GetTaskScheduler();
+  impl_ = std::make_shared<AutoRefreshingToken::Impl>(
+      std::move(token_endpoint), std::move(token_request), refresh_ahead,
+      std::move(task_scheduler));
+}
 
 TokenEndpoint::TokenResponse AutoRefreshingToken::GetToken(
     client::CancellationToken& cancellation_token,
@@ -1,5 +1,5 @@
 /*
- * Copyright (C) 2019-2020 HERE Europe B.V.
+ * Copyright (C) 2019-2021 HERE Europe B.V.
  *
  * Licensed under the Apache License, Version 2.0 (the "License");
  * you may not use this file except in compliance with the License.
@@ -60,14 +60,20 @@ class TokenEndpoint::Impl {
       client::CancellationToken& cancel_token,
       const TokenRequest& token_request);
 
+  std::shared_ptr<thread::TaskScheduler> GetTaskScheduler() const {
+    return task_scheduler_;
+  }
+
  private:
   AuthenticationClient auth_client_;
   AuthenticationCredentials auth_credentials_;
+  std::shared_ptr<thread::TaskScheduler> task_scheduler_;
 };
 
 TokenEndpoint::Impl::Impl(Settings settings)
     : auth_client_(ConvertSettings(settings)),
-      auth_credentials_(std::move(settings.credentials)) {}
+      auth_credentials_(std::move(settings.credentials)),
+      task_scheduler_(std::move(settings.task_scheduler)) {}
 
 client::CancellationToken TokenEndpoint::Impl::RequestToken(
     const TokenRequest& token_request, const RequestTokenCallback& callback) {
@@ -135,9 +141,14 @@ std::future<TokenEndpoint::TokenResponse> TokenEndpoint::RequestToken(
   return impl_->RequestToken(cancellation_token, token_request);
 }
 
+std::shared_ptr<thread::TaskScheduler> TokenEndpoint::GetTaskScheduler()
+    const {
+  return impl_->GetTaskScheduler();
+}
+
 AutoRefreshingToken TokenEndpoint::RequestAutoRefreshingToken(
-    const TokenRequest& token_request) {
-  return AutoRefreshingToken(*this, token_request);
+    const TokenRequest& token_request, std::chrono::seconds refresh_ahead) {
+  return AutoRefreshingToken(*this, token_request, refresh_ahead);
 }
 
 PORTING_POP_WARNINGS()
@@ -0,0 +1,341 @@
+/*
+ * Copyright (C) 2021 HERE Europe B.V.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ * License-Filename: LICENSE
+ */
+
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>
+#include <olp/authentication/AutoRefreshingToken.h>
+#include <olp/authentication/TokenEndpoint.h>
+#include <olp/core/http/HttpStatusCode.h>
+#include <olp/core/http/Network.h>
+#include <olp/core/thread/TaskScheduler.h>
+
+PORTING_PUSH_WARNINGS()
+PORTING_CLANG_GCC_DISABLE_WARNING("-Wdeprecated-declarations")
+
+namespace {
+namespace auth = olp::authentication;
+namespace client = olp::client;
+namespace http = olp::http;
+
+constexpr auto kTokenEndpointUrl = "https://auth.local/oauth2/token";
+constexpr auto kTimeout = std::chrono::seconds(5);
+constexpr auto kExpiresIn = 100;
+constexpr auto kMinimumValidity = std::chrono::seconds(10);
+// Longer than the token lifetime, so a valid token is always refreshed ahead.
+constexpr auto kRefreshAhead = std::chrono::seconds(200);
+
+using TokenPromise = std::promise<auth::TokenEndpoint::TokenResponse>;
+using TokenFuture = std::future<auth::TokenEndpoint::TokenResponse>;
+
+/// Holds the token requests until the test answers them.
+class TokenNetwork : public http::Network {
+ public:
+  http::SendOutcome Send(http::NetworkRequest /*request*/, Payload payload,
+                         Callback callback, HeaderCallback /*header_callback*/,
+                         DataCallback /*data_callback*/) override {
+    std::lock_guard<std::mutex> lock(mutex_);
+    const auto id = static_cast<http::RequestId>(++requests_count_);
+    pending_.push_back({id, std::move(payload), std::move(callback)});
+    sent_.notify_all();
+    return http::SendOutcome(id);
+  }
+
+  void Cancel(http::RequestId /*id*/) override {}
+
+  /// Waits for the next request, and answers it with the token, or with an
+  /// error for a status other than OK.
+  bool Respond(const std::string& token,
+               int status = http::HttpStatusCode::OK) {
+    Request request;
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      if (!sent_.wait_for(lock, kTimeout, [&] { return !pending_.empty(); })) {
+        return false;
+      }
+      request = std::move(pending_.front());
+      pending_.pop_front();
+    }
+
+    const std::string body =
+        status == http::HttpStatusCode::OK
+            ? R"({"accessToken":")" + token +
+                  R"(","tokenType":"bearer","expiresIn":)" +
+                  std::to_string(kExpiresIn) + "}"
+            : R"({"errorCode":401300,"message":"Invalid credentials"})";
+    request.payload->write(body.data(), body.size());
+    request.callback(
+        http::NetworkResponse().WithRequestId(request.id).WithStatus(status));
+    return true;
+  }
+
+  /// Waits until a request is sent.
+  bool WaitForRequest() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    return sent_.wait_for(lock, kTimeout, [&] { return !pending_.empty(); });
+  }
+
+  size_t GetRequestsCount() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return requests_count_;
+  }
+
+ private:
+  struct Request {
+    http::RequestId id;
+    Payload payload;
+    Callback callback;
+  };
+
+  mutable std::mutex mutex_;
+  std::condition_variable sent_;
+  std::deque<Request> pending_;
+  size_t requests_count_{0};
+};
+
+/// Runs the queued tasks when the test asks for it.
+class ManualTaskScheduler : public olp::thread::TaskScheduler {
+ public:
+  size_t GetTasksCount() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return tasks_.size();
+  }
+
+  /// Runs the queued tasks on a new thread.
+  std::thread RunTasks() {
+    std::vector<CallFuncType> tasks;
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      tasks.swap(tasks_);
+    }
+    return std::thread([tasks]() {
+      for (const auto& task : tasks) {
+        task();
+      }
+    });
+  }
+
+ protected:
+  void EnqueueTask(CallFuncType&& func) override {
+    std::lock_guard<std::mutex> lock(mutex_);
+    tasks_.push_back(std::move(func));
+  }
+
+ private:
+  mutable std::mutex mutex_;
+  std::vector<CallFuncType> tasks_;
+};
+
+bool HasToken(const auth::TokenEndpoint::TokenResponse& response,
+              const std::string& token) {
+  return response.IsSuccessful() &&
+         response.GetResult().GetErrorResponse().code == 0 &&
+         response.GetResult().GetAccessToken() == token;
+}
+
+bool IsFailed(const auth::TokenEndpoint::TokenResponse& response) {
+  return !response.IsSuccessful() ||
+         response.GetResult().GetErrorResponse().code != 0;
+}
+
+bool IsCancelled(const auth::TokenEndpoint::TokenResponse& response) {
+  return !response.IsSuccessful() &&
+         response.GetError().GetErrorCode() == client::ErrorCode::Cancelled;
+}
+
+auth::AutoRefreshingToken::GetTokenCallback SetValue(TokenPromise& promise) {
+  return [&promise](const auth::TokenEndpoint::TokenResponse& response) {
+    promise.set_value(response);
+  };
+}
+
+class AutoRefreshingTokenTest : public ::testing::Test {
+ protected:
+  auth::AutoRefreshingToken CreateToken(
+      std::chrono::seconds refresh_ahead = std::chrono::seconds(0),
+      bool with_scheduler = false) {
+    auth::Settings settings({"key", "secret"});
+    settings.network_request_handler = network_;
+    settings.token_endpoint_url = kTokenEndpointUrl;
+    if (with_scheduler) {
+      settings.task_scheduler = scheduler_;
+    }
+    return auth::TokenEndpoint(settings).RequestAutoRefreshingToken(
+        auth::TokenRequest(), refresh_ahead);
+  }
+
+  // Gets the token with a blocking call on another thread.
+  TokenFuture GetTokenAsync(const auth::AutoRefreshingToken& token) {
+    return std::async(std::launch::async,
+                      [&token]() { return token.GetToken(kMinimumValidity); });
+  }
+
+  // Gets the first token through the scheduler.
+  void GetFirstToken(const auth::AutoRefreshingToken& token) {
+    TokenPromise promise;
+    token.GetToken(SetValue(promise), kMinimumValidity);
+    auto thread = scheduler_->RunTasks();
+    ASSERT_TRUE(network_->Respond("token-1"));
+    thread.join();
+    ASSERT_TRUE(HasToken(promise.get_future().get(), "token-1"));
+  }
+
+  std::shared_ptr<TokenNetwork> network_ = std::make_shared<TokenNetwork>();
+  std::shared_ptr<ManualTaskScheduler> scheduler_ =
+      std::make_shared<ManualTaskScheduler>();
+};
+
+TEST_F(AutoRefreshingTokenTest, SingleRequestInFlight) {
+  const auto token = CreateToken();
+
+  auto blocking_response = GetTokenAsync(token);
+  ASSERT_TRUE(network_->WaitForRequest());
+
+  // The callers join the request in flight.
+  TokenPromise first_promise;
+  TokenPromise second_promise;
+  token.GetToken(SetValue(first_promise), kMinimumValidity);
+  token.GetToken(SetValue(second_promise), kMinimumValidity);
+
+  ASSERT_TRUE(network_->Respond("token-1"));
+  EXPECT_TRUE(HasToken(blocking_response.get(), "token-1"));
+  EXPECT_TRUE(HasToken(first_promise.get_future().get(), "token-1"));
+  EXPECT_TRUE(HasToken(second_promise.get_future().get(), "token-1"));
+  EXPECT_EQ(network_->GetRequestsCount(), 1u);
+
+  // The token is cached.
+  EXPECT_TRUE(HasToken(token.GetToken(kMinimumValidity), "token-1"));
+  EXPECT_EQ(network_->GetRequestsCount(), 1u);
+}
+
+TEST_F(AutoRefreshingTokenTest, RetryAfterFailure) {
+  const auto token = CreateToken();
+
+  auto response = GetTokenAsync(token);
+  ASSERT_TRUE(network_->Respond("", http::HttpStatusCode::UNAUTHORIZED));
+  EXPECT_TRUE(IsFailed(response.get()));
+
+  // The failed response is not cached, the next call requests a new token.
+  response = GetTokenAsync(token);
+  ASSERT_TRUE(network_->Respond("token-1"));
+  EXPECT_TRUE(HasToken(response.get(), "token-1"));
+  EXPECT_EQ(network_->GetRequestsCount(), 2u);
+}
+
+TEST_F(AutoRefreshingTokenTest, RefreshAhead) {
+  const auto token = CreateToken(kRefreshAhead, true);
+  GetFirstToken(token);
+
+  // The old token is returned, and a single refresh is scheduled.
+  EXPECT_TRUE(HasToken(token.GetToken(kMinimumValidity), "token-1"));
+  EXPECT_TRUE(HasToken(token.GetToken(kMinimumValidity), "token-1"));
+  EXPECT_EQ(scheduler_->GetTasksCount(), 1u);
+
+  auto thread = scheduler_->RunTasks();
+  ASSERT_TRUE(network_->WaitForRequest());
+
+  // The old token is served while the refresh is in flight.
+  EXPECT_TRUE(HasToken(token.GetToken(kMinimumValidity), "token-1"));
+  EXPECT_EQ(scheduler_->GetTasksCount(), 0u);
+  EXPECT_EQ(network_->GetRequestsCount(), 2u);
+
+  ASSERT_TRUE(network_->Respond("token-2"));
+  thread.join();
+  EXPECT_TRUE(HasToken(token.GetToken(kMinimumValidity), "token-2"));
+}
+
+TEST_F(AutoRefreshingTokenTest, RefreshAheadFailure) {
+  const auto token = CreateToken(kRefreshAhead, true);
+  GetFirstToken(token);
+
+  EXPECT_TRUE(HasToken(token.GetToken(kMinimumValidity), "token-1"));
+  auto thread = scheduler_->RunTasks();
+  ASSERT_TRUE(network_->Respond("", http::HttpStatusCode::UNAUTHORIZED));
+  thread.join();
+
+  // The valid token is kept, and the refresh is not retried right away.
+  EXPECT_TRUE(HasToken(token.GetToken(kMinimumValidity), "token-1"));
+  EXPECT_EQ(scheduler_->GetTasksCount(), 0u);
+  EXPECT_EQ(network_->GetRequestsCount(), 2u);
+}
+
+TEST_F(AutoRefreshingTokenTest, CancelWaiters) {
+  const auto token = CreateToken(std::chrono::seconds(0), true);
+
+  {
+    SCOPED_TRACE("One of the waiters cancels");
+
+    TokenPromise cancelled_promise;
+    TokenPromise promise;
+    auto cancellation_token =
+        token.GetToken(SetValue(cancelled_promise), kMinimumValidity);
+    token.GetToken(SetValue(promise), kMinimumValidity);
+
+    cancellation_token.Cancel();
+    EXPECT_TRUE(IsCancelled(cancelled_promise.get_future().get()));
+
+    auto thread = scheduler_->RunTasks();
+    ASSERT_TRUE(network_->Respond("token-1"));
+    thread.join();
+    EXPECT_TRUE(HasToken(promise.get_future().get(), "token-1"));
+    EXPECT_EQ(network_->GetRequestsCount(), 1u);
+  }
+
+  {
+    SCOPED_TRACE("All waiters cancel before the request starts");
+
+    TokenPromise promise;
+    token.GetToken(SetValue(promise), auth::kForceRefresh).Cancel();
+    EXPECT_TRUE(IsCancelled(promise.get_future().get()));
+
+    scheduler_->RunTasks().join();
+    EXPECT_EQ(network_->GetRequestsCount(), 1u);
+  }
+
+  {
+    SCOPED_TRACE("All waiters cancel while the request is in flight");
+
+    TokenPromise promise;
+    auto cancellation_token =
+        token.GetToken(SetValue(promise), auth::kForceRefresh);
+    auto thread = scheduler_->RunTasks();
+    ASSERT_TRUE(network_->WaitForRequest());
+
+    cancellation_token.Cancel();
+    EXPECT_TRUE(IsCancelled(promise.get_future().get()));
+
+    // The abandoned response does not replace the current token.
+    ASSERT_TRUE(network_->Respond("token-2"));
+    thread.join();
+    EXPECT_TRUE(HasToken(token.GetToken(kMinimumValidity), "token-1"));
+    EXPECT_EQ(network_->GetRequestsCount(), 2u);
+  }
+}
+
+}  // namespace
+
+PORTING_POP_WARNINGS()
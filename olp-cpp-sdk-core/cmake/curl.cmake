@@ -50,6 +50,10 @@ if(CURL_FOUND AND NOT NETWORK_NO_CURL)
     if(OLP_SDK_HAS_PIPE2)
         add_definitions(-DOLP_SDK_NETWORK_HAS_PIPE2=1)
     endif()
+    check_symbol_exists(epoll_create1 "sys/epoll.h" OLP_SDK_HAS_EPOLL)
+    if(OLP_SDK_HAS_EPOLL AND OLP_SDK_HAS_PIPE2)
+        add_definitions(-DOLP_SDK_NETWORK_HAS_EPOLL=1)
+    endif()
 
 else()
     set(OLP_SDK_HTTP_CURL_SOURCES)
@@ -145,6 +145,20 @@ struct CORE_API CacheSettings {
    */
   CompressionType compression = CompressionType::kDefaultCompression;
 
+  /**
+   * @brief Sets the value size (in bytes) above which the values of the
+   * mutable cache are stored outside of the database.
+   *
+   * Such values are appended to the segment files in the `value_log` folder
+   * of `disk_path_mutable`, and the database only keeps their location, so
+   * large values are not rewritten on every database compaction. The removed
+   * and overwritten values count against `max_disk_storage` until their
+   * space is reclaimed in the background. The space of the evicted values is
+   * reclaimed after the eviction and on `DefaultCache::Compact`. If set to
+   * `0`, all values are stored in the database. The default value is `0`.
+   */
+  size_t large_value_threshold = 0u;
+
   /**
    * @brief The path to the protected (read-only) cache.
    *
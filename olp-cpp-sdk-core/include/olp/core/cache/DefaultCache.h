@@ -19,9 +19,12 @@
 
 #pragma once
 
+#include <chrono>
+#include <cstdint>
 #include <memory>
 #include <mutex>
 #include <string>
+#include <vector>
 
 #include <olp/core/Config.h>
 #include "CacheSettings.h"
@@ -51,6 +54,11 @@ class DefaultCacheImpl;
  * limitation, the default cache can be accessed only by one process
  * exclusively.
  *
+ * A mutable cache written by an older SDK version is converted to the current
+ * format when it is opened in the read-write mode. The converted cache can't
+ * be read by older SDK versions. Read-only and protected caches are read in
+ * the format they were written in.
+ *
  * By default, the maximum size of the memory cache is 1MB. To change it,
  * set `olp::cache::CacheSettings::max_memory_cache_size` to the desired value.
  */
@@ -74,6 +82,62 @@ class CORE_API DefaultCache : public KeyValueCache {
     kProtected /*!< The protected cache type. */
   };
 
+  /**
+   * @brief The eviction statistics of the mutable cache.
+   */
+  struct EvictionStatistics {
+    /// The number of eviction runs.
+    uint64_t runs{0u};
+    /// The number of evicted values.
+    uint64_t evicted_count{0u};
+    /// The size of the evicted keys and values.
+    uint64_t evicted_bytes{0u};
+    /// The total time spent on eviction.
+    std::chrono::microseconds time{0};
+  };
+
+  /**
+   * @brief The lookup statistics of one cache tier.
+   */
+  struct TierStatistics {
+    /// The number of lookups which found the value.
+    uint64_t hits{0u};
+    /// The number of lookups which did not find the value.
+    uint64_t misses{0u};
+  };
+
+  /**
+   * @brief The cache statistics, collected since the cache was created.
+   *
+   * The lookups go through the tiers in order: memory, protected, mutable.
+   * A tier is only counted when the lookup reaches it.
+   */
+  struct Statistics {
+    /// The memory cache lookups.
+    TierStatistics memory;
+    /// The mutable disk cache lookups.
+    TierStatistics mutable_cache;
+    /// The protected disk cache lookups.
+    TierStatistics protected_cache;
+    /// The size of the values read from the disk caches.
+    uint64_t bytes_read{0u};
+    /// The size of the keys and values written to the mutable cache.
+    uint64_t bytes_written{0u};
+    /// The mutable cache eviction.
+    EvictionStatistics eviction;
+    /// The time the operations waited for other operations to release the
+    /// cache, e.g. for `Open`, `Close` or `Compact`.
+    std::chrono::microseconds lock_wait_time{0};
+    /// The number of mutable cache compactions.
+    uint64_t compactions{0u};
+    /// The total time spent on the mutable cache compactions.
+    std::chrono::microseconds compaction_time{0};
+    /// The LevelDB compaction statistics of the mutable cache per level, as
+    /// reported by the `leveldb.stats` property. Empty if the mutable cache is
+    /// not open.
+    std::string storage_statistics;
+  };
+
   /**
    * @brief Creates the `DefaultCache` instance.
    *
@@ -173,6 +237,17 @@ class CORE_API DefaultCache : public KeyValueCache {
   bool Put(const std::string& key, const KeyValueCache::ValueTypePtr value,
            time_t expiry) override;
 
+  /**
+   * @brief Stores the key-value pairs in the cache.
+   *
+   * All the values are written to the mutable cache in a single batch.
+   *
+   * @param items The key-value pairs.
+   *
+   * @return True if the operation is successful; false otherwise.
+   */
+  bool PutBatch(const KeyValueCache::BatchItemListType& items) override;
+
   /**
    * @brief Gets the key-value pair from the cache.
    *
@@ -192,6 +267,32 @@ class CORE_API DefaultCache : public KeyValueCache {
    */
   KeyValueCache::ValueTypePtr Get(const std::string& key) override;
 
+  /**
+   * @brief Gets the values of the keys from the cache.
+   *
+   * The keys missing in the memory cache are read from the same disk cache
+   * snapshot, in the key order.
+   *
+   * @param keys The keys that are used to look for the values.
+   * @param decoder Decodes the values from a string.
+   *
+   * @return The values in the order of the keys. The value is empty if the
+   * key is not found.
+   */
+  std::vector<boost::any> GetBatch(const KeyValueCache::KeyListType& keys,
+                                   const Decoder& decoder) override;
+
+  /**
+   * @brief Gets the binary data of the keys from the cache.
+   *
+   * @param keys The keys that are used to look for the binary data.
+   *
+   * @return The binary data in the order of the keys. The data is `nullptr` if
+   * the key is not found.
+   */
+  std::vector<KeyValueCache::ValueTypePtr> GetBatch(
+      const KeyValueCache::KeyListType& keys) override;
+
   /**
    * @brief Removes the key-value pair from the cache.
    *
@@ -220,6 +321,17 @@ class CORE_API DefaultCache : public KeyValueCache {
    */
   bool Contains(const std::string& key) const override;
 
+  /**
+   * @brief Checks if the keys are in the cache.
+   *
+   * @param keys The keys for the values.
+   *
+   * @return The flags in the order of the keys, true if the key/value is
+   * cached; false otherwise.
+   */
+  std::vector<bool> ContainsBatch(
+      const KeyValueCache::KeyListType& keys) const override;
+
   /**
    * @brief Protects keys from eviction.
    *
@@ -275,6 +387,28 @@ class CORE_API DefaultCache : public KeyValueCache {
    */
   uint64_t Size(uint64_t new_size);
 
+  /**
+   * @brief Gets the eviction statistics of the mutable cache.
+   *
+   * The mutable cache is evicted in the background once it is filled up to
+   * 90% of `CacheSettings::max_disk_storage`, until it is filled up to 85%.
+   * The writes wait for the eviction only when the cache exceeds the maximum
+   * size.
+   *
+   * @return The statistics collected since the cache was created.
+   */
+  EvictionStatistics GetEvictionStatistics() const;
+
+  /**
+   * @brief Gets the cache statistics.
+   *
+   * The counters are updated without blocking the cache operations, so the
+   * statistics of the operations running concurrently might be incomplete.
+   *
+   * @return The statistics collected since the cache was created.
+   */
+  Statistics GetStatistics() const;
+
  private:
   std::shared_ptr<DefaultCacheImpl> impl_;
 };
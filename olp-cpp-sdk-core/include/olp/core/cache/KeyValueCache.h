@@ -63,6 +63,25 @@ class CORE_API KeyValueCache {
    */
   using KeyListType = std::vector<std::string>;
 
+  /**
+   * @brief The key-value pair that is stored by `PutBatch`.
+   */
+  struct BatchItem {
+    /// The key for this value.
+    std::string key;
+    /// The value of any type.
+    boost::any value;
+    /// Encodes the specified value into a string.
+    Encoder encoder;
+    /// The expiry time (in seconds) of the key-value pair.
+    time_t expiry;
+  };
+
+  /**
+   * @brief Alias for the list of key-value pairs stored by `PutBatch`.
+   */
+  using BatchItemListType = std::vector<BatchItem>;
+
   virtual ~KeyValueCache() = default;
 
   /**
@@ -90,6 +109,25 @@ class CORE_API KeyValueCache {
   virtual bool Put(const std::string& key, const ValueTypePtr value,
                    time_t expiry = kDefaultExpiry) = 0;
 
+  /**
+   * @brief Stores the key-value pairs in the cache.
+   *
+   * The default implementation calls `Put` for every item and stops on the
+   * first failure.
+   *
+   * @param items The key-value pairs.
+   *
+   * @return True if all the items are stored; false otherwise.
+   */
+  virtual bool PutBatch(const BatchItemListType& items) {
+    for (const auto& item : items) {
+      if (!Put(item.key, item.value, item.encoder, item.expiry)) {
+        return false;
+      }
+    }
+    return true;
+  }
+
   /**
    * @brief Gets the key-value pair from the cache.
    *
@@ -109,6 +147,46 @@ class CORE_API KeyValueCache {
    */
   virtual ValueTypePtr Get(const std::string& key) = 0;
 
+  /**
+   * @brief Gets the values of the keys from the cache.
+   *
+   * The default implementation calls `Get` for every key.
+   *
+   * @param keys The keys that are used to look for the values.
+   * @param decoder Decodes the values from a string.
+   *
+   * @return The values in the order of the keys. The value is empty if the
+   * key is not found.
+   */
+  virtual std::vector<boost::any> GetBatch(const KeyListType& keys,
+                                           const Decoder& decoder) {
+    std::vector<boost::any> values;
+    values.reserve(keys.size());
+    for (const auto& key : keys) {
+      values.emplace_back(Get(key, decoder));
+    }
+    return values;
+  }
+
+  /**
+   * @brief Gets the binary data of the keys from the cache.
+   *
+   * The default implementation calls `Get` for every key.
+   *
+   * @param keys The keys that are used to look for the binary data.
+   *
+   * @return The binary data in the order of the keys. The data is `nullptr` if
+   * the key is not found.
+   */
+  virtual std::vector<ValueTypePtr> GetBatch(const KeyListType& keys) {
+    std::vector<ValueTypePtr> values;
+    values.reserve(keys.size());
+    for (const auto& key : keys) {
+      values.emplace_back(Get(key));
+    }
+    return values;
+  }
+
   /**
    * @brief Removes the key-value pair from the cache.
    *
@@ -140,6 +218,25 @@ class CORE_API KeyValueCache {
     return false;
   }
 
+  /**
+   * @brief Checks if the keys are in the cache.
+   *
+   * The default implementation calls `Contains` for every key.
+   *
+   * @param keys The keys for the values.
+   *
+   * @return The flags in the order of the keys, true if the key/value is
+   * cached; false otherwise.
+   */
+  virtual std::vector<bool> ContainsBatch(const KeyListType& keys) const {
+    std::vector<bool> result;
+    result.reserve(keys.size());
+    for (const auto& key : keys) {
+      result.push_back(Contains(key));
+    }
+    return result;
+  }
+
   /**
    * @brief Protects keys from eviction.
    *
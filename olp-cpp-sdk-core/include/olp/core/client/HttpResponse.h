@@ -19,6 +19,7 @@
 
 #pragma once
 
+#include <memory>
 #include <sstream>
 #include <string>
 #include <utility>
@@ -117,6 +118,24 @@ class CORE_API HttpResponse {
         response(std::move(response)),
         headers(std::move(headers)) {}
 
+  /**
+   * @brief Creates the `HttpResponse` instance with the response body stored
+   * in a contiguous buffer.
+   *
+   * The body is not copied to the `response` stream. Use the `GetResponse`
+   * methods to read it, or `MoveResponseData` to take it without copying.
+   *
+   * @param status The HTTP status.
+   * @param response_data The response body.
+   * @param headers Response headers.
+   */
+  HttpResponse(int status,
+               std::shared_ptr<std::vector<unsigned char>> response_data,
+               http::Headers headers)
+      : status(status),
+        headers(std::move(headers)),
+        response_data_(std::move(response_data)) {}
+
   /**
    * @brief Copy constructor.
    *
@@ -127,6 +146,10 @@ class CORE_API HttpResponse {
    */
   HttpResponse(const HttpResponse& other)
       : status(other.status), headers(other.headers) {
+    if (other.response_data_) {
+      response_data_ =
+          std::make_shared<std::vector<unsigned char>>(*other.response_data_);
+    }
     response << other.response.rdbuf();
     if (!response.good()) {
       // Depending on the users handling of the stringstream it might be that
@@ -150,6 +173,11 @@ class CORE_API HttpResponse {
       status = other.status;
       response << other.response.rdbuf();
       headers = other.headers;
+      response_data_ =
+          other.response_data_
+              ? std::make_shared<std::vector<unsigned char>>(
+                    *other.response_data_)
+              : nullptr;
     }
 
     return *this;
@@ -165,6 +193,11 @@ class CORE_API HttpResponse {
    * @param output Reference to a vector.
    */
   void GetResponse(std::vector<unsigned char>& output) {
+    if (response_data_) {
+      output = *response_data_;
+      return;
+    }
+
     response.seekg(0, std::ios::end);
     const auto pos = response.tellg();
     if (pos > 0) {
@@ -180,7 +213,33 @@ class CORE_API HttpResponse {
    *
    * @param output Reference to a string.
    */
-  void GetResponse(std::string& output) { output = response.str(); }
+  void GetResponse(std::string& output) {
+    if (response_data_) {
+      output.assign(response_data_->begin(), response_data_->end());
+      return;
+    }
+
+    output = response.str();
+  }
+
+  /**
+   * @brief Moves the `HttpResponse` content out to a vector of unsigned chars.
+   *
+   * If the body is stored in a contiguous buffer, it is returned without
+   * copying, and the response body is empty afterwards. Otherwise, the body
+   * is copied from the `response` stream.
+   *
+   * @return The response body.
+   */
+  std::shared_ptr<std::vector<unsigned char>> MoveResponseData() {
+    if (response_data_) {
+      return std::move(response_data_);
+    }
+
+    auto output = std::make_shared<std::vector<unsigned char>>();
+    GetResponse(*output);
+    return output;
+  }
 
   /**
    * @brief Return the const reference to the response headers.
@@ -233,6 +292,8 @@ class CORE_API HttpResponse {
 
  private:
   NetworkStatistics network_statistics_;
+  /// The response body when it is stored in a contiguous buffer.
+  std::shared_ptr<std::vector<unsigned char>> response_data_;
 };
 
 }  // namespace client
@@ -136,14 +136,25 @@ class CORE_API OlpClient {
    * @param content_type The content type for the `post_body` or `form_params`.
    * @param context The `CancellationContext` instance that is used to cancel
    * the request.
+   * @param buffer_response If true, the body of a successful response is
+   * stored in a contiguous buffer that is sized using the `Content-Length`
+   * header instead of the `HttpResponse::response` stream. Use it for large
+   * bodies and take the body with `HttpResponse::MoveResponseData` without
+   * copying.
+   * @param data_callback The callback that receives the chunks of the body as
+   * they arrive. Unless `buffer_response` is true, the body is not stored in
+   * the `HttpResponse` instance. Each retry delivers the body again starting
+   * from the zero offset. The body of an error response is not delivered,
+   * so a small body is delivered once the response is complete.
    *
    * @return The `HttpResponse` instance.
    */
-  HttpResponse CallApi(std::string path, std::string method,
-                       ParametersType query_params,
-                       ParametersType header_params, ParametersType form_params,
-                       RequestBodyType post_body, std::string content_type,
-                       CancellationContext context) const;
+  HttpResponse CallApi(
+      std::string path, std::string method, ParametersType query_params,
+      ParametersType header_params, ParametersType form_params,
+      RequestBodyType post_body, std::string content_type,
+      CancellationContext context, bool buffer_response = false,
+      http::Network::DataCallback data_callback = nullptr) const;
 
  private:
   class OlpClientImpl;
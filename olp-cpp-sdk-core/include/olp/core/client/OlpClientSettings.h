@@ -281,6 +281,17 @@ struct CORE_API OlpClientSettings {
    */
   boost::optional<http::NetworkProxySettings> proxy_settings = boost::none;
 
+  /**
+   * @brief Enables HTTP/2 for the requests.
+   *
+   * The requests to the same host are multiplexed over a single connection,
+   * which reduces the number of connections needed for the bulk downloads.
+   * Disabled by default.
+   *
+   * @see `http::NetworkSettings::WithHttp2Enabled` for more details.
+   */
+  bool http2_enabled = false;
+
   /**
    * @brief The authentication settings.
    *
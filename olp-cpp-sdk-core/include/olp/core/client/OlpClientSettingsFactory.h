@@ -24,6 +24,7 @@
 #include <olp/core/CoreApi.h>
 #include <olp/core/http/Network.h>
 #include <olp/core/thread/TaskScheduler.h>
+#include <olp/core/thread/ThreadPoolSettings.h>
 #include <boost/optional.hpp>
 
 namespace olp {
@@ -53,6 +54,20 @@ class CORE_API OlpClientSettingsFactory final {
   static std::unique_ptr<thread::TaskScheduler> CreateDefaultTaskScheduler(
       size_t thread_count = 1u);
 
+  /**
+   * @brief Creates the `TaskScheduler` instance used for all the delayed
+   * operations with the custom scheduling policy.
+   *
+   * Defaulted to `olp::thread::ThreadPoolTaskScheduler`.
+   *
+   * @param settings The thread pool settings, e.g. the priority aging and the
+   * concurrency limits per priority band.
+   *
+   * @return The `TaskScheduler` instance.
+   */
+  static std::unique_ptr<thread::TaskScheduler> CreateDefaultTaskScheduler(
+      const thread::ThreadPoolSettings& settings);
+
   /**
    * @brief Creates the `Network` instance used for all the non-local requests.
    *
@@ -74,6 +89,20 @@ class CORE_API OlpClientSettingsFactory final {
   static std::shared_ptr<http::Network> CreateDefaultNetworkRequestHandler(
       size_t max_requests_count = 30u);
 
+  /**
+   * @brief Creates the `Network` instance used for all the non-local requests.
+   *
+   * Same as the overload above, but also configures the resources shared by
+   * all requests, like the connection limits.
+   *
+   * @param[in] settings The settings that are applied to the whole network
+   * instance.
+   *
+   * @return The `Network` instance.
+   */
+  static std::shared_ptr<http::Network> CreateDefaultNetworkRequestHandler(
+      http::NetworkInitializationSettings settings);
+
   /**
    * @brief Creates the `KeyValueCache` instance that includes both a small
    * memory LRU cache and a larger persistent database cache.
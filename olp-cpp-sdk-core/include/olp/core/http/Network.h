@@ -25,6 +25,7 @@
 #include <string>
 
 #include <olp/core/CoreApi.h>
+#include <olp/core/http/NetworkInitializationSettings.h>
 #include <olp/core/http/NetworkRequest.h>
 #include <olp/core/http/NetworkResponse.h>
 #include <olp/core/http/NetworkTypes.h>
@@ -137,5 +138,14 @@ class CORE_API Network {
 CORE_API std::shared_ptr<Network> CreateDefaultNetwork(
     size_t max_requests_count);
 
+/**
+ * @brief Creates a default `Network` implementation.
+ *
+ * @param[in] settings The settings that are applied to the whole network
+ * instance.
+ */
+CORE_API std::shared_ptr<Network> CreateDefaultNetwork(
+    NetworkInitializationSettings settings);
+
 }  // namespace http
 }  // namespace olp
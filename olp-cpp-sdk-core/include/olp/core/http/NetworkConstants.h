@@ -29,7 +29,10 @@ namespace http {
  * @brief The HTTP headers.
  */
 static constexpr auto kAuthorizationHeader = "Authorization";
+static constexpr auto kContentLengthHeader = "Content-Length";
+static constexpr auto kContentRangeHeader = "Content-Range";
 static constexpr auto kContentTypeHeader = "Content-Type";
+static constexpr auto kRangeHeader = "Range";
 static constexpr auto kUserAgentHeader = "User-Agent";
 
 /**
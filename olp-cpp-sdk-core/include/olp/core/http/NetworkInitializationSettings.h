@@ -0,0 +1,78 @@
+/*
+ * Copyright (C) 2021 HERE Europe B.V.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ * License-Filename: LICENSE
+ */
+
+#pragma once
+
+#include <cstddef>
+
+#include <olp/core/CoreApi.h>
+
+namespace olp {
+namespace http {
+
+/**
+ * @brief Settings that are applied to the whole network instance on
+ * creation.
+ *
+ * Unlike `NetworkSettings`, which are applied per request, these settings
+ * configure the resources shared by all requests, like the connection pool.
+ */
+struct CORE_API NetworkInitializationSettings {
+  /**
+   * @brief The maximum number of requests that can be sent simultaneously.
+   */
+  std::size_t max_requests_count = 30u;
+
+  /**
+   * @brief The maximum number of connections that are opened to a single
+   * host.
+   *
+   * Requests that exceed the limit wait for a free connection. The default
+   * value is 0, which means no limit.
+   *
+   * @note Only supported by the libcurl-based network.
+   */
+  std::size_t max_host_connections = 0u;
+
+  /**
+   * @brief The maximum number of connections that are opened
+   * simultaneously.
+   *
+   * Requests that exceed the limit wait for a free connection. The default
+   * value is 0, which means no limit.
+   *
+   * @note Only supported by the libcurl-based network.
+   */
+  std::size_t max_total_connections = 0u;
+
+  /**
+   * @brief The maximum number of concurrent streams over a single HTTP/2
+   * connection.
+   *
+   * Applies only to the requests with HTTP/2 enabled, see
+   * `NetworkSettings::WithHttp2Enabled`. The default value is 0, which means
+   * the library default (100).
+   *
+   * @note Only supported by the libcurl-based network.
+   */
+  std::size_t max_concurrent_streams = 0u;
+};
+
+}  // namespace http
+}  // namespace olp
@@ -98,6 +98,28 @@ class CORE_API NetworkSettings final {
    */
   NetworkSettings& WithProxySettings(NetworkProxySettings settings);
 
+  /**
+   * @brief Checks whether HTTP/2 is enabled for the request.
+   *
+   * @return True if HTTP/2 is enabled; false otherwise.
+   */
+  bool GetHttp2Enabled() const;
+
+  /**
+   * @brief Enables HTTP/2 for the request.
+   *
+   * HTTPS requests negotiate HTTP/2 with the server and fall back to
+   * HTTP/1.1 if the server does not support it. HTTP/2 requests to the same
+   * host are multiplexed over a single connection. Disabled by default.
+   *
+   * @note Only supported by the libcurl-based network.
+   *
+   * @param[in] enabled True to enable HTTP/2; false otherwise.
+   *
+   * @return A reference to *this.
+   */
+  NetworkSettings& WithHttp2Enabled(bool enabled);
+
  private:
   /// The maximum number of retries for the HTTP request.
   std::size_t retries_{3};
@@ -107,6 +129,8 @@ class CORE_API NetworkSettings final {
   int transfer_timeout_{30};
   /// The network proxy settings.
   NetworkProxySettings proxy_settings_;
+  /// Whether HTTP/2 is enabled.
+  bool http2_enabled_{false};
 };
 
 }  // namespace http
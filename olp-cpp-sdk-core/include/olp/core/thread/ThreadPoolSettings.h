@@ -0,0 +1,90 @@
+/*
+ * Copyright (C) 2021 HERE Europe B.V.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ * License-Filename: LICENSE
+ */
+
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include <olp/core/CoreApi.h>
+
+namespace olp {
+namespace thread {
+
+/**
+ * @brief Limits the number of threads that execute the tasks of a priority
+ * band simultaneously.
+ */
+struct CORE_API PriorityBandLimit {
+  /**
+   * @brief The highest priority of the band.
+   *
+   * The band includes all priorities up to this value that are not included
+   * in a band with a lower `max_priority`.
+   */
+  uint32_t max_priority;
+
+  /**
+   * @brief The maximum number of threads that execute the tasks of the band
+   * simultaneously.
+   *
+   * Zero is raised to one thread. A limit that is not lower than
+   * `ThreadPoolSettings::thread_count` does not limit the band.
+   */
+  size_t max_threads;
+};
+
+/**
+ * @brief Settings for the `ThreadPoolTaskScheduler` instance.
+ */
+struct CORE_API ThreadPoolSettings {
+  /**
+   * @brief The number of threads initialized in the thread pool.
+   */
+  size_t thread_count = 1u;
+
+  /**
+   * @brief The time after which the priority of a queued task grows by one.
+   *
+   * With aging, a task with a low priority eventually runs before the newer
+   * tasks with a higher priority, so the steady flow of the higher priority
+   * tasks cannot starve it. For example, with 1 ms, a `LOW` priority task
+   * that waits for 400 ms runs before a new `NORMAL` priority task.
+   *
+   * The default value is 0, which disables aging.
+   */
+  std::chrono::milliseconds aging_interval{0};
+
+  /**
+   * @brief The concurrency limits per priority band.
+   *
+   * Use them to keep the threads free for the interactive requests while the
+   * background tasks are executed, e.g. to execute the `LOW` priority
+   * prefetch tasks on at most two threads:
+   * `{{thread::LOW, 2u}}`.
+   *
+   * Tasks with a priority higher than all bands are not limited.
+   */
+  std::vector<PriorityBandLimit> band_limits;
+};
+
+}  // namespace thread
+}  // namespace olp
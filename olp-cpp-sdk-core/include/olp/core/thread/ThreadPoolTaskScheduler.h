@@ -23,6 +23,7 @@
 #include <vector>
 
 #include <olp/core/thread/TaskScheduler.h>
+#include <olp/core/thread/ThreadPoolSettings.h>
 
 namespace olp {
 namespace thread {
@@ -42,7 +43,16 @@ class CORE_API ThreadPoolTaskScheduler final : public TaskScheduler {
   explicit ThreadPoolTaskScheduler(size_t thread_count = 1u);
 
   /**
-   * @brief Closes the `SyncQueue` instance and joins threads.
+   * @brief Creates the `ThreadPoolTaskScheduler` object with the scheduling
+   * policy.
+   *
+   * @param settings The number of threads, the priority aging, and the
+   * concurrency limits per priority band.
+   */
+  explicit ThreadPoolTaskScheduler(const ThreadPoolSettings& settings);
+
+  /**
+   * @brief Closes the queue and joins threads.
    */
   ~ThreadPoolTaskScheduler() override;
 
@@ -86,7 +96,7 @@ class CORE_API ThreadPoolTaskScheduler final : public TaskScheduler {
 
   /// Thread pool created in constructor.
   std::vector<std::thread> thread_pool_;
-  /// SyncQueue used to manage tasks.
+  /// The priority queues used to manage tasks.
   std::unique_ptr<QueueImpl> queue_;
 };
 
@@ -0,0 +1,107 @@
+/*
+ * Copyright (C) 2021 HERE Europe B.V.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ * License-Filename: LICENSE
+ */
+
+#pragma once
+
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include <olp/core/thread/TaskScheduler.h>
+
+namespace olp {
+namespace thread {
+
+/**
+ * @brief An implementation of the `TaskScheduler` instance that uses a thread
+ * pool with a task queue per thread.
+ *
+ * Unlike `ThreadPoolTaskScheduler`, which shares one queue between all
+ * threads, every thread has its own queue. Tasks scheduled from a pool thread
+ * are added to the queue of that thread, and tasks scheduled from other
+ * threads are distributed between the queues. An idle thread takes the task
+ * with the highest priority from all queues, its own queue first, and steals
+ * from other threads only when they have more urgent or any work. It reduces
+ * the lock contention when many small tasks are scheduled, e.g. by prefetch.
+ *
+ * Tasks with the same priority that are added to the same queue keep their
+ * order. With one thread, the order is the same as with
+ * `ThreadPoolTaskScheduler`.
+ */
+class CORE_API WorkStealingTaskScheduler final : public TaskScheduler {
+ public:
+  /**
+   * @brief Creates the `WorkStealingTaskScheduler` object.
+   *
+   * @param thread_count The number of threads initialized in the thread pool.
+   */
+  explicit WorkStealingTaskScheduler(size_t thread_count = 1u);
+
+  /**
+   * @brief Discards the queued tasks and joins threads.
+   */
+  ~WorkStealingTaskScheduler() override;
+
+  /// Non-copyable, non-movable
+  WorkStealingTaskScheduler(const WorkStealingTaskScheduler&) = delete;
+  /// Non-copyable, non-movable
+  WorkStealingTaskScheduler& operator=(const WorkStealingTaskScheduler&) =
+      delete;
+  /// Non-copyable, non-movable
+  WorkStealingTaskScheduler(WorkStealingTaskScheduler&&) = delete;
+  /// Non-copyable, non-movable
+  WorkStealingTaskScheduler& operator=(WorkStealingTaskScheduler&&) = delete;
+
+ protected:
+  /**
+   * @brief Overrides the base class method to enqueue tasks and execute them on
+   * the next free thread from the thread pool.
+   *
+   * @note Tasks added with this method has Priority::NORMAL priority.
+   *
+   * @param func The rvalue reference of the task that should be enqueued.
+   * Move this task into your queue. No internal references are
+   * kept. Once this method is called, you own the task.
+   */
+  void EnqueueTask(TaskScheduler::CallFuncType&& func) override;
+
+  /**
+   * @brief Overrides the base class method to enqueue tasks and execute them on
+   * the next free thread from the thread pool.
+   *
+   * @param func The rvalue reference of the task that should be enqueued.
+   * Move this task into your queue. No internal references are
+   * kept. Once this method is called, you own the task.
+   * @param priority The priority of the task. Tasks with higher priority
+   * executes earlier.
+   */
+  void EnqueueTask(TaskScheduler::CallFuncType&& func,
+                   uint32_t priority) override;
+
+ private:
+  class Impl;
+
+  /// Thread pool created in constructor.
+  std::vector<std::thread> thread_pool_;
+  /// The per thread queues and the state shared by the threads.
+  std::unique_ptr<Impl> impl_;
+};
+
+}  // namespace thread
+}  // namespace olp
@@ -0,0 +1,785 @@
+/*
+ * Copyright (C) 2021 HERE Europe B.V.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ * License-Filename: LICENSE
+ */
+
+#pragma once
+
+#include <cassert>
+#include <cstddef>
+#include <functional>
+#include <iterator>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include <olp/core/utils/LruCache.h>
+
+namespace olp {
+namespace utils {
+/**
+ * @brief A generic key-value LRU cache with hashed lookup.
+ *
+ * Has the same interface and eviction behavior as `LruCache`, but finds the
+ * elements in constant time. The elements are stored in nodes taken from a
+ * pool, which are linked into the hash buckets and into the LRU list, so
+ * inserting an element allocates only when the pool is exhausted.
+ *
+ * Use it instead of `LruCache` for caches with many elements that are looked
+ * up frequently. Unlike `LruCache`, the keys are not ordered.
+ *
+ * @tparam Key The `HashedLruCache` key type.
+ * @tparam Value The `HashedLruCache` value type.
+ * @tparam CacheCostFunc The cache cost functor.
+ * The specializations should return a non-zero value for any given object.
+ * The default implementation returns "1" as the size for each object.
+ * @tparam Hash The hash function for the keys.
+ * @tparam KeyEqual The function to compare the keys for equality.
+ * @tparam Alloc The allocator to be used for allocating internal data.
+ * The default value of `std::allocator` is used.
+ */
+template <typename Key, typename Value,
+          typename CacheCostFunc = CacheCost<Value>,
+          typename Hash = std::hash<Key>,
+          typename KeyEqual = std::equal_to<Key>,
+          template <typename> class Alloc = std::allocator>
+class HashedLruCache {
+  struct Node;
+
+ public:
+  /// An alias for the eviction function.
+  using EvictionFunction = std::function<void(const Key&, Value&&)>;
+
+  /// An alias for the key hash function.
+  using HasherType = Hash;
+
+  /// An alias for the key equality function.
+  using KeyEqualType = KeyEqual;
+
+  /// An alias for the cache allocator type.
+  using AllocType = Alloc<Node>;
+
+  /**
+   * @brief A type of objects to be stored.
+   *
+   * Each object is defined by a key-value pair.
+   */
+  class ValueType {
+   public:
+    /**
+     * @brief Gets the key of the `ValueType` object.
+     *
+     * @return The key of the `ValueType` object.
+     */
+    const Key& key() const { return node_->key_; }
+
+    /**
+     * @brief Gets the value of the `ValueType` object.
+     *
+     * @return The value of the `ValueType` object.
+     */
+    const Value& value() const { return node_->value_; }
+
+   protected:
+    /// The node of the element, null for `end()`.
+    const Node* node_{nullptr};
+  };
+
+  /// A constant iterator of the `HashedLruCache` object.
+  class const_iterator : public ValueType {
+   public:
+    /// A typedef for the iterator category.
+    typedef std::bidirectional_iterator_tag iterator_category;
+    /// A typedef for the difference type.
+    typedef std::ptrdiff_t difference_type;
+    /// A typedef for the `ValueType` type.
+    typedef ValueType value_type;
+    /// A typedef for the `ValueType` constant reference.
+    typedef const value_type& reference;
+    /// A typedef for the `ValueType` constant pointer.
+    typedef const value_type* pointer;
+
+    /// Creates a constant iterator object.
+    const_iterator() = default;
+    /// Creates a constant iterator object.
+    const_iterator(const const_iterator&) = default;
+    /**
+     * @brief Copies this and the specified iterator to this.
+     *
+     * @return A refenrence to this object.
+     */
+    const_iterator& operator=(const const_iterator&) = default;
+
+    /**
+     * @brief Checks whether both iterators point to the same element.
+     *
+     * @param other The `const_iterator` instance.
+     *
+     * @return True if the iterators are the same; false otherwise.
+     */
+    bool operator==(const const_iterator& other) const {
+      return this->node_ == other.node_;
+    }
+
+    /**
+     * @brief Checks whether the iterators point to different elements.
+     *
+     * @param other The `const_iterator` instance.
+     *
+     * @return True if the iterators are not the same; false otherwise.
+     */
+    bool operator!=(const const_iterator& other) const {
+      return !operator==(other);
+    }
+
+    /**
+     * @brief Iterates to the next, less recently used element.
+     *
+     * @return A reference to this.
+     */
+    const_iterator& operator++() {
+      this->node_ = this->node_->next_;
+      return *this;
+    }
+
+    /**
+     * @brief Iterates to the next, less recently used element.
+     *
+     * @return The iterator before the increment.
+     */
+    const_iterator operator++(int) {
+      const_iterator old_value = *this;
+      ++(*this);
+      return old_value;
+    }
+
+    /**
+     * @brief Iterates to the previous, more recently used element.
+     *
+     * @return A reference to this.
+     */
+    const_iterator& operator--() {
+      this->node_ = this->node_->previous_;
+      return *this;
+    }
+
+    /**
+     * @brief Iterates to the previous, more recently used element.
+     *
+     * @return The iterator before the decrement.
+     */
+    const_iterator operator--(int) {
+      const_iterator old_value = *this;
+      --(*this);
+      return old_value;
+    }
+
+    /**
+     * @brief Gets a reference to this object.
+     *
+     * @return The reference to this.
+     */
+    reference operator*() const { return *this; }
+
+    /**
+     * @brief Gets a pointer to this object.
+     *
+     * @return The pointer to this.
+     */
+    pointer operator->() const { return this; }
+
+   private:
+    friend class HashedLruCache;
+
+    explicit const_iterator(const Node* node) { this->node_ = node; }
+  };
+
+  /**
+   * @brief Creates a `HashedLruCache` instance.
+   *
+   * Creates an invalid `HashedLruCache` with the maximum size of `0`
+   * that caches nothing.
+   *
+   * @param alloc The allocator for the cache.
+   */
+  explicit HashedLruCache(const AllocType& alloc = AllocType())
+      : HashedLruCache(0u, CacheCostFunc(), HasherType(), KeyEqualType(),
+                       alloc) {}
+
+  /**
+   * @brief Creates a `HashedLruCache` instance.
+   *
+   * @param maxSize The maximum size of values this cache can keep.
+   * @param cacheCostFunc The function this cache uses to compute the
+   *        caching cost of each cached value.
+   * @param hash The function object for hashing keys.
+   * @param equal The function object for comparing keys.
+   * @param alloc The allocator for the cache.
+   */
+  HashedLruCache(std::size_t maxSize,
+                 CacheCostFunc cacheCostFunc = CacheCostFunc(),
+                 const HasherType& hash = HasherType(),
+                 const KeyEqualType& equal = KeyEqualType(),
+                 const AllocType& alloc = AllocType())
+      : cache_cost_func_(std::move(cacheCostFunc)),
+        hash_(hash),
+        equal_(equal),
+        pool_(alloc),
+        buckets_(BucketAllocType(alloc)),
+        max_size_(maxSize) {}
+
+  /// The deleted copy constructor.
+  HashedLruCache(const HashedLruCache&) = delete;
+
+  /// The default move constructor.
+  HashedLruCache(HashedLruCache&& other) noexcept
+      : eviction_callback_(std::move(other.eviction_callback_)),
+        cache_cost_func_(std::move(other.cache_cost_func_)),
+        hash_(std::move(other.hash_)),
+        equal_(std::move(other.equal_)),
+        pool_(std::move(other.pool_)),
+        buckets_(std::move(other.buckets_)),
+        first_(other.first_),
+        last_(other.last_),
+        count_(other.count_),
+        max_size_(other.max_size_),
+        size_(other.size_) {
+    other.ResetState();
+  }
+
+  /// The deleted assignment operator.
+  HashedLruCache& operator=(const HashedLruCache&) = delete;
+
+  /// The default move assignment operator.
+  HashedLruCache& operator=(HashedLruCache&& other) noexcept {
+    if (this != &other) {
+      Clear();
+      eviction_callback_ = std::move(other.eviction_callback_);
+      cache_cost_func_ = std::move(other.cache_cost_func_);
+      hash_ = std::move(other.hash_);
+      equal_ = std::move(other.equal_);
+      pool_ = std::move(other.pool_);
+      buckets_ = std::move(other.buckets_);
+      first_ = other.first_;
+      last_ = other.last_;
+      count_ = other.count_;
+      std::swap(max_size_, other.max_size_);
+      size_ = other.size_;
+      other.ResetState();
+    }
+
+    return *this;
+  }
+
+  ~HashedLruCache() { DestroyNodes(); }
+
+  /**
+   * @brief Inserts a key-value pair in the cache.
+   *
+   * @note If the key already exists in the cache, it is promoted in the
+   * LRU, but its value and cost are not updated. To update or insert existing
+   * values, use `InsertOrAssign` instead.
+   *
+   * @param key The key to add.
+   * @param value The value to add.
+   *
+   * @return A pair of bool and an iterator, analogously to
+   * `LruCache::Insert()`.
+   */
+  template <typename _Key, typename _Value>
+  std::pair<const_iterator, bool> Insert(_Key&& key, _Value&& value) {
+    Value new_value(std::forward<_Value>(value));
+
+    // If the item is too large, do not insert it.
+    const std::size_t cost = cache_cost_func_(new_value);
+    if (cost > max_size_) {
+      return std::make_pair(end(), false);
+    }
+
+    Key new_key(std::forward<_Key>(key));
+    const auto hash = hash_(new_key);
+    if (auto node = FindNode(new_key, hash)) {
+      Promote(node);
+      return std::make_pair(const_iterator{node}, false);
+    }
+
+    auto node = AddNode(std::move(new_key), std::move(new_value), hash, cost);
+    return std::make_pair(const_iterator{node}, true);
+  }
+
+  /**
+   * @brief Inserts a key-value pair in the cache or updates an existing
+   * key-value pair.
+   *
+   * @note If the key already exists in the cache, its value and cost are
+   * updated. Not to update the existing key-value pair, use `Insert` instead.
+   *
+   * @param key The key to add.
+   * @param value The value to add.
+   *
+   * @return A pair of bool and an iterator, analogously to
+   * `LruCache::InsertOrAssign()`.
+   */
+  template <typename _Value>
+  std::pair<const_iterator, bool> InsertOrAssign(Key key, _Value&& value) {
+    const auto hash = hash_(key);
+    if (auto node = FindNode(key, hash)) {
+      // element already exists, update it
+      const std::size_t old_cost = cache_cost_func_(node->value_);
+      node->value_ = std::forward<_Value>(value);
+      size_ += cache_cost_func_(node->value_) - old_cost;
+      Promote(node);
+      Evict();
+      return std::make_pair(const_iterator{node}, false);
+    }
+
+    Value new_value(std::forward<_Value>(value));
+    const std::size_t cost = cache_cost_func_(new_value);
+    if (cost > max_size_) {
+      return std::make_pair(end(), false);
+    }
+
+    auto node = AddNode(std::move(key), std::move(new_value), hash, cost);
+    return std::make_pair(const_iterator{node}, true);
+  }
+
+  /**
+   * @brief Removes a key from the cache.
+   *
+   * @param key The key to remove.
+   *
+   * @return True if the key exists and is removed from the cache; false
+   * otherwise.
+   */
+  bool Erase(const Key& key) {
+    auto node = FindNode(key, hash_(key));
+    if (!node) {
+      return false;
+    }
+
+    EraseNode(node, false);
+    return true;
+  }
+
+  /**
+   * @brief Removes a key from the cache.
+   *
+   * @param it The iterator of the key that should be removed.
+   *
+   * @return The iterator to the next, less recently used element.
+   */
+  const_iterator Erase(const_iterator& it) {
+    auto node = const_cast<Node*>(it.node_);
+    ++it;
+    EraseNode(node, false);
+    return it;
+  }
+
+  /**
+   * @brief Gets the current size of the cache.
+   *
+   * @return The current cache size.
+   */
+  std::size_t Size() const { return size_; }
+
+  /**
+   * @brief Gets the maximum size of the cache.
+   *
+   * @return The maximum cache size.
+   */
+  std::size_t GetMaxSize() const { return max_size_; }
+
+  /**
+   * @brief Sets the new maximum size of the cache.
+   *
+   * If the new maximum size is smaller than the current size, items are evicted
+   * until the cache shrinks to less than or equal to the new maximum size.
+   *
+   * @param maxSize The new maximum size of the cache.
+   */
+  void Resize(size_t maxSize) {
+    max_size_ = maxSize;
+    Evict();
+  }
+
+  /**
+   * @brief Finds a value in the cache.
+   *
+   * @note This function promotes the item pointed to by a key if found.
+   *
+   * @param key The key to find.
+   *
+   * @return If found, the iterator to the value; the iterator pointing
+   * to `end()` otherwise.
+   */
+  const_iterator Find(const Key& key) {
+    auto node = FindNode(key, hash_(key));
+    if (node) {
+      Promote(node);
+    }
+    return const_iterator{node};
+  }
+
+  /**
+   * @brief Finds a value in the cache.
+   *
+   * @note This function does NOT promote the item pointed to by a key if found.
+   *
+   * @param key The key to find.
+   *
+   * @return If found, the iterator to the value; the iterator pointing
+   * to `end()` otherwise.
+   */
+  const_iterator FindNoPromote(const Key& key) const {
+    return const_iterator{FindNode(key, hash_(key))};
+  }
+
+  /**
+   * @brief Finds a value in the cache.
+   *
+   * @note This function promotes the item pointed to by a key if found.
+   *
+   * @param key The key to find.
+   * @param nullValue The value to return if the key-value pair is not in the
+   * cache
+   * @return If found, a constant reference to the value; `nullValue` otherwise.
+   */
+  const Value& Find(const Key& key, const Value& nullValue) {
+    auto it = Find(key);
+    return it == end() ? nullValue : it.value();
+  }
+
+  /// Returns a constant iterator to the most recently used element.
+  const_iterator begin() const { return const_iterator{first_}; }
+
+  /// Returns a constant iterator to the end.
+  const_iterator end() const { return const_iterator{}; }
+
+  /// Returns a reverse constant iterator to the least recently used element.
+  const_iterator rbegin() const { return const_iterator{last_}; }
+
+  /// Returns a reverse constant iterator to the end.
+  const_iterator rend() const { return const_iterator{}; }
+
+  /**
+   * @brief Removes all items from the cache.
+   *
+   * Removes all content but does not reset the eviction callback
+   * or maximum size.
+   */
+  void Clear() {
+    DestroyNodes();
+    pool_.Release();
+    buckets_.clear();
+    first_ = last_ = nullptr;
+    count_ = 0u;
+    size_ = 0u;
+  }
+
+  /**
+   * @brief Sets a function that is invoked when a value is
+   * evicted from the cache.
+   *
+   * @note The function must not modify the cache in the
+   * callback. The value can be safely moved. If not, it is destroyed when
+   * the function returns.
+   *
+   * To reset the eviction callback, pass `nullptr`.
+   *
+   * @param func The function to be called on eviction.
+   */
+  void SetEvictionCallback(EvictionFunction func) {
+    eviction_callback_ = std::move(func);
+  }
+
+ private:
+  // The element, linked into its hash bucket and into the LRU list.
+  struct Node {
+    Node(Key key, Value value, std::size_t hash)
+        : key_(std::move(key)), value_(std::move(value)), hash_(hash) {}
+
+    Key key_;
+    Value value_;
+    std::size_t hash_;
+    // The more recently used element.
+    Node* previous_{nullptr};
+    // The less recently used element.
+    Node* next_{nullptr};
+    // The next element of the hash bucket.
+    Node* bucket_next_{nullptr};
+  };
+
+  // Hands out the node memory in chunks and reuses the memory of the erased
+  // nodes.
+  class NodePool {
+   public:
+    explicit NodePool(const AllocType& alloc) : alloc_(alloc), chunks_() {}
+
+    NodePool(NodePool&& other) noexcept
+        : alloc_(std::move(other.alloc_)),
+          chunks_(std::move(other.chunks_)),
+          free_(other.free_),
+          next_chunk_size_(other.next_chunk_size_) {
+      other.chunks_.clear();
+      other.free_ = nullptr;
+      other.next_chunk_size_ = kMinChunkSize;
+    }
+
+    NodePool& operator=(NodePool&& other) noexcept {
+      if (this != &other) {
+        Release();
+        alloc_ = std::move(other.alloc_);
+        chunks_ = std::move(other.chunks_);
+        free_ = other.free_;
+        next_chunk_size_ = other.next_chunk_size_;
+        other.chunks_.clear();
+        other.free_ = nullptr;
+        other.next_chunk_size_ = kMinChunkSize;
+      }
+      return *this;
+    }
+
+    ~NodePool() { Release(); }
+
+    // Returns the memory for one node.
+    void* Allocate() {
+      if (!free_) {
+        AddChunk();
+      }
+
+      auto slot = free_;
+      free_ = slot->next_free;
+      return slot;
+    }
+
+    // Returns the memory of a destroyed node to the pool.
+    void Deallocate(void* memory) {
+      auto slot = static_cast<Slot*>(memory);
+      slot->next_free = free_;
+      free_ = slot;
+    }
+
+    // Frees all chunks, all nodes must be destroyed.
+    void Release() {
+      SlotAllocType slot_alloc(alloc_);
+      for (const auto& chunk : chunks_) {
+        SlotAllocTraits::deallocate(slot_alloc, chunk.first, chunk.second);
+      }
+      chunks_.clear();
+      free_ = nullptr;
+      next_chunk_size_ = kMinChunkSize;
+    }
+
+   private:
+    union Slot {
+      Slot* next_free;
+      typename std::aligned_storage<sizeof(Node), alignof(Node)>::type node;
+    };
+
+    using SlotAllocType =
+        typename std::allocator_traits<AllocType>::template rebind_alloc<Slot>;
+    using SlotAllocTraits = std::allocator_traits<SlotAllocType>;
+    using ChunkAllocType = typename std::allocator_traits<
+        AllocType>::template rebind_alloc<std::pair<Slot*, std::size_t>>;
+
+    static constexpr std::size_t kMinChunkSize = 16u;
+    static constexpr std::size_t kMaxChunkSize = 4096u;
+
+    void AddChunk() {
+      SlotAllocType slot_alloc(alloc_);
+      const auto size = next_chunk_size_;
+      auto chunk = SlotAllocTraits::allocate(slot_alloc, size);
+      chunks_.emplace_back(chunk, size);
+
+      for (std::size_t i = size; i > 0u; --i) {
+        chunk[i - 1u].next_free = free_;
+        free_ = &chunk[i - 1u];
+      }
+
+      next_chunk_size_ = next_chunk_size_ < kMaxChunkSize / 2u
+                             ? next_chunk_size_ * 2u
+                             : kMaxChunkSize;
+    }
+
+    AllocType alloc_;
+    std::vector<std::pair<Slot*, std::size_t>, ChunkAllocType> chunks_;
+    Slot* free_{nullptr};
+    std::size_t next_chunk_size_{kMinChunkSize};
+  };
+
+  using BucketAllocType =
+      typename std::allocator_traits<AllocType>::template rebind_alloc<Node*>;
+
+  static constexpr std::size_t kMinBucketCount = 16u;
+
+  Node* FindNode(const Key& key, std::size_t hash) const {
+    if (buckets_.empty()) {
+      return nullptr;
+    }
+
+    for (auto node = buckets_[BucketIndex(hash)]; node;
+         node = node->bucket_next_) {
+      if (node->hash_ == hash && equal_(node->key_, key)) {
+        return node;
+      }
+    }
+
+    return nullptr;
+  }
+
+  std::size_t BucketIndex(std::size_t hash) const {
+    return hash & (buckets_.size() - 1u);
+  }
+
+  Node* AddNode(Key key, Value value, std::size_t hash, std::size_t cost) {
+    if (count_ >= buckets_.size()) {
+      Rehash(buckets_.empty() ? kMinBucketCount : buckets_.size() * 2u);
+    }
+
+    auto memory = pool_.Allocate();
+    Node* node = nullptr;
+    try {
+      node = new (memory) Node(std::move(key), std::move(value), hash);
+    } catch (...) {
+      pool_.Deallocate(memory);
+      throw;
+    }
+
+    auto& bucket = buckets_[BucketIndex(hash)];
+    node->bucket_next_ = bucket;
+    bucket = node;
+
+    node->next_ = first_;
+    if (first_) {
+      first_->previous_ = node;
+    } else {
+      last_ = node;
+    }
+    first_ = node;
+
+    ++count_;
+    size_ += cost;
+    Evict();
+    return node;
+  }
+
+  void Rehash(std::size_t bucket_count) {
+    std::vector<Node*, BucketAllocType> buckets(bucket_count, nullptr,
+                                                buckets_.get_allocator());
+    buckets_.swap(buckets);
+    for (auto node : buckets) {
+      while (node) {
+        auto next = node->bucket_next_;
+        auto& bucket = buckets_[BucketIndex(node->hash_)];
+        node->bucket_next_ = bucket;
+        bucket = node;
+        node = next;
+      }
+    }
+  }
+
+  void Promote(Node* node) {
+    if (node == first_) {
+      return;  // nothing to do
+    }
+
+    // re-link previous and next nodes together
+    node->previous_->next_ = node->next_;
+    if (node->next_) {
+      node->next_->previous_ = node->previous_;
+    } else {
+      last_ = node->previous_;
+    }
+
+    // re-link our node as the head
+    node->previous_ = nullptr;
+    node->next_ = first_;
+    first_->previous_ = node;
+    first_ = node;
+  }
+
+  void EraseNode(Node* node, bool do_eviction_callback) {
+    const std::size_t cost = cache_cost_func_(node->value_);
+
+    if (node->next_) {
+      node->next_->previous_ = node->previous_;
+    } else {
+      last_ = node->previous_;
+    }
+
+    if (node->previous_) {
+      node->previous_->next_ = node->next_;
+    } else {
+      first_ = node->next_;
+    }
+
+    auto bucket_node = &buckets_[BucketIndex(node->hash_)];
+    while (*bucket_node != node) {
+      bucket_node = &(*bucket_node)->bucket_next_;
+    }
+    *bucket_node = node->bucket_next_;
+
+    if (do_eviction_callback && eviction_callback_) {
+      eviction_callback_(node->key_, std::move(node->value_));
+    }
+
+    node->~Node();
+    pool_.Deallocate(node);
+    --count_;
+    size_ -= cost;
+  }
+
+  void Evict() {
+    while (size_ > max_size_) {
+      // assert if the cache is empty
+      assert(last_ != nullptr);
+      EraseNode(last_, true);
+    }
+  }
+
+  void DestroyNodes() {
+    for (auto node = first_; node;) {
+      auto next = node->next_;
+      node->~Node();
+      pool_.Deallocate(node);
+      node = next;
+    }
+  }
+
+  void ResetState() {
+    first_ = last_ = nullptr;
+    count_ = 0u;
+    size_ = 0u;
+  }
+
+  EvictionFunction eviction_callback_;
+  CacheCostFunc cache_cost_func_;
+  HasherType hash_;
+  KeyEqualType equal_;
+  NodePool pool_;
+  std::vector<Node*, BucketAllocType> buckets_;
+  Node* first_{nullptr};
+  Node* last_{nullptr};
+  std::size_t count_{0u};
+  std::size_t max_size_;
+  std::size_t size_{0u};
+};
+
+}  // namespace utils
+}  // namespace olp
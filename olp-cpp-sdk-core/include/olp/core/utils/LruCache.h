@@ -748,7 +748,7 @@ inline typename LruCache<Key, Value, CacheCostFunc, Compare,
                          Alloc>::const_iterator&
 LruCache<Key, Value, CacheCostFunc, Compare, Alloc>::const_iterator::
 operator--() {
-  this->m_it = this->m_it->second.m_previous;
+  this->m_it = this->m_it->second.previous_;
   return *this;
 }
 
@@ -759,7 +759,7 @@ inline
     LruCache<Key, Value, CacheCostFunc, Compare, Alloc>::const_iterator::
     operator--(int) {
   typename MapType::const_iterator old_value = this->m_it;
-  this->m_it = this->m_it->second.m_previous;
+  this->m_it = this->m_it->second.previous_;
   return const_iterator{old_value};
 }
 
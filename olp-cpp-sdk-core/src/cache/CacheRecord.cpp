@@ -0,0 +1,118 @@
+/*
+ * Copyright (C) 2021 HERE Europe B.V.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ * License-Filename: LICENSE
+ */
+
+#include "CacheRecord.h"
+
+#include <boost/crc.hpp>
+
+#include "olp/core/cache/KeyValueCache.h"
+
+namespace olp {
+namespace cache {
+
+namespace {
+constexpr size_t kVersionOffset = 0u;
+constexpr size_t kFlagsOffset = 1u;
+constexpr size_t kChecksumOffset = 4u;
+constexpr size_t kExpiryOffset = 8u;
+
+void WriteLittleEndian(uint64_t value, size_t size, char* out) {
+  for (size_t i = 0u; i < size; ++i) {
+    out[i] = static_cast<char>((value >> (8u * i)) & 0xffu);
+  }
+}
+
+uint64_t ReadLittleEndian(const char* in, size_t size) {
+  uint64_t value = 0u;
+  for (size_t i = 0u; i < size; ++i) {
+    value |= static_cast<uint64_t>(static_cast<uint8_t>(in[i])) << (8u * i);
+  }
+  return value;
+}
+
+uint32_t Checksum(const leveldb::Slice& value) {
+  boost::crc_32_type crc;
+  crc.process_bytes(value.data(), value.size());
+  return crc.checksum();
+}
+}  // namespace
+
+constexpr uint8_t CacheRecord::kVersion;
+constexpr size_t CacheRecord::kHeaderSize;
+
+std::string CacheRecord::Encode(const leveldb::Slice& value, time_t expiry,
+                                bool with_checksum, bool in_value_log) {
+  std::string record(kHeaderSize, '\0');
+  record.reserve(kHeaderSize + value.size());
+
+  uint8_t flags = 0u;
+  if (expiry < KeyValueCache::kDefaultExpiry) {
+    flags |= kHasExpiry;
+    WriteLittleEndian(static_cast<uint64_t>(expiry), sizeof(uint64_t),
+                      &record[kExpiryOffset]);
+  }
+
+  if (with_checksum) {
+    flags |= kHasChecksum;
+    WriteLittleEndian(Checksum(value), sizeof(uint32_t),
+                      &record[kChecksumOffset]);
+  }
+
+  if (in_value_log) {
+    flags |= kInValueLog;
+  }
+
+  record[kVersionOffset] = static_cast<char>(kVersion);
+  record[kFlagsOffset] = static_cast<char>(flags);
+  record.append(value.data(), value.size());
+  return record;
+}
+
+bool CacheRecord::Decode(const leveldb::Slice& record, bool verify_checksum,
+                         time_t& expiry, leveldb::Slice& value) {
+  if (record.size() < kHeaderSize ||
+      static_cast<uint8_t>(record[kVersionOffset]) != kVersion) {
+    return false;
+  }
+
+  const auto flags = static_cast<uint8_t>(record[kFlagsOffset]);
+  value = leveldb::Slice(record.data() + kHeaderSize,
+                         record.size() - kHeaderSize);
+
+  if (verify_checksum && (flags & kHasChecksum) &&
+      Checksum(value) != ReadLittleEndian(record.data() + kChecksumOffset,
+                                          sizeof(uint32_t))) {
+    return false;
+  }
+
+  expiry = (flags & kHasExpiry)
+               ? static_cast<time_t>(ReadLittleEndian(
+                     record.data() + kExpiryOffset, sizeof(uint64_t)))
+               : KeyValueCache::kDefaultExpiry;
+  return true;
+}
+
+bool CacheRecord::IsInValueLog(const leveldb::Slice& record) {
+  return record.size() >= kHeaderSize &&
+         static_cast<uint8_t>(record[kVersionOffset]) == kVersion &&
+         (static_cast<uint8_t>(record[kFlagsOffset]) & kInValueLog) != 0u;
+}
+
+}  // namespace cache
+}  // namespace olp
@@ -0,0 +1,102 @@
+/*
+ * Copyright (C) 2021 HERE Europe B.V.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ * License-Filename: LICENSE
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <ctime>
+#include <string>
+
+#include <leveldb/slice.h>
+
+namespace olp {
+namespace cache {
+
+/**
+ * @brief Encodes and decodes the values stored in the disk cache.
+ *
+ * Every value is stored with a fixed-size header in front of it, so the
+ * expiry is read together with the value in a single lookup. The header
+ * layout is:
+ *   byte 0     - record format version;
+ *   byte 1     - flags;
+ *   bytes 2-3  - reserved, zero;
+ *   bytes 4-7  - CRC-32 of the value, little-endian;
+ *   bytes 8-15 - absolute expiry time in seconds, little-endian.
+ */
+class CacheRecord {
+ public:
+  /// The version written by `Encode`.
+  static constexpr uint8_t kVersion = 2u;
+
+  /// The size of the header in front of every value.
+  static constexpr size_t kHeaderSize = 16u;
+
+  /// The header flags.
+  enum Flags : uint8_t {
+    /// The record has an expiry.
+    kHasExpiry = 0x01,
+    /// The record has a checksum of the value.
+    kHasChecksum = 0x02,
+    /// The value is stored in the `ValueLog`, the record holds its location.
+    kInValueLog = 0x04,
+  };
+
+  /**
+   * @brief Creates a record from the value and the absolute expiry time.
+   *
+   * @param value The value to store.
+   * @param expiry The absolute expiry time or `KeyValueCache::kDefaultExpiry`.
+   * @param with_checksum If true, the checksum of the value is calculated.
+   * @param in_value_log If true, the value is an encoded `ValueLog` location.
+   *
+   * @return The record with the header and the value.
+   */
+  static std::string Encode(const leveldb::Slice& value, time_t expiry,
+                            bool with_checksum, bool in_value_log = false);
+
+  /**
+   * @brief Splits the record into the expiry and the value.
+   *
+   * @param record The record created by `Encode`.
+   * @param verify_checksum If true, the value is checked against the stored
+   * checksum, if any.
+   * @param expiry The absolute expiry time or `KeyValueCache::kDefaultExpiry`.
+   * @param value The value, which points to the `record` memory.
+   *
+   * @return False if the record is malformed, has an unknown version or the
+   * checksum does not match.
+   */
+  static bool Decode(const leveldb::Slice& record, bool verify_checksum,
+                     time_t& expiry, leveldb::Slice& value);
+
+  /**
+   * @brief Checks if the value of the record is stored in the `ValueLog`.
+   *
+   * @param record The record created by `Encode`.
+   *
+   * @return True if the record holds a `ValueLog` location instead of the
+   * value.
+   */
+  static bool IsInValueLog(const leveldb::Slice& record);
+};
+
+}  // namespace cache
+}  // namespace olp
@@ -53,6 +53,10 @@ bool DefaultCache::Put(const std::string& key,
   return impl_->Put(key, value, expiry);
 }
 
+bool DefaultCache::PutBatch(const KeyValueCache::BatchItemListType& items) {
+  return impl_->PutBatch(items);
+}
+
 boost::any DefaultCache::Get(const std::string& key, const Decoder& decoder) {
   return impl_->Get(key, decoder);
 }
@@ -61,6 +65,16 @@ KeyValueCache::ValueTypePtr DefaultCache::Get(const std::string& key) {
   return impl_->Get(key);
 }
 
+std::vector<boost::any> DefaultCache::GetBatch(
+    const KeyValueCache::KeyListType& keys, const Decoder& decoder) {
+  return impl_->GetBatch(keys, decoder);
+}
+
+std::vector<KeyValueCache::ValueTypePtr> DefaultCache::GetBatch(
+    const KeyValueCache::KeyListType& keys) {
+  return impl_->GetBatch(keys);
+}
+
 bool DefaultCache::Remove(const std::string& key) { return impl_->Remove(key); }
 
 bool DefaultCache::RemoveKeysWithPrefix(const std::string& prefix) {
@@ -71,6 +85,11 @@ bool DefaultCache::Contains(const std::string& key) const {
   return impl_->Contains(key);
 }
 
+std::vector<bool> DefaultCache::ContainsBatch(
+    const KeyValueCache::KeyListType& keys) const {
+  return impl_->ContainsBatch(keys);
+}
+
 bool DefaultCache::Protect(const KeyValueCache::KeyListType& keys) {
   return impl_->Protect(keys);
 }
@@ -89,5 +108,13 @@ uint64_t DefaultCache::Size(CacheType cache_type) const {
 
 uint64_t DefaultCache::Size(uint64_t new_size) { return impl_->Size(new_size); }
 
+DefaultCache::EvictionStatistics DefaultCache::GetEvictionStatistics() const {
+  return impl_->GetEvictionStatistics();
+}
+
+DefaultCache::Statistics DefaultCache::GetStatistics() const {
+  return impl_->GetStatistics();
+}
+
 }  // namespace cache
 }  // namespace olp
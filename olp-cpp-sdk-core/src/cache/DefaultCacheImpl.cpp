@@ -22,10 +22,16 @@
 #include <algorithm>
 #include <chrono>
 #include <cmath>
+#include <cstdlib>
+#include <initializer_list>
+#include <limits>
 #include <memory>
 #include <string>
 #include <utility>
 
+#include "CacheRecord.h"
+#include "LruSnapshot.h"
+#include "ValueLog.h"
 #include "olp/core/logging/Log.h"
 #include "olp/core/porting/make_unique.h"
 #include "olp/core/utils/Dir.h"
@@ -38,14 +44,34 @@ constexpr auto kLogTag = "DefaultCache";
 constexpr auto kExpirySuffix = "::expiry";
 constexpr auto kProtectedKeys = "internal::protected::protected_data";
 constexpr auto kInternalKeysPrefix = "internal::";
+constexpr auto kFormatVersionKey = "internal::format_version";
+constexpr auto kFormatUpgradeKey = "internal::format_upgrade";
+constexpr auto kLruSnapshotKey = "internal::lru_snapshot";
+constexpr auto kLruSnapshotFile = "/lru_snapshot";
+constexpr auto kInlineExpiryFormat = "2";
 constexpr auto kMaxDiskSize = std::uint64_t(-1);
 constexpr auto kMinDiskUsedThreshold = 0.85f;
 constexpr auto kMaxDiskUsedThreshold = 0.9f;
 constexpr auto kEvictionPortion = 1024u * 1024u;  // 1 MB
-
-// current epoch time contains 10 digits.
-constexpr auto kExpiryValueSize = 10;
-const auto kExpirySuffixLength = strlen(kExpirySuffix);
+constexpr auto kEvictionRetryDelay = std::chrono::milliseconds(1);
+constexpr auto kUpgradeBatchSize = 4u * 1024u * 1024u;  // 4 MB
+constexpr auto kValueLogFolder = "value_log";
+constexpr auto kMaxValueLogSegmentSize = 64u * 1024u * 1024u;  // 64 MB
+// A value log segment is collected when at most this part of it is still used.
+constexpr auto kValueLogCollectRatio = 0.5f;
+// Larger mutable caches are scanned for the LRU in the background.
+constexpr auto kLruScanThreshold = 64u * 1024u * 1024u;  // 64 MB
+constexpr auto kLruScanPortion = 1024u;
+constexpr auto kLruScanRetryDelay = std::chrono::milliseconds(1);
+// The LRU snapshot is saved after this many writes, or this long after the
+// first unsaved write, so an unclean exit does not lose it.
+constexpr auto kLruSnapshotMutations = 10000u;
+constexpr auto kLruSnapshotInterval = std::chrono::minutes(1);
+// The keys compacted at once after an eviction, the close waits for one slice
+// at most.
+constexpr auto kCompactionSliceKeys = 16u * 1024u;
+// Promotions queued while the LRU is busy, the ones beyond are dropped.
+constexpr auto kMaxPendingPromotions = 4096u;
 
 std::string CreateExpiryKey(const std::string& key) {
   return key + kExpirySuffix;
@@ -59,38 +85,72 @@ bool IsExpiryValid(time_t expiry) {
   return expiry < olp::cache::KeyValueCache::kDefaultExpiry;
 }
 
-time_t GetRemainingExpiryTime(const std::string& key,
-                              olp::cache::DiskCache& disk_cache) {
-  auto expiry_key = CreateExpiryKey(key);
+time_t GetRemainingExpiryTime(time_t expiry) {
+  if (IsExpiryValid(expiry)) {
+    expiry -= olp::cache::InMemoryCache::DefaultTimeProvider()();
+  }
+
+  return expiry;
+}
+
+time_t GetLegacyExpiry(const std::string& key,
+                       olp::cache::DiskCache& disk_cache) {
   auto expiry = olp::cache::KeyValueCache::kDefaultExpiry;
-  auto expiry_value = disk_cache.Get(expiry_key);
+  auto expiry_value = disk_cache.Get(CreateExpiryKey(key));
   if (expiry_value) {
     expiry = std::stol(*expiry_value);
-    expiry -= olp::cache::InMemoryCache::DefaultTimeProvider()();
   }
 
   return expiry;
 }
 
+/// Returns false if the record does not refer to the value log.
+bool DecodeValueLogLocation(const leveldb::Slice& record,
+                            olp::cache::ValueLog::Location& location) {
+  if (!olp::cache::CacheRecord::IsInValueLog(record)) {
+    return false;
+  }
+
+  time_t expiry = olp::cache::KeyValueCache::kDefaultExpiry;
+  leveldb::Slice payload;
+  return olp::cache::CacheRecord::Decode(record, false, expiry, payload) &&
+         olp::cache::ValueLog::DecodeLocation(payload, location);
+}
+
+/// Returns the data size of the record including the value it refers to in the
+/// value log.
+uint64_t GetStoredValueSize(const leveldb::Slice& record) {
+  olp::cache::ValueLog::Location location;
+  if (DecodeValueLogLocation(record, location)) {
+    return record.size() + location.size;
+  }
+
+  return record.size();
+}
+
+/// Returns false if the key is not found or its value is stored inline.
+bool FindValueLogLocation(olp::cache::DiskCache& disk_cache,
+                          const std::string& key,
+                          olp::cache::ValueLog::Location& location) {
+  auto iterator = disk_cache.NewIterator(leveldb::ReadOptions());
+  iterator->Seek(key);
+  return iterator->Valid() && iterator->key() == key &&
+         DecodeValueLogLocation(iterator->value(), location);
+}
+
+uint64_t GetValueLogSegmentSize(const olp::cache::CacheSettings& settings) {
+  const uint64_t segment_size =
+      std::max<uint64_t>(settings.max_disk_storage / 16u,
+                         settings.max_file_size);
+  return std::min<uint64_t>(segment_size, kMaxValueLogSegmentSize);
+}
+
 void PurgeDiskItem(const std::string& key, olp::cache::DiskCache& disk_cache,
                    uint64_t& removed_data_size) {
-  auto expiry_key = CreateExpiryKey(key);
   uint64_t data_size = 0u;
 
   disk_cache.Remove(key, data_size);
   removed_data_size += data_size;
-
-  disk_cache.Remove(expiry_key, data_size);
-  removed_data_size += data_size;
-}
-
-size_t StoreExpiry(const std::string& key, leveldb::WriteBatch& batch,
-                   time_t expiry) {
-  auto expiry_key = CreateExpiryKey(key);
-  auto time_str = std::to_string(expiry);
-  batch.Put(expiry_key, time_str);
-
-  return expiry_key.size() + time_str.size();
 }
 
 leveldb::CompressionType GetCompression(
@@ -108,6 +168,7 @@ olp::cache::StorageSettings CreateStorageSettings(
   storage_settings.enforce_immediate_flush = settings.enforce_immediate_flush;
   storage_settings.max_file_size = settings.max_file_size;
   storage_settings.compression = GetCompression(settings.compression);
+  storage_settings.value_size = GetStoredValueSize;
 
   return storage_settings;
 }
@@ -118,10 +179,26 @@ int64_t GetElapsedTime(std::chrono::steady_clock::time_point start) {
       .count();
 }
 
+uint64_t GetElapsedMicroseconds(std::chrono::steady_clock::time_point start) {
+  return std::chrono::duration_cast<std::chrono::microseconds>(
+             std::chrono::steady_clock::now() - start)
+      .count();
+}
+
+// The statistics are not used for synchronization.
+void Increment(std::atomic<uint64_t>& counter, uint64_t value = 1u) {
+  counter.fetch_add(value, std::memory_order_relaxed);
+}
+
 bool IsInternalKey(const std::string& key) {
   return key.find(kInternalKeysPrefix) == 0u;
 }
 
+// The bookkeeping keys which are not accounted in the size.
+bool IsBookkeepingKey(const leveldb::Slice& key) {
+  return key == kFormatVersionKey || key == kLruSnapshotKey;
+}
+
 olp::cache::DefaultCache::StorageOpenResult ToStorageOpenResult(
     olp::cache::OpenResult input) {
   switch (input) {
@@ -147,19 +224,36 @@ DefaultCacheImpl::DefaultCacheImpl(CacheSettings settings)
       memory_cache_(nullptr),
       mutable_cache_(nullptr),
       mutable_cache_lru_(nullptr),
+      lru_scan_cache_(nullptr),
+      lru_scan_threshold_(kLruScanThreshold),
+      stop_lru_scan_(false),
       protected_cache_(nullptr),
       mutable_cache_data_size_(0),
-      eviction_portion_(kEvictionPortion) {}
+      eviction_portion_(kEvictionPortion),
+      eviction_requested_(false),
+      value_log_collection_requested_(false),
+      eviction_running_(false),
+      stop_eviction_(false),
+      eviction_runs_(0),
+      evicted_count_(0),
+      evicted_bytes_(0),
+      eviction_time_us_(0),
+      mutable_cache_inline_expiry_(true),
+      protected_cache_inline_expiry_(true),
+      mutable_cache_generation_(0),
+      lru_snapshot_generation_(0),
+      lru_snapshot_scheduled_(false),
+      lru_snapshot_mutations_(kLruSnapshotMutations) {}
 
 DefaultCache::StorageOpenResult DefaultCacheImpl::Open() {
-  std::lock_guard<std::mutex> lock(cache_lock_);
+  auto lock = LockExclusive();
   is_open_ = true;
   return SetupStorage();
 }
 
 DefaultCache::StorageOpenResult DefaultCacheImpl::Open(
     DefaultCache::CacheType type) {
-  std::lock_guard<std::mutex> lock(cache_lock_);
+  auto lock = LockExclusive();
   if (!is_open_) {
     return DefaultCache::NotReady;
   }
@@ -203,7 +297,7 @@ DefaultCache::StorageOpenResult DefaultCacheImpl::Open(
 DefaultCacheImpl::~DefaultCacheImpl() { Close(); }
 
 void DefaultCacheImpl::Close() {
-  std::lock_guard<std::mutex> lock(cache_lock_);
+  auto lock = LockExclusive();
   if (!is_open_) {
     return;
   }
@@ -215,7 +309,7 @@ void DefaultCacheImpl::Close() {
 }
 
 bool DefaultCacheImpl::Close(DefaultCache::CacheType type) {
-  std::lock_guard<std::mutex> lock(cache_lock_);
+  auto lock = LockExclusive();
   if (!is_open_) {
     return false;
   }
@@ -226,7 +320,7 @@ bool DefaultCacheImpl::Close(DefaultCache::CacheType type) {
 }
 
 bool DefaultCacheImpl::Clear() {
-  std::lock_guard<std::mutex> lock(cache_lock_);
+  auto lock = LockExclusive();
   if (!is_open_) {
     return false;
   }
@@ -235,12 +329,18 @@ bool DefaultCacheImpl::Clear() {
     memory_cache_->Clear();
   }
 
+  StopEviction();
+  StopLruScan();
+  lru_scan_cache_.reset();
+
   if (mutable_cache_lru_) {
     mutable_cache_lru_->Clear();
   }
 
   if (mutable_cache_) {
     mutable_cache_data_size_ = 0;
+    // The value log lives in the mutable cache folder, close it first.
+    mutable_value_log_.reset();
     if (!mutable_cache_->Clear()) {
       return false;
     }
@@ -250,20 +350,24 @@ bool DefaultCacheImpl::Clear() {
 }
 
 void DefaultCacheImpl::Compact() {
-  std::lock_guard<std::mutex> lock(cache_lock_);
+  auto lock = LockExclusive();
   if (mutable_cache_) {
-    mutable_cache_->Compact();
+    CompleteLruScan();
+    CollectValueLogGarbage(false);
+    CompactMutableCache();
   }
 }
 
 bool DefaultCacheImpl::Put(const std::string& key, const boost::any& value,
                            const Encoder& encoder, time_t expiry) {
-  std::lock_guard<std::mutex> lock(cache_lock_);
+  auto lock = LockShared();
   if (!is_open_) {
     return false;
   }
 
   auto encoded_item = encoder();
+
+  std::lock_guard<std::mutex> key_lock(GetKeyLock(key));
   if (memory_cache_) {
     const auto size = encoded_item.size();
     const bool result = memory_cache_->Put(
@@ -285,11 +389,13 @@ bool DefaultCacheImpl::Put(const std::string& key,
     return false;
   }
 
-  std::lock_guard<std::mutex> lock(cache_lock_);
+  auto lock = LockShared();
   if (!is_open_) {
     return false;
   }
 
+  std::lock_guard<std::mutex> key_lock(GetKeyLock(key));
+
   if (memory_cache_) {
     const auto size = value->size();
     const bool result = memory_cache_->Put(
@@ -306,9 +412,66 @@ bool DefaultCacheImpl::Put(const std::string& key,
   return PutMutableCache(key, slice, expiry);
 }
 
+bool DefaultCacheImpl::PutBatch(const KeyValueCache::BatchItemListType& items) {
+  auto lock = LockShared();
+  if (!is_open_) {
+    return false;
+  }
+
+  // Lock the key stripes in the address order, so concurrent batches can't
+  // deadlock.
+  std::vector<std::mutex*> key_mutexes;
+  key_mutexes.reserve(items.size());
+  for (const auto& item : items) {
+    key_mutexes.push_back(&GetKeyLock(item.key));
+  }
+  std::sort(key_mutexes.begin(), key_mutexes.end());
+  key_mutexes.erase(std::unique(key_mutexes.begin(), key_mutexes.end()),
+                    key_mutexes.end());
+
+  std::vector<std::unique_lock<std::mutex>> key_locks;
+  key_locks.reserve(key_mutexes.size());
+  for (auto* key_mutex : key_mutexes) {
+    key_locks.emplace_back(*key_mutex);
+  }
+
+  auto batch = std::make_unique<leveldb::WriteBatch>();
+  std::vector<LruEntry> entries;
+  entries.reserve(items.size());
+
+  for (const auto& item : items) {
+    const auto encoded_item = item.encoder();
+
+    if (memory_cache_) {
+      const auto size = encoded_item.size();
+      const bool result = memory_cache_->Put(
+          item.key, item.value, GetExpiryForMemoryCache(item.key, item.expiry),
+          size);
+      if (!result && size > settings_.max_memory_cache_size &&
+          !mutable_cache_) {
+        OLP_SDK_LOG_INFO_F(kLogTag,
+                           "Failed to store value in memory cache %s, size %d",
+                           item.key.c_str(), static_cast<int>(size));
+      }
+    }
+
+    if (mutable_cache_) {
+      entries.push_back(AddRecord(*batch, item.key, encoded_item, item.expiry));
+    }
+  }
+
+  if (!mutable_cache_ || entries.empty()) {
+    return true;
+  }
+
+  const auto result = ApplyMutableCacheBatch(std::move(batch), entries);
+  CommitValueLogEntries(entries);
+  return result;
+}
+
 boost::any DefaultCacheImpl::Get(const std::string& key,
                                  const Decoder& decoder) {
-  std::lock_guard<std::mutex> lock(cache_lock_);
+  auto lock = LockShared();
   if (!is_open_) {
     return boost::any();
   }
@@ -316,20 +479,26 @@ boost::any DefaultCacheImpl::Get(const std::string& key,
   if (memory_cache_) {
     auto value = memory_cache_->Get(key);
     if (!value.empty()) {
-      PromoteKeyLru(key);
+      Increment(statistics_.memory_hits);
+      MaybePromoteKeyLru(key);
       return value;
     }
+    Increment(statistics_.memory_misses);
   }
 
-  auto disc_cache = GetFromDiscCache(key);
+  std::lock_guard<std::mutex> key_lock(GetKeyLock(key));
+
+  leveldb::Slice value;
+  time_t expiry = KeyValueCache::kDefaultExpiry;
+  DiskIterators iterators;
+  iterators.single_key = true;
 
-  if (disc_cache) {
-    auto decoded_item = decoder(disc_cache->first);
+  if (GetFromDiskCache(key, value, expiry, iterators)) {
+    const auto size = value.size();
+    auto decoded_item = decoder(TakeDiskValue(value, iterators));
     if (memory_cache_) {
-      auto expiry = disc_cache->second;
       memory_cache_->Put(key, decoded_item,
-                         GetExpiryForMemoryCache(key, expiry),
-                         disc_cache->first.size());
+                         GetExpiryForMemoryCache(key, expiry), size);
     }
     return decoded_item;
   }
@@ -338,7 +507,7 @@ boost::any DefaultCacheImpl::Get(const std::string& key,
 }
 
 KeyValueCache::ValueTypePtr DefaultCacheImpl::Get(const std::string& key) {
-  std::lock_guard<std::mutex> lock(cache_lock_);
+  auto lock = LockShared();
   if (!is_open_) {
     return nullptr;
   }
@@ -346,16 +515,33 @@ KeyValueCache::ValueTypePtr DefaultCacheImpl::Get(const std::string& key) {
   if (memory_cache_) {
     auto value = memory_cache_->Get(key);
     if (!value.empty()) {
-      PromoteKeyLru(key);
+      Increment(statistics_.memory_hits);
+      MaybePromoteKeyLru(key);
       return boost::any_cast<KeyValueCache::ValueTypePtr>(value);
     }
+    Increment(statistics_.memory_misses);
   }
 
-  KeyValueCache::ValueTypePtr value = nullptr;
-  time_t expiry = KeyValueCache::kDefaultExpiry;
+  std::lock_guard<std::mutex> key_lock(GetKeyLock(key));
 
-  auto result = GetFromDiskCache(key, value, expiry);
-  if (result && value) {
+  leveldb::Slice payload;
+  time_t expiry = KeyValueCache::kDefaultExpiry;
+  DiskIterators iterators;
+  iterators.single_key = true;
+  iterators.use_value_buffer = true;
+
+  if (GetFromDiskCache(key, payload, expiry, iterators)) {
+    // The value log values are read into the returned buffer, the inline ones
+    // are copied out of the record.
+    KeyValueCache::ValueTypePtr value;
+    if (iterators.value_buffer &&
+        payload.data() ==
+            reinterpret_cast<const char*>(iterators.value_buffer->data())) {
+      value = std::move(iterators.value_buffer);
+    } else {
+      value = std::make_shared<KeyValueCache::ValueType>(
+          payload.data(), payload.data() + payload.size());
+    }
     if (memory_cache_) {
       memory_cache_->Put(key, value, GetExpiryForMemoryCache(key, expiry),
                          value->size());
@@ -366,8 +552,88 @@ KeyValueCache::ValueTypePtr DefaultCacheImpl::Get(const std::string& key) {
   return nullptr;
 }
 
+std::vector<boost::any> DefaultCacheImpl::GetBatch(
+    const KeyValueCache::KeyListType& keys, const Decoder& decoder) {
+  std::vector<boost::any> values(keys.size());
+
+  auto lock = LockShared();
+  if (!is_open_) {
+    return values;
+  }
+
+  std::vector<size_t> disk_lookups;
+  for (size_t index = 0; index < keys.size(); ++index) {
+    if (memory_cache_) {
+      auto value = memory_cache_->Get(keys[index]);
+      if (!value.empty()) {
+        Increment(statistics_.memory_hits);
+        MaybePromoteKeyLru(keys[index]);
+        values[index] = std::move(value);
+        continue;
+      }
+      Increment(statistics_.memory_misses);
+    }
+    disk_lookups.push_back(index);
+  }
+
+  GetBatchFromDisk(
+      keys, std::move(disk_lookups),
+      [&](size_t index, const leveldb::Slice& value, time_t expiry) {
+        const auto& key = keys[index];
+        auto decoded_item = decoder(value.ToString());
+        if (memory_cache_) {
+          memory_cache_->Put(key, decoded_item,
+                             GetExpiryForMemoryCache(key, expiry),
+                             value.size());
+        }
+        values[index] = std::move(decoded_item);
+      });
+
+  return values;
+}
+
+std::vector<KeyValueCache::ValueTypePtr> DefaultCacheImpl::GetBatch(
+    const KeyValueCache::KeyListType& keys) {
+  std::vector<KeyValueCache::ValueTypePtr> values(keys.size());
+
+  auto lock = LockShared();
+  if (!is_open_) {
+    return values;
+  }
+
+  std::vector<size_t> disk_lookups;
+  for (size_t index = 0; index < keys.size(); ++index) {
+    if (memory_cache_) {
+      auto value = memory_cache_->Get(keys[index]);
+      if (!value.empty()) {
+        Increment(statistics_.memory_hits);
+        MaybePromoteKeyLru(keys[index]);
+        values[index] = boost::any_cast<KeyValueCache::ValueTypePtr>(value);
+        continue;
+      }
+      Increment(statistics_.memory_misses);
+    }
+    disk_lookups.push_back(index);
+  }
+
+  GetBatchFromDisk(
+      keys, std::move(disk_lookups),
+      [&](size_t index, const leveldb::Slice& payload, time_t expiry) {
+        const auto& key = keys[index];
+        auto value = std::make_shared<KeyValueCache::ValueType>(
+            payload.data(), payload.data() + payload.size());
+        if (memory_cache_) {
+          memory_cache_->Put(key, value, GetExpiryForMemoryCache(key, expiry),
+                             value->size());
+        }
+        values[index] = std::move(value);
+      });
+
+  return values;
+}
+
 bool DefaultCacheImpl::Remove(const std::string& key) {
-  std::lock_guard<std::mutex> lock(cache_lock_);
+  auto lock = LockShared();
 
   if (!is_open_) {
     return false;
@@ -382,25 +648,40 @@ bool DefaultCacheImpl::Remove(const std::string& key) {
     return false;
   }
 
+  std::lock_guard<std::mutex> key_lock(GetKeyLock(key));
+
   // protected data could be removed by user
   if (memory_cache_) {
     memory_cache_->Remove(key);
   }
 
+  std::lock_guard<std::mutex> lru_lock(lru_lock_);
   RemoveKeyLru(key);
 
   if (mutable_cache_) {
+    ValueLog::Location location;
+    const bool in_value_log =
+        mutable_value_log_ &&
+        FindValueLogLocation(*mutable_cache_, key, location);
+
     uint64_t removed_data_size = 0;
     PurgeDiskItem(key, *mutable_cache_, removed_data_size);
 
-    mutable_cache_data_size_ -= removed_data_size;
+    if (IsAccountedInSize(key)) {
+      mutable_cache_data_size_ -= removed_data_size;
+    }
+    if (in_value_log && removed_data_size > 0u) {
+      ReleaseValueLogValue(location);
+    }
+    ++mutable_cache_generation_;
+    ScheduleLruSnapshot();
   }
 
   return true;
 }
 
 bool DefaultCacheImpl::RemoveKeysWithPrefix(const std::string& key) {
-  std::lock_guard<std::mutex> lock(cache_lock_);
+  auto lock = LockExclusive();
 
   if (!is_open_) {
     return false;
@@ -414,6 +695,8 @@ bool DefaultCacheImpl::RemoveKeysWithPrefix(const std::string& key) {
     memory_cache_->RemoveKeysWithPrefix(key, filter);
   }
 
+  CompleteLruScan();
+
   // No need to check here for protected key as these are not added to LRU from
   // the start
   RemoveKeysWithPrefixLru(key);
@@ -429,56 +712,113 @@ bool DefaultCacheImpl::RemoveKeysWithPrefix(const std::string& key) {
 }
 
 bool DefaultCacheImpl::Contains(const std::string& key) const {
-  std::lock_guard<std::mutex> lock(cache_lock_);
+  auto lock = LockShared();
   if (!is_open_) {
     return false;
   }
 
+  DiskIterators iterators;
+  return ContainsKey(key, iterators);
+}
+
+std::vector<bool> DefaultCacheImpl::ContainsBatch(
+    const KeyValueCache::KeyListType& keys) const {
+  std::vector<bool> result(keys.size(), false);
+
+  auto lock = LockShared();
+  if (!is_open_) {
+    return result;
+  }
+
+  // Look up in the key order, so consecutive disk reads hit the same blocks
+  std::vector<size_t> indices(keys.size());
+  for (size_t index = 0; index < indices.size(); ++index) {
+    indices[index] = index;
+  }
+  std::sort(indices.begin(), indices.end(),
+            [&](size_t lhs, size_t rhs) { return keys[lhs] < keys[rhs]; });
+
+  DiskIterators iterators;
+  for (const auto index : indices) {
+    result[index] = ContainsKey(keys[index], iterators);
+  }
+
+  return result;
+}
+
+bool DefaultCacheImpl::ContainsKey(const std::string& key,
+                                   DiskIterators& iterators) const {
   if (memory_cache_ && memory_cache_->Contains(key)) {
     return true;
   }
 
+  // check in mutable cache only if lru does not exist, or is not built yet
+  bool check_mutable_cache = !mutable_cache_lru_;
+
   // if lru exist check if key is there
   if (mutable_cache_lru_) {
+    std::unique_lock<std::mutex> lru_lock(lru_lock_);
     auto it = mutable_cache_lru_->FindNoPromote(key);
     if (it != mutable_cache_lru_->end()) {
       ValueProperties props = it->value();
       props.expiry -= olp::cache::InMemoryCache::DefaultTimeProvider()();
       return (props.expiry > 0);
-      // if lru exist, but key not found, this case possible only for protected
-      // keys
-    } else if (protected_keys_.IsProtected(key)) {
+    }
+    check_mutable_cache = lru_scan_cache_ != nullptr;
+    lru_lock.unlock();
+
+    // if lru exist, but key not found, this case possible only for protected
+    // keys
+    if (!check_mutable_cache && protected_keys_.IsProtected(key)) {
       return mutable_cache_ && mutable_cache_->Contains(key);
     }
+  }
 
-    // check in mutable cache only if lru does not exist
-  } else if (mutable_cache_ && mutable_cache_->Contains(key)) {
-    return (GetRemainingExpiryTime(key, *mutable_cache_) > 0) ||
-           protected_keys_.IsProtected(key);
+  if (check_mutable_cache && mutable_cache_) {
+    time_t expiry = KeyValueCache::kDefaultExpiry;
+    if (ReadDiskRecord(CacheType::kMutable, key, iterators, nullptr, expiry)) {
+      return (GetRemainingExpiryTime(expiry) > 0) ||
+             protected_keys_.IsProtected(key);
+    }
   }
 
-  if (protected_cache_ && protected_cache_->Contains(key)) {
-    return (GetRemainingExpiryTime(key, *protected_cache_) > 0);
+  time_t expiry = KeyValueCache::kDefaultExpiry;
+  if (protected_cache_ &&
+      ReadDiskRecord(CacheType::kProtected, key, iterators, nullptr, expiry)) {
+    return (GetRemainingExpiryTime(expiry) > 0);
   }
 
   return false;
 }
 
-bool DefaultCacheImpl::AddKeyLru(std::string key, const leveldb::Slice& value) {
+bool DefaultCacheImpl::AddKeyLru(std::string key, const leveldb::Slice& value,
+                                 DiskLruCache& lru) {
   // do not add protected keys to lru, this applies to all keys with some
   // protected prefix, do not add internal keys
-  if (mutable_cache_lru_ && !protected_keys_.IsProtected(key) &&
-      !IsInternalKey(key)) {
+  if (!protected_keys_.IsProtected(key) && !IsInternalKey(key)) {
+    ValueProperties props;
+
+    if (mutable_cache_inline_expiry_) {
+      leveldb::Slice payload;
+      if (!CacheRecord::Decode(value, false, props.expiry, payload)) {
+        OLP_SDK_LOG_WARNING_F(kLogTag, "Malformed record, key='%s'",
+                              key.c_str());
+        return false;
+      }
+
+      props.size = GetStoredValueSize(value);
+      auto result = lru.InsertOrAssign(key, props);
+      return result.second;
+    }
+
     // remove the prefix to restore original key
     const bool expiration_key = IsExpiryKey(key);
     if (expiration_key) {
-      key.resize(key.size() - kExpirySuffixLength);
+      key.resize(key.size() - strlen(kExpirySuffix));
     }
 
-    ValueProperties props;
-
-    auto iterator = mutable_cache_lru_->FindNoPromote(key);
-    if (iterator != mutable_cache_lru_->end()) {
+    auto iterator = lru.FindNoPromote(key);
+    if (iterator != lru.end()) {
       props = iterator->value();
     }
 
@@ -492,7 +832,7 @@ bool DefaultCacheImpl::AddKeyLru(std::string key, const leveldb::Slice& value) {
       props.size = value.size();
     }
 
-    auto result = mutable_cache_lru_->InsertOrAssign(key, props);
+    auto result = lru.InsertOrAssign(key, props);
     return result.second;
   }
   return false;
@@ -503,36 +843,284 @@ void DefaultCacheImpl::InitializeLru() {
     return;
   }
 
-  OLP_SDK_LOG_INFO_F(kLogTag, "Initializing mutable LRU cache");
-
   mutable_cache_data_size_ = 0;
 
   mutable_cache_lru_ =
       std::make_unique<DiskLruCache>(settings_.max_disk_storage);
 
+  if (LoadLruSnapshot()) {
+    return;
+  }
+
+  OLP_SDK_LOG_INFO_F(kLogTag, "Initializing mutable LRU cache");
+
+  lru_scan_cache_ = std::make_unique<DiskLruCache>(settings_.max_disk_storage);
+  lru_scan_position_.clear();
+  lru_scan_start_ = std::chrono::steady_clock::now();
+
+  // Do not block the open of a large cache, the keys which are not scanned yet
+  // are looked up on disk meanwhile.
+  if (mutable_cache_->Size() >= lru_scan_threshold_) {
+    StartLruScan();
+    return;
+  }
+
+  while (ScanLruPortion(std::numeric_limits<size_t>::max())) {
+  }
+}
+
+bool DefaultCacheImpl::LoadLruSnapshot() {
+  KeyValueCache::ValueTypePtr value = nullptr;
+  if (!mutable_cache_inline_expiry_ ||
+      !mutable_cache_->Get(kLruSnapshotKey, value) || !value) {
+    return false;
+  }
+
+  const auto start = std::chrono::steady_clock::now();
+  const auto path = settings_.disk_path_mutable.get() + kLruSnapshotFile;
+  const auto id =
+      std::strtoull(std::string(value->begin(), value->end()).c_str(), nullptr,
+                    10);
+
+  uint64_t data_size = 0u;
+  const auto loaded = LruSnapshot::Load(
+      path, id, data_size, [&](const LruSnapshot::Entry& entry) {
+        ValueProperties props;
+        props.size = static_cast<size_t>(entry.size);
+        props.expiry = entry.expiry;
+        mutable_cache_lru_->InsertOrAssign(entry.key.ToString(), props);
+      });
+
+  if ((settings_.openOptions & ReadOnly) != ReadOnly &&
+      !InvalidateLruSnapshot()) {
+    mutable_cache_lru_->Clear();
+    return false;
+  }
+
+  if (!loaded) {
+    OLP_SDK_LOG_WARNING_F(kLogTag, "LRU snapshot not loaded, path='%s'",
+                          path.c_str());
+    return false;
+  }
+
+  mutable_cache_data_size_ = data_size;
+
+  OLP_SDK_LOG_INFO_F(
+      kLogTag, "LRU cache loaded, items=%zu, time=%" PRId64 " ms",
+      mutable_cache_lru_->Size(), GetElapsedTime(start));
+  return true;
+}
+
+bool DefaultCacheImpl::InvalidateLruSnapshot() {
+  LruSnapshot::Remove(settings_.disk_path_mutable.get() + kLruSnapshotFile);
+
+  KeyValueCache::ValueTypePtr value = nullptr;
+  if (!mutable_cache_->Get(kLruSnapshotKey, value) || !value) {
+    return true;
+  }
+
+  // The snapshot is outdated by the first write, drop it before. If the marker
+  // removal is lost on a crash, all later writes are lost with it.
+  auto batch = std::make_unique<leveldb::WriteBatch>();
+  batch->Delete(kLruSnapshotKey);
+  if (!mutable_cache_->ApplyBatch(std::move(batch)).IsSuccessful()) {
+    OLP_SDK_LOG_WARNING(kLogTag, "Failed to remove the LRU snapshot marker");
+    return false;
+  }
+
+  return true;
+}
+
+void DefaultCacheImpl::SaveLruSnapshot() {
   const auto start = std::chrono::steady_clock::now();
-  auto it = mutable_cache_->NewIterator(leveldb::ReadOptions());
+  const auto path = settings_.disk_path_mutable.get() + kLruSnapshotFile;
+  const auto id = static_cast<uint64_t>(
+      std::chrono::system_clock::now().time_since_epoch().count());
+
+  auto it = mutable_cache_lru_->rbegin();
+  const auto saved = LruSnapshot::Save(
+      path, id, mutable_cache_data_size_, [&](LruSnapshot::Entry& entry) {
+        if (it == mutable_cache_lru_->rend()) {
+          return false;
+        }
+
+        entry.key = it->key();
+        entry.size = it->value().size;
+        entry.expiry = it->value().expiry;
+        --it;
+        return true;
+      });
+  if (!saved) {
+    return;
+  }
+
+  auto batch = std::make_unique<leveldb::WriteBatch>();
+  batch->Put(kLruSnapshotKey, std::to_string(id));
+  if (!mutable_cache_->ApplyBatch(std::move(batch)).IsSuccessful()) {
+    LruSnapshot::Remove(path);
+    return;
+  }
+
+  // The snapshot is outdated by the next write.
+  mutable_cache_->DeleteWithNextWrite(kLruSnapshotKey);
+
+  OLP_SDK_LOG_INFO_F(
+      kLogTag, "LRU snapshot saved, items=%zu, time=%" PRId64 " ms",
+      mutable_cache_lru_->Size(), GetElapsedTime(start));
+}
+
+bool DefaultCacheImpl::CanSaveLruSnapshot() const {
+  return mutable_cache_ && mutable_cache_lru_ && !lru_scan_cache_ &&
+         mutable_cache_inline_expiry_ &&
+         (settings_.openOptions & ReadOnly) != ReadOnly;
+}
+
+bool DefaultCacheImpl::IsLruSnapshotDue() const {
+  if (!lru_snapshot_scheduled_ || !CanSaveLruSnapshot()) {
+    return false;
+  }
+
+  return mutable_cache_generation_ - lru_snapshot_generation_ >=
+             lru_snapshot_mutations_ ||
+         std::chrono::steady_clock::now() - lru_snapshot_scheduled_time_ >=
+             kLruSnapshotInterval;
+}
+
+void DefaultCacheImpl::ScheduleLruSnapshot() {
+  if (mutable_cache_generation_ == lru_snapshot_generation_ ||
+      !CanSaveLruSnapshot()) {
+    return;
+  }
+
+  if (!lru_snapshot_scheduled_) {
+    lru_snapshot_scheduled_ = true;
+    lru_snapshot_scheduled_time_ = std::chrono::steady_clock::now();
+    WakeEvictionThread();
+  } else if (IsLruSnapshotDue()) {
+    WakeEvictionThread();
+  }
+}
+
+void DefaultCacheImpl::MaybeSaveLruSnapshot() {
+  std::lock_guard<std::mutex> lru_lock(lru_lock_);
+  if (!IsLruSnapshotDue()) {
+    // The LRU can be rebuilt meanwhile, the next write schedules it again.
+    if (!CanSaveLruSnapshot()) {
+      lru_snapshot_scheduled_ = false;
+    }
+    return;
+  }
+
+  ApplyPendingPromotions();
+  SaveLruSnapshot();
+
+  // A failed save is not repeated before the next write.
+  lru_snapshot_generation_ = mutable_cache_generation_;
+  lru_snapshot_scheduled_ = false;
+}
 
-  for (it->SeekToFirst(); it->Valid(); it->Next()) {
-    auto key = it->key().ToString();
+bool DefaultCacheImpl::ScanLruPortion(size_t max_count) {
+  leveldb::ReadOptions options;
+  options.fill_cache = false;
+  auto it = mutable_cache_->NewIterator(options);
+
+  if (lru_scan_position_.empty()) {
+    it->SeekToFirst();
+  } else {
+    it->Seek(lru_scan_position_);
+    if (it->Valid() && it->key() == lru_scan_position_) {
+      it->Next();
+    }
+  }
+
+  for (size_t count = 0u; it->Valid() && count < max_count;
+       it->Next(), ++count) {
     const auto& value = it->value();
+    lru_scan_position_ = it->key().ToString();
+
+    // The markers are bookkeeping and are not accounted in the size
+    if (IsBookkeepingKey(lru_scan_position_)) {
+      continue;
+    }
 
-    // Here we count both expiry keys and regular keys
-    mutable_cache_data_size_ += key.size() + value.size();
+    mutable_cache_data_size_ +=
+        lru_scan_position_.size() +
+        (mutable_cache_inline_expiry_ ? GetStoredValueSize(value)
+                                      : value.size());
 
-    AddKeyLru(key, value);
+    // Keep the place of the keys written since the cache was opened
+    if (mutable_cache_lru_->FindNoPromote(lru_scan_position_) ==
+        mutable_cache_lru_->end()) {
+      AddKeyLru(lru_scan_position_, value, *lru_scan_cache_);
+    }
+  }
+
+  if (it->Valid()) {
+    return true;
   }
 
+  // The keys used since the cache was opened are the most recent ones.
+  for (auto lru_it = mutable_cache_lru_->rbegin();
+       lru_it != mutable_cache_lru_->rend(); --lru_it) {
+    lru_scan_cache_->InsertOrAssign(lru_it->key(), lru_it->value());
+  }
+  mutable_cache_lru_ = std::move(lru_scan_cache_);
+  lru_scan_position_.clear();
+
   OLP_SDK_LOG_INFO_F(
       kLogTag, "LRU cache initialized, items=%zu, time=%" PRId64 " ms",
-      mutable_cache_lru_->Size(), GetElapsedTime(start));
+      mutable_cache_lru_->Size(), GetElapsedTime(lru_scan_start_));
+  return false;
+}
+
+void DefaultCacheImpl::StartLruScan() {
+  lru_scan_thread_ = std::thread([this]() {
+    while (!stop_lru_scan_) {
+      // Never wait for the exclusive lock, its owner may wait for this thread
+      // to stop.
+      ReadLock lock(cache_lock_, std::try_to_lock);
+      if (!lock) {
+        std::this_thread::sleep_for(kLruScanRetryDelay);
+        continue;
+      }
+
+      std::lock_guard<std::mutex> lru_lock(lru_lock_);
+      if (!ScanLruPortion(kLruScanPortion)) {
+        return;
+      }
+    }
+  });
+}
+
+void DefaultCacheImpl::StopLruScan() {
+  if (lru_scan_thread_.joinable()) {
+    stop_lru_scan_ = true;
+    lru_scan_thread_.join();
+    stop_lru_scan_ = false;
+  }
+}
+
+void DefaultCacheImpl::CompleteLruScan() {
+  StopLruScan();
+  if (lru_scan_cache_) {
+    while (ScanLruPortion(std::numeric_limits<size_t>::max())) {
+    }
+  }
+}
+
+bool DefaultCacheImpl::IsAccountedInSize(const std::string& key) const {
+  return !lru_scan_cache_ || key <= lru_scan_position_;
 }
 
 bool DefaultCacheImpl::RemoveKeyLru(const std::string& key) {
+  bool removed = false;
+  if (lru_scan_cache_) {
+    removed = lru_scan_cache_->Erase(key);
+  }
   if (mutable_cache_lru_) {
-    return mutable_cache_lru_->Erase(key);
+    removed = mutable_cache_lru_->Erase(key) || removed;
   }
-  return false;
+  return removed;
 }
 
 void DefaultCacheImpl::RemoveKeysWithPrefixLru(const std::string& key) {
@@ -556,25 +1144,74 @@ void DefaultCacheImpl::RemoveKeysWithPrefixLru(const std::string& key) {
 bool DefaultCacheImpl::PromoteKeyLru(const std::string& key) {
   if (mutable_cache_lru_) {
     auto it = mutable_cache_lru_->Find(key);
-    return it != mutable_cache_lru_->end() || protected_keys_.IsProtected(key);
+    if (it != mutable_cache_lru_->end()) {
+      return true;
+    }
+
+    // While the LRU is built, the key is either scanned already, then it is
+    // moved to the recently used keys, or is not reached yet.
+    if (lru_scan_cache_) {
+      auto scanned_it = lru_scan_cache_->FindNoPromote(key);
+      if (scanned_it != lru_scan_cache_->end()) {
+        mutable_cache_lru_->InsertOrAssign(key, scanned_it->value());
+        lru_scan_cache_->Erase(scanned_it);
+      }
+      return true;
+    }
+
+    return protected_keys_.IsProtected(key);
   }
 
   return true;
 }
 
-uint64_t DefaultCacheImpl::MaybeEvictData() {
-  if (!mutable_cache_ || !mutable_cache_lru_) {
-    return 0;
+void DefaultCacheImpl::MaybePromoteKeyLru(const std::string& key) {
+  std::unique_lock<std::mutex> lru_lock(lru_lock_, std::try_to_lock);
+  if (!lru_lock) {
+    // The LRU is busy, e.g. with a write or an eviction portion. The key is
+    // promoted later, so it is not evicted as cold meanwhile. The order is
+    // approximate: the queued keys are promoted after the ones that got the
+    // LRU directly, and the promotions beyond the queue limit are dropped.
+    std::lock_guard<std::mutex> lock(pending_promotions_lock_);
+    if (pending_promotions_.size() < kMaxPendingPromotions) {
+      pending_promotions_.push_back(key);
+    }
+    return;
   }
 
-  const auto max_size = kMaxDiskUsedThreshold * settings_.max_disk_storage;
-  if (mutable_cache_data_size_ < max_size) {
-    return 0;
+  ApplyPendingPromotions();
+  PromoteKeyLru(key);
+}
+
+void DefaultCacheImpl::ApplyPendingPromotions() {
+  std::vector<std::string> keys;
+  {
+    std::lock_guard<std::mutex> lock(pending_promotions_lock_);
+    keys.swap(pending_promotions_);
   }
 
+  for (const auto& key : keys) {
+    PromoteKeyLru(key);
+  }
+}
+
+uint64_t DefaultCacheImpl::MaybeEvictData() {
+  // The size and the LRU are not complete until the LRU scan finishes
+  if (!mutable_cache_ || !mutable_cache_lru_ || lru_scan_cache_) {
+    return 0;
+  }
+
+  const auto max_size = kMaxDiskUsedThreshold * settings_.max_disk_storage;
+  const auto data_size = GetMutableCacheSize();
+  if (data_size < max_size) {
+    return 0;
+  }
+
+  ApplyPendingPromotions();
+
   const auto start = std::chrono::steady_clock::now();
   int64_t left_to_evict =
-      mutable_cache_data_size_ -
+      data_size -
       std::llroundl(settings_.max_disk_storage * kMinDiskUsedThreshold);
   uint64_t evicted = 0u;
   auto count = 0u;
@@ -610,7 +1247,7 @@ uint64_t DefaultCacheImpl::MaybeEvictData() {
             break;
           }
 
-          mutable_cache_->Compact();
+          CompactMutableCache();
 
           evicted += eviction_result.size;
           count += eviction_result.count;
@@ -628,12 +1265,216 @@ uint64_t DefaultCacheImpl::MaybeEvictData() {
     call_evict_method(std::mem_fn(&DefaultCacheImpl::EvictDataPortion));
   }
 
+  // Reclaim the value log space of the evicted values.
+  CollectValueLogGarbage(false);
+
+  UpdateEvictionStatistics(count, evicted, start);
+
+  return evicted;
+}
+
+void DefaultCacheImpl::RequestEviction() {
+  eviction_requested_ = true;
+  WakeEvictionThread();
+}
+
+void DefaultCacheImpl::WakeEvictionThread() {
+  if (eviction_thread_.joinable()) {
+    eviction_cv_.notify_all();
+    return;
+  }
+
+  eviction_thread_ = std::thread([this]() {
+    std::unique_lock<std::mutex> lru_lock(lru_lock_);
+    while (true) {
+      const auto woken = [this]() {
+        return stop_eviction_ || eviction_requested_ ||
+               value_log_collection_requested_ || IsLruSnapshotDue();
+      };
+      if (lru_snapshot_scheduled_) {
+        eviction_cv_.wait_until(
+            lru_lock, lru_snapshot_scheduled_time_ + kLruSnapshotInterval,
+            woken);
+      } else {
+        eviction_cv_.wait(lru_lock, woken);
+      }
+      if (stop_eviction_) {
+        return;
+      }
+
+      // The writes during the eviction request the next one.
+      const bool evict = eviction_requested_;
+      const bool collect = value_log_collection_requested_;
+      eviction_requested_ = false;
+      value_log_collection_requested_ = false;
+      eviction_running_ = true;
+      lru_lock.unlock();
+      {
+        // Never wait for the exclusive lock, its owner may wait for this
+        // thread to stop.
+        ReadLock lock(cache_lock_, std::try_to_lock);
+        const bool locked = lock.owns_lock();
+        if (locked) {
+          const bool compact = evict && EvictDataInBackground();
+          if (collect) {
+            std::lock_guard<std::mutex> collect_lock(lru_lock_);
+            CollectValueLogGarbage(true);
+          }
+          MaybeSaveLruSnapshot();
+          lock.unlock();
+          if (compact) {
+            CompactInBackground();
+          }
+        } else {
+          std::this_thread::sleep_for(kEvictionRetryDelay);
+        }
+        lru_lock.lock();
+        eviction_requested_ = eviction_requested_ || (evict && !locked);
+        value_log_collection_requested_ =
+            value_log_collection_requested_ || (collect && !locked);
+        eviction_running_ = false;
+        eviction_cv_.notify_all();
+      }
+    }
+  });
+}
+
+void DefaultCacheImpl::StopEviction() {
+  if (!eviction_thread_.joinable()) {
+    return;
+  }
+
+  {
+    std::lock_guard<std::mutex> lru_lock(lru_lock_);
+    stop_eviction_ = true;
+    eviction_cv_.notify_all();
+  }
+  eviction_thread_.join();
+
+  std::lock_guard<std::mutex> lru_lock(lru_lock_);
+  stop_eviction_ = false;
+  eviction_requested_ = false;
+  value_log_collection_requested_ = false;
+  eviction_running_ = false;
+  lru_snapshot_scheduled_ = false;
+  eviction_cv_.notify_all();
+}
+
+bool DefaultCacheImpl::EvictDataInBackground() {
+  if (!mutable_cache_) {
+    return false;
+  }
+
+  const auto start = std::chrono::steady_clock::now();
+  const auto min_size = static_cast<uint64_t>(
+      std::llroundl(settings_.max_disk_storage * kMinDiskUsedThreshold));
+  uint64_t evicted = 0u;
+  auto count = 0u;
+
+  // The released values are reclaimed before the used ones are evicted. The
+  // values evicted below are only released once their segments are scanned.
+  uint64_t released_size = 0u;
+  if (mutable_value_log_) {
+    std::lock_guard<std::mutex> lru_lock(lru_lock_);
+    CollectValueLogGarbage(true);
+    released_size = mutable_value_log_->DeadSize();
+  }
+
+  // Writes can take the LRU between the portions.
+  const auto evict_portions =
+      [&](EvictionResult (DefaultCacheImpl::*evict_method)(
+          leveldb::WriteBatch&, uint64_t)) {
+        while (true) {
+          std::lock_guard<std::mutex> lru_lock(lru_lock_);
+          if (stop_eviction_ || !mutable_cache_lru_ || lru_scan_cache_ ||
+              mutable_cache_data_size_ + released_size <= min_size) {
+            return false;
+          }
+
+          ApplyPendingPromotions();
+
+          const auto left_to_evict =
+              mutable_cache_data_size_ + released_size - min_size;
+          const auto target = left_to_evict < eviction_portion_
+                                  ? left_to_evict
+                                  : eviction_portion_;
+          auto batch = std::make_unique<leveldb::WriteBatch>();
+          const auto result = (this->*evict_method)(*batch, target);
+          if (result.count == 0u) {
+            return true;
+          }
+
+          const auto apply_result =
+              mutable_cache_->ApplyBatch(std::move(batch));
+          ++mutable_cache_generation_;
+          if (!apply_result.IsSuccessful()) {
+            OLP_SDK_LOG_WARNING_F(
+                kLogTag,
+                "EvictDataInBackground(): failed to apply batch, "
+                "error_code=%d, error_message=%s",
+                static_cast<int>(apply_result.GetError().GetErrorCode()),
+                apply_result.GetError().GetMessage().c_str());
+            return false;
+          }
+
+          mutable_cache_data_size_ -= result.size;
+          evicted += result.size;
+          count += result.count;
+
+          if (result.size < target) {
+            return true;
+          }
+        }
+      };
+
+  // Evict expired data first
+  if (evict_portions(&DefaultCacheImpl::EvictExpiredDataPortion)) {
+    evict_portions(&DefaultCacheImpl::EvictDataPortion);
+  }
+
+  if (count == 0u) {
+    return false;
+  }
+
+  {
+    // Reclaim the value log space of the evicted values.
+    std::lock_guard<std::mutex> lru_lock(lru_lock_);
+    CollectValueLogGarbage(false);
+  }
+
+  UpdateEvictionStatistics(count, evicted, start);
+  return true;
+}
+
+void DefaultCacheImpl::CompactInBackground() {
+  const auto start = std::chrono::steady_clock::now();
+
+  // LevelDB allows writes while compacting.
+  const auto completed =
+      mutable_cache_->Compact(kCompactionSliceKeys, [this]() {
+        std::lock_guard<std::mutex> lru_lock(lru_lock_);
+        return stop_eviction_;
+      });
+
+  // Skipped and cancelled compactions are not counted.
+  if (completed) {
+    Increment(statistics_.compactions);
+    Increment(statistics_.compaction_time_us, GetElapsedMicroseconds(start));
+  }
+}
+
+void DefaultCacheImpl::UpdateEvictionStatistics(
+    unsigned count, uint64_t evicted,
+    std::chrono::steady_clock::time_point start) {
+  Increment(eviction_runs_);
+  Increment(evicted_count_, count);
+  Increment(evicted_bytes_, evicted);
+  Increment(eviction_time_us_, GetElapsedMicroseconds(start));
+
   OLP_SDK_LOG_INFO_F(kLogTag,
                      "Evicted from mutable cache, items=%" PRId32
                      ", time=%" PRId64 "ms, size=%" PRIu64,
                      count, GetElapsedTime(start), evicted);
-
-  return evicted;
 }
 
 DefaultCacheImpl::EvictionResult DefaultCacheImpl::EvictExpiredDataPortion(
@@ -659,11 +1500,6 @@ DefaultCacheImpl::EvictionResult DefaultCacheImpl::EvictExpiredDataPortion(
     batch.Delete(key);
     evicted += key.size() + properties.size;
 
-    // Remove the key's expiry
-    auto expiry_key = CreateExpiryKey(key);
-    batch.Delete(expiry_key);
-    evicted += expiry_key.size() + kExpiryValueSize;
-
     ++count;
 
     if (memory_cache_) {
@@ -695,13 +1531,6 @@ DefaultCacheImpl::EvictionResult DefaultCacheImpl::EvictDataPortion(
     evicted += key.size() + properties.size;
     batch.Delete(key);
 
-    // Remove the key's expiry
-    if (IsExpiryValid(properties.expiry)) {
-      const auto expiry_key = CreateExpiryKey(key);
-      evicted += expiry_key.size() + kExpiryValueSize;
-      batch.Delete(expiry_key);
-    }
-
     ++count;
 
     if (memory_cache_) {
@@ -748,59 +1577,173 @@ bool DefaultCacheImpl::PutMutableCache(const std::string& key,
     return true;
   }
 
-  // can't put new item if cache is full and eviction disabled
-  const auto item_size = value.size();
-  const auto expected_size = mutable_cache_data_size_ + item_size + key.size() +
-                             key.size() + kExpirySuffixLength +
-                             kExpiryValueSize;
-  if (!mutable_cache_lru_ && expected_size > settings_.max_disk_storage) {
-    return false;
-  }
-
-  uint64_t added_data_size = 0u;
   auto batch = std::make_unique<leveldb::WriteBatch>();
-  batch->Put(key, value);
-  added_data_size += key.size() + item_size;
+  const std::vector<LruEntry> entries{AddRecord(*batch, key, value, expiry)};
+
+  const auto result = ApplyMutableCacheBatch(std::move(batch), entries);
+  CommitValueLogEntries(entries);
+  return result;
+}
 
+DefaultCacheImpl::LruEntry DefaultCacheImpl::AddRecord(
+    leveldb::WriteBatch& batch, const std::string& key,
+    const leveldb::Slice& value, time_t expiry) const {
   if (IsExpiryValid(expiry)) {
     expiry += olp::cache::InMemoryCache::DefaultTimeProvider()();
-    added_data_size += StoreExpiry(key, *batch, expiry);
   }
 
-  auto removed_data_size = MaybeEvictData();
+  const bool with_checksum = (settings_.openOptions & CheckCrc) == CheckCrc;
+
+  LruEntry entry{key, ValueProperties(), ValueLog::Location()};
+  entry.properties.expiry = expiry;
+
+  if (mutable_value_log_ && settings_.large_value_threshold > 0u &&
+      value.size() > settings_.large_value_threshold &&
+      value.size() <= std::numeric_limits<uint32_t>::max() &&
+      mutable_value_log_->Append(key, value, entry.location)) {
+    const auto record = CacheRecord::Encode(
+        ValueLog::EncodeLocation(entry.location), expiry, with_checksum, true);
+    batch.Put(key, record);
+    entry.properties.size = record.size() + value.size();
+    return entry;
+  }
+
+  const auto record = CacheRecord::Encode(value, expiry, with_checksum);
+  batch.Put(key, record);
+  entry.properties.size = record.size();
+  return entry;
+}
+
+void DefaultCacheImpl::CommitValueLogEntries(
+    const std::vector<LruEntry>& entries) const {
+  if (!mutable_value_log_) {
+    return;
+  }
+
+  for (const auto& entry : entries) {
+    if (entry.location.segment != 0u) {
+      mutable_value_log_->Commit(entry.location);
+    }
+  }
+}
+
+bool DefaultCacheImpl::ApplyMutableCacheBatch(
+    std::unique_ptr<leveldb::WriteBatch> batch,
+    const std::vector<LruEntry>& entries) {
+  std::lock_guard<std::mutex> lru_lock(lru_lock_);
+  ApplyPendingPromotions();
+
+  uint64_t added_data_size = 0u;
+  uint64_t written_data_size = 0u;
+  for (const auto& entry : entries) {
+    const auto entry_size = entry.key.size() + entry.properties.size;
+    written_data_size += entry_size;
+    if (IsAccountedInSize(entry.key)) {
+      added_data_size += entry_size;
+    }
+  }
+
+  // can't put new items if cache is full and eviction disabled
+  const auto expected_size = GetMutableCacheSize() + added_data_size;
+  if (!mutable_cache_lru_ && expected_size > settings_.max_disk_storage) {
+    return false;
+  }
+
+  // The eviction runs in the background, unless the writes outpace it and the
+  // cache exceeds its maximum size.
+  uint64_t removed_data_size = 0u;
+  if (expected_size > settings_.max_disk_storage) {
+    removed_data_size = MaybeEvictData();
+  }
+
   auto updated_data_size = MaybeUpdatedProtectedKeys(*batch);
+  if (!IsAccountedInSize(kProtectedKeys)) {
+    updated_data_size = 0;
+  }
+
+  // The values in the value log must be durable before the records which
+  // refer to them.
+  if (mutable_value_log_ && !mutable_value_log_->Sync()) {
+    return false;
+  }
+
+  // The overwritten values stay in the value log until their segments are
+  // collected.
+  std::vector<ValueLog::Location> replaced;
+  uint64_t replaced_data_size = 0u;
+  if (mutable_value_log_) {
+    auto iterator = mutable_cache_->NewIterator(leveldb::ReadOptions());
+    for (const auto& entry : entries) {
+      ValueLog::Location location;
+      iterator->Seek(entry.key);
+      if (!iterator->Valid() || iterator->key() != entry.key ||
+          !DecodeValueLogLocation(iterator->value(), location)) {
+        continue;
+      }
+
+      replaced.push_back(location);
+      if (IsAccountedInSize(entry.key)) {
+        replaced_data_size +=
+            entry.key.size() + GetStoredValueSize(iterator->value());
+      }
+    }
+  }
 
   auto result = mutable_cache_->ApplyBatch(std::move(batch));
+  ++mutable_cache_generation_;
   if (!result.IsSuccessful()) {
     return false;
   }
+  Increment(statistics_.bytes_written, written_data_size);
   mutable_cache_data_size_ += added_data_size;
   mutable_cache_data_size_ -= removed_data_size;
+  mutable_cache_data_size_ -= replaced_data_size;
   mutable_cache_data_size_ += updated_data_size;
+  for (const auto& location : replaced) {
+    ReleaseValueLogValue(location);
+  }
 
-  // do not add protected keys to lru
-  if (mutable_cache_lru_ && !protected_keys_.IsProtected(key)) {
-    ValueProperties props;
-    props.size = item_size;
-    props.expiry = expiry;
-    const auto result = mutable_cache_lru_->InsertOrAssign(key, props);
+  if (!mutable_cache_lru_) {
+    return true;
+  }
+
+  const auto max_size = kMaxDiskUsedThreshold * settings_.max_disk_storage;
+  if (!lru_scan_cache_ && GetMutableCacheSize() >= max_size) {
+    RequestEviction();
+  }
+
+  bool stored = true;
+  for (const auto& entry : entries) {
+    // do not add protected keys to lru
+    if (protected_keys_.IsProtected(entry.key)) {
+      continue;
+    }
+
+    const auto result =
+        mutable_cache_lru_->InsertOrAssign(entry.key, entry.properties);
     if (result.first == mutable_cache_lru_->end() && !result.second) {
       OLP_SDK_LOG_WARNING_F(
           kLogTag, "Failed to store value in mutable LRU cache, key %s",
-          key.c_str());
-      return false;
+          entry.key.c_str());
+      stored = false;
     }
   }
 
-  return true;
+  ScheduleLruSnapshot();
+  return stored;
 }
 
 DefaultCache::StorageOpenResult DefaultCacheImpl::SetupStorage() {
   auto result = DefaultCache::Success;
 
+  StopEviction();
+  StopLruScan();
+  lru_scan_cache_.reset();
   memory_cache_.reset();
+  mutable_value_log_.reset();
   mutable_cache_.reset();
   mutable_cache_lru_.reset();
+  protected_value_log_.reset();
   protected_cache_.reset();
   protected_keys_ = ProtectedKeyList();
   mutable_cache_data_size_ = 0;
@@ -859,6 +1802,18 @@ DefaultCache::StorageOpenResult DefaultCacheImpl::SetupProtectedCache() {
     return ToStorageOpenResult(status);
   }
 
+  // The protected cache is never converted, it is read in the format it was
+  // written in.
+  KeyValueCache::ValueTypePtr format = nullptr;
+  protected_cache_inline_expiry_ =
+      protected_cache_->Get(kFormatVersionKey, format) && format &&
+      std::string(format->begin(), format->end()) == kInlineExpiryFormat;
+
+  if (protected_cache_inline_expiry_) {
+    protected_value_log_ =
+        OpenValueLog(settings_.disk_path_protected.get(), true);
+  }
+
   return DefaultCache::Success;
 }
 
@@ -879,6 +1834,19 @@ DefaultCache::StorageOpenResult DefaultCacheImpl::SetupMutableCache() {
     return StorageOpenResult::OpenDiskPathFailure;
   }
 
+  if (!UpgradeMutableCache()) {
+    OLP_SDK_LOG_ERROR_F(kLogTag, "Failed to upgrade the mutable cache %s",
+                        settings_.disk_path_mutable.get().c_str());
+
+    mutable_cache_.reset();
+    return StorageOpenResult::OpenDiskPathFailure;
+  }
+
+  mutable_value_log_ = OpenValueLog(
+      settings_.disk_path_mutable.get(),
+      (settings_.openOptions & ReadOnly) == ReadOnly ||
+          !mutable_cache_inline_expiry_);
+
   // read protected keys
   KeyValueCache::ValueTypePtr value = nullptr;
   auto result = mutable_cache_->Get(kProtectedKeys, value);
@@ -893,98 +1861,531 @@ DefaultCache::StorageOpenResult DefaultCacheImpl::SetupMutableCache() {
     InitializeLru();
   } else {
     mutable_cache_data_size_ = mutable_cache_->Size();
+    if (mutable_value_log_) {
+      mutable_cache_data_size_ += mutable_value_log_->Size();
+    }
+
+    // Without the LRU the snapshot is not loaded, but it is outdated by the
+    // writes all the same.
+    if ((settings_.openOptions & ReadOnly) != ReadOnly) {
+      InvalidateLruSnapshot();
+    }
   }
 
+  lru_snapshot_generation_ = mutable_cache_generation_;
+  lru_snapshot_scheduled_ = false;
+
   return DefaultCache::Success;
 }
 
 void DefaultCacheImpl::DestroyCache(DefaultCache::CacheType type) {
   if (type == DefaultCache::CacheType::kMutable) {
+    StopEviction();
+    StopLruScan();
+
     if (mutable_cache_ && protected_keys_.IsDirty()) {
       auto batch = std::make_unique<leveldb::WriteBatch>();
-      MaybeUpdatedProtectedKeys(*batch);
+      const auto updated_data_size = MaybeUpdatedProtectedKeys(*batch);
       auto result = mutable_cache_->ApplyBatch(std::move(batch));
+      if (result.IsSuccessful() && IsAccountedInSize(kProtectedKeys)) {
+        mutable_cache_data_size_ += updated_data_size;
+      }
       OLP_SDK_LOG_INFO_F(kLogTag,
                          "Close(): store list of protected keys, result=%s",
                          result.IsSuccessful() ? "true" : "false");
     }
 
+    // The snapshot is only written for a complete LRU
+    if (CanSaveLruSnapshot()) {
+      SaveLruSnapshot();
+    }
+
+    mutable_value_log_.reset();
     mutable_cache_.reset();
     mutable_cache_lru_.reset();
+    lru_scan_cache_.reset();
     protected_keys_ = ProtectedKeyList();
     mutable_cache_data_size_ = 0;
   } else {
+    protected_value_log_.reset();
     protected_cache_.reset();
   }
 }
 
 bool DefaultCacheImpl::GetFromDiskCache(const std::string& key,
-                                        KeyValueCache::ValueTypePtr& value,
-                                        time_t& expiry) {
+                                        leveldb::Slice& value, time_t& expiry,
+                                        DiskIterators& iterators) {
   // Make sure we do not get a dirty entry
-  value = nullptr;
+  value.clear();
   expiry = KeyValueCache::kDefaultExpiry;
 
   if (protected_cache_) {
-    auto result = protected_cache_->Get(key, value);
-    if (result && value && !value->empty()) {
-      expiry = GetRemainingExpiryTime(key, *protected_cache_);
+    auto result =
+        ReadDiskRecord(CacheType::kProtected, key, iterators, &value, expiry);
+    if (result && !value.empty()) {
+      expiry = GetRemainingExpiryTime(expiry);
       if (expiry > 0) {
+        Increment(statistics_.protected_cache_hits);
+        Increment(statistics_.bytes_read, value.size());
         return true;
       }
-      value = nullptr;
     }
+    Increment(statistics_.protected_cache_misses);
+    value.clear();
+    expiry = KeyValueCache::kDefaultExpiry;
   }
 
   if (mutable_cache_) {
-    expiry = GetRemainingExpiryTime(key, *mutable_cache_);
-
-    if (expiry > 0 || protected_keys_.IsProtected(key)) {
-      // Entry didn't expire yet, we can still use it
+    {
+      std::lock_guard<std::mutex> lru_lock(lru_lock_);
       if (!PromoteKeyLru(key)) {
         // If not found in LRU or not protected no need to look in disk cache
         // either.
         OLP_SDK_LOG_DEBUG_F(kLogTag,
                             "Key not found in LRU, and not protected, key='%s'",
                             key.c_str());
+        Increment(statistics_.mutable_cache_misses);
+        return false;
+      }
+    }
+
+    if (!ReadDiskRecord(CacheType::kMutable, key, iterators, &value, expiry)) {
+      Increment(statistics_.mutable_cache_misses);
+      return false;
+    }
+
+    expiry = GetRemainingExpiryTime(expiry);
+    if (expiry > 0 || protected_keys_.IsProtected(key)) {
+      // Entry didn't expire yet, we can still use it
+      if (value.empty()) {
+        Increment(statistics_.mutable_cache_misses);
         return false;
       }
 
-      auto result = mutable_cache_->Get(key, value);
-      return result && value;
+      Increment(statistics_.mutable_cache_hits);
+      Increment(statistics_.bytes_read, value.size());
+      return true;
     }
 
+    Increment(statistics_.mutable_cache_misses);
+    value.clear();
+
     // Data expired in cache -> remove, but not protected keys
+    std::lock_guard<std::mutex> lru_lock(lru_lock_);
     uint64_t removed_data_size = 0u;
     PurgeDiskItem(key, *mutable_cache_, removed_data_size);
-    mutable_cache_data_size_ -= removed_data_size;
+    if (IsAccountedInSize(key)) {
+      mutable_cache_data_size_ -= removed_data_size;
+    }
+    ++mutable_cache_generation_;
     RemoveKeyLru(key);
   }
 
   return false;
 }
 
-boost::optional<std::pair<std::string, time_t>>
-DefaultCacheImpl::GetFromDiscCache(const std::string& key) {
-  KeyValueCache::ValueTypePtr value = nullptr;
-  time_t expiry = KeyValueCache::kDefaultExpiry;
-  auto result = GetFromDiskCache(key, value, expiry);
-  if (result && value) {
-    return std::make_pair(std::string(value->begin(), value->end()), expiry);
+void DefaultCacheImpl::GetBatchFromDisk(const KeyValueCache::KeyListType& keys,
+                                        std::vector<size_t> indices,
+                                        const DiskValueCallback& callback) {
+  if (indices.empty() || (!mutable_cache_ && !protected_cache_)) {
+    return;
+  }
+
+  // Look up in the key order, so consecutive disk reads hit the same blocks
+  std::sort(indices.begin(), indices.end(),
+            [&](size_t lhs, size_t rhs) { return keys[lhs] < keys[rhs]; });
+
+  DiskIterators iterators;
+  for (const auto index : indices) {
+    const auto& key = keys[index];
+    std::lock_guard<std::mutex> key_lock(GetKeyLock(key));
+
+    leveldb::Slice value;
+    time_t expiry = KeyValueCache::kDefaultExpiry;
+    if (GetFromDiskCache(key, value, expiry, iterators)) {
+      callback(index, value, expiry);
+    }
+  }
+}
+
+bool DefaultCacheImpl::ReadDiskRecord(DefaultCache::CacheType type,
+                                      const std::string& key,
+                                      DiskIterators& iterators,
+                                      leveldb::Slice* value,
+                                      time_t& expiry) const {
+  const bool is_mutable = type == DefaultCache::CacheType::kMutable;
+  const auto& value_log =
+      is_mutable ? mutable_value_log_ : protected_value_log_;
+
+  // Pin the value log before the record is looked up, so the segment it
+  // refers to is still readable if the value is moved meanwhile.
+  ValueLog::ReadPin pin(value ? value_log.get() : nullptr);
+
+  auto& disk_cache = is_mutable ? *mutable_cache_ : *protected_cache_;
+  auto& iterator = is_mutable ? GetMutableCacheIterator(iterators)
+                              : iterators.protected_cache;
+  const bool inline_expiry = is_mutable ? mutable_cache_inline_expiry_
+                                         : protected_cache_inline_expiry_;
+
+  const bool check_crc = (settings_.openOptions & CheckCrc) == CheckCrc;
+  leveldb::Slice record;
+  if (iterators.single_key) {
+    // A point lookup is cheaper than an iterator which is used only once
+    auto result = disk_cache.Get(key);
+    if (!result) {
+      return false;
+    }
+
+    iterators.record_buffer = std::move(*result);
+    record = iterators.record_buffer;
+  } else {
+    if (!iterator) {
+      leveldb::ReadOptions options;
+      options.verify_checksums = check_crc;
+      iterator = disk_cache.NewIterator(options);
+    }
+
+    iterator->Seek(key);
+    if (!iterator->Valid() || iterator->key() != key) {
+      return false;
+    }
+
+    record = iterator->value();
+  }
+
+  leveldb::Slice payload = record;
+  if (inline_expiry) {
+    if (!CacheRecord::Decode(record, check_crc, expiry, payload)) {
+      OLP_SDK_LOG_WARNING_F(kLogTag, "Malformed record, key='%s'",
+                            key.c_str());
+      return false;
+    }
+  } else {
+    expiry = GetLegacyExpiry(key, disk_cache);
+  }
+
+  if (value && inline_expiry && CacheRecord::IsInValueLog(record)) {
+    ValueLog::Location location;
+    bool read = value_log && ValueLog::DecodeLocation(payload, location);
+    if (read && iterators.use_value_buffer) {
+      if (!iterators.value_buffer) {
+        iterators.value_buffer = std::make_shared<KeyValueCache::ValueType>();
+      }
+      auto& buffer = *iterators.value_buffer;
+      read = value_log->Read(location, check_crc, buffer);
+      payload = leveldb::Slice(reinterpret_cast<const char*>(buffer.data()),
+                               buffer.size());
+    } else if (read) {
+      read = value_log->Read(location, check_crc, iterators.value_log_buffer);
+      payload = leveldb::Slice(iterators.value_log_buffer);
+    }
+
+    if (!read) {
+      OLP_SDK_LOG_WARNING_F(kLogTag, "Failed to read value log, key='%s'",
+                            key.c_str());
+      return false;
+    }
+  }
+
+  if (value) {
+    *value = payload;
+  }
+
+  return true;
+}
+
+std::string DefaultCacheImpl::TakeDiskValue(const leveldb::Slice& value,
+                                            DiskIterators& iterators) {
+  for (auto* buffer : {&iterators.value_log_buffer, &iterators.record_buffer}) {
+    const auto* end = buffer->data() + buffer->size();
+    if (!buffer->empty() && value.data() >= buffer->data() &&
+        value.data() + value.size() == end) {
+      // Drops the record header in front of the value, if any
+      buffer->erase(0, value.data() - buffer->data());
+      return std::move(*buffer);
+    }
+  }
+
+  return value.ToString();
+}
+
+std::unique_ptr<leveldb::Iterator>& DefaultCacheImpl::GetMutableCacheIterator(
+    DiskIterators& iterators) const {
+  const auto generation = mutable_cache_generation_.load();
+  if (iterators.mutable_cache &&
+      iterators.mutable_cache_generation != generation) {
+    iterators.mutable_cache.reset();
+  }
+
+  iterators.mutable_cache_generation = generation;
+  return iterators.mutable_cache;
+}
+
+std::unique_ptr<ValueLog> DefaultCacheImpl::OpenValueLog(
+    const std::string& cache_path, bool read_only) const {
+  const auto path = cache_path + '/' + kValueLogFolder;
+
+  // The existing values are still read when the threshold is not set anymore.
+  if ((read_only || settings_.large_value_threshold == 0u) &&
+      !utils::Dir::Exists(path)) {
+    return nullptr;
+  }
+
+  auto value_log = std::make_unique<ValueLog>(
+      path, GetValueLogSegmentSize(settings_),
+      settings_.enforce_immediate_flush);
+  if (!value_log->Open(read_only)) {
+    OLP_SDK_LOG_ERROR_F(kLogTag, "Failed to open the value log %s",
+                        path.c_str());
+    return nullptr;
+  }
+
+  return value_log;
+}
+
+void DefaultCacheImpl::CollectValueLogGarbage(bool released_only) {
+  if (!mutable_cache_ || !mutable_value_log_) {
+    return;
+  }
+
+  struct LiveValue {
+    std::string key;
+    ValueLog::Location location;
+    time_t expiry;
+  };
+
+  const auto start = std::chrono::steady_clock::now();
+  const bool check_crc = (settings_.openOptions & CheckCrc) == CheckCrc;
+  auto collected = 0u;
+
+  // The oldest segments hold the least recently written values, which are
+  // evicted first, so only the segments with enough released values are
+  // scanned after the first segment which is still in use.
+  bool in_use_found = released_only;
+  for (const auto segment : mutable_value_log_->GetSealedSegments()) {
+    const auto segment_size = mutable_value_log_->GetSegmentSize(segment);
+    const auto max_live_size = kValueLogCollectRatio * segment_size;
+    const auto released_size = mutable_value_log_->GetSegmentDeadSize(segment);
+    if (in_use_found && segment_size - released_size > max_live_size) {
+      continue;
+    }
+
+    leveldb::ReadOptions options;
+    options.fill_cache = false;
+    auto iterator = mutable_cache_->NewIterator(options);
+
+    std::vector<LiveValue> live_values;
+    uint64_t live_size = 0u;
+    uint64_t dead_size = 0u;
+    const auto scanned = mutable_value_log_->ForEachEntry(
+        segment,
+        [&](const std::string& key, const ValueLog::Location& location) {
+          dead_size += location.size;
+          iterator->Seek(key);
+          if (!iterator->Valid() || iterator->key() != key ||
+              !CacheRecord::IsInValueLog(iterator->value())) {
+            return;
+          }
+
+          time_t expiry = KeyValueCache::kDefaultExpiry;
+          leveldb::Slice payload;
+          ValueLog::Location current;
+          if (CacheRecord::Decode(iterator->value(), false, expiry, payload) &&
+              ValueLog::DecodeLocation(payload, current) &&
+              current.segment == location.segment &&
+              current.offset == location.offset) {
+            live_values.push_back({key, location, expiry});
+            live_size += location.size;
+            dead_size -= location.size;
+          }
+        });
+
+    if (!scanned) {
+      in_use_found = true;
+      continue;
+    }
+
+    if (live_size > max_live_size) {
+      // Also accounts the evicted values, and the ones released before the
+      // open.
+      mutable_value_log_->SetDeadSize(segment, dead_size);
+      in_use_found = true;
+      continue;
+    }
+
+    // Move the values which are still used to the active segment.
+    auto batch = std::make_unique<leveldb::WriteBatch>();
+    std::string value;
+    uint64_t removed_data_size = 0u;
+    std::vector<ValueLog::Location> appended;
+    const auto commit_appended = [&]() {
+      for (const auto& location : appended) {
+        mutable_value_log_->Commit(location);
+      }
+    };
+
+    for (const auto& live_value : live_values) {
+      ValueLog::Location location;
+      if (!mutable_value_log_->Read(live_value.location, check_crc, value)) {
+        // The value is lost, drop the record which refers to it.
+        batch->Delete(live_value.key);
+        removed_data_size += live_value.key.size() + CacheRecord::kHeaderSize +
+                             ValueLog::kLocationSize +
+                             live_value.location.size;
+        RemoveKeyLru(live_value.key);
+        if (memory_cache_) {
+          memory_cache_->Remove(live_value.key);
+        }
+        continue;
+      }
+
+      if (!mutable_value_log_->Append(live_value.key, value, location)) {
+        commit_appended();
+        return;
+      }
+      appended.push_back(location);
+
+      batch->Put(live_value.key,
+                 CacheRecord::Encode(ValueLog::EncodeLocation(location),
+                                     live_value.expiry, check_crc, true));
+    }
+
+    const auto moved =
+        mutable_value_log_->Sync() &&
+        mutable_cache_->ApplyBatch(std::move(batch)).IsSuccessful();
+    commit_appended();
+    if (!moved) {
+      OLP_SDK_LOG_WARNING_F(kLogTag,
+                            "Failed to move values of value log segment=%u",
+                            segment);
+      return;
+    }
+
+    ++mutable_cache_generation_;
+    mutable_cache_data_size_ -= removed_data_size;
+    mutable_value_log_->RemoveSegment(segment);
+    ++collected;
   }
 
-  return boost::none;
+  if (collected > 0u) {
+    OLP_SDK_LOG_INFO_F(kLogTag,
+                       "Collected value log segments, count=%u, time=%" PRId64
+                       "ms",
+                       collected, GetElapsedTime(start));
+  }
 }
 
-std::string DefaultCacheImpl::GetExpiryKey(const std::string& key) const {
-  return CreateExpiryKey(key);
+void DefaultCacheImpl::ReleaseValueLogValue(
+    const ValueLog::Location& location) {
+  const auto released_size = mutable_value_log_->Release(location);
+  const auto segment_size =
+      mutable_value_log_->GetSegmentSize(location.segment);
+  if (released_size == 0u ||
+      segment_size - released_size > kValueLogCollectRatio * segment_size) {
+    return;
+  }
+
+  // A segment which is still appended to is collected by a later pass.
+  value_log_collection_requested_ = true;
+  WakeEvictionThread();
+}
+
+uint64_t DefaultCacheImpl::GetMutableCacheSize() const {
+  if (!mutable_value_log_) {
+    return mutable_cache_data_size_;
+  }
+
+  return mutable_cache_data_size_ + mutable_value_log_->DeadSize();
+}
+
+bool DefaultCacheImpl::UpgradeMutableCache() {
+  KeyValueCache::ValueTypePtr format = nullptr;
+  if (mutable_cache_->Get(kFormatVersionKey, format) && format &&
+      std::string(format->begin(), format->end()) == kInlineExpiryFormat) {
+    mutable_cache_inline_expiry_ = true;
+    return true;
+  }
+
+  if ((settings_.openOptions & ReadOnly) == ReadOnly) {
+    OLP_SDK_LOG_INFO(kLogTag,
+                     "Mutable cache is read-only, using the legacy format");
+    mutable_cache_inline_expiry_ = false;
+    return true;
+  }
+
+  const auto start = std::chrono::steady_clock::now();
+  const bool with_checksum = (settings_.openOptions & CheckCrc) == CheckCrc;
+
+  leveldb::ReadOptions options;
+  options.fill_cache = false;
+  auto it = mutable_cache_->NewIterator(options);
+
+  // Continue an upgrade interrupted by a crash or a failed write
+  KeyValueCache::ValueTypePtr last_key = nullptr;
+  if (mutable_cache_->Get(kFormatUpgradeKey, last_key) && last_key) {
+    const std::string key(last_key->begin(), last_key->end());
+    it->Seek(key);
+    if (it->Valid() && it->key() == key) {
+      it->Next();
+    }
+  } else {
+    it->SeekToFirst();
+  }
+
+  auto batch = std::make_unique<leveldb::WriteBatch>();
+  auto count = 0u;
+
+  for (; it->Valid(); it->Next()) {
+    const auto key = it->key().ToString();
+    if (IsInternalKey(key)) {
+      continue;
+    }
+
+    // The expiry key sorts after its value key, so it is not needed anymore
+    if (IsExpiryKey(key)) {
+      batch->Delete(key);
+    } else {
+      batch->Put(key, CacheRecord::Encode(it->value(),
+                                          GetLegacyExpiry(key, *mutable_cache_),
+                                          with_checksum));
+      ++count;
+    }
+
+    if (batch->ApproximateSize() >= kUpgradeBatchSize) {
+      batch->Put(kFormatUpgradeKey, key);
+      if (!mutable_cache_->ApplyBatch(std::move(batch)).IsSuccessful()) {
+        return false;
+      }
+      batch = std::make_unique<leveldb::WriteBatch>();
+    }
+  }
+
+  if (!it->status().ok()) {
+    OLP_SDK_LOG_WARNING_F(kLogTag, "Upgrade iteration failed, error=%s",
+                          it->status().ToString().c_str());
+    return false;
+  }
+
+  batch->Delete(kFormatUpgradeKey);
+  batch->Put(kFormatVersionKey, kInlineExpiryFormat);
+  if (!mutable_cache_->ApplyBatch(std::move(batch)).IsSuccessful()) {
+    return false;
+  }
+
+  mutable_cache_inline_expiry_ = true;
+
+  OLP_SDK_LOG_INFO_F(kLogTag,
+                     "Mutable cache upgraded, items=%u, time=%" PRId64 " ms",
+                     count, GetElapsedTime(start));
+  return true;
 }
 
 bool DefaultCacheImpl::Protect(const DefaultCache::KeyListType& keys) {
-  std::lock_guard<std::mutex> lock(cache_lock_);
+  auto lock = LockExclusive();
   if (!mutable_cache_) {
     return false;
   }
+  CompleteLruScan();
   auto start = std::chrono::steady_clock::now();
   auto result = protected_keys_.Protect(keys, [&](const std::string& key) {
     if (!RemoveKeyLru(key)) {
@@ -1005,10 +2406,11 @@ bool DefaultCacheImpl::Protect(const DefaultCache::KeyListType& keys) {
 }
 
 bool DefaultCacheImpl::Release(const DefaultCache::KeyListType& keys) {
-  std::lock_guard<std::mutex> lock(cache_lock_);
+  auto lock = LockExclusive();
   if (!mutable_cache_) {
     return false;
   }
+  CompleteLruScan();
   auto start = std::chrono::steady_clock::now();
   auto result = protected_keys_.Release(keys);
 
@@ -1022,14 +2424,14 @@ bool DefaultCacheImpl::Release(const DefaultCache::KeyListType& keys) {
         memory_cache_->RemoveKeysWithPrefix(key);
       }
     }
-    if (mutable_cache_) {
+    if (mutable_cache_lru_) {
       auto it = mutable_cache_->NewIterator(leveldb::ReadOptions());
       it->Seek(key);
       while (it->Valid()) {
         auto cached_key = it->key().ToString();
         if (cached_key.size() >= key.size() &&
             std::equal(key.begin(), key.end(), cached_key.begin())) {
-          AddKeyLru(cached_key, it->value());
+          AddKeyLru(cached_key, it->value(), *mutable_cache_lru_);
         } else {
           break;
         }
@@ -1048,7 +2450,7 @@ bool DefaultCacheImpl::Release(const DefaultCache::KeyListType& keys) {
 }
 
 bool DefaultCacheImpl::IsProtected(const std::string& key) const {
-  std::lock_guard<std::mutex> lock(cache_lock_);
+  auto lock = LockShared();
   return protected_keys_.IsProtected(key);
 }
 
@@ -1061,20 +2463,111 @@ time_t DefaultCacheImpl::GetExpiryForMemoryCache(const std::string& key,
   return expiry;
 }
 
+DefaultCacheImpl::ReadLock DefaultCacheImpl::LockShared() const {
+  // Only the contended case is timed, the clock is not read otherwise.
+  ReadLock lock(cache_lock_, std::try_to_lock);
+  if (!lock) {
+    const auto start = std::chrono::steady_clock::now();
+    lock.lock();
+    Increment(statistics_.lock_wait_time_us, GetElapsedMicroseconds(start));
+  }
+  return lock;
+}
+
+DefaultCacheImpl::WriteLock DefaultCacheImpl::LockExclusive() const {
+  WriteLock lock(cache_lock_, std::try_to_lock);
+  if (!lock) {
+    const auto start = std::chrono::steady_clock::now();
+    lock.lock();
+    Increment(statistics_.lock_wait_time_us, GetElapsedMicroseconds(start));
+  }
+  return lock;
+}
+
+void DefaultCacheImpl::CompactMutableCache() {
+  const auto start = std::chrono::steady_clock::now();
+  if (mutable_cache_->Compact()) {
+    Increment(statistics_.compactions);
+    Increment(statistics_.compaction_time_us, GetElapsedMicroseconds(start));
+  }
+}
+
+std::mutex& DefaultCacheImpl::GetKeyLock(const std::string& key) const {
+  return key_locks_[std::hash<std::string>{}(key) % key_locks_.size()];
+}
+
 void DefaultCacheImpl::SetEvictionPortion(uint64_t size) {
   eviction_portion_ = size;
 }
 
+void DefaultCacheImpl::SetLruScanThreshold(uint64_t size) {
+  lru_scan_threshold_ = size;
+}
+
+void DefaultCacheImpl::SetLruSnapshotMutations(uint64_t count) {
+  lru_snapshot_mutations_ = count;
+}
+
+bool DefaultCacheImpl::IsLruScanInProgress() const {
+  std::lock_guard<std::mutex> lru_lock(lru_lock_);
+  return lru_scan_cache_ != nullptr;
+}
+
+void DefaultCacheImpl::WaitForEviction() {
+  std::unique_lock<std::mutex> lru_lock(lru_lock_);
+  eviction_cv_.wait(lru_lock, [this]() {
+    return !eviction_requested_ && !value_log_collection_requested_ &&
+           !eviction_running_;
+  });
+}
+
+DefaultCache::EvictionStatistics DefaultCacheImpl::GetEvictionStatistics()
+    const {
+  DefaultCache::EvictionStatistics statistics;
+  statistics.runs = eviction_runs_;
+  statistics.evicted_count = evicted_count_;
+  statistics.evicted_bytes = evicted_bytes_;
+  statistics.time = std::chrono::microseconds(eviction_time_us_);
+  return statistics;
+}
+
+DefaultCache::Statistics DefaultCacheImpl::GetStatistics() const {
+  DefaultCache::Statistics statistics;
+  statistics.memory.hits = statistics_.memory_hits;
+  statistics.memory.misses = statistics_.memory_misses;
+  statistics.mutable_cache.hits = statistics_.mutable_cache_hits;
+  statistics.mutable_cache.misses = statistics_.mutable_cache_misses;
+  statistics.protected_cache.hits = statistics_.protected_cache_hits;
+  statistics.protected_cache.misses = statistics_.protected_cache_misses;
+  statistics.bytes_read = statistics_.bytes_read;
+  statistics.bytes_written = statistics_.bytes_written;
+  statistics.eviction = GetEvictionStatistics();
+  statistics.lock_wait_time =
+      std::chrono::microseconds(statistics_.lock_wait_time_us);
+  statistics.compactions = statistics_.compactions;
+  statistics.compaction_time =
+      std::chrono::microseconds(statistics_.compaction_time_us);
+
+  // Not counted as the lock wait of the cache operations.
+  ReadLock lock(cache_lock_);
+  if (mutable_cache_) {
+    statistics.storage_statistics = mutable_cache_->GetCompactionStats();
+  }
+  return statistics;
+}
+
 uint64_t DefaultCacheImpl::Size(CacheType type) const {
   if (type == CacheType::kMutable) {
-    return mutable_cache_data_size_;
+    // Changed by the eviction thread as well.
+    std::lock_guard<std::mutex> lru_lock(lru_lock_);
+    return GetMutableCacheSize();
   }
 
   return protected_cache_ ? protected_cache_->Size() : 0;
 }
 
 uint64_t DefaultCacheImpl::Size(uint64_t new_size) {
-  std::lock_guard<std::mutex> lock(cache_lock_);
+  auto lock = LockExclusive();
 
   if (!is_open_ || !mutable_cache_ || !mutable_cache_lru_) {
     return 0u;
@@ -1086,12 +2579,14 @@ uint64_t DefaultCacheImpl::Size(uint64_t new_size) {
     return 0u;
   }
 
+  CompleteLruScan();
+
   settings_.max_disk_storage = new_size;
 
   const auto evicted = MaybeEvictData();
 
   mutable_cache_data_size_ -= evicted;
-  mutable_cache_->Compact();
+  CompactMutableCache();
   return evicted;
 }
 
@@ -21,13 +21,25 @@
 
 #include "olp/core/cache/DefaultCache.h"
 
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <functional>
 #include <memory>
+#include <mutex>
 #include <string>
+#include <thread>
 #include <utility>
+#include <vector>
+
+#include "olp/core/porting/shared_mutex.h"
+#include "olp/core/utils/HashedLruCache.h"
 
 #include "DiskCache.h"
 #include "InMemoryCache.h"
 #include "ProtectedKeyList.h"
+#include "ValueLog.h"
 
 namespace olp {
 namespace cache {
@@ -54,15 +66,24 @@ class DefaultCacheImpl {
   bool Put(const std::string& key, const boost::any& value,
            const Encoder& encoder, time_t expiry);
 
+  bool PutBatch(const KeyValueCache::BatchItemListType& items);
+
   boost::any Get(const std::string& key, const Decoder& decoder);
 
   DefaultCache::ValueTypePtr Get(const std::string& key);
 
+  std::vector<boost::any> GetBatch(const KeyValueCache::KeyListType& keys,
+                                   const Decoder& decoder);
+
+  std::vector<KeyValueCache::ValueTypePtr> GetBatch(
+      const KeyValueCache::KeyListType& keys);
+
   bool Remove(const std::string& key);
 
   bool RemoveKeysWithPrefix(const std::string& key);
 
   bool Contains(const std::string& key) const;
+  std::vector<bool> ContainsBatch(const KeyValueCache::KeyListType& keys) const;
   bool Protect(const DefaultCache::KeyListType& keys);
   bool Release(const DefaultCache::KeyListType& keys);
   bool IsProtected(const std::string& key) const;
@@ -70,6 +91,10 @@ class DefaultCacheImpl {
   uint64_t Size(DefaultCache::CacheType type) const;
   uint64_t Size(uint64_t new_size);
 
+  DefaultCache::EvictionStatistics GetEvictionStatistics() const;
+
+  DefaultCache::Statistics GetStatistics() const;
+
  protected:
   /// The LRU value property.
   struct ValueProperties {
@@ -79,7 +104,7 @@ class DefaultCacheImpl {
 
   /// The LRU cache definition using the leveldb keys as key and the value size
   /// as value.
-  using DiskLruCache = utils::LruCache<std::string, ValueProperties>;
+  using DiskLruCache = utils::HashedLruCache<std::string, ValueProperties>;
 
   /// Returns LRU mutable cache, used for tests.
   const std::unique_ptr<DiskLruCache>& GetMutableCacheLru() const {
@@ -101,13 +126,32 @@ class DefaultCacheImpl {
     return memory_cache_;
   }
 
-  /// Gets expiry key, used for tests.
-  std::string GetExpiryKey(const std::string& key) const;
-
   /// Sets eviction portion, used for tests.
   void SetEvictionPortion(uint64_t size);
 
+  /// Sets the mutable cache size from which the LRU is built in the
+  /// background, used for tests.
+  void SetLruScanThreshold(uint64_t size);
+
+  /// Returns true while the LRU is built in the background, used for tests.
+  bool IsLruScanInProgress() const;
+
+  /// Sets the number of mutations after which the LRU snapshot is saved,
+  /// used for tests.
+  void SetLruSnapshotMutations(uint64_t count);
+
+  /// Waits until the requested background eviction is finished, used for
+  /// tests.
+  void WaitForEviction();
+
  private:
+  using SharedMutex = std::shared_mutex;
+  using ReadLock = std::shared_lock<SharedMutex>;
+  using WriteLock = std::unique_lock<SharedMutex>;
+
+  /// Number of stripes used to serialize operations on the same key.
+  static constexpr size_t kKeyLockCount = 64u;
+
   /// Represents intermediate eviction result.
   struct EvictionResult {
     /// Number of evicted elements.
@@ -116,12 +160,117 @@ class DefaultCacheImpl {
     uint64_t size;
   };
 
-  /// Add single key to LRU.
-  bool AddKeyLru(std::string key, const leveldb::Slice& value);
+  /// The disk cache iterators shared by the lookups of one operation, so all
+  /// of them read from the same LevelDB snapshot. Created on first use.
+  struct DiskIterators {
+    std::unique_ptr<leveldb::Iterator> mutable_cache;
+    std::unique_ptr<leveldb::Iterator> protected_cache;
+    /// The `mutable_cache_generation_` the `mutable_cache` snapshot is from.
+    uint64_t mutable_cache_generation{0u};
+    /// Holds the last value read from a value log.
+    std::string value_log_buffer;
+    /// Set by `Get(key)`, which reads the value log values into
+    /// `value_buffer` instead, and returns that buffer without a copy.
+    bool use_value_buffer{false};
+    KeyValueCache::ValueTypePtr value_buffer;
+    /// Set by the single key lookups, which read the record with
+    /// `leveldb::DB::Get` instead of creating an iterator for one seek.
+    bool single_key{false};
+    /// Holds the last record read with `leveldb::DB::Get`.
+    std::string record_buffer;
+  };
+
+  /// The counters of `DefaultCache::Statistics`, updated with relaxed atomic
+  /// increments.
+  struct StatisticsCounters {
+    std::atomic<uint64_t> memory_hits{0u};
+    std::atomic<uint64_t> memory_misses{0u};
+    std::atomic<uint64_t> mutable_cache_hits{0u};
+    std::atomic<uint64_t> mutable_cache_misses{0u};
+    std::atomic<uint64_t> protected_cache_hits{0u};
+    std::atomic<uint64_t> protected_cache_misses{0u};
+    std::atomic<uint64_t> bytes_read{0u};
+    std::atomic<uint64_t> bytes_written{0u};
+    std::atomic<uint64_t> lock_wait_time_us{0u};
+    std::atomic<uint64_t> compactions{0u};
+    std::atomic<uint64_t> compaction_time_us{0u};
+  };
+
+  /// The key and the LRU properties of a value written to the mutable cache.
+  struct LruEntry {
+    const std::string& key;
+    ValueProperties properties;
+    /// The value log location of the value, the segment is 0 if the value is
+    /// stored inline.
+    ValueLog::Location location;
+  };
+
+  /// Called for every value found by `GetBatchFromDisk`. The value is only
+  /// valid during the call.
+  using DiskValueCallback = std::function<void(
+      size_t index, const leveldb::Slice& value, time_t expiry)>;
 
-  /// Initializes LRU mutable cache if possible.
+  /// Add single key to the given LRU.
+  bool AddKeyLru(std::string key, const leveldb::Slice& value,
+                 DiskLruCache& lru);
+
+  /// Initializes LRU mutable cache if possible. The LRU is loaded from the
+  /// snapshot written on close, or rebuilt from the mutable cache. Large caches
+  /// are scanned in the background.
   void InitializeLru();
 
+  /// Loads the LRU and the data size from the snapshot, if it matches the
+  /// mutable cache.
+  bool LoadLruSnapshot();
+
+  /// Removes the LRU snapshot and its marker. Called on every read-write open,
+  /// as the first write outdates the snapshot. Returns false if the marker
+  /// could not be removed.
+  bool InvalidateLruSnapshot();
+
+  /// Writes the LRU snapshot, loaded on the next open. Called on a clean
+  /// close, and by the eviction thread with `lru_lock_` held. The first write
+  /// after it drops the snapshot marker.
+  void SaveLruSnapshot();
+
+  /// Whether the LRU is complete and can be saved.
+  bool CanSaveLruSnapshot() const;
+
+  /// Whether the LRU changed `lru_snapshot_mutations_` times, or
+  /// `kLruSnapshotInterval` passed since the first unsaved change. Called with
+  /// `lru_lock_` held.
+  bool IsLruSnapshotDue() const;
+
+  /// Wakes up the eviction thread to save the LRU snapshot later, if the LRU
+  /// has unsaved changes. Called with `lru_lock_` held after a write.
+  void ScheduleLruSnapshot();
+
+  /// Saves the LRU snapshot if it is due. Called by the eviction thread with
+  /// `cache_lock_` held in shared mode.
+  void MaybeSaveLruSnapshot();
+
+  /// Adds the next `max_count` keys of the mutable cache to the scanned LRU.
+  /// When the whole cache is scanned, merges the scanned LRU with the LRU and
+  /// returns false.
+  bool ScanLruPortion(size_t max_count);
+
+  /// Starts the thread which scans the mutable cache in portions.
+  void StartLruScan();
+
+  /// Stops the scan thread, the LRU stays incomplete. Called with `cache_lock_`
+  /// held exclusively.
+  void StopLruScan();
+
+  /// Scans the rest of the mutable cache on the calling thread, for the
+  /// operations which need the complete LRU. Called with `cache_lock_` held
+  /// exclusively.
+  void CompleteLruScan();
+
+  /// Returns true if the value of the key is accounted in the mutable cache
+  /// size. While the LRU is built, the scan accounts the keys it has not
+  /// reached yet.
+  bool IsAccountedInSize(const std::string& key) const;
+
   /// Removes key from the mutable lru cache;
   bool RemoveKeyLru(const std::string& key);
 
@@ -132,9 +281,47 @@ class DefaultCacheImpl {
   /// otherwise.
   bool PromoteKeyLru(const std::string& key);
 
-  /// Returns evicted data size.
+  /// Promotes the key in the LRU. When the LRU is locked by someone else, the
+  /// key is queued and promoted by the next caller that gets the LRU, so the
+  /// readers never wait for the writers.
+  void MaybePromoteKeyLru(const std::string& key);
+
+  /// Promotes the queued keys. Called with `lru_lock_` held.
+  void ApplyPendingPromotions();
+
+  /// Evicts the data on the calling thread, if the mutable cache is filled up
+  /// to the high watermark. Returns evicted data size, the caller updates the
+  /// mutable cache size.
   uint64_t MaybeEvictData();
 
+  /// Requests the eviction from the eviction thread. Called with `lru_lock_`
+  /// held.
+  void RequestEviction();
+
+  /// Wakes up the eviction thread, starts it on first use. Called with
+  /// `lru_lock_` held.
+  void WakeEvictionThread();
+
+  /// Stops the eviction thread. Called with `cache_lock_` held exclusively.
+  void StopEviction();
+
+  /// Evicts the data down to the low watermark in portions, so the writes
+  /// are not blocked for the whole eviction. Called by the eviction thread
+  /// with `cache_lock_` held in shared mode. Returns true if data was
+  /// evicted and the mutable cache needs a compaction.
+  bool EvictDataInBackground();
+
+  /// Compacts the mutable cache after an eviction. Called by the eviction
+  /// thread without `cache_lock_`, which is safe as `StopEviction` joins the
+  /// thread before the mutable cache is closed. Stops between the slices once
+  /// the eviction is stopped, so close and clear do not wait for it.
+  void CompactInBackground();
+
+  /// Adds the eviction run to the statistics.
+  void UpdateEvictionStatistics(
+      unsigned count, uint64_t evicted,
+      std::chrono::steady_clock::time_point start);
+
   /// Returns number of evicted elements, evicted data size and a flag indicatin
   /// if eviction limit reached. If the flag is true, another
   /// EvictExpiredDataPortion call is needed to continue eviction.
@@ -155,32 +342,164 @@ class DefaultCacheImpl {
   bool PutMutableCache(const std::string& key, const leveldb::Slice& value,
                        time_t expiry);
 
+  /// Adds the value to the batch, returns the LRU entry of the value. A large
+  /// value is appended to the value log, which keeps it until
+  /// `CommitValueLogEntries` is called after the batch is written.
+  LruEntry AddRecord(leveldb::WriteBatch& batch, const std::string& key,
+                     const leveldb::Slice& value, time_t expiry) const;
+
+  /// Commits the value log values of the entries, so the segments they were
+  /// appended to can be collected.
+  void CommitValueLogEntries(const std::vector<LruEntry>& entries) const;
+
+  /// Evicts data if needed, writes the batch to the mutable cache and adds the
+  /// entries to the LRU.
+  bool ApplyMutableCacheBatch(std::unique_ptr<leveldb::WriteBatch> batch,
+                              const std::vector<LruEntry>& entries);
+
   DefaultCache::StorageOpenResult SetupStorage();
 
   DefaultCache::StorageOpenResult SetupProtectedCache();
 
   DefaultCache::StorageOpenResult SetupMutableCache();
 
+  /// Converts the values of the mutable cache to the `CacheRecord` format and
+  /// removes the separate expiry keys. Returns false if the conversion failed.
+  bool UpgradeMutableCache();
+
+  /// Reads the value and the absolute expiry of the key from the disk cache.
+  /// The value is not read if `value` is null. It points into the block pinned
+  /// by the `iterators`, or into one of their buffers, and stays valid until
+  /// the next read. Returns false if the key is not found or the record is
+  /// malformed.
+  bool ReadDiskRecord(DefaultCache::CacheType type, const std::string& key,
+                      DiskIterators& iterators, leveldb::Slice* value,
+                      time_t& expiry) const;
+
+  /// Opens the value log of the cache, returns null if the cache has none and
+  /// large values are not enabled.
+  std::unique_ptr<ValueLog> OpenValueLog(const std::string& cache_path,
+                                         bool read_only) const;
+
+  /// Moves the values which are still used out of the value log segments and
+  /// removes the segments. Collects the oldest segments up to the first one
+  /// which is still used, and the ones with enough released values. Only the
+  /// latter if `released_only` is true.
+  void CollectValueLogGarbage(bool released_only);
+
+  /// Releases the removed or overwritten value log value, and requests the
+  /// collection of its segment once enough of it is released. Called with
+  /// `lru_lock_` held.
+  void ReleaseValueLogValue(const ValueLog::Location& location);
+
+  /// Returns the data size of the mutable cache, including the released
+  /// values which are still in the value log. Called with `lru_lock_` held.
+  uint64_t GetMutableCacheSize() const;
+
+  /// Returns the mutable cache iterator, resets it if the mutable cache was
+  /// changed after the iterator snapshot was taken.
+  std::unique_ptr<leveldb::Iterator>& GetMutableCacheIterator(
+      DiskIterators& iterators) const;
+
   void DestroyCache(DefaultCache::CacheType type);
 
-  bool GetFromDiskCache(const std::string& key,
-                        KeyValueCache::ValueTypePtr& value, time_t& expiry);
+  /// Looks up the key in the protected and the mutable cache. The value is
+  /// pinned by `iterators`, so the caller copies it before the next lookup.
+  bool GetFromDiskCache(const std::string& key, leveldb::Slice& value,
+                        time_t& expiry, DiskIterators& iterators);
 
-  boost::optional<std::pair<std::string, time_t>> GetFromDiscCache(
-      const std::string& key);
+  /// Returns the value read by `GetFromDiskCache`. Moves it out of the buffer
+  /// of `iterators` which holds it, copies it otherwise.
+  static std::string TakeDiskValue(const leveldb::Slice& value,
+                                   DiskIterators& iterators);
+
+  /// Reads the keys with the given indices from the disk cache, in the key
+  /// order. The callback is called with the key lock held.
+  void GetBatchFromDisk(const KeyValueCache::KeyListType& keys,
+                        std::vector<size_t> indices,
+                        const DiskValueCallback& callback);
+
+  bool ContainsKey(const std::string& key, DiskIterators& iterators) const;
 
   time_t GetExpiryForMemoryCache(const std::string& key, const time_t& expiry) const;
 
+  /// Locks `cache_lock_` in shared mode, accounts the time spent waiting.
+  ReadLock LockShared() const;
+
+  /// Locks `cache_lock_` exclusively, accounts the time spent waiting.
+  WriteLock LockExclusive() const;
+
+  /// Compacts the mutable cache, accounts the compaction.
+  void CompactMutableCache();
+
+  /// Returns the stripe mutex which serializes operations on the key.
+  std::mutex& GetKeyLock(const std::string& key) const;
+
   CacheSettings settings_;
   bool is_open_;
   std::unique_ptr<InMemoryCache> memory_cache_;
   std::unique_ptr<DiskCache> mutable_cache_;
   std::unique_ptr<DiskLruCache> mutable_cache_lru_;
+  /// The entries found by the LRU scan, older than any entry used since the
+  /// cache was opened. Not null while the scan is in progress.
+  std::unique_ptr<DiskLruCache> lru_scan_cache_;
+  /// The last key the LRU scan has reached.
+  std::string lru_scan_position_;
+  std::chrono::steady_clock::time_point lru_scan_start_;
+  uint64_t lru_scan_threshold_;
+  std::thread lru_scan_thread_;
+  std::atomic<bool> stop_lru_scan_;
   std::unique_ptr<DiskCache> protected_cache_;
+  /// The large values of the mutable cache, see
+  /// `CacheSettings::large_value_threshold`.
+  std::unique_ptr<ValueLog> mutable_value_log_;
+  std::unique_ptr<ValueLog> protected_value_log_;
   uint64_t mutable_cache_data_size_;
   ProtectedKeyList protected_keys_;
-  mutable std::mutex cache_lock_;
   uint64_t eviction_portion_;
+  std::thread eviction_thread_;
+  /// Wakes up the eviction thread, and the ones waiting for the eviction.
+  std::condition_variable eviction_cv_;
+  /// Set by the writes which fill the mutable cache up to the high watermark,
+  /// reset by the eviction thread when it starts the eviction.
+  bool eviction_requested_;
+  /// Set when a value log segment has enough released values to be collected.
+  bool value_log_collection_requested_;
+  bool eviction_running_;
+  bool stop_eviction_;
+  std::atomic<uint64_t> eviction_runs_;
+  std::atomic<uint64_t> evicted_count_;
+  std::atomic<uint64_t> evicted_bytes_;
+  std::atomic<uint64_t> eviction_time_us_;
+  mutable StatisticsCounters statistics_;
+  /// True if the values of the mutable cache are stored as `CacheRecord`s,
+  /// false if the cache still has the separate expiry keys.
+  bool mutable_cache_inline_expiry_;
+  /// Same as `mutable_cache_inline_expiry_` for the protected cache.
+  bool protected_cache_inline_expiry_;
+  /// Incremented on every write to the mutable cache, tells the batch lookups
+  /// that their snapshot is outdated.
+  std::atomic<uint64_t> mutable_cache_generation_;
+  /// The `mutable_cache_generation_` of the last saved LRU snapshot, or of the
+  /// open. Guarded by `lru_lock_`, like the rest of the snapshot state.
+  uint64_t lru_snapshot_generation_;
+  /// When the first change after the last saved LRU snapshot was scheduled.
+  std::chrono::steady_clock::time_point lru_snapshot_scheduled_time_;
+  bool lru_snapshot_scheduled_;
+  uint64_t lru_snapshot_mutations_;
+
+  /// Guards the storage state. Key-value operations take it shared, while
+  /// open, close, clear, protect and release take it exclusively.
+  mutable SharedMutex cache_lock_;
+  /// Key-hash striped locks, keep the memory and the disk cache consistent
+  /// when the same key is written or read from disk concurrently.
+  mutable std::array<std::mutex, kKeyLockCount> key_locks_;
+  /// Guards the LRU, the LRU scan, the mutable cache size and the eviction
+  /// state when `cache_lock_` is held in shared mode.
+  mutable std::mutex lru_lock_;
+  /// The keys which found the LRU busy, guarded by `pending_promotions_lock_`.
+  std::vector<std::string> pending_promotions_;
+  std::mutex pending_promotions_lock_;
 };
 
 }  // namespace cache
@@ -172,20 +172,91 @@ bool DiskCache::Clear() {
   return true;
 }
 
-void DiskCache::Compact() {
+bool DiskCache::Compact() {
   // Lets make sure that the parallel thread which is running the compact is not
   // doing it already. We don't need two at the same time.
-  if (database_ && !compacting_.exchange(true)) {
-    OLP_SDK_LOG_INFO(kLogTag, "Compact: Compacting database started");
+  if (!database_ || compacting_.exchange(true)) {
+    return false;
+  }
+
+  OLP_SDK_LOG_INFO(kLogTag, "Compact: Compacting database started");
+
+  do {
+    database_->CompactRange(nullptr, nullptr);
+  } while (!CheckCompactionFinished(*database_));
+
+  compacting_ = false;
+
+  OLP_SDK_LOG_INFO(kLogTag, "Compact: Compacting database finished");
+  return true;
+}
+
+bool DiskCache::Compact(size_t slice_keys,
+                        const std::function<bool()>& cancelled) {
+  if (!database_ || compacting_.exchange(true)) {
+    return false;
+  }
+
+  OLP_SDK_LOG_INFO(kLogTag, "Compact: Compacting database in slices started");
+
+  std::string begin;
+  bool first = true;
+  bool completed = true;
+  while (true) {
+    if (cancelled()) {
+      completed = false;
+      break;
+    }
+
+    // The iterator is not kept over the compaction, it would pin the files
+    // which are replaced.
+    std::string end;
+    bool last = false;
+    {
+      leveldb::ReadOptions options;
+      options.fill_cache = false;
+      auto iterator = NewIterator(options);
+      if (first) {
+        iterator->SeekToFirst();
+      } else {
+        iterator->Seek(begin);
+      }
+      for (size_t count = 0u; count < slice_keys && iterator->Valid();
+           ++count) {
+        iterator->Next();
+      }
+
+      last = !iterator->Valid();
+      if (!last) {
+        end = iterator->key().ToString();
+      }
+    }
+
+    const leveldb::Slice begin_slice(begin);
+    const leveldb::Slice end_slice(end);
+    database_->CompactRange(first ? nullptr : &begin_slice,
+                            last ? nullptr : &end_slice);
+    if (last) {
+      break;
+    }
+
+    begin = std::move(end);
+    first = false;
+  }
 
-    do {
-      database_->CompactRange(nullptr, nullptr);
-    } while (!CheckCompactionFinished(*database_));
+  compacting_ = false;
 
-    compacting_ = false;
+  OLP_SDK_LOG_INFO_F(kLogTag, "Compact: Compacting database %s",
+                     completed ? "finished" : "cancelled");
+  return completed;
+}
 
-    OLP_SDK_LOG_INFO(kLogTag, "Compact: Compacting database finished");
+std::string DiskCache::GetCompactionStats() const {
+  std::string stats;
+  if (database_) {
+    database_->GetProperty("leveldb.stats", &stats);
   }
+  return stats;
 }
 
 OpenResult DiskCache::Open(const std::string& data_path,
@@ -201,6 +272,7 @@ OpenResult DiskCache::Open(const std::string& data_path,
   }
 
   enforce_immediate_flush_ = settings.enforce_immediate_flush;
+  value_size_ = settings.value_size;
 
   max_size_ = settings.max_disk_storage;
   auto open_options = CreateOpenOptions(settings, is_read_only);
@@ -293,7 +365,14 @@ bool DiskCache::Put(const std::string& key, leveldb::Slice slice) {
   leveldb::WriteOptions write_options;
   write_options.sync = enforce_immediate_flush_;
 
-  const auto status = database_->Put(write_options, ToLeveldbSlice(key), slice);
+  leveldb::Status status;
+  leveldb::WriteBatch batch;
+  if (TakePendingDelete(batch)) {
+    batch.Put(ToLeveldbSlice(key), slice);
+    status = database_->Write(write_options, &batch);
+  } else {
+    status = database_->Put(write_options, ToLeveldbSlice(key), slice);
+  }
   if (!status.ok()) {
     OLP_SDK_LOG_ERROR(kLogTag, "Put: failed, status=" << status.ToString());
     return false;
@@ -363,13 +442,20 @@ bool DiskCache::Remove(const std::string& key, uint64_t& removed_data_size) {
   auto it = NewIterator({});
   it->Seek(key);
   if (it->Valid() && it->key() == key) {
-    data_size = key.size() + it->value().size();
+    data_size = key.size() + GetValueSize(it->value());
   }
 
   leveldb::WriteOptions write_options;
   write_options.sync = enforce_immediate_flush_;
 
-  auto result = database_->Delete(write_options, key).ok();
+  leveldb::WriteBatch batch;
+  bool result = false;
+  if (TakePendingDelete(batch)) {
+    batch.Delete(key);
+    result = database_->Write(write_options, &batch).ok();
+  } else {
+    result = database_->Delete(write_options, key).ok();
+  }
   if (result) {
     removed_data_size = data_size;
   }
@@ -416,6 +502,8 @@ DiskCache::OperationOutcome DiskCache::ApplyBatch(
     }
   }
 
+  TakePendingDelete(*batch);
+
   leveldb::WriteOptions write_options;
   write_options.sync = enforce_immediate_flush_;
 
@@ -468,7 +556,7 @@ bool DiskCache::RemoveKeysWithPrefix(const std::string& prefix,
     }
 
     batch->Delete(key);
-    data_size += iterator->value().size() + key.size();
+    data_size += GetValueSize(iterator->value()) + key.size();
   }
 
   auto result = ApplyBatch(std::move(batch));
@@ -480,6 +568,25 @@ bool DiskCache::RemoveKeysWithPrefix(const std::string& prefix,
   return result.IsSuccessful();
 }
 
+void DiskCache::DeleteWithNextWrite(std::string key) {
+  std::lock_guard<std::mutex> lock(pending_delete_mutex_);
+  pending_delete_ = std::move(key);
+  has_pending_delete_ = true;
+}
+
+bool DiskCache::TakePendingDelete(leveldb::WriteBatch& batch) {
+  if (!has_pending_delete_) {
+    return false;
+  }
+
+  std::lock_guard<std::mutex> lock(pending_delete_mutex_);
+  if (!has_pending_delete_.exchange(false)) {
+    return false;
+  }
+  batch.Delete(pending_delete_);
+  return true;
+}
+
 leveldb::Status DiskCache::InitializeDB(const StorageSettings& settings,
                                         const std::string& path) const {
   // NOTE: FilterPolicy should be deleted after DB
@@ -513,6 +620,10 @@ leveldb::Options DiskCache::CreateOpenOptions(const StorageSettings& settings,
   return options;
 }
 
+uint64_t DiskCache::GetValueSize(const leveldb::Slice& value) const {
+  return value_size_ ? value_size_(value) : value.size();
+}
+
 uint64_t DiskCache::Size() const {
   uint64_t result{0u};
   leveldb::Range range{"0", "z"};
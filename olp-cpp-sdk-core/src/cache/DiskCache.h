@@ -84,6 +84,10 @@ struct StorageSettings {
   /// Compression type to be applied on the data before storing it.
   leveldb::CompressionType compression =
       leveldb::CompressionType::kSnappyCompression;
+
+  /// Returns the data size a stored value accounts for, when it refers to data
+  /// kept outside of the database. If not set, the value size is used.
+  std::function<uint64_t(const leveldb::Slice& value)> value_size = nullptr;
 };
 
 /**
@@ -121,8 +125,22 @@ class DiskCache {
   /// method which compacts the storage. In particular, deleted and overwritten
   /// versions are discarded, and the data is rearranged to reduce the cost of
   /// operations needed to access the data. In some cases this operation might
-  /// take a very long time, so use with care.
-  void Compact();
+  /// take a very long time, so use with care. Returns false if another
+  /// compaction is running, which is not repeated then.
+  bool Compact();
+
+  /**
+   * @brief Compacts the database in slices of consecutive keys, so it can be
+   * stopped between them.
+   *
+   * @param slice_keys The number of keys compacted at once.
+   * @param cancelled Called before every slice, the compaction stops if it
+   * returns true.
+   *
+   * @return False if the compaction was cancelled, or skipped because
+   * another compaction is running.
+   */
+  bool Compact(size_t slice_keys, const std::function<bool()>& cancelled);
 
   OperationOutcome OpenError() const { return error_; }
 
@@ -153,19 +171,33 @@ class DiskCache {
   /// Check if cache contains data with the key.
   bool Contains(const std::string& key);
 
+  /// Deletes the key with the next write, so a marker which is only valid
+  /// for the current content is dropped atomically with the first change.
+  void DeleteWithNextWrite(std::string key);
+
   /// Gets size of the database: approximate for read-write, more-or-less
   /// precise for read-only
   uint64_t Size() const;
 
+  /// Returns the LevelDB compaction statistics per level.
+  std::string GetCompactionStats() const;
+
  private:
   /// Initialize empty db, so it can be used as protected cache.
   leveldb::Status InitializeDB(const StorageSettings& settings,
                                const std::string& path) const;
 
+  /// Returns the data size the stored value accounts for.
+  uint64_t GetValueSize(const leveldb::Slice& value) const;
+
   /// Create options for DB basing on settings and cache type.
   leveldb::Options CreateOpenOptions(const StorageSettings& settings,
                                      bool is_read_only) const;
 
+  /// Adds the delete requested by `DeleteWithNextWrite` to the batch. Returns
+  /// false if there is none.
+  bool TakePendingDelete(leveldb::WriteBatch& batch);
+
   const std::shared_ptr<leveldb::Env> env_;
   std::string disk_cache_path_;
   std::unique_ptr<const leveldb::FilterPolicy> filter_policy_;
@@ -180,6 +212,11 @@ class DiskCache {
   /// Used to asynchronously call database_->CompactRange().
   std::thread compaction_thread_;
   OperationOutcome error_;
+  std::function<uint64_t(const leveldb::Slice& value)> value_size_;
+  /// The key deleted with the next write, see `DeleteWithNextWrite`.
+  std::string pending_delete_;
+  std::atomic<bool> has_pending_delete_{false};
+  std::mutex pending_delete_mutex_;
 };
 
 }  // namespace cache
@@ -27,7 +27,7 @@
 #include <tuple>
 #include <vector>
 
-#include <olp/core/utils/LruCache.h>
+#include <olp/core/utils/HashedLruCache.h>
 #include <boost/any.hpp>
 
 namespace olp {
@@ -89,7 +89,7 @@ class InMemoryCache {
 
  private:
   mutable std::mutex mutex_;
-  utils::LruCache<std::string, ItemTuple, ModelCacheCostFunc> item_tuples_;
+  utils::HashedLruCache<std::string, ItemTuple, ModelCacheCostFunc> item_tuples_;
   std::map<time_t, ItemTuples> item_expiries_;
   TimeProvider time_provider_;
 };
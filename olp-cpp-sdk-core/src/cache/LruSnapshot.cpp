@@ -0,0 +1,218 @@
+/*
+ * Copyright (C) 2021 HERE Europe B.V.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ * License-Filename: LICENSE
+ */
+
+#include "LruSnapshot.h"
+
+#include <cstring>
+#include <memory>
+
+#include <boost/crc.hpp>
+#include <leveldb/env.h>
+
+#include "DiskCacheEnv.h"
+#include "olp/core/logging/Log.h"
+
+namespace olp {
+namespace cache {
+
+namespace {
+constexpr auto kLogTag = "LruSnapshot";
+constexpr auto kTemporarySuffix = ".tmp";
+constexpr uint32_t kFormatVersion = 1u;
+constexpr size_t kHeaderSize = 20u;
+constexpr size_t kEntryFixedSize = 20u;
+constexpr size_t kFooterSize = 12u;
+constexpr size_t kWriteBufferSize = 1024u * 1024u;
+
+void AppendLittleEndian(uint64_t value, size_t size, std::string& out) {
+  for (size_t i = 0u; i < size; ++i) {
+    out.push_back(static_cast<char>((value >> (8u * i)) & 0xffu));
+  }
+}
+
+uint64_t ReadLittleEndian(const char* in, size_t size) {
+  uint64_t value = 0u;
+  for (size_t i = 0u; i < size; ++i) {
+    value |= static_cast<uint64_t>(static_cast<uint8_t>(in[i])) << (8u * i);
+  }
+  return value;
+}
+
+bool ReadFile(leveldb::Env& env, const std::string& path, std::string& data) {
+  uint64_t size = 0u;
+  if (!env.GetFileSize(path, &size).ok()) {
+    return false;
+  }
+
+  leveldb::SequentialFile* file = nullptr;
+  if (!env.NewSequentialFile(path, &file).ok()) {
+    return false;
+  }
+  std::unique_ptr<leveldb::SequentialFile> file_guard(file);
+
+  data.resize(static_cast<size_t>(size));
+  size_t offset = 0u;
+  while (offset < data.size()) {
+    leveldb::Slice result;
+    if (!file->Read(data.size() - offset, &result, &data[offset]).ok() ||
+        result.empty()) {
+      return false;
+    }
+
+    if (result.data() != &data[offset]) {
+      memcpy(&data[offset], result.data(), result.size());
+    }
+    offset += result.size();
+  }
+
+  return true;
+}
+}  // namespace
+
+bool LruSnapshot::Save(const std::string& path, uint64_t id,
+                       uint64_t data_size,
+                       const NextEntryCallback& next_entry) {
+  auto env = DiskCacheEnv::CreateEnv();
+  const auto temporary_path = path + kTemporarySuffix;
+
+  leveldb::WritableFile* file = nullptr;
+  if (!env->NewWritableFile(temporary_path, &file).ok()) {
+    OLP_SDK_LOG_WARNING_F(kLogTag, "Save: failed to create file, path='%s'",
+                          temporary_path.c_str());
+    return false;
+  }
+  std::unique_ptr<leveldb::WritableFile> file_guard(file);
+
+  boost::crc_32_type crc;
+  std::string buffer;
+  buffer.reserve(kWriteBufferSize);
+
+  auto flush = [&]() {
+    crc.process_bytes(buffer.data(), buffer.size());
+    const auto status = file->Append(buffer);
+    buffer.clear();
+    return status.ok();
+  };
+
+  AppendLittleEndian(kFormatVersion, 4u, buffer);
+  AppendLittleEndian(data_size, 8u, buffer);
+  AppendLittleEndian(id, 8u, buffer);
+
+  bool written = true;
+  uint64_t count = 0u;
+  Entry entry;
+  while (written && next_entry(entry)) {
+    AppendLittleEndian(entry.key.size(), 4u, buffer);
+    buffer.append(entry.key.data(), entry.key.size());
+    AppendLittleEndian(entry.size, 8u, buffer);
+    AppendLittleEndian(static_cast<uint64_t>(entry.expiry), 8u, buffer);
+    ++count;
+
+    if (buffer.size() >= kWriteBufferSize) {
+      written = flush();
+    }
+  }
+
+  AppendLittleEndian(count, 8u, buffer);
+  written = written && flush();
+  AppendLittleEndian(crc.checksum(), 4u, buffer);
+  written = written && file->Append(buffer).ok() && file->Sync().ok();
+  written = file->Close().ok() && written;
+  file_guard.reset();
+
+  if (!written || !env->RenameFile(temporary_path, path).ok()) {
+    OLP_SDK_LOG_WARNING_F(kLogTag, "Save: failed to write file, path='%s'",
+                          path.c_str());
+    env->DeleteFile(temporary_path);
+    return false;
+  }
+
+  return true;
+}
+
+bool LruSnapshot::Load(const std::string& path, uint64_t id,
+                       uint64_t& data_size, const EntryCallback& callback) {
+  auto env = DiskCacheEnv::CreateEnv();
+
+  std::string data;
+  if (!ReadFile(*env, path, data) ||
+      data.size() < kHeaderSize + kFooterSize) {
+    return false;
+  }
+
+  const auto footer = data.data() + data.size() - kFooterSize;
+  boost::crc_32_type crc;
+  crc.process_bytes(data.data(), data.size() - 4u);
+  if (crc.checksum() != ReadLittleEndian(footer + 8u, 4u)) {
+    OLP_SDK_LOG_WARNING_F(kLogTag, "Load: checksum mismatch, path='%s'",
+                          path.c_str());
+    return false;
+  }
+
+  if (ReadLittleEndian(data.data(), 4u) != kFormatVersion ||
+      ReadLittleEndian(data.data() + 12u, 8u) != id) {
+    return false;
+  }
+
+  // Verify the entries before reporting any of them.
+  const size_t end = data.size() - kFooterSize;
+  uint64_t count = 0u;
+  size_t offset = kHeaderSize;
+  while (offset < end) {
+    if (end - offset < kEntryFixedSize) {
+      return false;
+    }
+
+    const auto key_size = ReadLittleEndian(data.data() + offset, 4u);
+    if (end - offset - kEntryFixedSize < key_size) {
+      return false;
+    }
+
+    offset += kEntryFixedSize + static_cast<size_t>(key_size);
+    ++count;
+  }
+
+  if (count != ReadLittleEndian(footer, 8u)) {
+    return false;
+  }
+
+  data_size = ReadLittleEndian(data.data() + 4u, 8u);
+
+  Entry entry;
+  for (offset = kHeaderSize; offset < end;) {
+    const auto entry_data = data.data() + offset;
+    const auto key_size = static_cast<size_t>(ReadLittleEndian(entry_data, 4u));
+    entry.key = leveldb::Slice(entry_data + 4u, key_size);
+    entry.size = ReadLittleEndian(entry_data + 4u + key_size, 8u);
+    entry.expiry = static_cast<time_t>(
+        static_cast<int64_t>(ReadLittleEndian(entry_data + 12u + key_size, 8u)));
+    callback(entry);
+    offset += kEntryFixedSize + key_size;
+  }
+
+  return true;
+}
+
+void LruSnapshot::Remove(const std::string& path) {
+  // Fails if there is no snapshot, which is fine.
+  DiskCacheEnv::CreateEnv()->DeleteFile(path);
+}
+
+}  // namespace cache
+}  // namespace olp
@@ -0,0 +1,99 @@
+/*
+ * Copyright (C) 2021 HERE Europe B.V.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ * License-Filename: LICENSE
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <ctime>
+#include <functional>
+#include <string>
+
+#include <leveldb/slice.h>
+
+namespace olp {
+namespace cache {
+
+/**
+ * @brief Persists the LRU of the mutable cache, so it does not have to be
+ * rebuilt from the whole database when the cache is opened.
+ *
+ * The snapshot is stored as:
+ *   header - format version u32, data size u64, id u64;
+ *   entries, the least recently used first - key size u32, key, value size
+ *   u64, expiry i64;
+ *   footer - entry count u64, CRC-32 of everything before it u32.
+ * All numbers are little-endian.
+ *
+ * The snapshot only matches the database it was written for, the owner
+ * stores the `id` in the database and compares it on load.
+ */
+class LruSnapshot {
+ public:
+  /// The LRU entry. The key is only valid during the callback.
+  struct Entry {
+    leveldb::Slice key;
+    uint64_t size{0u};
+    time_t expiry{0};
+  };
+
+  /// Returns the next entry to save, false when there are no more entries.
+  using NextEntryCallback = std::function<bool(Entry& entry)>;
+
+  /// Called for every loaded entry, the least recently used first.
+  using EntryCallback = std::function<void(const Entry& entry)>;
+
+  /**
+   * @brief Writes the snapshot, replaces the existing one.
+   *
+   * The snapshot is written to a temporary file first, so a failed write
+   * never leaves a partial snapshot behind.
+   *
+   * @param path The snapshot file.
+   * @param id The identifier of the snapshot.
+   * @param data_size The size of the cache data.
+   * @param next_entry Returns the entries, the least recently used first.
+   *
+   * @return False if the snapshot can't be written.
+   */
+  static bool Save(const std::string& path, uint64_t id, uint64_t data_size,
+                   const NextEntryCallback& next_entry);
+
+  /**
+   * @brief Reads the snapshot.
+   *
+   * The entries are only reported when the whole snapshot is read and
+   * verified.
+   *
+   * @param path The snapshot file.
+   * @param id The identifier the snapshot must have.
+   * @param data_size The size of the cache data.
+   * @param callback Called for every entry.
+   *
+   * @return False if the snapshot does not exist, has another identifier or
+   * is malformed.
+   */
+  static bool Load(const std::string& path, uint64_t id, uint64_t& data_size,
+                   const EntryCallback& callback);
+
+  /// Removes the snapshot file.
+  static void Remove(const std::string& path);
+};
+
+}  // namespace cache
+}  // namespace olp
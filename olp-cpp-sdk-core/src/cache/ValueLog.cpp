@@ -0,0 +1,544 @@
+/*
+ * Copyright (C) 2021 HERE Europe B.V.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ * License-Filename: LICENSE
+ */
+
+#include "ValueLog.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <utility>
+
+#include <boost/crc.hpp>
+
+#include "DiskCacheEnv.h"
+#include "olp/core/logging/Log.h"
+#include "olp/core/utils/Dir.h"
+
+namespace olp {
+namespace cache {
+
+namespace {
+constexpr auto kLogTag = "ValueLog";
+constexpr auto kSegmentSuffix = ".vlog";
+constexpr size_t kEntryHeaderSize = 8u;
+constexpr size_t kChecksumSize = 4u;
+
+void WriteLittleEndian(uint64_t value, size_t size, char* out) {
+  for (size_t i = 0u; i < size; ++i) {
+    out[i] = static_cast<char>((value >> (8u * i)) & 0xffu);
+  }
+}
+
+uint64_t ReadLittleEndian(const char* in, size_t size) {
+  uint64_t value = 0u;
+  for (size_t i = 0u; i < size; ++i) {
+    value |= static_cast<uint64_t>(static_cast<uint8_t>(in[i])) << (8u * i);
+  }
+  return value;
+}
+
+uint32_t Checksum(const char* data, size_t size) {
+  boost::crc_32_type crc;
+  crc.process_bytes(data, size);
+  return crc.checksum();
+}
+
+bool ParseSegmentName(const std::string& name, uint32_t& segment) {
+  const auto suffix_size = strlen(kSegmentSuffix);
+  if (name.size() <= suffix_size ||
+      name.compare(name.size() - suffix_size, suffix_size, kSegmentSuffix) !=
+          0) {
+    return false;
+  }
+
+  char* end = nullptr;
+  const auto number = std::strtoul(name.c_str(), &end, 10);
+  if (end != name.c_str() + name.size() - suffix_size || number == 0u ||
+      number > UINT32_MAX) {
+    return false;
+  }
+
+  segment = static_cast<uint32_t>(number);
+  return true;
+}
+}  // namespace
+
+constexpr size_t ValueLog::kLocationSize;
+
+ValueLog::ReadPin::ReadPin(const ValueLog* value_log) : value_log_(value_log) {
+  if (value_log_) {
+    std::lock_guard<std::mutex> lock(value_log_->mutex_);
+    ++value_log_->read_pins_;
+  }
+}
+
+ValueLog::ReadPin::~ReadPin() {
+  if (value_log_) {
+    std::lock_guard<std::mutex> lock(value_log_->mutex_);
+    if (--value_log_->read_pins_ == 0u) {
+      value_log_->DeleteRemovedSegments();
+    }
+  }
+}
+
+ValueLog::ValueLog(std::string path, uint64_t max_segment_size, bool sync)
+    : env_(DiskCacheEnv::CreateEnv()),
+      path_(std::move(path)),
+      max_segment_size_(max_segment_size),
+      sync_(sync) {}
+
+ValueLog::~ValueLog() { Close(); }
+
+bool ValueLog::Open(bool read_only) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  read_only_ = read_only;
+
+  if (!read_only_ && !utils::Dir::Exists(path_) &&
+      !utils::Dir::Create(path_)) {
+    OLP_SDK_LOG_ERROR_F(kLogTag, "Open: failed to create folder, path='%s'",
+                        path_.c_str());
+    return false;
+  }
+
+  std::vector<std::string> children;
+  const auto status = env_->GetChildren(path_, &children);
+  if (!status.ok()) {
+    OLP_SDK_LOG_ERROR_F(kLogTag, "Open: failed to list folder, path='%s'",
+                        path_.c_str());
+    return false;
+  }
+
+  uint32_t last_segment = 0u;
+  for (const auto& child : children) {
+    uint32_t segment = 0u;
+    if (!ParseSegmentName(child, segment)) {
+      continue;
+    }
+
+    uint64_t size = 0u;
+    if (env_->GetFileSize(GetSegmentPath(segment), &size).ok()) {
+      segments_[segment].size = size;
+      last_segment = std::max(last_segment, segment);
+    }
+  }
+
+  if (read_only_) {
+    return true;
+  }
+
+  // Never append to a segment of the previous run, its tail could be torn.
+  return StartSegment(last_segment + 1u);
+}
+
+void ValueLog::Close() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (active_file_) {
+    if (sync_ && dirty_) {
+      active_file_->Sync();
+    }
+    active_file_->Close();
+    active_file_.reset();
+
+    auto it = segments_.find(active_segment_);
+    if (it != segments_.end() && it->second.size == 0u) {
+      env_->DeleteFile(GetSegmentPath(active_segment_));
+    }
+  }
+
+  active_segment_ = 0u;
+  dirty_ = false;
+  segments_.clear();
+  DeleteRemovedSegments();
+}
+
+bool ValueLog::Append(const std::string& key, const leveldb::Slice& value,
+                      Location& location) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (read_only_ || !active_file_) {
+    return false;
+  }
+
+  auto& active = segments_[active_segment_];
+  if (active.size >= max_segment_size_) {
+    if (!StartSegment(active_segment_ + 1u)) {
+      return false;
+    }
+  }
+
+  auto& segment = segments_[active_segment_];
+
+  char header[kEntryHeaderSize];
+  WriteLittleEndian(key.size(), sizeof(uint32_t), header);
+  WriteLittleEndian(value.size(), sizeof(uint32_t), header + sizeof(uint32_t));
+
+  char checksum[kChecksumSize];
+  WriteLittleEndian(Checksum(value.data(), value.size()), kChecksumSize,
+                    checksum);
+
+  auto status = active_file_->Append(leveldb::Slice(header, sizeof(header)));
+  if (status.ok()) {
+    status = active_file_->Append(key);
+  }
+  if (status.ok()) {
+    status = active_file_->Append(value);
+  }
+  if (status.ok()) {
+    status = active_file_->Append(leveldb::Slice(checksum, sizeof(checksum)));
+  }
+  if (status.ok()) {
+    status = active_file_->Flush();
+  }
+
+  if (!status.ok()) {
+    OLP_SDK_LOG_WARNING_F(kLogTag, "Append: failed, segment=%u, error='%s'",
+                          active_segment_, status.ToString().c_str());
+    // The segment may end with a partial entry now, continue in a new one.
+    StartSegment(active_segment_ + 1u);
+    return false;
+  }
+
+  location.segment = active_segment_;
+  location.size = static_cast<uint32_t>(value.size());
+  location.offset = segment.size + kEntryHeaderSize + key.size();
+
+  segment.size += kEntryHeaderSize + key.size() + value.size() + kChecksumSize;
+  ++segment.uncommitted;
+  dirty_ = true;
+  return true;
+}
+
+void ValueLog::Commit(const Location& location) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto it = segments_.find(location.segment);
+  if (it != segments_.end() && it->second.uncommitted > 0u) {
+    --it->second.uncommitted;
+  }
+}
+
+bool ValueLog::Sync() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (!sync_ || !dirty_ || !active_file_) {
+    return true;
+  }
+
+  dirty_ = false;
+  return active_file_->Sync().ok();
+}
+
+uint64_t ValueLog::Release(const Location& location) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto it = segments_.find(location.segment);
+  if (it == segments_.end()) {
+    return 0u;
+  }
+
+  auto& segment = it->second;
+  segment.dead_size =
+      std::min<uint64_t>(segment.dead_size + location.size, segment.size);
+  return segment.dead_size;
+}
+
+void ValueLog::SetDeadSize(uint32_t segment, uint64_t size) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto it = segments_.find(segment);
+  if (it != segments_.end()) {
+    it->second.dead_size = std::min<uint64_t>(size, it->second.size);
+  }
+}
+
+uint64_t ValueLog::GetSegmentDeadSize(uint32_t segment) const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto it = segments_.find(segment);
+  return it != segments_.end() ? it->second.dead_size : 0u;
+}
+
+uint64_t ValueLog::DeadSize() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  uint64_t size = 0u;
+  for (const auto& segment : segments_) {
+    size += segment.second.dead_size;
+  }
+  return size;
+}
+
+template <typename Buffer>
+bool ValueLog::ReadValue(const Location& location, bool verify_checksum,
+                         Buffer& value) const {
+  const size_t size = location.size + kChecksumSize;
+  auto file = GetSegmentFile(location.segment, location.offset + size);
+  if (!file) {
+    return false;
+  }
+
+  value.resize(size);
+  auto* data = reinterpret_cast<char*>(&value[0]);
+
+  leveldb::Slice result;
+  const auto status = file->Read(location.offset, size, &result, data);
+  if (!status.ok() || result.size() != size) {
+    OLP_SDK_LOG_WARNING_F(kLogTag, "Read: failed, segment=%u, offset=%llu",
+                          location.segment,
+                          static_cast<unsigned long long>(location.offset));
+    return false;
+  }
+
+  if (result.data() != data) {
+    memcpy(data, result.data(), size);
+  }
+
+  if (verify_checksum &&
+      Checksum(data, location.size) !=
+          ReadLittleEndian(data + location.size, kChecksumSize)) {
+    OLP_SDK_LOG_WARNING_F(kLogTag,
+                          "Read: checksum mismatch, segment=%u, offset=%llu",
+                          location.segment,
+                          static_cast<unsigned long long>(location.offset));
+    return false;
+  }
+
+  value.resize(location.size);
+  return true;
+}
+
+bool ValueLog::Read(const Location& location, bool verify_checksum,
+                    std::string& value) const {
+  return ReadValue(location, verify_checksum, value);
+}
+
+bool ValueLog::Read(const Location& location, bool verify_checksum,
+                    std::vector<unsigned char>& value) const {
+  return ReadValue(location, verify_checksum, value);
+}
+
+std::vector<uint32_t> ValueLog::GetSealedSegments() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  std::vector<uint32_t> result;
+  result.reserve(segments_.size());
+  for (const auto& segment : segments_) {
+    if (segment.first != active_segment_ && segment.second.uncommitted == 0u) {
+      result.push_back(segment.first);
+    }
+  }
+  return result;
+}
+
+uint64_t ValueLog::GetSegmentSize(uint32_t segment) const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto it = segments_.find(segment);
+  return it != segments_.end() ? it->second.size : 0u;
+}
+
+uint64_t ValueLog::Size() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  uint64_t size = 0u;
+  for (const auto& segment : segments_) {
+    size += segment.second.size;
+  }
+  return size;
+}
+
+bool ValueLog::ForEachEntry(uint32_t segment,
+                            const EntryCallback& callback) const {
+  const auto segment_size = GetSegmentSize(segment);
+
+  leveldb::SequentialFile* raw_file = nullptr;
+  const auto status =
+      env_->NewSequentialFile(GetSegmentPath(segment), &raw_file);
+  if (!status.ok()) {
+    OLP_SDK_LOG_WARNING_F(kLogTag, "ForEachEntry: failed to open segment=%u",
+                          segment);
+    return false;
+  }
+  std::unique_ptr<leveldb::SequentialFile> file(raw_file);
+
+  char header[kEntryHeaderSize];
+  std::string key;
+  uint64_t offset = 0u;
+
+  while (offset + kEntryHeaderSize <= segment_size) {
+    leveldb::Slice result;
+    if (!file->Read(kEntryHeaderSize, &result, header).ok() ||
+        result.size() != kEntryHeaderSize) {
+      break;
+    }
+
+    const auto key_size = ReadLittleEndian(result.data(), sizeof(uint32_t));
+    const auto value_size =
+        ReadLittleEndian(result.data() + sizeof(uint32_t), sizeof(uint32_t));
+    const auto entry_size =
+        kEntryHeaderSize + key_size + value_size + kChecksumSize;
+
+    // The tail of the segment could be torn by a crash.
+    if (offset + entry_size > segment_size) {
+      break;
+    }
+
+    key.resize(key_size);
+    if (key_size > 0u &&
+        (!file->Read(key_size, &result, &key[0]).ok() ||
+         result.size() != key_size)) {
+      break;
+    }
+    if (result.data() != key.data()) {
+      key.assign(result.data(), result.size());
+    }
+
+    if (!file->Skip(value_size + kChecksumSize).ok()) {
+      break;
+    }
+
+    Location location;
+    location.segment = segment;
+    location.size = static_cast<uint32_t>(value_size);
+    location.offset = offset + kEntryHeaderSize + key_size;
+    callback(key, location);
+
+    offset += entry_size;
+  }
+
+  return true;
+}
+
+bool ValueLog::RemoveSegment(uint32_t segment) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto it = segments_.find(segment);
+  if (read_only_ || segment == active_segment_ ||
+      (it != segments_.end() && it->second.uncommitted > 0u)) {
+    return false;
+  }
+
+  // The pinned readers could still read the values of the segment.
+  if (read_pins_ > 0u && it != segments_.end()) {
+    removed_segments_[segment] = std::move(it->second);
+    segments_.erase(it);
+    return true;
+  }
+
+  if (it != segments_.end()) {
+    segments_.erase(it);
+  }
+  const auto status = env_->DeleteFile(GetSegmentPath(segment));
+  if (!status.ok()) {
+    OLP_SDK_LOG_WARNING_F(kLogTag,
+                          "RemoveSegment: failed, segment=%u, error='%s'",
+                          segment, status.ToString().c_str());
+    return false;
+  }
+
+  return true;
+}
+
+std::string ValueLog::EncodeLocation(const Location& location) {
+  std::string data(kLocationSize, '\0');
+  WriteLittleEndian(location.segment, sizeof(uint32_t), &data[0]);
+  WriteLittleEndian(location.size, sizeof(uint32_t), &data[4]);
+  WriteLittleEndian(location.offset, sizeof(uint64_t), &data[8]);
+  return data;
+}
+
+bool ValueLog::DecodeLocation(const leveldb::Slice& data, Location& location) {
+  if (data.size() != kLocationSize) {
+    return false;
+  }
+
+  location.segment =
+      static_cast<uint32_t>(ReadLittleEndian(data.data(), sizeof(uint32_t)));
+  location.size = static_cast<uint32_t>(
+      ReadLittleEndian(data.data() + 4, sizeof(uint32_t)));
+  location.offset = ReadLittleEndian(data.data() + 8, sizeof(uint64_t));
+  return location.segment != 0u;
+}
+
+std::string ValueLog::GetSegmentPath(uint32_t segment) const {
+  char name[32];
+  snprintf(name, sizeof(name), "%06u%s", segment, kSegmentSuffix);
+  return path_ + '/' + name;
+}
+
+bool ValueLog::StartSegment(uint32_t segment) {
+  if (active_file_) {
+    if (sync_ && dirty_) {
+      active_file_->Sync();
+    }
+    active_file_->Close();
+    active_file_.reset();
+    dirty_ = false;
+  }
+
+  leveldb::WritableFile* file = nullptr;
+  const auto status = env_->NewWritableFile(GetSegmentPath(segment), &file);
+  if (!status.ok()) {
+    OLP_SDK_LOG_ERROR_F(kLogTag,
+                        "StartSegment: failed, segment=%u, error='%s'",
+                        segment, status.ToString().c_str());
+    active_segment_ = 0u;
+    return false;
+  }
+
+  active_file_.reset(file);
+  active_segment_ = segment;
+  segments_[segment] = Segment();
+  return true;
+}
+
+void ValueLog::DeleteRemovedSegments() const {
+  for (auto& segment : removed_segments_) {
+    // The file is closed first, some platforms can't delete open files.
+    segment.second.file.reset();
+    const auto status = env_->DeleteFile(GetSegmentPath(segment.first));
+    if (!status.ok()) {
+      OLP_SDK_LOG_WARNING_F(kLogTag,
+                            "RemoveSegment: failed, segment=%u, error='%s'",
+                            segment.first, status.ToString().c_str());
+    }
+  }
+  removed_segments_.clear();
+}
+
+std::shared_ptr<leveldb::RandomAccessFile> ValueLog::GetSegmentFile(
+    uint32_t segment, uint64_t end) const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto it = segments_.find(segment);
+  if (it == segments_.end()) {
+    it = removed_segments_.find(segment);
+    if (it == removed_segments_.end()) {
+      return nullptr;
+    }
+  }
+  if (end > it->second.size) {
+    return nullptr;
+  }
+
+  auto& entry = it->second;
+  if (!entry.file || entry.file_size < end) {
+    leveldb::RandomAccessFile* file = nullptr;
+    if (!env_->NewRandomAccessFile(GetSegmentPath(segment), &file).ok()) {
+      OLP_SDK_LOG_WARNING_F(kLogTag, "Failed to open segment=%u", segment);
+      return nullptr;
+    }
+    entry.file.reset(file);
+    entry.file_size = entry.size;
+  }
+
+  return entry.file;
+}
+
+}  // namespace cache
+}  // namespace olp
@@ -0,0 +1,264 @@
+/*
+ * Copyright (C) 2021 HERE Europe B.V.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ * License-Filename: LICENSE
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include <leveldb/env.h>
+#include <leveldb/slice.h>
+
+namespace olp {
+namespace cache {
+
+/**
+ * @brief Stores large values in append-only segment files, so the disk cache
+ * database only holds their locations and does not rewrite them on every
+ * compaction.
+ *
+ * Every entry of a segment is stored as:
+ *   bytes 0-3 - key size, little-endian;
+ *   bytes 4-7 - value size, little-endian;
+ *   the key and the value;
+ *   4 bytes   - CRC-32 of the value, little-endian.
+ *
+ * Values are never removed from a segment. The owner marks the values which
+ * are not referenced anymore with `Release`, finds the ones which still are
+ * with `ForEachEntry`, moves them to the active segment and removes the old
+ * segment with `RemoveSegment`.
+ *
+ * The owner calls `Commit` once it stored the location of an appended value,
+ * the segments with uncommitted values are not collected. The readers hold a
+ * `ReadPin` from looking up a location until reading it, so the segments are
+ * not removed under them.
+ */
+class ValueLog {
+ public:
+  /// The location of a value in the log.
+  struct Location {
+    /// The segment number.
+    uint32_t segment{0u};
+    /// The size of the value.
+    uint32_t size{0u};
+    /// The offset of the value in the segment file.
+    uint64_t offset{0u};
+  };
+
+  /// The size of an encoded `Location`.
+  static constexpr size_t kLocationSize = 16u;
+
+  /// Called for every entry found by `ForEachEntry`.
+  using EntryCallback =
+      std::function<void(const std::string& key, const Location& location)>;
+
+  /// Keeps the segments removed while it exists readable until the last pin
+  /// is released. Does nothing if `value_log` is null.
+  class ReadPin {
+   public:
+    explicit ReadPin(const ValueLog* value_log);
+    ~ReadPin();
+
+    ReadPin(const ReadPin&) = delete;
+    ReadPin& operator=(const ReadPin&) = delete;
+
+   private:
+    const ValueLog* value_log_;
+  };
+
+  /**
+   * @brief Creates the `ValueLog` instance.
+   *
+   * @param path The folder of the segment files.
+   * @param max_segment_size The size after which a new segment is started.
+   * @param sync If true, `Sync` flushes the appended values to the disk.
+   */
+  ValueLog(std::string path, uint64_t max_segment_size, bool sync);
+
+  ~ValueLog();
+
+  /**
+   * @brief Opens the log and starts a new segment for the appended values.
+   *
+   * @param read_only If true, the existing segments are only read.
+   *
+   * @return False if the folder can't be created or listed.
+   */
+  bool Open(bool read_only);
+
+  /// Closes the active segment, removes it if nothing was written to it.
+  void Close();
+
+  /**
+   * @brief Appends the value to the active segment.
+   *
+   * The value can be read as soon as the call returns. The segment is not
+   * returned by `GetSealedSegments` until the value is committed.
+   *
+   * @param key The key of the value, used by `ForEachEntry`.
+   * @param value The value to append.
+   * @param location The location of the appended value.
+   *
+   * @return False if the log is read-only or the write failed.
+   */
+  bool Append(const std::string& key, const leveldb::Slice& value,
+              Location& location);
+
+  /**
+   * @brief Marks the appended value as committed.
+   *
+   * Called for every location returned by `Append`, once the owner stored the
+   * location or dropped it.
+   *
+   * @param location The location returned by `Append`.
+   */
+  void Commit(const Location& location);
+
+  /// Makes the appended values durable, if the log was created with `sync`.
+  bool Sync();
+
+  /**
+   * @brief Marks the value as not referenced anymore, its space is reclaimed
+   * once its segment is removed.
+   *
+   * @param location The location of the value.
+   *
+   * @return The size of the released values of the segment, 0 if the segment
+   * does not exist anymore.
+   */
+  uint64_t Release(const Location& location);
+
+  /// Sets the size of the released values of the segment, as found by the
+  /// owner. The values released before the log was opened are only known
+  /// after it.
+  void SetDeadSize(uint32_t segment, uint64_t size);
+
+  /// Returns the size of the released values of the segment.
+  uint64_t GetSegmentDeadSize(uint32_t segment) const;
+
+  /// Returns the size of the released values of all segments.
+  uint64_t DeadSize() const;
+
+  /**
+   * @brief Reads the value.
+   *
+   * @param location The location returned by `Append`.
+   * @param verify_checksum If true, the value is checked against the stored
+   * checksum.
+   * @param value The value.
+   *
+   * @return False if the segment does not exist, the read failed or the
+   * checksum does not match.
+   */
+  bool Read(const Location& location, bool verify_checksum,
+            std::string& value) const;
+
+  /// Same as above, reads the value straight into a byte vector, so it can be
+  /// returned by the cache without a copy.
+  bool Read(const Location& location, bool verify_checksum,
+            std::vector<unsigned char>& value) const;
+
+  /// Returns the segments which are not appended to anymore and have no
+  /// uncommitted values, the oldest first.
+  std::vector<uint32_t> GetSealedSegments() const;
+
+  /// Returns the size of the segment file.
+  uint64_t GetSegmentSize(uint32_t segment) const;
+
+  /// Returns the size of all segment files.
+  uint64_t Size() const;
+
+  /**
+   * @brief Calls `callback` for every complete entry of the sealed segment.
+   *
+   * The values are skipped, only the keys are read.
+   *
+   * @return False if the segment can't be read.
+   */
+  bool ForEachEntry(uint32_t segment, const EntryCallback& callback) const;
+
+  /// Removes the sealed segment file. While a `ReadPin` exists, the file is
+  /// kept for reading and removed once the last pin is released.
+  bool RemoveSegment(uint32_t segment);
+
+  /// Encodes the location into `kLocationSize` bytes.
+  static std::string EncodeLocation(const Location& location);
+
+  /// Decodes the location, returns false if the data is malformed.
+  static bool DecodeLocation(const leveldb::Slice& data, Location& location);
+
+ private:
+  struct Segment {
+    uint64_t size{0u};
+    /// Opened on the first read.
+    std::shared_ptr<leveldb::RandomAccessFile> file;
+    /// The segment size when `file` was opened. Some environments map the
+    /// file, so the active segment is reopened to read the newer values.
+    uint64_t file_size{0u};
+    /// The number of appended values which are not committed yet.
+    uint32_t uncommitted{0u};
+    /// The size of the released values.
+    uint64_t dead_size{0u};
+  };
+
+  std::string GetSegmentPath(uint32_t segment) const;
+
+  /// Reads the value into the buffer, a string or a byte vector.
+  template <typename Buffer>
+  bool ReadValue(const Location& location, bool verify_checksum,
+                 Buffer& value) const;
+
+  /// Seals the active segment and starts the given one.
+  bool StartSegment(uint32_t segment);
+
+  /// Deletes the files of the removed segments. Called with `mutex_` held.
+  void DeleteRemovedSegments() const;
+
+  /// Returns the file to read the segment up to `end` from, opens it if
+  /// needed.
+  std::shared_ptr<leveldb::RandomAccessFile> GetSegmentFile(
+      uint32_t segment, uint64_t end) const;
+
+  const std::shared_ptr<leveldb::Env> env_;
+  const std::string path_;
+  const uint64_t max_segment_size_;
+  const bool sync_;
+  bool read_only_{true};
+  /// Guards the segments and the active file.
+  mutable std::mutex mutex_;
+  mutable std::map<uint32_t, Segment> segments_;
+  /// The removed segments which are still readable for the pinned readers.
+  mutable std::map<uint32_t, Segment> removed_segments_;
+  /// The number of `ReadPin` instances.
+  mutable size_t read_pins_{0u};
+  std::unique_ptr<leveldb::WritableFile> active_file_;
+  /// The segment values are appended to, 0 if there is none.
+  uint32_t active_segment_{0u};
+  /// True if values were appended since the last `Sync`.
+  bool dirty_{false};
+};
+
+}  // namespace cache
+}  // namespace olp
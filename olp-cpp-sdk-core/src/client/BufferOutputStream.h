@@ -0,0 +1,123 @@
+/*
+ * Copyright (C) 2021 HERE Europe B.V.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ * License-Filename: LICENSE
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <memory>
+#include <ostream>
+#include <streambuf>
+#include <vector>
+
+namespace olp {
+namespace client {
+
+/// An output stream that writes directly into a contiguous buffer, so the
+/// response body can be handed over without copying it out of a
+/// `std::stringstream`. Supports `seekp` and `tellp`, which the network
+/// uses to rewrite the body on retries. Without a buffer, the data is
+/// discarded, e.g. when the body is consumed by the data callback.
+class BufferOutputStream : public std::ostream {
+ public:
+  using Buffer = std::vector<unsigned char>;
+
+  explicit BufferOutputStream(std::shared_ptr<Buffer> buffer)
+      : std::ostream(nullptr), stream_buffer_(std::move(buffer)) {
+    rdbuf(&stream_buffer_);
+  }
+
+  /// Stops writing into the buffer, the following data is discarded.
+  void Discard() { stream_buffer_.Discard(); }
+
+ private:
+  class StreamBuffer : public std::streambuf {
+   public:
+    explicit StreamBuffer(std::shared_ptr<Buffer> buffer)
+        : buffer_(std::move(buffer)) {}
+
+    void Discard() { buffer_.reset(); }
+
+   protected:
+    std::streamsize xsputn(const char* data, std::streamsize count) override {
+      if (!buffer_) {
+        position_ += count;
+        size_ = std::max(size_, position_);
+        return count;
+      }
+
+      const auto size = static_cast<std::streamsize>(buffer_->size());
+      const auto begin = reinterpret_cast<const unsigned char*>(data);
+
+      // Overwrites the existing bytes after seekp, appends the rest.
+      const auto overwrite = std::min(size - position_, count);
+      std::copy(begin, begin + overwrite, buffer_->begin() + position_);
+      buffer_->insert(buffer_->end(), begin + overwrite, begin + count);
+      position_ += count;
+      size_ = static_cast<std::streamsize>(buffer_->size());
+      return count;
+    }
+
+    int_type overflow(int_type value) override {
+      if (traits_type::eq_int_type(value, traits_type::eof())) {
+        return traits_type::not_eof(value);
+      }
+
+      const auto c = traits_type::to_char_type(value);
+      xsputn(&c, 1);
+      return value;
+    }
+
+    pos_type seekoff(off_type offset, std::ios_base::seekdir direction,
+                     std::ios_base::openmode which) override {
+      if ((which & std::ios_base::out) == 0) {
+        return pos_type(off_type(-1));
+      }
+
+      off_type base = 0;
+      if (direction == std::ios_base::cur) {
+        base = position_;
+      } else if (direction == std::ios_base::end) {
+        base = size_;
+      }
+
+      const auto position = base + offset;
+      if (position < 0 || position > size_) {
+        return pos_type(off_type(-1));
+      }
+
+      position_ = position;
+      return pos_type(position_);
+    }
+
+    pos_type seekpos(pos_type position,
+                     std::ios_base::openmode which) override {
+      return seekoff(off_type(position), std::ios_base::beg, which);
+    }
+
+   private:
+    std::shared_ptr<Buffer> buffer_;
+    std::streamsize position_{0};
+    std::streamsize size_{0};
+  };
+
+  StreamBuffer stream_buffer_;
+};
+
+}  // namespace client
+}  // namespace olp
@@ -19,12 +19,16 @@
 
 #include "olp/core/client/OlpClient.h"
 
+#include <algorithm>
 #include <cctype>
 #include <chrono>
+#include <cstdlib>
 #include <future>
+#include <mutex>
 #include <sstream>
 #include <thread>
 
+#include "BufferOutputStream.h"
 #include "PendingUrlRequests.h"
 #include "olp/core/client/Condition.h"
 #include "olp/core/client/ErrorCode.h"
@@ -38,6 +42,12 @@
 namespace {
 constexpr auto kLogTag = "OlpClient";
 constexpr auto kApiKeyParam = "apiKey=";
+// The Content-Length is not trusted beyond this size, larger bodies grow the
+// buffer while they are received.
+constexpr auto kMaxReservedBodySize = 4u * 1024u * 1024u;
+// The error bodies are small, a streamed body that is larger is forwarded
+// before the status of the response is known.
+constexpr auto kMaxHeldBodySize = 64u * 1024u;
 
 struct RequestSettings {
   explicit RequestSettings(const int initial_backdown_period_ms,
@@ -94,6 +104,73 @@ bool StatusSuccess(int status) {
   return status >= 0 && status < http::HttpStatusCode::BAD_REQUEST;
 }
 
+bool StatusOk(int status) {
+  return status >= http::HttpStatusCode::OK &&
+         status < http::HttpStatusCode::MULTIPLE_CHOICES;
+}
+
+/// Forwards the streamed body to the data callback. The network streams the
+/// body of every response, so the start of the body is held back until the
+/// status is known, and is dropped for the error responses.
+class StreamedBody {
+ public:
+  StreamedBody(http::Network::DataCallback data_callback,
+               std::shared_ptr<BufferOutputStream> payload)
+      : data_callback_(std::move(data_callback)),
+        payload_(std::move(payload)) {}
+
+  void Write(const std::uint8_t* data, std::uint64_t offset,
+             std::size_t length) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (finished_) {
+      return;
+    }
+
+    if (!streaming_) {
+      if (held_.empty()) {
+        held_offset_ = offset;
+      }
+      if (held_.size() + length <= kMaxHeldBodySize) {
+        held_.insert(held_.end(), data, data + length);
+        return;
+      }
+
+      // Not an error body, the body is not stored from now on.
+      streaming_ = true;
+      payload_->Discard();
+      ForwardHeld();
+    }
+
+    data_callback_(data, offset, length);
+  }
+
+  /// Forwards the held data of a successful response, nothing is forwarded
+  /// afterwards.
+  void Finish(bool successful) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (successful) {
+      ForwardHeld();
+    }
+    finished_ = true;
+  }
+
+ private:
+  void ForwardHeld() {
+    if (!held_.empty()) {
+      data_callback_(held_.data(), held_offset_, held_.size());
+      std::vector<std::uint8_t>().swap(held_);
+    }
+  }
+
+  http::Network::DataCallback data_callback_;
+  std::shared_ptr<BufferOutputStream> payload_;
+  std::mutex mutex_;
+  std::vector<std::uint8_t> held_;
+  std::uint64_t held_offset_{0};
+  bool streaming_{false};
+  bool finished_{false};
+};
+
 bool CaseInsensitiveCompare(const std::string& str1, const std::string& str2) {
   return (str1.size() == str2.size()) &&
          std::equal(str1.begin(), str1.end(), str2.begin(),
@@ -254,7 +331,9 @@ http::NetworkRequest::HttpVerb GetHttpVerb(const std::string& verb) {
 HttpResponse SendRequest(const http::NetworkRequest& request,
                          const olp::client::OlpClientSettings& settings,
                          const olp::client::RetrySettings& retry_settings,
-                         client::CancellationContext context) {
+                         client::CancellationContext context,
+                         bool buffer_response,
+                         const http::Network::DataCallback& data_callback) {
   struct ResponseData {
     Condition condition;
     http::NetworkResponse response{kCancelledErrorResponse};
@@ -262,7 +341,29 @@ HttpResponse SendRequest(const http::NetworkRequest& request,
   };
 
   auto response_data = std::make_shared<ResponseData>();
-  auto response_body = std::make_shared<std::stringstream>();
+  std::shared_ptr<std::vector<unsigned char>> response_buffer;
+  auto response_stream = std::make_shared<std::stringstream>();
+  std::shared_ptr<std::ostream> response_body;
+  std::shared_ptr<StreamedBody> streamed_body;
+  http::Network::DataCallback forward_data;
+  if (buffer_response) {
+    response_buffer = std::make_shared<std::vector<unsigned char>>();
+    response_body = std::make_shared<BufferOutputStream>(response_buffer);
+  } else if (data_callback) {
+    // The body of a successful response is consumed by the data callback, and
+    // is not stored. The body of an error response is not streamed and is
+    // kept for the error message.
+    response_buffer = std::make_shared<std::vector<unsigned char>>();
+    auto error_body = std::make_shared<BufferOutputStream>(response_buffer);
+    streamed_body = std::make_shared<StreamedBody>(data_callback, error_body);
+    forward_data = [streamed_body](const std::uint8_t* data,
+                                   std::uint64_t offset, std::size_t length) {
+      streamed_body->Write(data, offset, length);
+    };
+    response_body = std::move(error_body);
+  } else {
+    response_body = response_stream;
+  }
   http::SendOutcome outcome{http::ErrorCode::CANCELLED_ERROR};
   const auto timeout = std::chrono::seconds(retry_settings.timeout);
 
@@ -274,10 +375,28 @@ HttpResponse SendRequest(const http::NetworkRequest& request,
               response_data->response = std::move(response);
               response_data->condition.Notify();
             },
-            [response_data](std::string key, std::string value) {
+            [response_data, response_buffer, buffer_response](
+                std::string key, std::string value) {
+              // Sizes the buffer upfront, so the body is written without
+              // reallocations.
+              if (buffer_response &&
+                  CaseInsensitiveCompare(key, http::kContentLengthHeader)) {
+                const auto length = std::min<unsigned long long>(
+                    std::strtoull(value.c_str(), nullptr, 10),
+                    kMaxReservedBodySize);
+                try {
+                  response_buffer->reserve(static_cast<size_t>(length));
+                } catch (const std::exception& e) {
+                  OLP_SDK_LOG_WARNING_F(kLogTag,
+                                        "SendRequest: reserving %llu bytes "
+                                        "failed, error=%s",
+                                        length, e.what());
+                }
+              }
               response_data->headers.emplace_back(std::move(key),
                                                   std::move(value));
-            });
+            },
+            forward_data);
 
         if (!outcome.IsSuccessful()) {
           OLP_SDK_LOG_WARNING_F(kLogTag,
@@ -300,7 +419,13 @@ HttpResponse SendRequest(const http::NetworkRequest& request,
     return ToHttpResponse(outcome);
   }
 
-  if (!response_data->condition.Wait(timeout)) {
+  const auto completed = response_data->condition.Wait(timeout);
+  if (streamed_body) {
+    streamed_body->Finish(completed && !context.IsCancelled() &&
+                          StatusOk(response_data->response.GetStatus()));
+  }
+
+  if (!completed) {
     OLP_SDK_LOG_WARNING_F(kLogTag, "Request %" PRIu64 " timed out!",
                           outcome.GetRequestId());
     context.CancelOperation();
@@ -311,9 +436,28 @@ HttpResponse SendRequest(const http::NetworkRequest& request,
     return ToHttpResponse(kCancelledErrorResponse);
   }
 
-  HttpResponse response{response_data->response.GetStatus(),
-                        std::move(*response_body),
-                        std::move(response_data->headers)};
+  const auto status = response_data->response.GetStatus();
+  HttpResponse response;
+  if (!response_buffer) {
+    response = HttpResponse{status, std::move(*response_stream),
+                            std::move(response_data->headers)};
+  } else if (StatusSuccess(status)) {
+    if (buffer_response) {
+      response = HttpResponse{status, std::move(response_buffer),
+                              std::move(response_data->headers)};
+    } else {
+      // The body was consumed by the data callback.
+      response = HttpResponse{status, std::move(*response_stream),
+                              std::move(response_data->headers)};
+    }
+  } else {
+    // Error bodies are small and are read from the stream by the callers.
+    std::stringstream error_body;
+    error_body.write(reinterpret_cast<const char*>(response_buffer->data()),
+                     response_buffer->size());
+    response = HttpResponse{status, std::move(error_body),
+                            std::move(response_data->headers)};
+  }
 
   response.SetNetworkStatistics(GetStatistics(response_data->response));
 
@@ -352,7 +496,8 @@ class OlpClient::OlpClientImpl {
                        ParametersType query_params,
                        ParametersType header_params, ParametersType form_params,
                        RequestBodyType post_body, std::string content_type,
-                       CancellationContext context) const;
+                       CancellationContext context, bool buffer_response,
+                       http::Network::DataCallback data_callback) const;
 
   std::shared_ptr<http::NetworkRequest> CreateRequest(
       const std::string& path, const std::string& method,
@@ -484,8 +629,14 @@ CancellationToken OlpClient::OlpClientImpl::CallApi(
 
   // Only merge same request in case there is no body as a body can alter the
   // outcome of the request and may not match the response of a request with a
-  // different body.
-  bool merge = (!post_body || post_body->empty());
+  // different body. The same applies to the requests of different ranges.
+  bool merge = (!post_body || post_body->empty()) &&
+               std::none_of(header_params.begin(), header_params.end(),
+                            [](const OlpClient::ParametersType::value_type&
+                                   header) {
+                              return CaseInsensitiveCompare(
+                                  header.first, http::kRangeHeader);
+                            });
   OLP_SDK_LOG_DEBUG_F(kLogTag, "CallApi: url='%s', merge='%s'", url.c_str(),
                       merge ? "true" : "false");
 
@@ -520,7 +671,8 @@ CancellationToken OlpClient::OlpClientImpl::CallApi(
           .WithConnectionTimeout(retry_settings.timeout)
           .WithTransferTimeout(retry_settings.timeout)
           .WithRetries(retry_settings.max_attempts)
-          .WithProxySettings(std::move(proxy)));
+          .WithProxySettings(std::move(proxy))
+          .WithHttp2Enabled(settings_.http2_enabled));
 
   auto network = settings_.network_request_handler;
   auto request_settings = GetRequestSettings(retry_settings);
@@ -539,7 +691,8 @@ HttpResponse OlpClient::OlpClientImpl::CallApi(
     OlpClient::ParametersType header_params,
     OlpClient::ParametersType /*forms_params*/,
     OlpClient::RequestBodyType post_body, std::string content_type,
-    CancellationContext context) const {
+    CancellationContext context, bool buffer_response,
+    http::Network::DataCallback data_callback) const {
   if (!settings_.network_request_handler) {
     return HttpResponse(static_cast<int>(olp::http::ErrorCode::OFFLINE_ERROR),
                         "Network request handler is empty.");
@@ -551,7 +704,8 @@ HttpResponse OlpClient::OlpClientImpl::CallApi(
           .WithTransferTimeout(retry_settings.timeout)
           .WithConnectionTimeout(retry_settings.timeout)
           .WithProxySettings(
-              settings_.proxy_settings.value_or(http::NetworkProxySettings()));
+              settings_.proxy_settings.value_or(http::NetworkProxySettings()))
+          .WithHttp2Enabled(settings_.http2_enabled);
 
   auto network_request = http::NetworkRequest(
       utils::Url::Construct(GetBaseUrl(), path, query_params));
@@ -590,8 +744,8 @@ HttpResponse OlpClient::OlpClientImpl::CallApi(
 
   AddBearer(query_params.empty(), network_request);
 
-  auto response =
-      SendRequest(network_request, settings_, retry_settings, context);
+  auto response = SendRequest(network_request, settings_, retry_settings,
+                              context, buffer_response, data_callback);
 
   NetworkStatistics accumulated_statistics = response.GetNetworkStatistics();
 
@@ -624,7 +778,8 @@ HttpResponse OlpClient::OlpClientImpl::CallApi(
     }
 
     backdown_period = CalculateNextWaitTime(retry_settings, i);
-    response = SendRequest(network_request, settings_, retry_settings, context);
+    response = SendRequest(network_request, settings_, retry_settings, context,
+                           buffer_response, data_callback);
 
     // In case we retry, accumulate the stats
     accumulated_statistics += response.GetNetworkStatistics();
@@ -668,17 +823,17 @@ CancellationToken OlpClient::CallApi(
                         post_body, content_type, callback);
 }
 
-HttpResponse OlpClient::CallApi(std::string path, std::string method,
-                                ParametersType query_params,
-                                ParametersType header_params,
-                                ParametersType form_params,
-                                RequestBodyType post_body,
-                                std::string content_type,
-                                CancellationContext context) const {
+HttpResponse OlpClient::CallApi(
+    std::string path, std::string method, ParametersType query_params,
+    ParametersType header_params, ParametersType form_params,
+    RequestBodyType post_body, std::string content_type,
+    CancellationContext context, bool buffer_response,
+    http::Network::DataCallback data_callback) const {
   return impl_->CallApi(std::move(path), std::move(method),
                         std::move(query_params), std::move(header_params),
                         std::move(form_params), std::move(post_body),
-                        std::move(content_type), std::move(context));
+                        std::move(content_type), std::move(context),
+                        buffer_response, std::move(data_callback));
 }
 
 }  // namespace client
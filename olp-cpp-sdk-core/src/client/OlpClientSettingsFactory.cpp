@@ -40,12 +40,24 @@ OlpClientSettingsFactory::CreateDefaultTaskScheduler(size_t thread_count) {
   return std::make_unique<thread::ThreadPoolTaskScheduler>(thread_count);
 }
 
+std::unique_ptr<thread::TaskScheduler>
+OlpClientSettingsFactory::CreateDefaultTaskScheduler(
+    const thread::ThreadPoolSettings& settings) {
+  return std::make_unique<thread::ThreadPoolTaskScheduler>(settings);
+}
+
 std::shared_ptr<http::Network>
 OlpClientSettingsFactory::CreateDefaultNetworkRequestHandler(
     size_t max_requests_count) {
   return http::CreateDefaultNetwork(max_requests_count);
 }
 
+std::shared_ptr<http::Network>
+OlpClientSettingsFactory::CreateDefaultNetworkRequestHandler(
+    http::NetworkInitializationSettings settings) {
+  return http::CreateDefaultNetwork(settings);
+}
+
 std::unique_ptr<cache::KeyValueCache>
 OlpClientSettingsFactory::CreateDefaultCache(cache::CacheSettings settings) {
 #ifdef OLP_SDK_ENABLE_DEFAULT_CACHE
@@ -83,7 +95,8 @@ void OlpClientSettingsFactory::PrewarmConnection(
           .WithTransferTimeout(retry_settings.timeout)
           .WithConnectionTimeout(retry_settings.timeout)
           .WithProxySettings(
-              settings.proxy_settings.value_or(http::NetworkProxySettings()));
+              settings.proxy_settings.value_or(http::NetworkProxySettings()))
+          .WithHttp2Enabled(settings.http2_enabled);
 
   auto request =
       http::NetworkRequest(url)
@@ -36,17 +36,18 @@ namespace olp {
 namespace http {
 
 namespace {
-std::shared_ptr<Network> CreateDefaultNetworkImpl(size_t max_requests_count) {
-  OLP_SDK_CORE_UNUSED(max_requests_count);
+std::shared_ptr<Network> CreateDefaultNetworkImpl(
+    const NetworkInitializationSettings& settings) {
 #ifdef OLP_SDK_NETWORK_HAS_CURL
-  return std::make_shared<NetworkCurl>(max_requests_count);
+  return std::make_shared<NetworkCurl>(settings);
 #elif OLP_SDK_NETWORK_HAS_ANDROID
-  return std::make_shared<NetworkAndroid>(max_requests_count);
+  return std::make_shared<NetworkAndroid>(settings.max_requests_count);
 #elif OLP_SDK_NETWORK_HAS_IOS
-  return std::make_shared<OLPNetworkIOS>(max_requests_count);
+  return std::make_shared<OLPNetworkIOS>(settings.max_requests_count);
 #elif OLP_SDK_NETWORK_HAS_WINHTTP
-  return std::make_shared<NetworkWinHttp>(max_requests_count);
+  return std::make_shared<NetworkWinHttp>(settings.max_requests_count);
 #else
+  OLP_SDK_CORE_UNUSED(settings);
   static_assert(false, "No default network implementation provided");
 #endif
 }
@@ -61,7 +62,14 @@ Network::Statistics Network::GetStatistics(uint8_t /*bucket_id*/) {
 }
 
 std::shared_ptr<Network> CreateDefaultNetwork(size_t max_requests_count) {
-  auto network = CreateDefaultNetworkImpl(max_requests_count);
+  NetworkInitializationSettings settings;
+  settings.max_requests_count = max_requests_count;
+  return CreateDefaultNetwork(settings);
+}
+
+std::shared_ptr<Network> CreateDefaultNetwork(
+    NetworkInitializationSettings settings) {
+  auto network = CreateDefaultNetworkImpl(settings);
   if (network) {
     return std::make_shared<DefaultNetwork>(network);
   }
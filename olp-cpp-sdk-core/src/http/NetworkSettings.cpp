@@ -34,6 +34,8 @@ const NetworkProxySettings& NetworkSettings::GetProxySettings() const {
   return proxy_settings_;
 }
 
+bool NetworkSettings::GetHttp2Enabled() const { return http2_enabled_; }
+
 NetworkSettings& NetworkSettings::WithRetries(std::size_t retries) {
   retries_ = retries;
   return *this;
@@ -55,5 +57,10 @@ NetworkSettings& NetworkSettings::WithProxySettings(
   return *this;
 }
 
+NetworkSettings& NetworkSettings::WithHttp2Enabled(bool enabled) {
+  http2_enabled_ = enabled;
+  return *this;
+}
+
 }  // namespace http
 }  // namespace olp
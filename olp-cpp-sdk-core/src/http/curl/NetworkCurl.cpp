@@ -27,6 +27,10 @@
 #include <sys/stat.h>
 #include <unistd.h>
 
+#ifdef OLP_SDK_NETWORK_HAS_EPOLL
+#include <sys/epoll.h>
+#endif
+
 #if defined(HAVE_SIGNAL_H)
 #include <signal.h>
 #endif
@@ -54,6 +58,11 @@ namespace {
 
 const char* kLogTag = "CURL";
 
+#ifdef OLP_SDK_NETWORK_HAS_EPOLL
+// Maximum number of socket events handled per epoll_wait() call.
+constexpr int kMaxSocketEvents = 64;
+#endif
+
 #ifdef OLP_SDK_NETWORK_HAS_OPENSSL
 
 const auto curl_ca_bundle_name = "ca-bundle.crt";
@@ -210,13 +219,14 @@ int64_t GetElapsedTime(std::chrono::steady_clock::time_point start) {
 
 }  // anonymous namespace
 
-NetworkCurl::NetworkCurl(size_t max_requests_count)
-    : handles_(max_requests_count),
-      static_handle_count_(
-          std::max(static_cast<size_t>(1u), max_requests_count / 4)) {
+NetworkCurl::NetworkCurl(NetworkInitializationSettings settings)
+    : handles_(settings.max_requests_count),
+      static_handle_count_(std::max(static_cast<size_t>(1u),
+                                    settings.max_requests_count / 4)),
+      settings_(settings) {
   OLP_SDK_LOG_TRACE(kLogTag, "Created NetworkCurl with address="
-                                 << this
-                                 << ", handles_count=" << max_requests_count);
+                                 << this << ", handles_count="
+                                 << settings.max_requests_count);
   auto error = curl_global_init(CURL_GLOBAL_ALL);
   curl_initialized_ = (error == CURLE_OK);
   if (!curl_initialized_) {
@@ -280,6 +290,51 @@ bool NetworkCurl::Initialize() {
     return false;
   }
 
+#if LIBCURL_VERSION_NUM >= 0x071E00
+  // Connection limits (since Curl 7.30.0). Transfers exceeding the limits are
+  // queued by the multi handle until a connection is free.
+  if (settings_.max_host_connections > 0) {
+    curl_multi_setopt(curl_, CURLMOPT_MAX_HOST_CONNECTIONS,
+                      static_cast<long>(settings_.max_host_connections));
+  }
+  if (settings_.max_total_connections > 0) {
+    curl_multi_setopt(curl_, CURLMOPT_MAX_TOTAL_CONNECTIONS,
+                      static_cast<long>(settings_.max_total_connections));
+  }
+#endif
+
+  // The multiplexing is set up with the first HTTP/2 request.
+  multiplexing_enabled_ = false;
+
+#ifdef OLP_SDK_NETWORK_HAS_EPOLL
+  epoll_fd_ = epoll_create1(EPOLL_CLOEXEC);
+  if (epoll_fd_ < 0) {
+    OLP_SDK_LOG_ERROR(kLogTag, "epoll_create1 failed, this="
+                                   << this << ", error=" << errno);
+    return false;
+  }
+
+  epoll_event pipe_event{};
+  pipe_event.events = EPOLLIN;
+  pipe_event.data.fd = pipe_[0];
+  if (epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, pipe_[0], &pipe_event) != 0) {
+    OLP_SDK_LOG_ERROR(kLogTag, "epoll_ctl for pipe failed, this="
+                                   << this << ", error=" << errno);
+    return false;
+  }
+
+  // The worker thread waits for the sockets reported by CURL instead of
+  // polling all of them with curl_multi_wait().
+  timer_set_ = false;
+  curl_multi_setopt(curl_, CURLMOPT_SOCKETFUNCTION,
+                    &NetworkCurl::SocketFunction);
+  curl_multi_setopt(curl_, CURLMOPT_SOCKETDATA, this);
+  curl_multi_setopt(curl_, CURLMOPT_TIMERFUNCTION, &NetworkCurl::TimerFunction);
+  curl_multi_setopt(curl_, CURLMOPT_TIMERDATA, this);
+#endif
+
+  SetupShare();
+
   // handles setup
   std::shared_ptr<NetworkCurl> that = shared_from_this();
   for (auto& handle : handles_) {
@@ -357,6 +412,19 @@ void NetworkCurl::Teardown() {
     curl_multi_cleanup(curl_);
     curl_ = nullptr;
 
+    // The share handle can be released only after all the easy handles that
+    // use it are cleaned up.
+    if (share_) {
+      curl_share_cleanup(share_);
+      share_ = nullptr;
+    }
+
+#ifdef OLP_SDK_NETWORK_HAS_EPOLL
+    // Closed after the multi handle, as its cleanup removes the sockets.
+    close(epoll_fd_);
+    epoll_fd_ = -1;
+#endif
+
 #if (defined OLP_SDK_NETWORK_HAS_PIPE) || (defined OLP_SDK_NETWORK_HAS_PIPE2)
     close(pipe_[0]);
     close(pipe_[1]);
@@ -374,6 +442,60 @@ void NetworkCurl::Teardown() {
   }
 }
 
+void NetworkCurl::EnableMultiplexing() {
+  if (multiplexing_enabled_) {
+    return;
+  }
+  multiplexing_enabled_ = true;
+
+#if LIBCURL_VERSION_NUM >= 0x072B00
+  // Multiplex HTTP/2 requests over a single connection (since Curl 7.43.0).
+  curl_multi_setopt(curl_, CURLMOPT_PIPELINING, CURLPIPE_MULTIPLEX);
+#endif
+
+#if LIBCURL_VERSION_NUM >= 0x074300
+  // Limit of the concurrent HTTP/2 streams (since Curl 7.67.0).
+  if (settings_.max_concurrent_streams > 0) {
+    curl_multi_setopt(curl_, CURLMOPT_MAX_CONCURRENT_STREAMS,
+                      static_cast<long>(settings_.max_concurrent_streams));
+  }
+#endif
+}
+
+void NetworkCurl::SetupShare() {
+  share_ = curl_share_init();
+  if (!share_) {
+    // Not fatal, requests just do not share the DNS cache and TLS sessions.
+    OLP_SDK_LOG_WARNING(kLogTag, "curl_share_init failed, this=" << this);
+    return;
+  }
+
+  curl_share_setopt(share_, CURLSHOPT_LOCKFUNC, &NetworkCurl::LockShare);
+  curl_share_setopt(share_, CURLSHOPT_UNLOCKFUNC, &NetworkCurl::UnlockShare);
+  curl_share_setopt(share_, CURLSHOPT_USERDATA, this);
+
+  // The connection cache is not added here, as all the easy handles added to
+  // the multi handle already share its connection pool.
+  curl_share_setopt(share_, CURLSHOPT_SHARE, CURL_LOCK_DATA_DNS);
+  curl_share_setopt(share_, CURLSHOPT_SHARE, CURL_LOCK_DATA_SSL_SESSION);
+}
+
+void NetworkCurl::LockShare(CURL* /*handle*/, curl_lock_data data,
+                            curl_lock_access /*access*/, void* user_ptr) {
+  auto network = static_cast<NetworkCurl*>(user_ptr);
+  if (network && data < CURL_LOCK_DATA_LAST) {
+    network->share_mutexes_[data].lock();
+  }
+}
+
+void NetworkCurl::UnlockShare(CURL* /*handle*/, curl_lock_data data,
+                              void* user_ptr) {
+  auto network = static_cast<NetworkCurl*>(user_ptr);
+  if (network && data < CURL_LOCK_DATA_LAST) {
+    network->share_mutexes_[data].unlock();
+  }
+}
+
 bool NetworkCurl::IsStarted() const { return state_ == WorkerState::STARTED; }
 
 bool NetworkCurl::Initialized() const { return IsStarted(); }
@@ -459,6 +581,7 @@ ErrorCode NetworkCurl::SendImplementation(
   handle->transfer_timeout = config.GetTransferTimeout();
   handle->ignore_offset = false;  // request.IgnoreOffset();
   handle->skip_content = false;   // config->SkipContentWhenError();
+  handle->http2 = config.GetHttp2Enabled();
 
   for (const auto& header : request.GetHeaders()) {
     std::ostringstream sstrm;
@@ -581,6 +704,14 @@ ErrorCode NetworkCurl::SendImplementation(
   }
   curl_easy_setopt(handle->handle, CURLOPT_ERRORBUFFER, handle->error_text);
 
+  // curl_easy_reset() clears the share handle, so it is set on every request.
+  if (share_) {
+    curl_easy_setopt(handle->handle, CURLOPT_SHARE, share_);
+  }
+
+  // Used to find the request context of a completed CURL handle.
+  curl_easy_setopt(handle->handle, CURLOPT_PRIVATE, handle);
+
 #if (LIBCURL_VERSION_MAJOR >= 7) && (LIBCURL_VERSION_MINOR >= 21)
   curl_easy_setopt(handle->handle, CURLOPT_ACCEPT_ENCODING, "");
   curl_easy_setopt(handle->handle, CURLOPT_TRANSFER_ENCODING, 1L);
@@ -593,6 +724,18 @@ ErrorCode NetworkCurl::SendImplementation(
   curl_easy_setopt(handle->handle, CURLOPT_TCP_KEEPINTVL, 60L);
 #endif
 
+#if LIBCURL_VERSION_NUM >= 0x072F00
+  // HTTP/2 (since Curl 7.47.0) is opt-in, otherwise the libcurl default HTTP
+  // version is used.
+  if (handle->http2) {
+    curl_easy_setopt(handle->handle, CURLOPT_HTTP_VERSION,
+                     CURL_HTTP_VERSION_2TLS);
+    // Wait for a connection that can be multiplexed instead of opening a new
+    // one.
+    curl_easy_setopt(handle->handle, CURLOPT_PIPEWAIT, 1L);
+  }
+#endif
+
   {
     std::lock_guard<std::mutex> lock(event_mutex_);
     AddEvent(EventInfo::Type::SEND_EVENT, handle);
@@ -673,6 +816,7 @@ NetworkCurl::RequestHandle* NetworkCurl::GetHandle(
       handle.send_time = std::chrono::steady_clock::now();
       handle.error_text[0] = 0;
       handle.skip_content = false;
+      handle.http2 = false;
 
       return &handle;
     }
@@ -859,12 +1003,18 @@ void NetworkCurl::CompleteMessage(CURL* handle, CURLcode result) {
     const char* url;
     curl_easy_getinfo(rhandle.handle, CURLINFO_EFFECTIVE_URL, &url);
 
+    // Number of new connections created for the request, zero when a pooled
+    // connection was reused.
+    long connects = 0;
+    curl_easy_getinfo(rhandle.handle, CURLINFO_NUM_CONNECTS, &connects);
+
     OLP_SDK_LOG_DEBUG(kLogTag,
                       "Message completed, id="
                           << rhandle.id << ", url='" << url << "', status=("
                           << status << ") " << error
                           << ", time=" << GetElapsedTime(rhandle.send_time)
-                          << "ms, bytes=" << download_bytes + upload_bytes);
+                          << "ms, bytes=" << download_bytes + upload_bytes
+                          << ", connects=" << connects);
 
     response.WithStatus(status).WithError(error);
     ReleaseHandleUnlocked(&rhandle);
@@ -877,6 +1027,16 @@ void NetworkCurl::CompleteMessage(CURL* handle, CURLcode result) {
 }
 
 int NetworkCurl::GetHandleIndex(CURL* handle) {
+  char* data = nullptr;
+  if (curl_easy_getinfo(handle, CURLINFO_PRIVATE, &data) == CURLE_OK &&
+      data) {
+    const auto index = reinterpret_cast<RequestHandle*>(data) - handles_.data();
+    if (index >= 0 && index < static_cast<std::ptrdiff_t>(handles_.size()) &&
+        handles_[index].in_use && handles_[index].handle == handle) {
+      return static_cast<int>(index);
+    }
+  }
+
   for (size_t index = 0; index < handles_.size(); index++) {
     if (handles_[index].in_use && (handles_[index].handle == handle)) {
       return static_cast<int>(index);
@@ -885,6 +1045,109 @@ int NetworkCurl::GetHandleIndex(CURL* handle) {
   return -1;
 }
 
+#ifdef OLP_SDK_NETWORK_HAS_EPOLL
+int NetworkCurl::SocketFunction(CURL* /*handle*/, curl_socket_t socket,
+                                int action, void* user_ptr,
+                                void* socket_ptr) {
+  auto network = static_cast<NetworkCurl*>(user_ptr);
+
+  if (action == CURL_POLL_REMOVE) {
+    // The socket might be already closed, so the error is ignored.
+    epoll_ctl(network->epoll_fd_, EPOLL_CTL_DEL, socket, nullptr);
+    return 0;
+  }
+
+  epoll_event event{};
+  event.data.fd = socket;
+  if (action == CURL_POLL_IN || action == CURL_POLL_INOUT) {
+    event.events |= EPOLLIN;
+  }
+  if (action == CURL_POLL_OUT || action == CURL_POLL_INOUT) {
+    event.events |= EPOLLOUT;
+  }
+
+  // socket_ptr is assigned once the socket is added to epoll.
+  const auto operation = socket_ptr ? EPOLL_CTL_MOD : EPOLL_CTL_ADD;
+  if (epoll_ctl(network->epoll_fd_, operation, socket, &event) != 0) {
+    OLP_SDK_LOG_WARNING(kLogTag, "SocketFunction - epoll_ctl failed, socket="
+                                     << socket << ", error=" << errno);
+    return 0;
+  }
+
+  if (!socket_ptr) {
+    curl_multi_assign(network->curl_, socket, network);
+  }
+  return 0;
+}
+
+int NetworkCurl::TimerFunction(CURLM* /*multi*/, long timeout_ms,
+                               void* user_ptr) {
+  auto network = static_cast<NetworkCurl*>(user_ptr);
+
+  // A negative timeout deletes the timer.
+  network->timer_set_ = timeout_ms >= 0;
+  if (network->timer_set_) {
+    network->timer_deadline_ = std::chrono::steady_clock::now() +
+                               std::chrono::milliseconds(timeout_ms);
+  }
+  return 0;
+}
+
+void NetworkCurl::PerformSocketActions() {
+  int timeout_ms = -1;
+  if (timer_set_) {
+    const auto remaining =
+        std::chrono::duration_cast<std::chrono::microseconds>(
+            timer_deadline_ - std::chrono::steady_clock::now())
+            .count();
+    // Rounded up, so the timer is expired when the wait times out.
+    timeout_ms = remaining > 0 ? static_cast<int>((remaining + 999) / 1000) : 0;
+  }
+
+  epoll_event events[kMaxSocketEvents];
+  const auto count = epoll_wait(epoll_fd_, events, kMaxSocketEvents, timeout_ms);
+  if (count < 0) {
+    if (errno != EINTR) {
+      OLP_SDK_LOG_INFO(kLogTag,
+                       "PerformSocketActions - epoll_wait failed, error="
+                           << errno);
+    }
+    return;
+  }
+
+  int running = 0;
+  for (int i = 0; i < count && IsStarted(); ++i) {
+    const auto socket = events[i].data.fd;
+    if (socket == pipe_[0]) {
+      // Empty pipe data to make sure we are clear for the next wait
+      char tmp;
+      while (read(socket, &tmp, 1) > 0) {
+      }
+      continue;
+    }
+
+    int mask = 0;
+    if (events[i].events & EPOLLIN) {
+      mask |= CURL_CSELECT_IN;
+    }
+    if (events[i].events & EPOLLOUT) {
+      mask |= CURL_CSELECT_OUT;
+    }
+    if (events[i].events & (EPOLLERR | EPOLLHUP)) {
+      mask |= CURL_CSELECT_ERR;
+    }
+    curl_multi_socket_action(curl_, socket, mask, &running);
+  }
+
+  if (IsStarted() && timer_set_ &&
+      std::chrono::steady_clock::now() >= timer_deadline_) {
+    // The callback may set a new timer during the action.
+    timer_set_ = false;
+    curl_multi_socket_action(curl_, CURL_SOCKET_TIMEOUT, 0, &running);
+  }
+}
+#endif
+
 void NetworkCurl::Run() {
   {
     std::lock_guard<std::mutex> lock(event_mutex_);
@@ -909,6 +1172,9 @@ void NetworkCurl::Run() {
         }
 
         if (event.type == EventInfo::Type::SEND_EVENT) {
+          if (event.handle->http2) {
+            EnableMultiplexing();
+          }
           auto res = curl_multi_add_handle(curl_, event.handle->handle);
           if ((res != CURLM_OK) && (res != CURLM_CALL_MULTI_PERFORM)) {
             OLP_SDK_LOG_ERROR(
@@ -951,12 +1217,18 @@ void NetworkCurl::Run() {
     //
     // Run cURL queue, i.e. upload/download
     //
+#ifdef OLP_SDK_NETWORK_HAS_EPOLL
+    // Waits for the socket events here, so the completed messages are
+    // handled right after the transfers progress.
+    PerformSocketActions();
+#else
     int running = 0;
     {
       do {
       } while (IsStarted() &&
                curl_multi_perform(curl_, &running) == CURLM_CALL_MULTI_PERFORM);
     }
+#endif
 
     //
     // Handle completed messages
@@ -1014,6 +1286,7 @@ void NetworkCurl::Run() {
       }
     }
 
+#ifndef OLP_SDK_NETWORK_HAS_EPOLL
     if (!IsStarted()) {
       continue;
     }
@@ -1082,6 +1355,7 @@ void NetworkCurl::Run() {
         // soon as curl_multi_wait tells us to do so.
       }
     }
+#endif
   }
 
   Teardown();
@@ -35,6 +35,7 @@
 #endif
 
 #include <olp/core/http/Network.h>
+#include <olp/core/http/NetworkInitializationSettings.h>
 #include <olp/core/http/NetworkRequest.h>
 
 
@@ -50,7 +51,7 @@ class NetworkCurl : public olp::http::Network,
   /**
    * @brief NetworkCurl constructor.
    */
-  explicit NetworkCurl(size_t max_requests_count);
+  explicit NetworkCurl(NetworkInitializationSettings settings);
 
   /**
    * @brief ~NetworkCurl destructor.
@@ -112,6 +113,7 @@ class NetworkCurl : public olp::http::Network,
     bool in_use{};
     bool cancelled{};
     bool skip_content{};
+    bool http2{};
     char error_text[CURL_ERROR_SIZE]{};
   };
 
@@ -248,6 +250,51 @@ class NetworkCurl : public olp::http::Network,
   static size_t HeaderFunction(char* ptr, size_t size, size_t nmemb,
                                RequestHandle* handle);
 
+  /**
+   * @brief CURL share lock callback.
+   */
+  static void LockShare(CURL* handle, curl_lock_data data,
+                        curl_lock_access access, void* user_ptr);
+
+  /**
+   * @brief CURL share unlock callback.
+   */
+  static void UnlockShare(CURL* handle, curl_lock_data data, void* user_ptr);
+
+  /**
+   * @brief Create the share handle used by all requests.
+   */
+  void SetupShare();
+
+  /**
+   * @brief Enable the HTTP/2 multiplexing on the multi handle.
+   *
+   * Called by the worker thread before the first HTTP/2 request is added, so
+   * the HTTP/1.1 only usage keeps the libcurl defaults.
+   */
+  void EnableMultiplexing();
+
+#ifdef OLP_SDK_NETWORK_HAS_EPOLL
+  /**
+   * @brief CURL socket callback. Registers the socket in epoll.
+   */
+  static int SocketFunction(CURL* handle, curl_socket_t socket, int action,
+                            void* user_ptr, void* socket_ptr);
+
+  /**
+   * @brief CURL timer callback. Stores the next timeout of the multi handle.
+   */
+  static int TimerFunction(CURLM* multi, long timeout_ms, void* user_ptr);
+
+  /**
+   * @brief Wait for socket events or the timeout and pass them to CURL.
+   *
+   * Blocks until a socket is ready, the CURL timer expires or the worker
+   * thread is notified through the pipe.
+   */
+  void PerformSocketActions();
+#endif
+
   /**
    * @brief The worker thread's main method.
    */
@@ -311,6 +358,20 @@ class NetworkCurl : public olp::http::Network,
   /// CURL multi handle. Shared among all network requests.
   CURLM* curl_{nullptr};
 
+  /// CURL share handle. Shares the DNS cache and the TLS sessions among all
+  /// network requests, so a new handle does not redo a full TLS handshake.
+  CURLSH* share_{nullptr};
+
+  /// Mutexes that guard the data of share_, one per curl_lock_data.
+  std::mutex share_mutexes_[CURL_LOCK_DATA_LAST];
+
+  /// Settings applied to the multi handle.
+  const NetworkInitializationSettings settings_;
+
+  /// Whether the HTTP/2 multiplexing is set up on the multi handle. Accessed
+  /// only by the worker thread after the initialization.
+  bool multiplexing_enabled_{false};
+
   /// Turn on and off verbose mode for CURL.
   bool verbose_{false};
 
@@ -320,6 +381,17 @@ class NetworkCurl : public olp::http::Network,
   /// UNIX Pipe used to notify sleeping worker thread during select() call.
   int pipe_[2]{};
 
+#ifdef OLP_SDK_NETWORK_HAS_EPOLL
+  /// Epoll instance that watches the CURL sockets and the notification pipe.
+  int epoll_fd_{-1};
+
+  /// Deadline of the CURL timer. Valid only when timer_set_ is true.
+  std::chrono::steady_clock::time_point timer_deadline_{};
+
+  /// Whether the CURL timer is set. Accessed only by the worker thread.
+  bool timer_set_{false};
+#endif
+
 #ifdef OLP_SDK_NETWORK_HAS_OPENSSL
   /// Mutexes that are used by OpenSSL to synchronize during concurrent
   /// network transfer.
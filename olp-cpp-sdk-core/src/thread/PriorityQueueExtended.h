@@ -86,13 +86,13 @@ class PriorityQueueExtended<T, COMPARE>::PriorityQueueExtendedImpl {
   /// Nested helper class to make an object distinguishable
   struct DistinguishableObject {
     template <class... Args>
-    DistinguishableObject(std::uint32_t id, Args... args)
+    DistinguishableObject(std::uint64_t id, Args... args)
         : id(id), obj(args...) {}
-    DistinguishableObject(std::uint32_t id, const T& obj) : id(id), obj(obj) {}
-    DistinguishableObject(std::uint32_t id, T&& obj)
+    DistinguishableObject(std::uint64_t id, const T& obj) : id(id), obj(obj) {}
+    DistinguishableObject(std::uint64_t id, T&& obj)
         : id(id), obj(std::move(obj)) {}
 
-    std::uint32_t id;
+    std::uint64_t id;
     T obj;
   };
 
@@ -112,14 +112,14 @@ class PriorityQueueExtended<T, COMPARE>::PriorityQueueExtendedImpl {
   };
 
   /// Getter for next object id. Id is used to keep equal objects FIFO order.
-  std::uint32_t GetNextId();
+  std::uint64_t GetNextId();
 
   /// internal queue container
   std::deque<DistinguishableObject> container_;
   /// prorized queue comparator
   Compare compare_;
   /// id counter
-  std::uint32_t next_id_ = 0;
+  std::uint64_t next_id_ = 0;
 };
 
 template <class T, class COMPARE>
@@ -201,14 +201,14 @@ void PriorityQueueExtended<T, COMPARE>::PriorityQueueExtendedImpl::Pop() {
 }
 
 template <class T, class COMPARE>
-std::uint32_t
+std::uint64_t
 PriorityQueueExtended<T, COMPARE>::PriorityQueueExtendedImpl::GetNextId() {
   if (container_.empty()) {
     next_id_ = 0;
   }
 
-  // TODO add renumbering of ids in case of overflow (when next_id_ equal
-  // UMAX_INT)
+  // 64 bit ids do not overflow in practice, so the FIFO order of equal objects
+  // is kept also for the long-living queues that are never empty.
   return next_id_++;
 }
 
@@ -19,58 +19,36 @@
 
 #include "olp/core/thread/ThreadPoolTaskScheduler.h"
 
-#if defined(PORTING_PLATFORM_QNX)
-#include <process.h>
-#elif defined(PORTING_PLATFORM_MAC)
-#include <pthread.h>
-#elif defined(PORTING_PLATFORM_LINUX) || defined(PORTING_PLATFORM_ANDROID)
-#ifndef _GNU_SOURCE
-#define _GNU_SOURCE 1
-#endif
-#include <pthread.h>
-#endif
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <limits>
+#include <mutex>
 #include <string>
 
 #include "olp/core/logging/Log.h"
 #include "olp/core/porting/make_unique.h"
-#include "olp/core/porting/platform.h"
-#include "olp/core/thread/SyncQueue.h"
-#include "olp/core/utils/WarningWorkarounds.h"
 #include "thread/PriorityQueueExtended.h"
+#include "thread/ThreadName.h"
 
 namespace olp {
 namespace thread {
 
 namespace {
 constexpr auto kLogTag = "ThreadPoolTaskScheduler";
-
-void SetCurrentThreadName(const std::string& thread_name) {
-  // Currently only supported for pthread users
-  OLP_SDK_CORE_UNUSED(thread_name);
-
-#if defined(PORTING_PLATFORM_MAC)
-  // Note that in Mac based systems the pthread_setname_np takes 1 argument
-  // only.
-  pthread_setname_np(thread_name.c_str());
-#elif defined(OLP_SDK_HAVE_PTHREAD_SETNAME_NP)  // Linux, Android, QNX
-  // QNX allows 100 but Linux only 16 so select min value and apply for both.
-  // If maximum length is exceeded on some systems, e.g. Linux, the name is not
-  // set at all. So better truncate it to have at least the minimum set.
-  constexpr size_t kMaxThreadNameLength = 16u;
-  std::string truncated_name = thread_name.substr(0, kMaxThreadNameLength - 1);
-  pthread_setname_np(pthread_self(), truncated_name.c_str());
-#endif  // OLP_SDK_HAVE_PTHREAD_SETNAME_NP
-}
+constexpr auto kUnlimited = std::numeric_limits<size_t>::max();
 
 struct PrioritizedTask {
   TaskScheduler::CallFuncType function;
   uint32_t priority;
+  /// The priority used for ordering, includes the aging of the task.
+  double rank;
 };
 
 struct ComparePrioritizedTask {
   bool operator()(const PrioritizedTask& lhs,
                   const PrioritizedTask& rhs) const {
-    return lhs.priority < rhs.priority;
+    return lhs.rank < rhs.rank;
   }
 };
 
@@ -80,21 +58,181 @@ class ThreadPoolTaskScheduler::QueueImpl {
  public:
   using ElementType = PrioritizedTask;
 
-  bool Pull(ElementType& element) { return sync_queue_.Pull(element); }
+  explicit QueueImpl(const ThreadPoolSettings& settings)
+      : aging_interval_(settings.aging_interval),
+        start_(std::chrono::steady_clock::now()) {
+    auto limits = settings.band_limits;
+    std::sort(limits.begin(), limits.end(),
+              [](const PriorityBandLimit& lhs, const PriorityBandLimit& rhs) {
+                return lhs.max_priority < rhs.max_priority;
+              });
+
+    bands_.resize(limits.size() + 1u);
+    for (size_t idx = 0; idx < limits.size(); ++idx) {
+      bands_[idx].max_priority = limits[idx].max_priority;
+      bands_[idx].max_threads =
+          ClampLimit(limits[idx], settings.thread_count);
+    }
+  }
+
+  /// Blocks until there is a task that can be executed. Returns false when
+  /// the queue is closed. The band of the task is returned in \p band.
+  bool Pull(ElementType& element, size_t& band) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    for (;;) {
+      if (closed_) {
+        return false;
+      }
+
+      // The first task of the band with the highest rank and free threads.
+      Band* best = nullptr;
+      for (auto& candidate : bands_) {
+        if (!candidate.queue.empty() &&
+            candidate.running < candidate.max_threads &&
+            (!best || ComparePrioritizedTask()(best->queue.front(),
+                                               candidate.queue.front()))) {
+          best = &candidate;
+        }
+      }
+
+      if (best) {
+        element = std::move(best->queue.front());
+        best->queue.pop();
+        if (best->max_threads != kUnlimited) {
+          ++best->running;
+        }
+        band = static_cast<size_t>(best - bands_.data());
+        return true;
+      }
+
+      ready_.wait(lock);
+    }
+  }
+
+  void Push(ElementType&& element) {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+
+      // Do not push on a closed queue
+      if (closed_) {
+        return;
+      }
+
+      element.rank = Rank(element.priority);
+      bands_[BandIndex(element.priority)].queue.push(std::move(element));
+    }
+    ready_.notify_one();
+  }
 
-  void Push(ElementType&& element) { sync_queue_.Push(std::move(element)); }
+  /// Marks the task pulled from the \p band as finished.
+  void Finish(size_t band) {
+    // The limits are not changed after construction, so the unlimited bands
+    // need no lock.
+    if (bands_[band].max_threads == kUnlimited) {
+      return;
+    }
 
-  void Close() { sync_queue_.Close(); }
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      auto& finished = bands_[band];
+      const bool was_full = finished.running-- == finished.max_threads;
+      if (!was_full || finished.queue.empty()) {
+        return;
+      }
+    }
+    // A task of the band can run now.
+    ready_.notify_one();
+  }
+
+  void Close() {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      closed_ = true;
+      for (auto& band : bands_) {
+        band.queue = PriorityQueue();
+      }
+    }
+    ready_.notify_all();
+  }
 
  private:
   using PriorityQueue =
       PriorityQueueExtended<ElementType, ComparePrioritizedTask>;
-  SyncQueue<ElementType, PriorityQueue> sync_queue_;
+
+  struct Band {
+    PriorityQueue queue;
+    uint32_t max_priority = std::numeric_limits<uint32_t>::max();
+    size_t max_threads = kUnlimited;
+    size_t running = 0u;
+  };
+
+  /// The tasks of a band without threads never run, and a limit which is not
+  /// lower than the pool size does not limit anything.
+  static size_t ClampLimit(const PriorityBandLimit& limit,
+                           size_t thread_count) {
+    if (limit.max_threads == 0u) {
+      OLP_SDK_LOG_WARNING_F(kLogTag,
+                            "Band limit of priority %u has no threads, "
+                            "using one thread",
+                            limit.max_priority);
+      return 1u;
+    }
+
+    if (limit.max_threads >= thread_count) {
+      OLP_SDK_LOG_WARNING_F(kLogTag,
+                            "Band limit of priority %u is not lower than the "
+                            "pool size %zu, the band is not limited",
+                            limit.max_priority, thread_count);
+      return kUnlimited;
+    }
+
+    return limit.max_threads;
+  }
+
+  size_t BandIndex(uint32_t priority) const {
+    // The last band is not limited and takes the remaining priorities.
+    size_t idx = 0u;
+    while (idx + 1u < bands_.size() && priority > bands_[idx].max_priority) {
+      ++idx;
+    }
+    return idx;
+  }
+
+  double Rank(uint32_t priority) const {
+    if (aging_interval_.count() <= 0) {
+      return priority;
+    }
+
+    // Every task gains one priority per aging interval. Subtracting the time
+    // of pushing instead of adding the time of waiting keeps the rank of the
+    // queued tasks constant, while the order is the same.
+    const std::chrono::duration<double> since_start =
+        std::chrono::steady_clock::now() - start_;
+    const std::chrono::duration<double> interval = aging_interval_;
+    return priority - since_start.count() / interval.count();
+  }
+
+  const std::chrono::milliseconds aging_interval_;
+  const std::chrono::steady_clock::time_point start_;
+  std::mutex mutex_;
+  std::condition_variable ready_;
+  /// Sorted by ascending max_priority.
+  std::vector<Band> bands_;
+  bool closed_{false};
 };
 
-ThreadPoolTaskScheduler::ThreadPoolTaskScheduler(size_t thread_count) {
-  queue_ = std::make_unique<QueueImpl>();
+ThreadPoolTaskScheduler::ThreadPoolTaskScheduler(size_t thread_count)
+    : ThreadPoolTaskScheduler([thread_count]() {
+        ThreadPoolSettings settings;
+        settings.thread_count = thread_count;
+        return settings;
+      }()) {}
+
+ThreadPoolTaskScheduler::ThreadPoolTaskScheduler(
+    const ThreadPoolSettings& settings) {
+  queue_ = std::make_unique<QueueImpl>(settings);
 
+  const auto thread_count = settings.thread_count;
   thread_pool_.reserve(thread_count);
 
   for (size_t idx = 0; idx < thread_count; ++idx) {
@@ -106,10 +244,13 @@ ThreadPoolTaskScheduler::ThreadPoolTaskScheduler(size_t thread_count) {
 
       for (;;) {
         PrioritizedTask task;
-        if (!queue_->Pull(task)) {
+        size_t band = 0u;
+        if (!queue_->Pull(task, band)) {
           return;
         }
         task.function();
+        task.function = nullptr;
+        queue_->Finish(band);
       }
     });
 
@@ -126,12 +267,12 @@ ThreadPoolTaskScheduler::~ThreadPoolTaskScheduler() {
 }
 
 void ThreadPoolTaskScheduler::EnqueueTask(TaskScheduler::CallFuncType&& func) {
-  queue_->Push({std::move(func), thread::NORMAL});
+  queue_->Push({std::move(func), thread::NORMAL, 0.0});
 }
 
 void ThreadPoolTaskScheduler::EnqueueTask(TaskScheduler::CallFuncType&& func,
                                           uint32_t priority) {
-  queue_->Push({std::move(func), priority});
+  queue_->Push({std::move(func), priority, 0.0});
 }
 
 }  // namespace thread
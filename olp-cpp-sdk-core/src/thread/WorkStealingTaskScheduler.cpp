@@ -0,0 +1,268 @@
+/*
+ * Copyright (C) 2021 HERE Europe B.V.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ * License-Filename: LICENSE
+ */
+
+#include "olp/core/thread/WorkStealingTaskScheduler.h"
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <string>
+
+#include "olp/core/logging/Log.h"
+#include "olp/core/porting/make_unique.h"
+#include "thread/ThreadName.h"
+
+namespace olp {
+namespace thread {
+
+namespace {
+constexpr auto kLogTag = "WorkStealingTaskScheduler";
+
+// Empty priority bands are kept to avoid reallocations, unless there are more
+// bands than this, e.g. when many different priorities are used.
+constexpr size_t kMaxPriorityBands = 8u;
+
+// The value of the top priority hint for an empty queue.
+constexpr uint64_t kEmptyQueue = 0u;
+
+/// The queue of a single thread. Tasks are grouped by priority, FIFO within
+/// the same priority.
+class WorkerQueue {
+ public:
+  void Push(TaskScheduler::CallFuncType&& func, uint32_t priority,
+            std::atomic<size_t>& pending) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = std::lower_bound(
+        bands_.begin(), bands_.end(), priority,
+        [](const Band& band, uint32_t value) { return band.priority > value; });
+    if (it == bands_.end() || it->priority != priority) {
+      if (bands_.size() >= kMaxPriorityBands) {
+        bands_.erase(std::remove_if(bands_.begin(), bands_.end(),
+                                    [](const Band& band) {
+                                      return band.tasks.empty();
+                                    }),
+                     bands_.end());
+        it = std::lower_bound(bands_.begin(), bands_.end(), priority,
+                              [](const Band& band, uint32_t value) {
+                                return band.priority > value;
+                              });
+      }
+      it = bands_.insert(it, Band{priority, {}});
+    }
+    it->tasks.push_back(std::move(func));
+    // Counted under the lock, so a thread that sees the pending task also
+    // finds it in the queue.
+    pending.fetch_add(1u);
+    UpdateTopPriority();
+  }
+
+  bool Pop(TaskScheduler::CallFuncType& func, std::atomic<size_t>& pending) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (auto& band : bands_) {
+      if (!band.tasks.empty()) {
+        func = std::move(band.tasks.front());
+        band.tasks.pop_front();
+        pending.fetch_sub(1u);
+        UpdateTopPriority();
+        return true;
+      }
+    }
+    return false;
+  }
+
+  /// The highest priority in the queue plus one, or kEmptyQueue. It is read
+  /// without the lock to pick the queue to take the next task from.
+  uint64_t TopPriority() const {
+    return top_priority_.load(std::memory_order_relaxed);
+  }
+
+ private:
+  struct Band {
+    uint32_t priority;
+    std::deque<TaskScheduler::CallFuncType> tasks;
+  };
+
+  void UpdateTopPriority() {
+    uint64_t top = kEmptyQueue;
+    for (const auto& band : bands_) {
+      if (!band.tasks.empty()) {
+        top = static_cast<uint64_t>(band.priority) + 1u;
+        break;
+      }
+    }
+    top_priority_.store(top, std::memory_order_relaxed);
+  }
+
+  std::mutex mutex_;
+  /// Sorted by descending priority.
+  std::vector<Band> bands_;
+  std::atomic<uint64_t> top_priority_{kEmptyQueue};
+};
+
+}  // namespace
+
+class WorkStealingTaskScheduler::Impl {
+ public:
+  explicit Impl(size_t thread_count) {
+    // At least one queue, so tasks can be scheduled without threads too.
+    const auto queue_count = std::max<size_t>(thread_count, 1u);
+    queues_.reserve(queue_count);
+    for (size_t idx = 0; idx < queue_count; ++idx) {
+      queues_.emplace_back(std::make_unique<WorkerQueue>());
+    }
+  }
+
+  void Push(TaskScheduler::CallFuncType&& func, uint32_t priority) {
+    // Tasks scheduled by a pool thread stay on this thread unless stolen.
+    const auto index = current_scheduler_ == this
+                           ? current_index_
+                           : next_queue_.fetch_add(1u, std::memory_order_relaxed) %
+                                 queues_.size();
+    queues_[index]->Push(std::move(func), priority, pending_);
+
+    // Waking up a thread is only needed when some thread sleeps, so busy
+    // threads do not touch the shared mutex.
+    if (sleeping_.load() > 0u) {
+      std::lock_guard<std::mutex> lock(sleep_mutex_);
+      sleep_cv_.notify_one();
+    }
+  }
+
+  /// Runs the tasks on the calling pool thread until the scheduler is closed.
+  void Run(size_t index) {
+    current_scheduler_ = this;
+    current_index_ = index;
+
+    TaskScheduler::CallFuncType func;
+    while (!closed_.load()) {
+      if (Take(index, func)) {
+        func();
+        func = nullptr;
+      } else if (!Wait()) {
+        break;
+      }
+    }
+
+    current_scheduler_ = nullptr;
+  }
+
+  void Close() {
+    {
+      std::lock_guard<std::mutex> lock(sleep_mutex_);
+      closed_.store(true);
+    }
+    sleep_cv_.notify_all();
+  }
+
+ private:
+  /// Takes the task with the highest priority, own queue wins the ties.
+  bool Take(size_t index, TaskScheduler::CallFuncType& func) {
+    const auto queue_count = queues_.size();
+    while (pending_.load() > 0u && !closed_.load()) {
+      auto best_index = index;
+      auto best_priority = queues_[index]->TopPriority();
+      for (size_t offset = 1u; offset < queue_count; ++offset) {
+        const auto victim = (index + offset) % queue_count;
+        const auto priority = queues_[victim]->TopPriority();
+        if (priority > best_priority) {
+          best_index = victim;
+          best_priority = priority;
+        }
+      }
+
+      if (best_priority != kEmptyQueue &&
+          queues_[best_index]->Pop(func, pending_)) {
+        return true;
+      }
+
+      // Lost the race for the task, or the hints are not yet visible.
+      std::this_thread::yield();
+    }
+    return false;
+  }
+
+  /// Blocks until there is a pending task. Returns false when closed.
+  bool Wait() {
+    std::unique_lock<std::mutex> lock(sleep_mutex_);
+    sleeping_.fetch_add(1u);
+    sleep_cv_.wait(lock,
+                   [&] { return closed_.load() || pending_.load() > 0u; });
+    sleeping_.fetch_sub(1u);
+    return !closed_.load();
+  }
+
+  static thread_local const Impl* current_scheduler_;
+  static thread_local size_t current_index_;
+
+  std::vector<std::unique_ptr<WorkerQueue>> queues_;
+  /// The round robin counter for tasks scheduled outside of the pool.
+  std::atomic<size_t> next_queue_{0u};
+  /// The number of tasks in all queues.
+  std::atomic<size_t> pending_{0u};
+  /// The number of threads waiting for tasks.
+  std::atomic<size_t> sleeping_{0u};
+  std::atomic<bool> closed_{false};
+  std::mutex sleep_mutex_;
+  std::condition_variable sleep_cv_;
+};
+
+thread_local const WorkStealingTaskScheduler::Impl*
+    WorkStealingTaskScheduler::Impl::current_scheduler_ = nullptr;
+thread_local size_t WorkStealingTaskScheduler::Impl::current_index_ = 0u;
+
+WorkStealingTaskScheduler::WorkStealingTaskScheduler(size_t thread_count)
+    : impl_(std::make_unique<Impl>(thread_count)) {
+  thread_pool_.reserve(thread_count);
+
+  for (size_t idx = 0; idx < thread_count; ++idx) {
+    std::thread executor([this, idx]() {
+      // Set thread name for easy profiling and debugging
+      std::string thread_name = "OLPSDKPOOL_" + std::to_string(idx);
+      SetCurrentThreadName(thread_name);
+      OLP_SDK_LOG_INFO_F(kLogTag, "Starting thread '%s'", thread_name.c_str());
+
+      impl_->Run(idx);
+    });
+
+    thread_pool_.push_back(std::move(executor));
+  }
+}
+
+WorkStealingTaskScheduler::~WorkStealingTaskScheduler() {
+  impl_->Close();
+  for (auto& thread : thread_pool_) {
+    thread.join();
+  }
+  thread_pool_.clear();
+}
+
+void WorkStealingTaskScheduler::EnqueueTask(
+    TaskScheduler::CallFuncType&& func) {
+  impl_->Push(std::move(func), thread::NORMAL);
+}
+
+void WorkStealingTaskScheduler::EnqueueTask(TaskScheduler::CallFuncType&& func,
+                                            uint32_t priority) {
+  impl_->Push(std::move(func), priority);
+}
+
+}  // namespace thread
+}  // namespace olp
@@ -0,0 +1,125 @@
+/*
+ * Copyright (C) 2021 HERE Europe B.V.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ * License-Filename: LICENSE
+ */
+
+#include <string>
+
+#include <gtest/gtest.h>
+
+#include <cache/CacheRecord.h>
+#include <olp/core/cache/KeyValueCache.h>
+
+namespace {
+namespace cache = olp::cache;
+
+TEST(CacheRecordTest, EncodeDecode) {
+  const std::string data{"this is key's data"};
+
+  {
+    SCOPED_TRACE("With expiry");
+
+    const time_t expiry = 1612345678;
+    const auto record = cache::CacheRecord::Encode(data, expiry, false);
+    EXPECT_EQ(record.size(), data.size() + cache::CacheRecord::kHeaderSize);
+
+    time_t decoded_expiry = 0;
+    leveldb::Slice value;
+    ASSERT_TRUE(
+        cache::CacheRecord::Decode(record, true, decoded_expiry, value));
+    EXPECT_EQ(decoded_expiry, expiry);
+    EXPECT_EQ(value.ToString(), data);
+  }
+
+  {
+    SCOPED_TRACE("Without expiry");
+
+    const auto record = cache::CacheRecord::Encode(
+        data, cache::KeyValueCache::kDefaultExpiry, true);
+
+    time_t decoded_expiry = 0;
+    leveldb::Slice value;
+    ASSERT_TRUE(
+        cache::CacheRecord::Decode(record, true, decoded_expiry, value));
+    EXPECT_EQ(decoded_expiry,
+              static_cast<time_t>(cache::KeyValueCache::kDefaultExpiry));
+    EXPECT_EQ(value.ToString(), data);
+  }
+
+  {
+    SCOPED_TRACE("Empty value");
+
+    const auto record = cache::CacheRecord::Encode({}, 1, true);
+
+    time_t decoded_expiry = 0;
+    leveldb::Slice value;
+    ASSERT_TRUE(
+        cache::CacheRecord::Decode(record, true, decoded_expiry, value));
+    EXPECT_EQ(decoded_expiry, 1);
+    EXPECT_TRUE(value.empty());
+  }
+}
+
+TEST(CacheRecordTest, DecodeFails) {
+  const std::string data{"this is key's data"};
+  time_t expiry = 0;
+  leveldb::Slice value;
+
+  {
+    SCOPED_TRACE("Record is too short");
+
+    EXPECT_FALSE(cache::CacheRecord::Decode(data.substr(0, 4), false, expiry,
+                                            value));
+  }
+
+  {
+    SCOPED_TRACE("Unknown version");
+
+    auto record = cache::CacheRecord::Encode(data, 1, false);
+    record[0] = 1;
+    EXPECT_FALSE(cache::CacheRecord::Decode(record, false, expiry, value));
+  }
+
+  {
+    SCOPED_TRACE("Checksum mismatch");
+
+    auto record = cache::CacheRecord::Encode(data, 1, true);
+    record.back() ^= 0x01;
+    EXPECT_FALSE(cache::CacheRecord::Decode(record, true, expiry, value));
+
+    // The checksum is not verified unless requested
+    EXPECT_TRUE(cache::CacheRecord::Decode(record, false, expiry, value));
+  }
+}
+
+TEST(CacheRecordTest, InValueLog) {
+  const std::string location(16u, 'l');
+
+  const auto record = cache::CacheRecord::Encode(location, 1, true, true);
+  EXPECT_TRUE(cache::CacheRecord::IsInValueLog(record));
+
+  time_t expiry = 0;
+  leveldb::Slice value;
+  ASSERT_TRUE(cache::CacheRecord::Decode(record, true, expiry, value));
+  EXPECT_EQ(expiry, 1);
+  EXPECT_EQ(value.ToString(), location);
+
+  EXPECT_FALSE(cache::CacheRecord::IsInValueLog(
+      cache::CacheRecord::Encode(location, 1, true)));
+  EXPECT_FALSE(cache::CacheRecord::IsInValueLog(location.substr(0, 4)));
+}
+}  // namespace
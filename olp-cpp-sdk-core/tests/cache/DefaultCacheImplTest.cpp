@@ -18,11 +18,14 @@
  */
 
 #include <chrono>
+#include <cstdio>
 #include <thread>
 
 #include <gtest/gtest.h>
 
+#include <cache/CacheRecord.h>
 #include <cache/DefaultCacheImpl.h>
+#include <olp/core/porting/make_unique.h>
 #include <olp/core/utils/Dir.h>
 #include <boost/uuid/uuid_generators.hpp>
 #include <boost/uuid/uuid_io.hpp>
@@ -33,6 +36,8 @@ namespace {
 namespace cache = olp::cache;
 using CacheType = cache::DefaultCache::CacheType;
 
+constexpr auto kHeaderSize = cache::CacheRecord::kHeaderSize;
+
 class DefaultCacheImplTest : public ::testing::Test {
  public:
   void SetUp() override {
@@ -100,21 +105,6 @@ class DefaultCacheImplHelper : public cache::DefaultCacheImpl {
     return disk_cache->Get(key) != boost::none;
   }
 
-  uint64_t CalculateExpirySize(const std::string& key) const {
-    const auto expiry_key = GetExpiryKey(key);
-    const auto& disk_cache = GetCache(CacheType::kMutable);
-    if (!disk_cache) {
-      return 0u;
-    }
-
-    const auto expiry_str = disk_cache->Get(expiry_key).get_value_or({});
-    if (expiry_str.empty()) {
-      return 0u;
-    }
-
-    return expiry_key.size() + expiry_str.size();
-  }
-
   DiskLruCache::const_iterator BeginLru() {
     const auto& lru_cache = GetMutableCacheLru();
     if (!lru_cache) {
@@ -136,6 +126,37 @@ class DefaultCacheImplHelper : public cache::DefaultCacheImpl {
   void SetEvictionPortion(uint64_t size) {
     cache::DefaultCacheImpl::SetEvictionPortion(size);
   }
+
+  void SetLruScanThreshold(uint64_t size) {
+    cache::DefaultCacheImpl::SetLruScanThreshold(size);
+  }
+
+  void SetLruSnapshotMutations(uint64_t count) {
+    cache::DefaultCacheImpl::SetLruSnapshotMutations(count);
+  }
+
+  bool IsLruScanInProgress() const {
+    return cache::DefaultCacheImpl::IsLruScanInProgress();
+  }
+
+  void WaitForLruScan() const {
+    while (IsLruScanInProgress()) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+  }
+
+  void WaitForEviction() { cache::DefaultCacheImpl::WaitForEviction(); }
+
+  std::vector<std::string> GetLruKeys() const {
+    std::vector<std::string> keys;
+    const auto& lru_cache = GetMutableCacheLru();
+    if (lru_cache) {
+      for (const auto& entry : *lru_cache) {
+        keys.push_back(entry.key());
+      }
+    }
+    return keys;
+  }
 };
 
 TEST_F(DefaultCacheImplTest, LruCache) {
@@ -470,13 +491,13 @@ TEST_F(DefaultCacheImplTest, MutableCacheSize) {
 
     cache.Put(key1, data_string, [=]() { return data_string; },
               (std::numeric_limits<time_t>::max)());
-    auto data_size = key1.size() + data_string.size();
+    auto data_size = key1.size() + data_string.size() + kHeaderSize;
 
     EXPECT_EQ(data_size, cache.Size(CacheType::kMutable));
 
     cache.Put(key2, data_string, [=]() { return data_string; }, expiry);
     data_size +=
-        key2.size() + data_string.size() + cache.CalculateExpirySize(key2);
+        key2.size() + data_string.size() + kHeaderSize;
 
     EXPECT_EQ(data_size, cache.Size(CacheType::kMutable));
   }
@@ -490,13 +511,13 @@ TEST_F(DefaultCacheImplTest, MutableCacheSize) {
     cache.Clear();
 
     cache.Put(key1, data_ptr, (std::numeric_limits<time_t>::max)());
-    auto data_size = key1.size() + binary_data.size();
+    auto data_size = key1.size() + binary_data.size() + kHeaderSize;
 
     EXPECT_EQ(data_size, cache.Size(CacheType::kMutable));
 
     cache.Put(key2, data_ptr, expiry);
     data_size +=
-        key2.size() + binary_data.size() + cache.CalculateExpirySize(key2);
+        key2.size() + binary_data.size() + kHeaderSize;
 
     EXPECT_EQ(data_size, cache.Size(CacheType::kMutable));
   }
@@ -547,7 +568,7 @@ TEST_F(DefaultCacheImplTest, MutableCacheSize) {
     cache.Put(key2, data_ptr, expiry);
     cache.Put(key3, data_string, [=]() { return data_string; }, expiry);
     const auto data_size =
-        key3.size() + data_string.size() + cache.CalculateExpirySize(key3);
+        key3.size() + data_string.size() + kHeaderSize;
 
     cache.RemoveKeysWithPrefix(invalid_key);
     cache.RemoveKeysWithPrefix("some");
@@ -615,7 +636,7 @@ TEST_F(DefaultCacheImplTest, MutableCacheSize) {
     auto total_size = 0u;
     for (; count < max_count; ++count) {
       const auto key = prefix + std::to_string(count);
-      const auto elem_size = key.size() + binary_data.size();
+      const auto elem_size = key.size() + binary_data.size() + kHeaderSize;
       if (total_size + elem_size > settings.max_disk_storage) {
         break;
       }
@@ -755,6 +776,7 @@ TEST_F(DefaultCacheImplTest, LruCacheEviction) {
     EXPECT_TRUE(cache.ContainsLru(key));
 
     // some items are removed, because eviction starts before the cache is full
+    cache.WaitForEviction();
     EXPECT_FALSE(cache.ContainsMutableCache(evicted_key));
     EXPECT_FALSE(cache.ContainsMemoryCache(evicted_key));
     EXPECT_FALSE(cache.ContainsLru(evicted_key));
@@ -807,6 +829,44 @@ TEST_F(DefaultCacheImplTest, LruCacheEviction) {
   }
 }
 
+TEST_F(DefaultCacheImplTest, BackgroundEviction) {
+  const auto data_size = 1024u;
+  const auto value = std::make_shared<std::vector<unsigned char>>(data_size);
+  cache::CacheSettings settings;
+  settings.disk_path_mutable = cache_path_;
+  settings.eviction_policy = cache::EvictionPolicy::kLeastRecentlyUsed;
+  settings.max_disk_storage = 2u * 1024u * 1024u;
+  DefaultCacheImplHelper cache(settings);
+
+  ASSERT_EQ(cache.Open(), cache::DefaultCache::Success);
+  ASSERT_TRUE(cache.Clear());
+
+  // Fill the cache up to the high watermark, below the maximum size. The
+  // eviction may already run meanwhile.
+  const auto high_watermark = settings.max_disk_storage * 9u / 10u;
+  auto count = 0u;
+  while (cache.Size(CacheType::kMutable) < high_watermark) {
+    ASSERT_TRUE(cache.Put("key" + std::to_string(count++), value,
+                          (std::numeric_limits<time_t>::max)()));
+  }
+  ASSERT_LT(cache.Size(CacheType::kMutable), settings.max_disk_storage);
+
+  cache.WaitForEviction();
+
+  // The least recently used values are evicted down to the low watermark
+  const auto low_watermark = settings.max_disk_storage * 85u / 100u;
+  EXPECT_LE(cache.Size(CacheType::kMutable), low_watermark);
+  EXPECT_FALSE(cache.ContainsMutableCache("key0"));
+  EXPECT_FALSE(cache.ContainsLru("key0"));
+  EXPECT_TRUE(cache.ContainsMutableCache("key" + std::to_string(count - 1)));
+
+  const auto statistics = cache.GetEvictionStatistics();
+  EXPECT_GE(statistics.runs, 1u);
+  EXPECT_GT(statistics.evicted_count, 0u);
+  EXPECT_GE(statistics.evicted_bytes, high_watermark - low_watermark);
+  EXPECT_GT(statistics.time.count(), 0);
+}
+
 TEST_F(DefaultCacheImplTest, ProtectTest) {
   const std::string key1_data_string = "this is key1's data";
   const std::string key2_data_string = "this is key2's data";
@@ -952,6 +1012,7 @@ TEST_F(DefaultCacheImplTest, LruCacheEvictionWithProtected) {
               std::make_shared<std::vector<unsigned char>>(binary_data),
               (std::numeric_limits<time_t>::max)());
     // mutable cache updated
+    cache.WaitForEviction();
     EXPECT_FALSE(cache.ContainsMutableCache(evicted_key));
     cache.Clear();
   }
@@ -988,6 +1049,78 @@ TEST_F(DefaultCacheImplTest, ReadOnlyPartitionForProtectedCache) {
   helpers::MakeDirectoryAndContentReadonly(cache_path_, false);
 }
 
+TEST_F(DefaultCacheImplTest, UpgradeLegacyFormat) {
+  const std::string key1{"somekey1"};
+  const std::string key2{"somekey2"};
+  const std::string expired_key{"somekey3"};
+  const std::string data_string{"this is key's data"};
+  const auto now = std::time(nullptr);
+
+  {
+    SCOPED_TRACE("Write the cache with separate expiry keys");
+
+    cache::DiskCache disk_cache;
+    ASSERT_EQ(cache::OpenResult::Success,
+              disk_cache.Open(cache_path_, cache_path_,
+                              cache::StorageSettings{},
+                              cache::OpenOptions::Default));
+
+    auto batch = std::make_unique<leveldb::WriteBatch>();
+    batch->Put(key1, data_string);
+    batch->Put(key2, data_string);
+    batch->Put(key2 + "::expiry", std::to_string(now + 1000));
+    batch->Put(expired_key, data_string);
+    batch->Put(expired_key + "::expiry", std::to_string(now - 1));
+    ASSERT_TRUE(disk_cache.ApplyBatch(std::move(batch)).IsSuccessful());
+  }
+
+  cache::CacheSettings settings;
+  settings.disk_path_mutable = cache_path_;
+  settings.max_memory_cache_size = 0;
+  DefaultCacheImplHelper cache(settings);
+  ASSERT_EQ(olp::cache::DefaultCache::StorageOpenResult::Success,
+            cache.Open());
+
+  {
+    SCOPED_TRACE("Expiry keys are removed");
+
+    EXPECT_FALSE(cache.ContainsMutableCache(key2 + "::expiry"));
+    EXPECT_FALSE(cache.ContainsMutableCache(expired_key + "::expiry"));
+    EXPECT_EQ(cache.Size(CacheType::kMutable),
+              key1.size() + key2.size() + expired_key.size() +
+                  3u * (data_string.size() + kHeaderSize));
+  }
+
+  {
+    SCOPED_TRACE("Values and expiry are kept");
+
+    const auto value1 =
+        cache.Get(key1, [](const std::string& value) { return value; });
+    ASSERT_FALSE(value1.empty());
+    EXPECT_EQ(data_string, boost::any_cast<std::string>(value1));
+
+    const auto value2 = cache.Get(key2);
+    ASSERT_NE(nullptr, value2.get());
+    EXPECT_EQ(data_string, std::string(value2->begin(), value2->end()));
+
+    EXPECT_TRUE(cache.Contains(key2));
+    EXPECT_FALSE(cache.Contains(expired_key));
+    EXPECT_EQ(nullptr, cache.Get(expired_key).get());
+  }
+
+  {
+    SCOPED_TRACE("Upgraded cache is reopened");
+
+    cache.Close();
+    ASSERT_EQ(olp::cache::DefaultCache::StorageOpenResult::Success,
+              cache.Open());
+
+    const auto value = cache.Get(key2);
+    ASSERT_NE(nullptr, value.get());
+    EXPECT_EQ(data_string, std::string(value->begin(), value->end()));
+  }
+}
+
 TEST_F(DefaultCacheImplTest, ProtectTestWithoutMutableCache) {
   const std::string key1_data_string = "this is key1's data";
   const std::string key1 = "key1";
@@ -1210,7 +1343,7 @@ TEST_F(DefaultCacheImplTest, SetMaxMutableSize) {
                 expiry);
 
       const auto size =
-          key.size() + binary_data.size() + cache.CalculateExpirySize(key);
+          key.size() + binary_data.size() + kHeaderSize;
       sizes.push_back(size);
       total_size += size;
     }
@@ -1240,7 +1373,7 @@ TEST_F(DefaultCacheImplTest, SetMaxMutableSize) {
       left_size += sizes[i];
     }
 
-    const auto new_max_size = 50;
+    const auto new_max_size = 110;
     const auto max_disk_used_threshold = 0.85;
     EXPECT_EQ(cache.Size(new_max_size), total_size - left_size);
     EXPECT_EQ(cache.Size(CacheType::kMutable), left_size);
@@ -1260,7 +1393,7 @@ TEST_F(DefaultCacheImplTest, SetMaxMutableSize) {
     cache.Put(key, std::make_shared<std::vector<unsigned char>>(binary_data),
               1);
     const auto new_item_size =
-        key.size() + binary_data.size() + cache.CalculateExpirySize(key);
+        key.size() + binary_data.size() + kHeaderSize;
 
     EXPECT_EQ(cache.Size(CacheType::kMutable), total_size + new_item_size);
   }
@@ -1315,4 +1448,231 @@ TEST_F(DefaultCacheImplTest, ProtectedCacheSize) {
 
   EXPECT_LT(std::fabs(diff_percentage), acceptable_diff_percentage);
 }
+
+TEST_F(DefaultCacheImplTest, LruSnapshot) {
+  cache::CacheSettings settings;
+  settings.disk_path_mutable = cache_path_;
+  const auto snapshot_path = cache_path_ + "/lru_snapshot";
+  const auto data = std::make_shared<std::vector<unsigned char>>(100u, 'a');
+
+  std::vector<std::string> lru_keys;
+  uint64_t size = 0u;
+
+  {
+    DefaultCacheImplHelper cache(settings);
+    ASSERT_EQ(cache.Open(), cache::DefaultCache::StorageOpenResult::Success);
+    for (auto i = 0; i < 10; ++i) {
+      cache.Put("key_" + std::to_string(i), data,
+                (std::numeric_limits<time_t>::max)());
+    }
+    cache.Get("key_3");
+    cache.Get("key_7");
+
+    lru_keys = cache.GetLruKeys();
+    size = cache.Size(CacheType::kMutable);
+    ASSERT_EQ(lru_keys.size(), 10u);
+    EXPECT_EQ(lru_keys.front(), "key_7");
+  }
+
+  {
+    SCOPED_TRACE("Loaded from snapshot");
+
+    ASSERT_TRUE(olp::utils::Dir::FileExists(snapshot_path));
+
+    DefaultCacheImplHelper cache(settings);
+    ASSERT_EQ(cache.Open(), cache::DefaultCache::StorageOpenResult::Success);
+    EXPECT_FALSE(cache.IsLruScanInProgress());
+    EXPECT_EQ(cache.GetLruKeys(), lru_keys);
+    EXPECT_EQ(cache.Size(CacheType::kMutable), size);
+
+    // The snapshot is invalidated on open
+    EXPECT_FALSE(olp::utils::Dir::FileExists(snapshot_path));
+    EXPECT_FALSE(cache.ContainsMutableCache("internal::lru_snapshot"));
+  }
+
+  {
+    SCOPED_TRACE("Rebuilt without snapshot");
+
+    ASSERT_TRUE(olp::utils::Dir::FileExists(snapshot_path));
+    ASSERT_EQ(std::remove(snapshot_path.c_str()), 0);
+
+    DefaultCacheImplHelper cache(settings);
+    ASSERT_EQ(cache.Open(), cache::DefaultCache::StorageOpenResult::Success);
+    EXPECT_FALSE(cache.IsLruScanInProgress());
+    EXPECT_EQ(cache.GetLruKeys().size(), lru_keys.size());
+    EXPECT_EQ(cache.Size(CacheType::kMutable), size);
+  }
+
+  {
+    SCOPED_TRACE("Invalidated with the LRU disabled");
+
+    ASSERT_TRUE(olp::utils::Dir::FileExists(snapshot_path));
+
+    auto no_lru_settings = settings;
+    no_lru_settings.eviction_policy = cache::EvictionPolicy::kNone;
+    DefaultCacheImplHelper no_lru_cache(no_lru_settings);
+    ASSERT_EQ(no_lru_cache.Open(),
+              cache::DefaultCache::StorageOpenResult::Success);
+    EXPECT_FALSE(olp::utils::Dir::FileExists(snapshot_path));
+    EXPECT_FALSE(no_lru_cache.ContainsMutableCache("internal::lru_snapshot"));
+    ASSERT_TRUE(no_lru_cache.Put("new_key", data,
+                                 (std::numeric_limits<time_t>::max)()));
+    no_lru_cache.Close();
+
+    // The LRU is rebuilt with the key written meanwhile
+    DefaultCacheImplHelper cache(settings);
+    ASSERT_EQ(cache.Open(), cache::DefaultCache::StorageOpenResult::Success);
+    EXPECT_EQ(cache.GetLruKeys().size(), lru_keys.size() + 1u);
+    EXPECT_TRUE(cache.ContainsLru("new_key"));
+  }
+}
+
+TEST_F(DefaultCacheImplTest, LruSnapshotSavedPeriodically) {
+  cache::CacheSettings settings;
+  settings.disk_path_mutable = cache_path_;
+  const auto snapshot_path = cache_path_ + "/lru_snapshot";
+  const auto data = std::make_shared<std::vector<unsigned char>>(100u, 'a');
+  constexpr auto kMutations = 5;
+
+  DefaultCacheImplHelper cache(settings);
+  cache.SetLruSnapshotMutations(kMutations);
+  ASSERT_EQ(cache.Open(), cache::DefaultCache::StorageOpenResult::Success);
+
+  {
+    SCOPED_TRACE("Saved after the mutations");
+
+    for (auto i = 0; i < kMutations; ++i) {
+      ASSERT_TRUE(cache.Put("key_" + std::to_string(i), data,
+                            (std::numeric_limits<time_t>::max)()));
+    }
+
+    while (!olp::utils::Dir::FileExists(snapshot_path)) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    cache.WaitForEviction();
+
+    EXPECT_TRUE(cache.ContainsMutableCache("internal::lru_snapshot"));
+  }
+
+  {
+    SCOPED_TRACE("Invalidated by the next write");
+
+    ASSERT_TRUE(cache.Put("new_key", data,
+                          (std::numeric_limits<time_t>::max)()));
+    EXPECT_FALSE(cache.ContainsMutableCache("internal::lru_snapshot"));
+  }
+}
+
+TEST_F(DefaultCacheImplTest, ValueLogCollectedOnRemove) {
+  cache::CacheSettings settings;
+  settings.disk_path_mutable = cache_path_;
+  settings.max_disk_storage = 512u * 1024u;
+  settings.max_file_size = 16u * 1024u;
+  settings.large_value_threshold = 1024u;
+  const auto value_log_path = cache_path_ + "/value_log";
+  const auto data = std::make_shared<std::vector<unsigned char>>(4096u, 'a');
+  constexpr auto kValues = 32;
+
+  DefaultCacheImplHelper cache(settings);
+  ASSERT_EQ(cache.Open(), cache::DefaultCache::StorageOpenResult::Success);
+  for (auto i = 0; i < kValues; ++i) {
+    ASSERT_TRUE(cache.Put("key_" + std::to_string(i), data,
+                          (std::numeric_limits<time_t>::max)()));
+  }
+
+  {
+    SCOPED_TRACE("Released values are accounted");
+
+    const auto size = cache.Size(CacheType::kMutable);
+    ASSERT_TRUE(cache.Remove("key_" + std::to_string(kValues - 1)));
+    EXPECT_GT(cache.Size(CacheType::kMutable), size - data->size());
+
+    ASSERT_TRUE(cache.Put("key_" + std::to_string(kValues - 2), data,
+                          (std::numeric_limits<time_t>::max)()));
+    EXPECT_GT(cache.Size(CacheType::kMutable), size);
+  }
+
+  {
+    SCOPED_TRACE("Collected after the removal");
+
+    const auto log_size = olp::utils::Dir::Size(value_log_path);
+    for (auto i = 0; i < kValues / 2; ++i) {
+      ASSERT_TRUE(cache.Remove("key_" + std::to_string(i)));
+    }
+    cache.WaitForEviction();
+
+    EXPECT_LT(olp::utils::Dir::Size(value_log_path),
+              log_size - kValues / 4 * data->size());
+    const auto value = cache.Get("key_" + std::to_string(kValues / 2));
+    ASSERT_TRUE(value != nullptr);
+    EXPECT_EQ(*value, *data);
+  }
+}
+
+TEST_F(DefaultCacheImplTest, LruBackgroundScan) {
+  cache::CacheSettings settings;
+  settings.disk_path_mutable = cache_path_;
+  const auto data = std::make_shared<std::vector<unsigned char>>(100u, 'a');
+  constexpr auto kKeyCount = 3000;
+
+  uint64_t size = 0u;
+  {
+    DefaultCacheImplHelper cache(settings);
+    ASSERT_EQ(cache.Open(), cache::DefaultCache::StorageOpenResult::Success);
+    for (auto i = 0; i < kKeyCount; ++i) {
+      cache.Put("key_" + std::to_string(i), data,
+                (std::numeric_limits<time_t>::max)());
+    }
+    size = cache.Size(CacheType::kMutable);
+  }
+  const auto snapshot_path = cache_path_ + "/lru_snapshot";
+  ASSERT_EQ(std::remove(snapshot_path.c_str()), 0);
+
+  DefaultCacheImplHelper cache(settings);
+  cache.SetLruScanThreshold(0u);
+  ASSERT_EQ(cache.Open(), cache::DefaultCache::StorageOpenResult::Success);
+
+  {
+    SCOPED_TRACE("Served while scanning");
+
+    const auto key = "key_" + std::to_string(kKeyCount - 1);
+    EXPECT_TRUE(cache.Contains(key));
+    EXPECT_TRUE(cache.Get(key) != nullptr);
+
+    const std::string new_key = "new_key";
+    ASSERT_TRUE(cache.Put(new_key, data, (std::numeric_limits<time_t>::max)()));
+    size += new_key.size() + data->size() + kHeaderSize;
+
+    EXPECT_TRUE(cache.Remove("key_0"));
+    size -= std::string("key_0").size() + data->size() + kHeaderSize;
+  }
+
+  {
+    SCOPED_TRACE("Scan completed");
+
+    cache.WaitForLruScan();
+
+    const auto lru_keys = cache.GetLruKeys();
+    ASSERT_EQ(lru_keys.size(), static_cast<size_t>(kKeyCount));
+    EXPECT_EQ(lru_keys.front(), "new_key");
+    EXPECT_FALSE(cache.ContainsLru("key_0"));
+    EXPECT_EQ(cache.Size(CacheType::kMutable), size);
+  }
+
+  {
+    SCOPED_TRACE("Closed while scanning");
+
+    cache.Close();
+    ASSERT_EQ(std::remove(snapshot_path.c_str()), 0);
+
+    // Close stops the scan
+    DefaultCacheImplHelper scanning_cache(settings);
+    scanning_cache.SetLruScanThreshold(0u);
+    ASSERT_EQ(scanning_cache.Open(),
+              cache::DefaultCache::StorageOpenResult::Success);
+    scanning_cache.Close();
+
+    EXPECT_FALSE(scanning_cache.IsLruScanInProgress());
+  }
+}
 }  // namespace
@@ -17,10 +17,12 @@
  * License-Filename: LICENSE
  */
 
+#include <atomic>
 #include <chrono>
 #include <fstream>
 #include <string>
 #include <thread>
+#include <vector>
 
 #include <gtest/gtest.h>
 
@@ -686,6 +688,247 @@ TEST(DefaultCacheTest, OpenTypeCache) {
   }
 }
 
+TEST(DefaultCacheTest, LargeValues) {
+  olp::cache::CacheSettings settings;
+  settings.disk_path_mutable = kTempDirMutable;
+  settings.max_memory_cache_size = 0;
+  settings.large_value_threshold = 8u;
+
+  olp::utils::Dir::Remove(kTempDirMutable);
+
+  {
+    SCOPED_TRACE("Basic operations");
+
+    BasicCacheTestWithSettings(settings);
+  }
+
+  const std::string small_data{"small"};
+  const std::string large_data(1024u, 'l');
+  const auto decoder = [](const std::string& data) { return data; };
+
+  {
+    SCOPED_TRACE("Put, Remove");
+
+    olp::cache::DefaultCache cache(settings);
+    ASSERT_EQ(olp::cache::DefaultCache::Success, cache.Open());
+    ASSERT_TRUE(cache.Clear());
+
+    ASSERT_TRUE(cache.Put("small", small_data, [=]() { return small_data; },
+                          kDefaultExpiry));
+    ASSERT_TRUE(cache.Put("large", large_data, [=]() { return large_data; },
+                          kDefaultExpiry));
+    ASSERT_TRUE(cache.Put("removed", large_data, [=]() { return large_data; },
+                          kDefaultExpiry));
+    EXPECT_TRUE(olp::utils::Dir::Exists(kTempDirMutable + "/value_log"));
+    EXPECT_GE(cache.Size(CacheType::kMutable), 2u * large_data.size());
+
+    // The removed value is accounted until its segment is collected.
+    ASSERT_TRUE(cache.Remove("removed"));
+    EXPECT_FALSE(cache.Contains("removed"));
+    EXPECT_GE(cache.Size(CacheType::kMutable), 2u * large_data.size());
+  }
+
+  {
+    SCOPED_TRACE("Reopen");
+
+    olp::cache::DefaultCache cache(settings);
+    ASSERT_EQ(olp::cache::DefaultCache::Success, cache.Open());
+
+    EXPECT_EQ(boost::any_cast<std::string>(cache.Get("small", decoder)),
+              small_data);
+    EXPECT_EQ(boost::any_cast<std::string>(cache.Get("large", decoder)),
+              large_data);
+    EXPECT_TRUE(cache.Get("removed", decoder).empty());
+
+    const auto values = cache.GetBatch({"large", "small"});
+    ASSERT_EQ(values.size(), 2u);
+    ASSERT_NE(values[0], nullptr);
+    EXPECT_EQ(std::string(values[0]->begin(), values[0]->end()), large_data);
+    ASSERT_NE(values[1], nullptr);
+    EXPECT_EQ(std::string(values[1]->begin(), values[1]->end()), small_data);
+  }
+
+  {
+    SCOPED_TRACE("Threshold unset, values are still read");
+
+    auto no_threshold_settings = settings;
+    no_threshold_settings.large_value_threshold = 0u;
+
+    olp::cache::DefaultCache cache(no_threshold_settings);
+    ASSERT_EQ(olp::cache::DefaultCache::Success, cache.Open());
+    EXPECT_EQ(boost::any_cast<std::string>(cache.Get("large", decoder)),
+              large_data);
+    ASSERT_TRUE(cache.Clear());
+  }
+
+  olp::utils::Dir::Remove(kTempDirMutable);
+}
+
+TEST(DefaultCacheTest, LargeValuesEviction) {
+  olp::cache::CacheSettings settings;
+  settings.disk_path_mutable = kTempDirMutable;
+  settings.max_memory_cache_size = 0;
+  settings.max_disk_storage = 512u * 1024u;
+  settings.max_file_size = 32u * 1024u;
+  settings.large_value_threshold = 1024u;
+
+  olp::utils::Dir::Remove(kTempDirMutable);
+
+  const std::string data(16u * 1024u, 'l');
+  const auto decoder = [](const std::string& data) { return data; };
+  const auto value_log_path = kTempDirMutable + "/value_log";
+
+  olp::cache::DefaultCache cache(settings);
+  ASSERT_EQ(olp::cache::DefaultCache::Success, cache.Open());
+
+  // Write four times the cache size, so the old values are evicted.
+  constexpr auto kValues = 128;
+  for (auto i = 0; i < kValues; ++i) {
+    ASSERT_TRUE(cache.Put("key" + std::to_string(i), data,
+                          [=]() { return data; }, kDefaultExpiry));
+  }
+
+  EXPECT_LE(cache.Size(CacheType::kMutable), settings.max_disk_storage);
+  EXPECT_TRUE(cache.Get("key0", decoder).empty());
+  EXPECT_EQ(boost::any_cast<std::string>(
+                cache.Get("key" + std::to_string(kValues - 1), decoder)),
+            data);
+
+  // The segments of the evicted values are removed.
+  EXPECT_LT(olp::utils::Dir::Size(value_log_path),
+            2u * settings.max_disk_storage);
+
+  // The compaction moves the remaining values out of the old segments.
+  cache.Compact();
+  EXPECT_LT(olp::utils::Dir::Size(value_log_path),
+            2u * settings.max_disk_storage);
+  EXPECT_EQ(boost::any_cast<std::string>(
+                cache.Get("key" + std::to_string(kValues - 1), decoder)),
+            data);
+
+  cache.Close();
+  olp::utils::Dir::Remove(kTempDirMutable);
+}
+
+TEST(DefaultCacheTest, LargeValuesConcurrentPutAndCollect) {
+  olp::cache::CacheSettings settings;
+  settings.disk_path_mutable = kTempDirMutable;
+  settings.max_memory_cache_size = 0;
+  settings.max_disk_storage = 256u * 1024u;
+  settings.max_file_size = 16u * 1024u;
+  settings.large_value_threshold = 1024u;
+
+  olp::utils::Dir::Remove(kTempDirMutable);
+
+  const auto decoder = [](const std::string& data) { return data; };
+  const auto make_value = [](const std::string& key) {
+    return key + std::string(4u * 1024u, 'v');
+  };
+
+  olp::cache::DefaultCache cache(settings);
+  ASSERT_EQ(olp::cache::DefaultCache::Success, cache.Open());
+
+  // The writers fill the cache several times over and remove most of their
+  // values, so the eviction collects the segments the other writers append
+  // to while their records are not written yet.
+  constexpr auto kThreads = 4;
+  constexpr auto kValues = 400;
+  std::atomic<int> lost_values{0};
+
+  std::vector<std::thread> threads;
+  for (auto thread = 0; thread < kThreads; ++thread) {
+    threads.emplace_back([&, thread]() {
+      const auto prefix = "key" + std::to_string(thread) + "_";
+      for (auto i = 0; i < kValues; ++i) {
+        const auto key = prefix + std::to_string(i);
+        const auto value = make_value(key);
+        if (!cache.Put(key, value, [=]() { return value; }, kDefaultExpiry)) {
+          continue;
+        }
+
+        if (i % 3 != 0) {
+          cache.Remove(key);
+          continue;
+        }
+
+        // The value can be evicted by the other writers meanwhile, but not
+        // lost while its record is still in the cache.
+        const auto result = cache.Get(key, decoder);
+        if (result.empty() ? cache.Contains(key)
+                           : boost::any_cast<std::string>(result) != value) {
+          ++lost_values;
+        }
+      }
+    });
+  }
+
+  for (auto& thread : threads) {
+    thread.join();
+  }
+
+  EXPECT_EQ(lost_values.load(), 0);
+
+  // The value stays readable after the garbage collection.
+  const std::string key = "last";
+  const auto value = make_value(key);
+  ASSERT_TRUE(cache.Put(key, value, [=]() { return value; }, kDefaultExpiry));
+  cache.Compact();
+  const auto result = cache.Get(key, decoder);
+  ASSERT_FALSE(result.empty());
+  EXPECT_EQ(boost::any_cast<std::string>(result), value);
+
+  cache.Close();
+  olp::utils::Dir::Remove(kTempDirMutable);
+}
+
+TEST(DefaultCacheTest, Statistics) {
+  olp::cache::CacheSettings settings;
+  settings.disk_path_mutable = kTempDirMutable;
+
+  olp::utils::Dir::Remove(kTempDirMutable);
+
+  const std::string data(1024u, 's');
+  const auto decoder = [](const std::string& data) { return data; };
+
+  olp::cache::DefaultCache cache(settings);
+  ASSERT_EQ(olp::cache::DefaultCache::Success, cache.Open());
+
+  ASSERT_TRUE(cache.Put("key", data, [=]() { return data; }, kDefaultExpiry));
+  EXPECT_FALSE(cache.Get("key", decoder).empty());
+  EXPECT_TRUE(cache.Get("missing", decoder).empty());
+
+  auto statistics = cache.GetStatistics();
+  EXPECT_EQ(statistics.memory.hits, 1u);
+  EXPECT_EQ(statistics.memory.misses, 1u);
+  EXPECT_EQ(statistics.mutable_cache.hits, 0u);
+  EXPECT_EQ(statistics.mutable_cache.misses, 1u);
+  EXPECT_EQ(statistics.protected_cache.hits, 0u);
+  EXPECT_EQ(statistics.protected_cache.misses, 0u);
+  EXPECT_EQ(statistics.bytes_read, 0u);
+  EXPECT_GT(statistics.bytes_written, data.size());
+  EXPECT_EQ(statistics.compactions, 0u);
+  EXPECT_FALSE(statistics.storage_statistics.empty());
+
+  // The reopened cache reads the value from disk
+  cache.Close();
+  ASSERT_EQ(olp::cache::DefaultCache::Success, cache.Open());
+  EXPECT_FALSE(cache.Get("key", decoder).empty());
+  cache.Compact();
+
+  statistics = cache.GetStatistics();
+  EXPECT_EQ(statistics.memory.hits, 1u);
+  EXPECT_EQ(statistics.memory.misses, 2u);
+  EXPECT_EQ(statistics.mutable_cache.hits, 1u);
+  EXPECT_EQ(statistics.mutable_cache.misses, 1u);
+  EXPECT_EQ(statistics.bytes_read, data.size());
+  EXPECT_EQ(statistics.compactions, 1u);
+  EXPECT_EQ(statistics.eviction.runs, 0u);
+
+  cache.Close();
+  EXPECT_TRUE(cache.GetStatistics().storage_statistics.empty());
+  olp::utils::Dir::Remove(kTempDirMutable);
+}
+
 struct TestParameters {
   OptionalString disk_path_mutable = kTempDirMutable;
   OptionalString disk_path_protected = boost::none;
@@ -920,6 +1163,116 @@ TEST_P(DefaultCacheParamTest, RemoveWithPrefix) {
   }
 }
 
+TEST_P(DefaultCacheParamTest, Batch) {
+  const auto decoder = [](const std::string& data) { return data; };
+  const KeyValueCache::KeyListType keys{"key3", "key1", "missing", "key2"};
+
+  KeyValueCache::BatchItemListType items;
+  for (const auto& key : {"key1", "key2", "key3"}) {
+    const auto data = std::string("data of ") + key;
+    items.push_back({key, data, [=]() { return data; }, kDefaultExpiry});
+  }
+  items.push_back({"expired", std::string("expired data"),
+                   []() { return std::string("expired data"); }, -1});
+
+  ASSERT_TRUE(cache_->PutBatch(items));
+
+  {
+    SCOPED_TRACE("GetBatch decoded");
+
+    const auto values = cache_->GetBatch(keys, decoder);
+    ASSERT_EQ(values.size(), keys.size());
+    EXPECT_EQ(boost::any_cast<std::string>(values[0]), "data of key3");
+    EXPECT_EQ(boost::any_cast<std::string>(values[1]), "data of key1");
+    EXPECT_TRUE(values[2].empty());
+    EXPECT_EQ(boost::any_cast<std::string>(values[3]), "data of key2");
+  }
+
+  {
+    SCOPED_TRACE("GetBatch binary");
+
+    const auto data = std::string("binary data");
+    ASSERT_TRUE(cache_->Put(
+        "binary",
+        std::make_shared<KeyValueCache::ValueType>(data.begin(), data.end()),
+        kDefaultExpiry));
+
+    const auto values = cache_->GetBatch({"missing", "binary", "expired"});
+    ASSERT_EQ(values.size(), 3u);
+    EXPECT_EQ(values[0], nullptr);
+    ASSERT_NE(values[1], nullptr);
+    EXPECT_EQ(std::string(values[1]->begin(), values[1]->end()), data);
+    EXPECT_EQ(values[2], nullptr);
+  }
+
+  {
+    SCOPED_TRACE("ContainsBatch");
+
+    const auto result = cache_->ContainsBatch(keys);
+    EXPECT_EQ(result, std::vector<bool>({true, true, false, true}));
+    EXPECT_EQ(cache_->ContainsBatch({"expired"}), std::vector<bool>({false}));
+  }
+
+  {
+    SCOPED_TRACE("Empty batch");
+
+    EXPECT_TRUE(cache_->PutBatch({}));
+    EXPECT_TRUE(cache_->GetBatch({}, decoder).empty());
+    EXPECT_TRUE(cache_->ContainsBatch({}).empty());
+  }
+}
+
+TEST_P(DefaultCacheParamTest, ConcurrentPutGet) {
+  constexpr auto kThreads = 8;
+  constexpr auto kKeys = 64;
+  constexpr auto kIterations = 200;
+
+  auto make_value = [](int key_index, int version) {
+    const auto data = std::to_string(key_index) + "#" + std::to_string(version);
+    return std::make_shared<KeyValueCache::ValueType>(data.begin(), data.end());
+  };
+
+  auto is_valid_value = [](int key_index,
+                           const KeyValueCache::ValueTypePtr& value) {
+    const auto prefix = std::to_string(key_index) + "#";
+    return value->size() > prefix.size() &&
+           std::equal(prefix.begin(), prefix.end(), value->begin());
+  };
+
+  std::atomic<int> invalid_values{0};
+  std::vector<std::thread> threads;
+  for (auto thread_index = 0; thread_index < kThreads; ++thread_index) {
+    threads.emplace_back([&, thread_index]() {
+      for (auto i = 0; i < kIterations; ++i) {
+        const auto key_index = (i * kThreads + thread_index) % kKeys;
+        const auto key = "key" + std::to_string(key_index);
+        if (i % 4 == 0) {
+          cache_->Put(key, make_value(key_index, i), kDefaultExpiry);
+        } else {
+          auto value = cache_->Get(key);
+          if (value && !is_valid_value(key_index, value)) {
+            ++invalid_values;
+          }
+        }
+      }
+    });
+  }
+
+  for (auto& thread : threads) {
+    thread.join();
+  }
+
+  EXPECT_EQ(invalid_values.load(), 0);
+
+  for (auto key_index = 0; key_index < kKeys; ++key_index) {
+    const auto key = "key" + std::to_string(key_index);
+    auto value = cache_->Get(key);
+    if (value) {
+      EXPECT_TRUE(is_valid_value(key_index, value));
+    }
+  }
+}
+
 std::string TestName(const testing::TestParamInfo<TestParameters>& info) {
   std::stringstream ss;
   ss << (info.param.disk_path_mutable ? "M" : "")
@@ -0,0 +1,155 @@
+/*
+ * Copyright (C) 2021 HERE Europe B.V.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ * License-Filename: LICENSE
+ */
+
+#include <cstdio>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include <cache/LruSnapshot.h>
+#include <olp/core/utils/Dir.h>
+
+namespace {
+namespace cache = olp::cache;
+
+const auto kSnapshotPath =
+    olp::utils::Dir::TempDirectory() + "/lru_snapshot_test";
+constexpr uint64_t kId = 42u;
+constexpr uint64_t kDataSize = 12345u;
+
+struct TestEntry {
+  std::string key;
+  uint64_t size;
+  time_t expiry;
+};
+
+class LruSnapshotTest : public ::testing::Test {
+ public:
+  void SetUp() override {
+    std::remove(kSnapshotPath.c_str());
+    entries_ = {{"first", 10u, 100}, {"second", 20u, 200}, {"", 0u, -1}};
+  }
+
+  void TearDown() override { std::remove(kSnapshotPath.c_str()); }
+
+  bool Save() {
+    size_t index = 0u;
+    return cache::LruSnapshot::Save(
+        kSnapshotPath, kId, kDataSize, [&](cache::LruSnapshot::Entry& entry) {
+          if (index == entries_.size()) {
+            return false;
+          }
+
+          entry.key = entries_[index].key;
+          entry.size = entries_[index].size;
+          entry.expiry = entries_[index].expiry;
+          ++index;
+          return true;
+        });
+  }
+
+  bool Load(uint64_t id, std::vector<TestEntry>& loaded,
+            uint64_t& data_size) {
+    return cache::LruSnapshot::Load(
+        kSnapshotPath, id, data_size,
+        [&](const cache::LruSnapshot::Entry& entry) {
+          loaded.push_back({entry.key.ToString(), entry.size, entry.expiry});
+        });
+  }
+
+ protected:
+  std::vector<TestEntry> entries_;
+};
+
+TEST_F(LruSnapshotTest, SaveAndLoad) {
+  ASSERT_TRUE(Save());
+
+  std::vector<TestEntry> loaded;
+  uint64_t data_size = 0u;
+  ASSERT_TRUE(Load(kId, loaded, data_size));
+  EXPECT_EQ(data_size, kDataSize);
+
+  ASSERT_EQ(loaded.size(), entries_.size());
+  for (size_t i = 0u; i < loaded.size(); ++i) {
+    EXPECT_EQ(loaded[i].key, entries_[i].key);
+    EXPECT_EQ(loaded[i].size, entries_[i].size);
+    EXPECT_EQ(loaded[i].expiry, entries_[i].expiry);
+  }
+}
+
+TEST_F(LruSnapshotTest, IdMismatch) {
+  ASSERT_TRUE(Save());
+
+  std::vector<TestEntry> loaded;
+  uint64_t data_size = 0u;
+  EXPECT_FALSE(Load(kId + 1u, loaded, data_size));
+  EXPECT_TRUE(loaded.empty());
+}
+
+TEST_F(LruSnapshotTest, Malformed) {
+  std::vector<TestEntry> loaded;
+  uint64_t data_size = 0u;
+
+  {
+    SCOPED_TRACE("Missing");
+
+    EXPECT_FALSE(Load(kId, loaded, data_size));
+  }
+
+  {
+    SCOPED_TRACE("Corrupted");
+
+    ASSERT_TRUE(Save());
+    {
+      std::fstream file(kSnapshotPath,
+                        std::ios::in | std::ios::out | std::ios::binary);
+      ASSERT_TRUE(file.is_open());
+      file.seekp(24);
+      file.put('x');
+    }
+
+    EXPECT_FALSE(Load(kId, loaded, data_size));
+  }
+
+  {
+    SCOPED_TRACE("Truncated");
+
+    ASSERT_TRUE(Save());
+    std::string content;
+    {
+      std::ifstream file(kSnapshotPath, std::ios::binary);
+      content.assign(std::istreambuf_iterator<char>(file),
+                     std::istreambuf_iterator<char>());
+    }
+    {
+      std::ofstream file(kSnapshotPath, std::ios::binary | std::ios::trunc);
+      file.write(content.data(), content.size() - 1u);
+    }
+
+    EXPECT_FALSE(Load(kId, loaded, data_size));
+  }
+
+  EXPECT_TRUE(loaded.empty());
+
+  cache::LruSnapshot::Remove(kSnapshotPath);
+  EXPECT_FALSE(olp::utils::Dir::FileExists(kSnapshotPath));
+}
+}  // namespace
@@ -0,0 +1,293 @@
+/*
+ * Copyright (C) 2021 HERE Europe B.V.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ * License-Filename: LICENSE
+ */
+
+#include <fstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include <cache/ValueLog.h>
+#include <olp/core/utils/Dir.h>
+
+namespace {
+namespace cache = olp::cache;
+
+const auto kValueLogPath =
+    olp::utils::Dir::TempDirectory() + "/value_log_test";
+constexpr auto kMaxSegmentSize = 1024u * 1024u;
+
+class ValueLogTest : public ::testing::Test {
+ public:
+  void SetUp() override { olp::utils::Dir::Remove(kValueLogPath); }
+  void TearDown() override { olp::utils::Dir::Remove(kValueLogPath); }
+};
+
+TEST_F(ValueLogTest, AppendAndRead) {
+  const std::string first_value(1000u, 'a');
+  const std::string second_value(2000u, 'b');
+
+  cache::ValueLog value_log(kValueLogPath, kMaxSegmentSize, false);
+  ASSERT_TRUE(value_log.Open(false));
+
+  cache::ValueLog::Location first;
+  cache::ValueLog::Location second;
+  ASSERT_TRUE(value_log.Append("first", first_value, first));
+  ASSERT_TRUE(value_log.Append("second", second_value, second));
+  EXPECT_EQ(first.segment, second.segment);
+  EXPECT_EQ(first.size, first_value.size());
+  EXPECT_GT(second.offset, first.offset + first.size);
+
+  std::string value;
+  ASSERT_TRUE(value_log.Read(first, true, value));
+  EXPECT_EQ(value, first_value);
+  ASSERT_TRUE(value_log.Read(second, true, value));
+  EXPECT_EQ(value, second_value);
+
+  // The active segment is never collected
+  EXPECT_TRUE(value_log.GetSealedSegments().empty());
+  EXPECT_GT(value_log.Size(), first_value.size() + second_value.size());
+}
+
+TEST_F(ValueLogTest, Reopen) {
+  const std::string data(1000u, 'a');
+  cache::ValueLog::Location location;
+
+  {
+    cache::ValueLog value_log(kValueLogPath, kMaxSegmentSize, true);
+    ASSERT_TRUE(value_log.Open(false));
+    ASSERT_TRUE(value_log.Append("key", data, location));
+    EXPECT_TRUE(value_log.Sync());
+  }
+
+  {
+    SCOPED_TRACE("Read-only");
+
+    cache::ValueLog value_log(kValueLogPath, kMaxSegmentSize, true);
+    ASSERT_TRUE(value_log.Open(true));
+
+    std::string value;
+    ASSERT_TRUE(value_log.Read(location, true, value));
+    EXPECT_EQ(value, data);
+
+    cache::ValueLog::Location new_location;
+    EXPECT_FALSE(value_log.Append("key", data, new_location));
+  }
+
+  {
+    SCOPED_TRACE("Read-write");
+
+    cache::ValueLog value_log(kValueLogPath, kMaxSegmentSize, true);
+    ASSERT_TRUE(value_log.Open(false));
+
+    // The values are appended to a new segment
+    cache::ValueLog::Location new_location;
+    ASSERT_TRUE(value_log.Append("key", data, new_location));
+    EXPECT_GT(new_location.segment, location.segment);
+
+    const auto sealed = value_log.GetSealedSegments();
+    ASSERT_EQ(sealed.size(), 1u);
+    EXPECT_EQ(sealed.front(), location.segment);
+  }
+}
+
+TEST_F(ValueLogTest, SegmentRotation) {
+  const std::string data(600u, 'a');
+
+  cache::ValueLog value_log(kValueLogPath, 1000u, false);
+  ASSERT_TRUE(value_log.Open(false));
+
+  std::vector<cache::ValueLog::Location> locations(3u);
+  for (auto& location : locations) {
+    ASSERT_TRUE(value_log.Append("key", data, location));
+    value_log.Commit(location);
+  }
+
+  EXPECT_EQ(locations[0].segment, locations[1].segment);
+  EXPECT_NE(locations[1].segment, locations[2].segment);
+
+  const auto sealed = value_log.GetSealedSegments();
+  ASSERT_EQ(sealed.size(), 1u);
+  EXPECT_EQ(sealed.front(), locations[0].segment);
+
+  std::string value;
+  for (const auto& location : locations) {
+    ASSERT_TRUE(value_log.Read(location, true, value));
+    EXPECT_EQ(value, data);
+  }
+}
+
+TEST_F(ValueLogTest, ForEachEntryAndRemoveSegment) {
+  cache::ValueLog value_log(kValueLogPath, 100u, false);
+  ASSERT_TRUE(value_log.Open(false));
+
+  std::vector<std::pair<std::string, cache::ValueLog::Location>> appended(2u);
+  appended[0].first = "first";
+  appended[1].first = "second";
+  for (auto& entry : appended) {
+    ASSERT_TRUE(
+        value_log.Append(entry.first, std::string(100u, 'a'), entry.second));
+    value_log.Commit(entry.second);
+  }
+
+  const auto sealed = value_log.GetSealedSegments();
+  ASSERT_EQ(sealed.size(), 1u);
+
+  std::vector<std::pair<std::string, cache::ValueLog::Location>> found;
+  ASSERT_TRUE(value_log.ForEachEntry(
+      sealed.front(),
+      [&](const std::string& key, const cache::ValueLog::Location& location) {
+        found.emplace_back(key, location);
+      }));
+  ASSERT_EQ(found.size(), 1u);
+  EXPECT_EQ(found[0].first, appended[0].first);
+  EXPECT_EQ(found[0].second.offset, appended[0].second.offset);
+  EXPECT_EQ(found[0].second.size, appended[0].second.size);
+
+  EXPECT_FALSE(value_log.RemoveSegment(appended[1].second.segment));
+  EXPECT_TRUE(value_log.RemoveSegment(sealed.front()));
+
+  std::string value;
+  EXPECT_FALSE(value_log.Read(appended[0].second, false, value));
+  EXPECT_TRUE(value_log.Read(appended[1].second, false, value));
+  EXPECT_TRUE(value_log.GetSealedSegments().empty());
+}
+
+TEST_F(ValueLogTest, UncommittedAndPinnedSegments) {
+  const std::string data(100u, 'a');
+
+  cache::ValueLog value_log(kValueLogPath, 100u, false);
+  ASSERT_TRUE(value_log.Open(false));
+
+  cache::ValueLog::Location first;
+  cache::ValueLog::Location second;
+  ASSERT_TRUE(value_log.Append("first", data, first));
+  ASSERT_TRUE(value_log.Append("second", data, second));
+  ASSERT_NE(first.segment, second.segment);
+
+  {
+    SCOPED_TRACE("Uncommitted");
+
+    // The location of the value could still be written by the owner
+    EXPECT_TRUE(value_log.GetSealedSegments().empty());
+    EXPECT_FALSE(value_log.RemoveSegment(first.segment));
+
+    value_log.Commit(first);
+    const auto sealed = value_log.GetSealedSegments();
+    ASSERT_EQ(sealed.size(), 1u);
+    EXPECT_EQ(sealed.front(), first.segment);
+  }
+
+  {
+    SCOPED_TRACE("Pinned");
+
+    std::string value;
+    {
+      cache::ValueLog::ReadPin pin(&value_log);
+      EXPECT_TRUE(value_log.RemoveSegment(first.segment));
+      EXPECT_TRUE(value_log.GetSealedSegments().empty());
+
+      // The reader which looked up the location before can read it
+      ASSERT_TRUE(value_log.Read(first, true, value));
+      EXPECT_EQ(value, data);
+    }
+
+    EXPECT_FALSE(value_log.Read(first, true, value));
+  }
+}
+
+TEST_F(ValueLogTest, ReleasedValues) {
+  const std::string data(100u, 'a');
+
+  cache::ValueLog value_log(kValueLogPath, 100u, false);
+  ASSERT_TRUE(value_log.Open(false));
+
+  cache::ValueLog::Location first;
+  cache::ValueLog::Location second;
+  ASSERT_TRUE(value_log.Append("first", data, first));
+  ASSERT_TRUE(value_log.Append("second", data, second));
+  value_log.Commit(first);
+  value_log.Commit(second);
+  EXPECT_EQ(value_log.DeadSize(), 0u);
+
+  EXPECT_EQ(value_log.Release(first), data.size());
+  EXPECT_EQ(value_log.GetSegmentDeadSize(first.segment), data.size());
+  EXPECT_EQ(value_log.GetSegmentDeadSize(second.segment), 0u);
+  EXPECT_EQ(value_log.DeadSize(), data.size());
+
+  // The dead size never exceeds the segment
+  value_log.SetDeadSize(second.segment, 10u * data.size());
+  EXPECT_EQ(value_log.GetSegmentDeadSize(second.segment),
+            value_log.GetSegmentSize(second.segment));
+
+  // The released values are gone with their segment
+  ASSERT_TRUE(value_log.RemoveSegment(first.segment));
+  EXPECT_EQ(value_log.Release(first), 0u);
+  EXPECT_EQ(value_log.DeadSize(),
+            value_log.GetSegmentSize(second.segment));
+}
+
+TEST_F(ValueLogTest, ChecksumMismatch) {
+  const std::string data(100u, 'a');
+  cache::ValueLog::Location location;
+
+  {
+    cache::ValueLog value_log(kValueLogPath, kMaxSegmentSize, false);
+    ASSERT_TRUE(value_log.Open(false));
+    ASSERT_TRUE(value_log.Append("key", data, location));
+  }
+
+  {
+    std::fstream file(kValueLogPath + "/000001.vlog",
+                      std::ios::in | std::ios::out | std::ios::binary);
+    ASSERT_TRUE(file.is_open());
+    file.seekp(location.offset);
+    file.put('b');
+  }
+
+  cache::ValueLog value_log(kValueLogPath, kMaxSegmentSize, false);
+  ASSERT_TRUE(value_log.Open(true));
+
+  std::string value;
+  EXPECT_FALSE(value_log.Read(location, true, value));
+
+  // The checksum is not verified unless requested
+  ASSERT_TRUE(value_log.Read(location, false, value));
+  EXPECT_EQ(value.front(), 'b');
+}
+
+TEST_F(ValueLogTest, EncodeDecodeLocation) {
+  cache::ValueLog::Location location;
+  location.segment = 7u;
+  location.size = 123456u;
+  location.offset = 0x123456789ull;
+
+  const auto data = cache::ValueLog::EncodeLocation(location);
+  EXPECT_EQ(data.size(), cache::ValueLog::kLocationSize);
+
+  cache::ValueLog::Location decoded;
+  ASSERT_TRUE(cache::ValueLog::DecodeLocation(data, decoded));
+  EXPECT_EQ(decoded.segment, location.segment);
+  EXPECT_EQ(decoded.size, location.size);
+  EXPECT_EQ(decoded.offset, location.offset);
+
+  EXPECT_FALSE(cache::ValueLog::DecodeLocation(data.substr(1), decoded));
+}
+}  // namespace
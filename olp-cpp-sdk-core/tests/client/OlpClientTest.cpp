@@ -2053,4 +2053,226 @@ TEST_F(OlpClientMergeTest, NoMergeMultipleCallbacks) {
   }
 }
 
+TEST(OlpClientBufferTest, BufferResponse) {
+  auto network = std::make_shared<NetworkMock>();
+  olp::client::OlpClientSettings settings;
+  settings.network_request_handler = network;
+  olp::client::OlpClient client(settings, "here.com");
+
+  const std::string content = "content";
+
+  auto send = [&](int status) {
+    return [=](olp::http::NetworkRequest /*request*/,
+               olp::http::Network::Payload payload,
+               olp::http::Network::Callback callback,
+               olp::http::Network::HeaderCallback header_callback,
+               olp::http::Network::DataCallback /*data_callback*/) {
+      header_callback("content-length", std::to_string(content.size()));
+
+      // The network rewrites the body from the beginning on retries.
+      *payload << "con";
+      payload->seekp(0);
+      *payload << content;
+      EXPECT_EQ(payload->tellp(), std::streampos(content.size()));
+
+      callback(
+          olp::http::NetworkResponse().WithStatus(status).WithRequestId(5));
+      return olp::http::SendOutcome(5);
+    };
+  };
+
+  {
+    SCOPED_TRACE("Successful response");
+
+    EXPECT_CALL(*network, Send(_, _, _, _, _))
+        .WillOnce(send(http::HttpStatusCode::OK));
+
+    auto response =
+        client.CallApi({}, "GET", {}, {}, {}, nullptr, {}, {}, true);
+    ASSERT_EQ(http::HttpStatusCode::OK, response.GetStatus());
+    EXPECT_TRUE(response.response.str().empty());
+
+    std::string response_payload;
+    response.GetResponse(response_payload);
+    EXPECT_EQ(content, response_payload);
+
+    auto copy = response;
+    auto data = response.MoveResponseData();
+    ASSERT_TRUE(data);
+    EXPECT_EQ(std::string(data->begin(), data->end()), content);
+    EXPECT_EQ(data->capacity(), content.size());
+
+    // The body is moved out, the copy keeps its own body.
+    EXPECT_TRUE(response.MoveResponseData()->empty());
+    copy.GetResponse(response_payload);
+    EXPECT_EQ(content, response_payload);
+  }
+
+  {
+    SCOPED_TRACE("Error response is readable from the stream");
+
+    EXPECT_CALL(*network, Send(_, _, _, _, _))
+        .WillOnce(send(http::HttpStatusCode::NOT_FOUND));
+
+    auto response =
+        client.CallApi({}, "GET", {}, {}, {}, nullptr, {}, {}, true);
+    EXPECT_EQ(http::HttpStatusCode::NOT_FOUND, response.GetStatus());
+    EXPECT_EQ(content, response.response.str());
+  }
+
+  {
+    SCOPED_TRACE("Content-Length is not trusted");
+
+    EXPECT_CALL(*network, Send(_, _, _, _, _))
+        .WillOnce([&](olp::http::NetworkRequest /*request*/,
+                      olp::http::Network::Payload payload,
+                      olp::http::Network::Callback callback,
+                      olp::http::Network::HeaderCallback header_callback,
+                      olp::http::Network::DataCallback /*data_callback*/) {
+          header_callback("Content-Length", "18446744073709551615");
+          *payload << content;
+          callback(olp::http::NetworkResponse()
+                       .WithStatus(http::HttpStatusCode::OK)
+                       .WithRequestId(5));
+          return olp::http::SendOutcome(5);
+        });
+
+    auto response =
+        client.CallApi({}, "GET", {}, {}, {}, nullptr, {}, {}, true);
+    ASSERT_EQ(http::HttpStatusCode::OK, response.GetStatus());
+
+    auto data = response.MoveResponseData();
+    ASSERT_TRUE(data);
+    EXPECT_EQ(std::string(data->begin(), data->end()), content);
+    EXPECT_LE(data->capacity(), 4u * 1024u * 1024u);
+  }
+}
+
+TEST(OlpClientBufferTest, DataCallback) {
+  auto network = std::make_shared<NetworkMock>();
+  olp::client::OlpClientSettings settings;
+  settings.network_request_handler = network;
+  olp::client::OlpClient client(settings, "here.com");
+
+  const std::string content = "content";
+
+  EXPECT_CALL(*network, Send(_, _, _, _, _))
+      .WillOnce([&](olp::http::NetworkRequest /*request*/,
+                    olp::http::Network::Payload payload,
+                    olp::http::Network::Callback callback,
+                    olp::http::Network::HeaderCallback /*header_callback*/,
+                    olp::http::Network::DataCallback data_callback) {
+        const auto data = reinterpret_cast<const uint8_t*>(content.data());
+        EXPECT_TRUE(data_callback);
+        data_callback(data, 0u, 3u);
+        data_callback(data + 3u, 3u, content.size() - 3u);
+        *payload << content;
+        EXPECT_EQ(payload->tellp(), std::streampos(content.size()));
+
+        callback(olp::http::NetworkResponse()
+                     .WithStatus(http::HttpStatusCode::OK)
+                     .WithRequestId(5));
+        return olp::http::SendOutcome(5);
+      });
+
+  std::string chunks;
+  auto response = client.CallApi(
+      {}, "GET", {}, {}, {}, nullptr, {}, {}, false,
+      [&](const uint8_t* data, uint64_t offset, size_t length) {
+        EXPECT_EQ(offset, chunks.size());
+        chunks.append(reinterpret_cast<const char*>(data), length);
+      });
+
+  ASSERT_EQ(http::HttpStatusCode::OK, response.GetStatus());
+  EXPECT_EQ(content, chunks);
+
+  // The body is consumed by the callback and is not stored.
+  EXPECT_TRUE(response.response.str().empty());
+  EXPECT_TRUE(response.MoveResponseData()->empty());
+}
+
+TEST(OlpClientBufferTest, DataCallbackErrorResponse) {
+  auto network = std::make_shared<NetworkMock>();
+  olp::client::OlpClientSettings settings;
+  settings.network_request_handler = network;
+  settings.retry_settings.max_attempts = 0;
+  olp::client::OlpClient client(settings, "here.com");
+
+  const std::string error_body = R"({"title":"Error"})";
+
+  for (const auto status : {http::HttpStatusCode::NOT_FOUND,
+                            http::HttpStatusCode::INTERNAL_SERVER_ERROR}) {
+    SCOPED_TRACE(testing::Message() << "status=" << status);
+
+    // The network streams the error body as well.
+    EXPECT_CALL(*network, Send(_, _, _, _, _))
+        .WillOnce([&](olp::http::NetworkRequest /*request*/,
+                      olp::http::Network::Payload payload,
+                      olp::http::Network::Callback callback,
+                      olp::http::Network::HeaderCallback /*header_callback*/,
+                      olp::http::Network::DataCallback data_callback) {
+          data_callback(reinterpret_cast<const uint8_t*>(error_body.data()),
+                        0u, error_body.size());
+          *payload << error_body;
+          callback(olp::http::NetworkResponse().WithStatus(status).WithRequestId(
+              5));
+          return olp::http::SendOutcome(5);
+        });
+
+    size_t chunks = 0u;
+    auto response = client.CallApi(
+        {}, "GET", {}, {}, {}, nullptr, {}, {}, false,
+        [&](const uint8_t* /*data*/, uint64_t /*offset*/,
+            size_t /*length*/) { ++chunks; });
+
+    EXPECT_EQ(status, response.GetStatus());
+    EXPECT_EQ(0u, chunks);
+
+    // The error body is kept for the error message.
+    EXPECT_EQ(error_body, response.response.str());
+  }
+}
+
+TEST(OlpClientBufferTest, DataCallbackLargeBody) {
+  auto network = std::make_shared<NetworkMock>();
+  olp::client::OlpClientSettings settings;
+  settings.network_request_handler = network;
+  olp::client::OlpClient client(settings, "here.com");
+
+  const size_t kChunkSize = 16u * 1024u;
+  const std::vector<uint8_t> content(10u * kChunkSize, 'z');
+  size_t received = 0u;
+
+  EXPECT_CALL(*network, Send(_, _, _, _, _))
+      .WillOnce([&](olp::http::NetworkRequest /*request*/,
+                    olp::http::Network::Payload /*payload*/,
+                    olp::http::Network::Callback callback,
+                    olp::http::Network::HeaderCallback /*header_callback*/,
+                    olp::http::Network::DataCallback data_callback) {
+        for (size_t offset = 0u; offset < content.size();
+             offset += kChunkSize) {
+          data_callback(content.data() + offset, offset, kChunkSize);
+        }
+
+        // A body larger than the error bodies is streamed before the status
+        // is known.
+        EXPECT_EQ(received, content.size());
+
+        callback(olp::http::NetworkResponse()
+                     .WithStatus(http::HttpStatusCode::OK)
+                     .WithRequestId(5));
+        return olp::http::SendOutcome(5);
+      });
+
+  auto response = client.CallApi(
+      {}, "GET", {}, {}, {}, nullptr, {}, {}, false,
+      [&](const uint8_t* /*data*/, uint64_t offset, size_t length) {
+        EXPECT_EQ(offset, received);
+        received += length;
+      });
+
+  ASSERT_EQ(http::HttpStatusCode::OK, response.GetStatus());
+  EXPECT_EQ(content.size(), received);
+}
+
 }  // namespace
@@ -280,3 +280,134 @@ TEST(ThreadPoolTaskSchedulerTest, Move) {
   thread_pool.reset();
   testing::Mock::VerifyAndClearExpectations(&mockop);
 }
+
+TEST(ThreadPoolTaskSchedulerTest, Aging) {
+  olp::thread::ThreadPoolSettings settings;
+  settings.aging_interval = chrono::milliseconds(1);
+  auto thread_pool = std::make_shared<ThreadPool>(settings);
+  TaskScheduler& scheduler = *thread_pool;
+
+  std::promise<void> block_promise;
+  auto block_future = block_promise.get_future();
+  scheduler.ScheduleTask(
+      [&]() { block_future.wait_for(std::chrono::milliseconds(kMaxWaitMs)); },
+      std::numeric_limits<uint32_t>::max());
+
+  std::promise<void> promise;
+  std::vector<uint32_t> order;
+  scheduler.ScheduleTask([&]() { order.push_back(1u); }, 1u);
+
+  // The first task gains more than 10 priorities while waiting.
+  std::this_thread::sleep_for(kSleep);
+  scheduler.ScheduleTask(
+      [&]() {
+        order.push_back(10u);
+        promise.set_value();
+      },
+      10u);
+
+  block_promise.set_value();
+  EXPECT_EQ(promise.get_future().wait_for(std::chrono::milliseconds(kMaxWaitMs)),
+            std::future_status::ready);
+  EXPECT_EQ(order, (std::vector<uint32_t>{1u, 10u}));
+
+  thread_pool.reset();
+}
+
+TEST(ThreadPoolTaskSchedulerTest, BandLimits) {
+  olp::thread::ThreadPoolSettings settings;
+  settings.thread_count = kThreads;
+  settings.band_limits = {{olp::thread::LOW, 1u}};
+  auto thread_pool = std::make_shared<ThreadPool>(settings);
+  TaskScheduler& scheduler = *thread_pool;
+
+  constexpr uint32_t kLowTasks = 5u;
+  std::atomic<uint32_t> running(0u);
+  std::atomic<uint32_t> max_running(0u);
+  std::atomic<uint32_t> low_counter(0u);
+  std::promise<void> low_promise;
+
+  for (uint32_t idx = 0u; idx < kLowTasks; ++idx) {
+    scheduler.ScheduleTask(
+        [&]() {
+          const auto now_running = ++running;
+          auto max = max_running.load();
+          while (now_running > max &&
+                 !max_running.compare_exchange_weak(max, now_running)) {
+          }
+          std::this_thread::sleep_for(kSleep / 10);
+          --running;
+          if (++low_counter == kLowTasks) {
+            low_promise.set_value();
+          }
+        },
+        olp::thread::LOW);
+  }
+
+  // The other threads are free for the higher priority tasks.
+  std::promise<uint32_t> normal_promise;
+  scheduler.ScheduleTask([&]() { normal_promise.set_value(low_counter); },
+                         olp::thread::NORMAL);
+
+  auto normal_future = normal_promise.get_future();
+  ASSERT_EQ(normal_future.wait_for(std::chrono::milliseconds(kMaxWaitMs)),
+            std::future_status::ready);
+  EXPECT_LT(normal_future.get(), kLowTasks);
+
+  EXPECT_EQ(low_promise.get_future().wait_for(
+                std::chrono::milliseconds(kMaxWaitMs)),
+            std::future_status::ready);
+  EXPECT_EQ(max_running.load(), 1u);
+
+  thread_pool.reset();
+}
+
+TEST(ThreadPoolTaskSchedulerTest, BandLimitsClamped) {
+  olp::thread::ThreadPoolSettings settings;
+  settings.thread_count = 2u;
+  settings.band_limits = {{olp::thread::LOW, 0u}, {olp::thread::NORMAL, 8u}};
+  auto thread_pool = std::make_shared<ThreadPool>(settings);
+  TaskScheduler& scheduler = *thread_pool;
+
+  {
+    SCOPED_TRACE("Band without threads runs on one thread");
+
+    std::promise<void> promise;
+    scheduler.ScheduleTask([&]() { promise.set_value(); }, olp::thread::LOW);
+    EXPECT_EQ(
+        promise.get_future().wait_for(std::chrono::milliseconds(kMaxWaitMs)),
+        std::future_status::ready);
+  }
+
+  {
+    SCOPED_TRACE("Band larger than the pool uses all threads");
+
+    // Both tasks wait for each other, so they have to run simultaneously.
+    std::promise<void> first_promise;
+    std::promise<void> second_promise;
+    auto first_future = first_promise.get_future();
+    auto second_future = second_promise.get_future();
+    std::promise<bool> done_promise;
+    scheduler.ScheduleTask(
+        [&]() {
+          first_promise.set_value();
+          second_future.wait_for(std::chrono::milliseconds(kMaxWaitMs));
+        },
+        olp::thread::NORMAL);
+    scheduler.ScheduleTask(
+        [&]() {
+          second_promise.set_value();
+          done_promise.set_value(
+              first_future.wait_for(std::chrono::milliseconds(kMaxWaitMs)) ==
+              std::future_status::ready);
+        },
+        olp::thread::NORMAL);
+
+    auto done_future = done_promise.get_future();
+    ASSERT_EQ(done_future.wait_for(std::chrono::milliseconds(2 * kMaxWaitMs)),
+              std::future_status::ready);
+    EXPECT_TRUE(done_future.get());
+  }
+
+  thread_pool.reset();
+}
@@ -0,0 +1,234 @@
+/*
+ * Copyright (C) 2021 HERE Europe B.V.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ * License-Filename: LICENSE
+ */
+
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <limits>
+#include <memory>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <olp/core/client/CancellationContext.h>
+#include <olp/core/thread/WorkStealingTaskScheduler.h>
+
+namespace {
+using CancellationContext = olp::client::CancellationContext;
+using TaskScheduler = olp::thread::TaskScheduler;
+using WorkStealing = olp::thread::WorkStealingTaskScheduler;
+
+namespace chrono = std::chrono;
+
+constexpr size_t kThreads{3u};
+constexpr uint32_t kNumTasks{1000u};
+constexpr chrono::milliseconds kMaxWait{1000};
+
+TEST(WorkStealingTaskSchedulerTest, MultiUserPush) {
+  constexpr uint32_t kPushThreads = 3;
+  constexpr uint32_t kTotalTasks = kPushThreads * (2 * kNumTasks);
+
+  auto scheduler = std::make_shared<WorkStealing>(kThreads);
+  std::atomic<uint32_t> counter(0u);
+  std::promise<void> promise;
+
+  auto increment = [&]() {
+    if (++counter == kTotalTasks) {
+      promise.set_value();
+    }
+  };
+
+  std::vector<std::thread> push_threads;
+  for (size_t idx = 0; idx < kPushThreads; ++idx) {
+    push_threads.emplace_back([&] {
+      for (uint32_t idx = 0u; idx < kNumTasks; ++idx) {
+        scheduler->ScheduleTask([&](const CancellationContext&) { increment(); });
+        scheduler->ScheduleTask(increment);
+      }
+    });
+  }
+
+  EXPECT_EQ(promise.get_future().wait_for(kMaxWait),
+            std::future_status::ready);
+  EXPECT_EQ(kTotalTasks, counter.load());
+
+  for (auto& thread : push_threads) {
+    thread.join();
+  }
+  scheduler.reset();
+}
+
+TEST(WorkStealingTaskSchedulerTest, NestedTasksAreStolen) {
+  // The tasks scheduled by a pool thread are queued on the same thread, the
+  // idle threads must steal them while this thread is blocked.
+  auto scheduler = std::make_shared<WorkStealing>(kThreads);
+
+  std::promise<void> block_promise;
+  auto block_future = block_promise.get_future().share();
+  std::promise<void> done_promise;
+  std::atomic<uint32_t> counter(0u);
+  std::mutex mutex;
+  std::set<std::thread::id> thread_ids;
+  std::thread::id blocked_id;
+
+  scheduler->ScheduleTask([&]() {
+    blocked_id = std::this_thread::get_id();
+    for (uint32_t idx = 0u; idx < kNumTasks; ++idx) {
+      scheduler->ScheduleTask([&]() {
+        {
+          std::lock_guard<std::mutex> lock(mutex);
+          thread_ids.insert(std::this_thread::get_id());
+        }
+        if (++counter == kNumTasks) {
+          done_promise.set_value();
+        }
+      });
+    }
+    block_future.wait_for(kMaxWait);
+  });
+
+  EXPECT_EQ(done_promise.get_future().wait_for(kMaxWait),
+            std::future_status::ready);
+  block_promise.set_value();
+
+  EXPECT_EQ(kNumTasks, counter.load());
+  EXPECT_FALSE(thread_ids.empty());
+  EXPECT_EQ(thread_ids.count(blocked_id), 0u);
+
+  scheduler.reset();
+}
+
+TEST(WorkStealingTaskSchedulerTest, Prioritization) {
+  auto scheduler = std::make_shared<WorkStealing>(1);
+
+  struct MockOp {
+    MOCK_METHOD(void, Op, (uint32_t, olp::thread::Priority));
+  } mockop;
+
+  testing::Sequence sequence;
+
+  std::promise<void> block_promise;
+  auto block_future = block_promise.get_future();
+
+  scheduler->ScheduleTask([&]() { block_future.wait_for(kMaxWait); },
+                          std::numeric_limits<uint32_t>::max());
+
+  const uint32_t expected_tasks = 30u;
+  const olp::thread::Priority priorities[] = {
+      olp::thread::LOW, olp::thread::NORMAL, olp::thread::HIGH};
+
+  // Higher priority first, the same priority in the order of scheduling.
+  for (auto priority : {olp::thread::HIGH, olp::thread::NORMAL,
+                        olp::thread::LOW}) {
+    for (uint32_t id = 0; id < expected_tasks; ++id) {
+      if (priorities[id % 3] == priority) {
+        EXPECT_CALL(mockop, Op(id, priority)).InSequence(sequence);
+      }
+    }
+  }
+
+  for (uint32_t id = 0; id < expected_tasks; ++id) {
+    auto priority = priorities[id % 3];
+    scheduler->ScheduleTask([&, id, priority]() { mockop.Op(id, priority); },
+                            priority);
+  }
+
+  block_promise.set_value();
+
+  std::promise<void> promise;
+  scheduler->ScheduleTask([&]() { promise.set_value(); }, 1);
+  EXPECT_EQ(promise.get_future().wait_for(kMaxWait),
+            std::future_status::ready);
+
+  scheduler.reset();
+  testing::Mock::VerifyAndClearExpectations(&mockop);
+}
+
+TEST(WorkStealingTaskSchedulerTest, HighPriorityIsStolenFirst) {
+  // The second thread prefers the urgent task queued on the blocked first
+  // thread to its own low priority task.
+  auto scheduler = std::make_shared<WorkStealing>(2);
+
+  std::promise<void> first_promise;
+  std::promise<void> second_promise;
+  std::promise<void> done_promise;
+  std::string order;
+
+  // Tasks from outside of the pool are distributed in the round robin order.
+  auto first_future = first_promise.get_future();
+  scheduler->ScheduleTask([&]() { first_future.wait_for(kMaxWait); });
+  auto second_future = second_promise.get_future();
+  scheduler->ScheduleTask([&]() { second_future.wait_for(kMaxWait); });
+  scheduler->ScheduleTask([&]() { order.push_back('h'); }, olp::thread::HIGH);
+  scheduler->ScheduleTask(
+      [&]() {
+        order.push_back('l');
+        done_promise.set_value();
+      },
+      olp::thread::LOW);
+
+  second_promise.set_value();
+  EXPECT_EQ(done_promise.get_future().wait_for(kMaxWait),
+            std::future_status::ready);
+  EXPECT_EQ(order, "hl");
+
+  first_promise.set_value();
+  scheduler.reset();
+}
+
+TEST(WorkStealingTaskSchedulerTest, DestroyWithPendingTasks) {
+  auto scheduler = std::make_shared<WorkStealing>(kThreads);
+
+  std::promise<void> block_promise;
+  auto block_future = block_promise.get_future().share();
+  std::atomic<uint32_t> counter(0u);
+
+  for (size_t idx = 0; idx < kThreads; ++idx) {
+    scheduler->ScheduleTask([=]() { block_future.wait_for(kMaxWait); });
+  }
+  for (uint32_t idx = 0u; idx < kNumTasks; ++idx) {
+    scheduler->ScheduleTask([&]() { ++counter; });
+  }
+
+  std::thread unblock([&]() {
+    std::this_thread::sleep_for(chrono::milliseconds(100));
+    block_promise.set_value();
+  });
+
+  // The queued tasks are discarded, the destructor does not wait for them.
+  scheduler.reset();
+  unblock.join();
+
+  EXPECT_LT(counter.load(), kNumTasks);
+}
+
+TEST(WorkStealingTaskSchedulerTest, NoThreads) {
+  auto scheduler = std::make_shared<WorkStealing>(0);
+  std::atomic<uint32_t> counter(0u);
+
+  scheduler->ScheduleTask([&]() { ++counter; });
+  scheduler.reset();
+
+  EXPECT_EQ(counter.load(), 0u);
+}
+}  // namespace
@@ -0,0 +1,226 @@
+/*
+ * Copyright (C) 2021 HERE Europe B.V.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ * License-Filename: LICENSE
+ */
+
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include <olp/core/utils/HashedLruCache.h>
+#include <olp/core/utils/LruCache.h>
+
+namespace {
+namespace utils = olp::utils;
+
+struct ValueCost {
+  std::size_t operator()(const std::string& value) const {
+    return value.size();
+  }
+};
+
+template <typename Cache>
+std::vector<std::string> Keys(const Cache& cache) {
+  std::vector<std::string> keys;
+  for (const auto& entry : cache) {
+    keys.push_back(entry.key());
+  }
+  return keys;
+}
+
+template <typename Cache>
+std::vector<std::string> ReverseKeys(const Cache& cache) {
+  std::vector<std::string> keys;
+  for (auto it = cache.rbegin(); it != cache.rend(); --it) {
+    keys.push_back(it->key());
+  }
+  return keys;
+}
+
+template <typename Cache>
+class LruCacheTest : public ::testing::Test {};
+
+// Both containers have the same interface and behavior.
+using CacheTypes = ::testing::Types<
+    utils::LruCache<std::string, std::string, ValueCost>,
+    utils::HashedLruCache<std::string, std::string, ValueCost>>;
+TYPED_TEST_SUITE(LruCacheTest, CacheTypes);
+
+TYPED_TEST(LruCacheTest, InsertAndFind) {
+  TypeParam cache(100u);
+
+  auto result = cache.Insert("a", std::string("1"));
+  EXPECT_TRUE(result.second);
+  EXPECT_EQ(result.first->key(), "a");
+
+  // Insert does not update the existing value
+  result = cache.Insert("a", std::string("22"));
+  EXPECT_FALSE(result.second);
+  EXPECT_EQ(result.first->value(), "1");
+  EXPECT_EQ(cache.Size(), 1u);
+
+  EXPECT_TRUE(cache.Insert("b", std::string("333")).second);
+  EXPECT_EQ(cache.Size(), 4u);
+
+  auto it = cache.FindNoPromote("a");
+  ASSERT_TRUE(it != cache.end());
+  EXPECT_EQ(it->value(), "1");
+  EXPECT_TRUE(cache.FindNoPromote("c") == cache.end());
+  EXPECT_EQ(cache.Find("c", "none"), "none");
+  EXPECT_EQ(cache.Find("b", "none"), "333");
+}
+
+TYPED_TEST(LruCacheTest, InsertOrAssign) {
+  TypeParam cache(100u);
+
+  EXPECT_TRUE(cache.InsertOrAssign("a", std::string("1")).second);
+  EXPECT_TRUE(cache.InsertOrAssign("b", std::string("1")).second);
+
+  const auto result = cache.InsertOrAssign("a", std::string("4444"));
+  EXPECT_FALSE(result.second);
+  EXPECT_EQ(result.first->value(), "4444");
+  EXPECT_EQ(cache.Size(), 5u);
+  EXPECT_EQ(Keys(cache), (std::vector<std::string>{"a", "b"}));
+}
+
+TYPED_TEST(LruCacheTest, Promote) {
+  TypeParam cache(100u);
+  for (const auto key : {"a", "b", "c", "d"}) {
+    cache.Insert(key, std::string("1"));
+  }
+  EXPECT_EQ(Keys(cache), (std::vector<std::string>{"d", "c", "b", "a"}));
+
+  cache.Find("b");
+  cache.Find("a");
+  EXPECT_EQ(Keys(cache), (std::vector<std::string>{"a", "b", "d", "c"}));
+  EXPECT_EQ(ReverseKeys(cache), (std::vector<std::string>{"c", "d", "b", "a"}));
+
+  // FindNoPromote and Insert of a too large value do not promote
+  cache.FindNoPromote("c");
+  cache.Insert("d", std::string(200u, 'x'));
+  EXPECT_EQ(Keys(cache), (std::vector<std::string>{"a", "b", "d", "c"}));
+
+  cache.Insert("c", std::string("1"));
+  EXPECT_EQ(cache.begin()->key(), "c");
+}
+
+TYPED_TEST(LruCacheTest, Eviction) {
+  TypeParam cache(5u);
+
+  std::vector<std::pair<std::string, std::string>> evicted;
+  cache.SetEvictionCallback([&](const std::string& key, std::string&& value) {
+    evicted.emplace_back(key, std::move(value));
+  });
+
+  cache.Insert("a", std::string("11"));
+  cache.Insert("b", std::string("22"));
+  cache.Find("a");
+  cache.Insert("c", std::string("33"));
+
+  ASSERT_EQ(evicted.size(), 1u);
+  EXPECT_EQ(evicted[0].first, "b");
+  EXPECT_EQ(evicted[0].second, "22");
+  EXPECT_EQ(cache.Size(), 4u);
+
+  // Too large values are not inserted
+  const auto result = cache.Insert("d", std::string(6u, 'x'));
+  EXPECT_FALSE(result.second);
+  EXPECT_TRUE(result.first == cache.end());
+
+  cache.Resize(2u);
+  EXPECT_EQ(evicted.size(), 2u);
+  EXPECT_EQ(Keys(cache), (std::vector<std::string>{"c"}));
+  EXPECT_EQ(cache.GetMaxSize(), 2u);
+
+  // Erase and Clear do not call the eviction callback
+  cache.Erase("c");
+  cache.Insert("e", std::string("1"));
+  cache.Clear();
+  EXPECT_EQ(evicted.size(), 2u);
+  EXPECT_EQ(cache.Size(), 0u);
+  EXPECT_TRUE(cache.begin() == cache.end());
+}
+
+TYPED_TEST(LruCacheTest, Erase) {
+  TypeParam cache(100u);
+  for (const auto key : {"a", "b", "c", "d", "e"}) {
+    cache.Insert(key, std::string("1"));
+  }
+
+  EXPECT_TRUE(cache.Erase("c"));
+  EXPECT_FALSE(cache.Erase("c"));
+  EXPECT_EQ(Keys(cache), (std::vector<std::string>{"e", "d", "b", "a"}));
+
+  for (auto it = cache.begin(); it != cache.end();) {
+    if (it->key() == "e" || it->key() == "a") {
+      it = cache.Erase(it);
+    } else {
+      ++it;
+    }
+  }
+
+  EXPECT_EQ(Keys(cache), (std::vector<std::string>{"d", "b"}));
+  EXPECT_EQ(ReverseKeys(cache), (std::vector<std::string>{"b", "d"}));
+  EXPECT_EQ(cache.Size(), 2u);
+}
+
+TEST(HashedLruCacheTest, Move) {
+  using Cache = utils::HashedLruCache<std::string, std::string, ValueCost>;
+  Cache cache(100u);
+  for (const auto key : {"a", "b", "c"}) {
+    cache.Insert(key, std::string("1"));
+  }
+
+  Cache moved(std::move(cache));
+  EXPECT_EQ(Keys(moved), (std::vector<std::string>{"c", "b", "a"}));
+  EXPECT_EQ(moved.Size(), 3u);
+
+  Cache assigned(10u);
+  assigned.Insert("x", std::string("1"));
+  assigned = std::move(moved);
+  EXPECT_EQ(Keys(assigned), (std::vector<std::string>{"c", "b", "a"}));
+  EXPECT_EQ(assigned.GetMaxSize(), 100u);
+  EXPECT_TRUE(assigned.FindNoPromote("x") == assigned.end());
+  EXPECT_TRUE(assigned.FindNoPromote("b") != assigned.end());
+}
+
+TEST(HashedLruCacheTest, ManyElements) {
+  utils::HashedLruCache<std::string, std::string, ValueCost> cache(10000u);
+
+  // Grows the buckets and the node pool, reuses the erased nodes.
+  for (auto i = 0; i < 20000; ++i) {
+    cache.InsertOrAssign(std::to_string(i), std::string("1"));
+  }
+  EXPECT_EQ(cache.Size(), 10000u);
+  EXPECT_TRUE(cache.FindNoPromote("9999") == cache.end());
+  EXPECT_EQ(cache.rbegin()->key(), "10000");
+
+  for (auto i = 10000; i < 20000; i += 2) {
+    EXPECT_TRUE(cache.Erase(std::to_string(i)));
+  }
+  EXPECT_EQ(cache.Size(), 5000u);
+
+  for (auto i = 10001; i < 20000; i += 2) {
+    auto it = cache.Find(std::to_string(i));
+    ASSERT_TRUE(it != cache.end());
+    EXPECT_EQ(it->value(), "1");
+  }
+  EXPECT_EQ(cache.begin()->key(), "19999");
+}
+}  // namespace
@@ -37,6 +37,21 @@ struct PrefetchStatus {
   size_t bytes_transferred;
 };
 
+/*
+ * @brief PrefetchTilesProgress structure represents the stored progress of an
+ * interrupted tiles prefetch operation.
+ */
+struct PrefetchTilesProgress {
+  /// Tiles that are already prefetched.
+  size_t prefetched_tiles;
+  /// Tiles to prefetch, found by the stored metadata queries.
+  size_t total_tiles_to_prefetch;
+  /// Root tiles with the stored metadata queries.
+  size_t queried_roots;
+  /// Total number of root tiles to query.
+  size_t total_roots;
+};
+
 /*
  * @brief PrefetchPartitionsStatus structure represent the progress of prefetch
  * operation for partitions.
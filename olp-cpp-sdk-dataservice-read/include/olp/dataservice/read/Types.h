@@ -19,6 +19,8 @@
 
 #pragma once
 
+#include <cstdint>
+#include <functional>
 #include <memory>
 #include <string>
 #include <vector>
@@ -79,6 +81,17 @@ using DataResponse = Response<DataResult>;
 /// The callback type of the data response.
 using DataResponseCallback = Callback<DataResult>;
 
+/// The callback type of the data chunk, receives `length` bytes of the data
+/// that start at `offset`.
+using DataChunkCallback = std::function<void(
+    const std::uint8_t* data, std::uint64_t offset, std::size_t length)>;
+/// The alias type of the streamed data result, the size of the data in bytes.
+using StreamDataResult = std::uint64_t;
+/// The streamed data response type.
+using StreamDataResponse = Response<StreamDataResult>;
+/// The callback type of the streamed data response.
+using StreamDataResponseCallback = Callback<StreamDataResult>;
+
 /// The aggregated data response alias.
 using AggregatedDataResponse = Response<AggregatedDataResult>;
 /// The callback type of the aggregated data response.
@@ -181,6 +181,36 @@ class DATASERVICE_READ_API VersionedLayerClient final {
    */
   client::CancellableFuture<DataResponse> GetData(DataRequest data_request);
 
+  /**
+   * @brief Fetches data asynchronously using a partition ID or data handle,
+   * and delivers it in chunks as they arrive.
+   *
+   * Unlike `GetData` with `DataResponseCallback`, the data is not collected
+   * in memory, and the first bytes are available before the download is
+   * finished. If the data is found in the cache, it is delivered in one
+   * chunk. If the fetch option is not `OnlineOnly`, the downloaded data is
+   * also collected and written to the cache.
+   *
+   * The chunks are delivered in order. If the download is retried, the data
+   * is delivered again starting from the zero offset. Until the `callback`
+   * reports success, treat the delivered data as incomplete, and discard it
+   * if an error is reported.
+   *
+   * @param data_request The `DataRequest` instance that contains a complete set
+   * of request parameters.
+   * @note CacheWithUpdate fetch option is not supported.
+   * @param chunk_callback The `DataChunkCallback` object that receives the
+   * data chunks. It is called from the network thread, so do not block it.
+   * @param callback The `StreamDataResponseCallback` object that is invoked
+   * with the size of the data once all chunks are delivered, or with an
+   * error.
+   *
+   * @return A token that can be used to cancel this request.
+   */
+  client::CancellationToken GetData(DataRequest data_request,
+                                    DataChunkCallback chunk_callback,
+                                    StreamDataResponseCallback callback);
+
   /**
    * @brief Fetches data asynchronously using a TileKey.
    *
@@ -352,6 +382,25 @@ class DATASERVICE_READ_API VersionedLayerClient final {
       PrefetchTilesRequest request,
       PrefetchStatusCallback status_callback = nullptr);
 
+  /**
+   * @brief Gets the stored progress of an interrupted tiles prefetch.
+   *
+   * `PrefetchTiles` keeps a journal of its progress in the cache until all
+   * tiles are prefetched. A prefetch restarted with the same request skips
+   * the metadata queries and the tiles that are already done.
+   *
+   * @note The journal survives the restart of the application only if the
+   * disk cache is used. The catalog version must be set or cached.
+   *
+   * @param request The `PrefetchTilesRequest` instance used to start the
+   * prefetch.
+   *
+   * @return The `PrefetchTilesProgress` instance, or `boost::none` if there is
+   * no stored progress for the request.
+   */
+  boost::optional<PrefetchTilesProgress> GetPrefetchTilesProgress(
+      const PrefetchTilesRequest& request);
+
   /**
    * @brief Prefetches a set of partitions asynchronously.
    *
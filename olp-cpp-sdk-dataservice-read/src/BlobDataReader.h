@@ -19,6 +19,7 @@
 
 #pragma once
 
+#include <cstring>
 #include <string>
 #include <vector>
 
@@ -50,22 +51,20 @@ class BlobDataReader {
 };
 
 template <>
-bool BlobDataReader::Read<std::string>(std::string& value) {
-  size_t end = std::numeric_limits<size_t>::max();
-  for (size_t i = read_offset_; i < data_.size(); ++i) {
-    if (data_[i] == 0) {
-      end = i;
-      break;
-    }
+inline bool BlobDataReader::Read<std::string>(std::string& value) {
+  if (read_offset_ >= data_.size()) {
+    return false;
   }
-  if (end == std::numeric_limits<size_t>::max()) {
+
+  const auto begin = data_.data() + read_offset_;
+  const auto end = static_cast<const unsigned char*>(
+      std::memchr(begin, 0, data_.size() - read_offset_));
+  if (end == nullptr) {
     return false;
   }
 
-  value = data_[read_offset_] == 0
-              ? std::string()
-              : std::string(&data_[read_offset_], &data_[end]);
-  read_offset_ = end + 1;
+  value.assign(begin, end);
+  read_offset_ += static_cast<size_t>(end - begin) + 1;
   return true;
 }
 
@@ -0,0 +1,280 @@
+/*
+ * Copyright (C) 2021 HERE Europe B.V.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ * License-Filename: LICENSE
+ */
+
+#include "PrefetchJournal.h"
+
+#include <algorithm>
+#include <cinttypes>
+#include <cstdio>
+#include <sstream>
+
+#include <olp/core/cache/KeyValueCache.h>
+#include <olp/core/logging/Log.h>
+
+namespace olp {
+namespace dataservice {
+namespace read {
+
+namespace {
+constexpr auto kLogTag = "PrefetchJournal";
+constexpr auto kNoDataHandle = "-";
+
+// The journal layout in the cache:
+//   <key>                - the segment count and the root tiles
+//   <key>::q::<root>     - the query result of the root, "<tile> <handle>",
+//                          "-" stands for the tiles without data
+//   <key>::t             - the filtered tiles to download, same format
+//   <key>::d::<segment>  - the downloaded data handles
+std::string QueryKey(const std::string& key, const geo::TileKey& root) {
+  return key + "::q::" + root.ToHereTile();
+}
+
+std::string TilesKey(const std::string& key) { return key + "::t"; }
+
+std::string SegmentKey(const std::string& key, size_t segment) {
+  return key + "::d::" + std::to_string(segment);
+}
+
+cache::KeyValueCache::ValueTypePtr ToValue(const std::string& str) {
+  return std::make_shared<cache::KeyValueCache::ValueType>(str.begin(),
+                                                           str.end());
+}
+
+std::string FromValue(const cache::KeyValueCache::ValueTypePtr& value) {
+  return value ? std::string(value->begin(), value->end()) : std::string();
+}
+
+std::string SerializeHeader(size_t segment_count,
+                            const std::vector<geo::TileKey>& roots) {
+  std::ostringstream stream;
+  stream << segment_count;
+  for (const auto& root : roots) {
+    stream << ' ' << root.ToHereTile();
+  }
+  return stream.str();
+}
+
+bool ParseHeader(const std::string& header, size_t& segment_count,
+                 std::vector<geo::TileKey>& roots) {
+  std::istringstream stream(header);
+  if (!(stream >> segment_count)) {
+    return false;
+  }
+  std::string tile;
+  while (stream >> tile) {
+    roots.push_back(geo::TileKey::FromHereTile(tile));
+  }
+  return true;
+}
+
+std::string SerializeTiles(const PrefetchJournal::TilesResult& tiles) {
+  std::ostringstream stream;
+  for (const auto& tile : tiles) {
+    stream << tile.first.ToHereTile() << ' '
+           << (tile.second.empty() ? kNoDataHandle : tile.second) << '\n';
+  }
+  return stream.str();
+}
+
+PrefetchJournal::TilesResult ParseTiles(const std::string& value) {
+  PrefetchJournal::TilesResult result;
+  std::istringstream stream(value);
+  std::string tile, data_handle;
+  while (stream >> tile >> data_handle) {
+    if (data_handle == kNoDataHandle) {
+      data_handle.clear();
+    }
+    result.emplace(geo::TileKey::FromHereTile(tile), std::move(data_handle));
+  }
+  return result;
+}
+
+void ReadSegments(cache::KeyValueCache& cache, const std::string& key,
+                  size_t segment_count,
+                  std::unordered_set<std::string>& completed) {
+  cache::KeyValueCache::KeyListType keys;
+  for (size_t segment = 0; segment < segment_count; ++segment) {
+    keys.push_back(SegmentKey(key, segment));
+  }
+
+  for (const auto& value : cache.GetBatch(keys)) {
+    std::istringstream stream(FromValue(value));
+    std::string data_handle;
+    while (stream >> data_handle) {
+      completed.insert(std::move(data_handle));
+    }
+  }
+}
+}  // namespace
+
+constexpr size_t PrefetchJournal::kSegmentSize;
+constexpr time_t PrefetchJournal::kExpiry;
+
+PrefetchJournal::PrefetchJournal(std::shared_ptr<cache::KeyValueCache> cache,
+                                 std::string key)
+    : cache_(std::move(cache)), key_(std::move(key)) {}
+
+std::string PrefetchJournal::CreateKey(const client::HRN& catalog,
+                                       const std::string& layer_id,
+                                       int64_t version,
+                                       const PrefetchTilesRequest& request) {
+  auto tiles = request.GetTileKeys();
+  std::sort(tiles.begin(), tiles.end());
+
+  std::ostringstream description;
+  description << request.GetMinLevel() << '/' << request.GetMaxLevel() << '/'
+              << request.GetDataAggregationEnabled();
+  for (const auto& tile : tiles) {
+    description << ' ' << tile.ToHereTile();
+  }
+
+  // FNV-1a, stable between the runs and the platforms.
+  uint64_t hash = 14695981039346656037ull;
+  for (const auto c : description.str()) {
+    hash ^= static_cast<unsigned char>(c);
+    hash *= 1099511628211ull;
+  }
+
+  char hash_string[17];
+  std::snprintf(hash_string, sizeof(hash_string), "%016" PRIx64, hash);
+
+  return catalog.ToCatalogHRNString() + "::" + layer_id +
+         "::" + std::to_string(version) + "::prefetch::" + hash_string;
+}
+
+bool PrefetchJournal::Load(const std::vector<geo::TileKey>& roots) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  roots_ = roots;
+
+  size_t segment_count = 0;
+  std::vector<geo::TileKey> stored_roots;
+  if (ParseHeader(FromValue(cache_->Get(key_)), segment_count,
+                  stored_roots)) {
+    ReadSegments(*cache_, key_, segment_count, completed_);
+    segment_count_ = segment_count;
+
+    OLP_SDK_LOG_INFO_F(kLogTag, "Resuming prefetch, key=%s, completed=%zu",
+                       key_.c_str(), completed_.size());
+    return true;
+  }
+
+  if (!cache_->Put(key_, ToValue(SerializeHeader(0u, roots_)), kExpiry)) {
+    OLP_SDK_LOG_WARNING_F(kLogTag, "Failed to write the journal, key=%s",
+                          key_.c_str());
+  }
+  return false;
+}
+
+boost::optional<PrefetchJournal::TilesResult> PrefetchJournal::GetQuery(
+    const geo::TileKey& root) const {
+  auto value = cache_->Get(QueryKey(key_, root));
+  if (!value) {
+    return boost::none;
+  }
+  return ParseTiles(FromValue(value));
+}
+
+void PrefetchJournal::AddQuery(const geo::TileKey& root,
+                               const TilesResult& result) {
+  cache_->Put(QueryKey(key_, root), ToValue(SerializeTiles(result)),
+              kExpiry);
+}
+
+void PrefetchJournal::SetTiles(const TilesResult& tiles) {
+  cache_->Put(TilesKey(key_), ToValue(SerializeTiles(tiles)), kExpiry);
+}
+
+void PrefetchJournal::AddCompleted(const std::string& data_handle) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (!completed_.insert(data_handle).second) {
+    return;
+  }
+
+  unsaved_.push_back(data_handle);
+  if (unsaved_.size() >= kSegmentSize) {
+    WriteSegment();
+  }
+}
+
+void PrefetchJournal::Flush() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (!unsaved_.empty()) {
+    WriteSegment();
+  }
+}
+
+void PrefetchJournal::Remove() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  unsaved_.clear();
+  cache_->RemoveKeysWithPrefix(key_);
+}
+
+void PrefetchJournal::WriteSegment() {
+  std::ostringstream stream;
+  for (const auto& data_handle : unsaved_) {
+    stream << data_handle << '\n';
+  }
+
+  // The header is updated after the segment, so it never refers to a
+  // missing segment.
+  if (cache_->Put(SegmentKey(key_, segment_count_), ToValue(stream.str()),
+                  kExpiry) &&
+      cache_->Put(key_, ToValue(SerializeHeader(segment_count_ + 1, roots_)),
+                  kExpiry)) {
+    ++segment_count_;
+    unsaved_.clear();
+  } else {
+    OLP_SDK_LOG_WARNING_F(kLogTag, "Failed to write the journal, key=%s",
+                          key_.c_str());
+  }
+}
+
+boost::optional<PrefetchTilesProgress> PrefetchJournal::ReadProgress(
+    cache::KeyValueCache& cache, const std::string& key) {
+  size_t segment_count = 0;
+  std::vector<geo::TileKey> roots;
+  if (!ParseHeader(FromValue(cache.Get(key)), segment_count, roots)) {
+    return boost::none;
+  }
+
+  std::unordered_set<std::string> completed;
+  ReadSegments(cache, key, segment_count, completed);
+
+  PrefetchTilesProgress progress{0u, 0u, 0u, roots.size()};
+  for (const auto& root : roots) {
+    if (cache.Contains(QueryKey(key, root))) {
+      ++progress.queried_roots;
+    }
+  }
+
+  for (const auto& tile : ParseTiles(FromValue(cache.Get(TilesKey(key))))) {
+    if (tile.second.empty()) {
+      continue;
+    }
+    ++progress.total_tiles_to_prefetch;
+    if (completed.find(tile.second) != completed.end()) {
+      ++progress.prefetched_tiles;
+    }
+  }
+  return progress;
+}
+
+}  // namespace read
+}  // namespace dataservice
+}  // namespace olp
@@ -0,0 +1,119 @@
+/*
+ * Copyright (C) 2021 HERE Europe B.V.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ * License-Filename: LICENSE
+ */
+
+#pragma once
+
+#include <ctime>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+#include <olp/core/client/HRN.h>
+#include <olp/core/geo/tiling/TileKey.h>
+#include <olp/dataservice/read/PrefetchStatus.h>
+#include <olp/dataservice/read/PrefetchTilesRequest.h>
+#include <boost/optional.hpp>
+
+namespace olp {
+namespace cache {
+class KeyValueCache;
+}
+namespace dataservice {
+namespace read {
+
+/**
+ * @brief Stores the progress of a tiles prefetch in the cache, so a prefetch
+ * restarted with the same request skips the finished work.
+ *
+ * The journal keeps the results of the metadata queries per root tile, the
+ * filtered tiles to download, and the data handles that are already
+ * downloaded. The queries and tiles are written once, the downloaded data
+ * handles are appended in segments of `kSegmentSize` items. The entries
+ * expire after `kExpiry`, so an abandoned journal does not stay in the cache.
+ * The class is thread-safe.
+ */
+class PrefetchJournal final {
+ public:
+  /// The data handles by tile keys, as returned by the metadata queries.
+  using TilesResult = std::map<geo::TileKey, std::string>;
+
+  /// The number of downloaded data handles written in one segment.
+  static constexpr size_t kSegmentSize = 1000u;
+
+  /// The expiry of the journal entries in seconds, renewed by every write.
+  static constexpr time_t kExpiry = 24 * 60 * 60;
+
+  PrefetchJournal(std::shared_ptr<cache::KeyValueCache> cache,
+                  std::string key);
+
+  /// Creates the journal key that is unique for the prefetch request.
+  static std::string CreateKey(const client::HRN& catalog,
+                               const std::string& layer_id, int64_t version,
+                               const PrefetchTilesRequest& request);
+
+  /**
+   * @brief Loads the stored journal, or starts a new one.
+   *
+   * @param roots The root tiles queried by the prefetch.
+   *
+   * @return True if the stored journal is found.
+   */
+  bool Load(const std::vector<geo::TileKey>& roots);
+
+  /// Gets the stored query result of the root tile.
+  boost::optional<TilesResult> GetQuery(const geo::TileKey& root) const;
+
+  /// Stores the query result of the root tile.
+  void AddQuery(const geo::TileKey& root, const TilesResult& result);
+
+  /// Stores the filtered tiles to download, used for the progress.
+  void SetTiles(const TilesResult& tiles);
+
+  /// Marks the data handle as downloaded, writes the full segments.
+  void AddCompleted(const std::string& data_handle);
+
+  /// Writes the data handles that are not stored yet.
+  void Flush();
+
+  /// Removes the journal from the cache.
+  void Remove();
+
+  /// Reads the progress of the stored journal without loading it.
+  static boost::optional<PrefetchTilesProgress> ReadProgress(
+      cache::KeyValueCache& cache, const std::string& key);
+
+ private:
+  // Writes the unsaved data handles, called under the lock.
+  void WriteSegment();
+
+  std::shared_ptr<cache::KeyValueCache> cache_;
+  const std::string key_;
+  std::vector<geo::TileKey> roots_;
+  std::unordered_set<std::string> completed_;
+  std::vector<std::string> unsaved_;
+  size_t segment_count_{0};
+  mutable std::mutex mutex_;
+};
+
+}  // namespace read
+}  // namespace dataservice
+}  // namespace olp
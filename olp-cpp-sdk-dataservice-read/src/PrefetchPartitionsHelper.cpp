@@ -46,11 +46,13 @@ const size_t kQueryPartitionsMaxSize = 100u;
 
 void PrefetchPartitionsHelper::Prefetch(
     std::shared_ptr<DownloadJob> download_job,
-    std::vector<std::string> partitions, QueryFunc query, TaskSink& task_sink,
-    uint32_t priority, client::CancellationContext execution_context) {
+    std::vector<std::string> partitions, QueryFunc query,
+    CachedItemsFunc<PartitionDataHandleResult> cached_items,
+    TaskSink& task_sink, uint32_t priority,
+    client::CancellationContext execution_context) {
   auto query_job = std::make_shared<QueryPartitionsJob>(
       std::move(query), nullptr, download_job, task_sink, execution_context,
-      priority);
+      priority, std::move(cached_items));
 
   size_t query_size = partitions.size() / kQueryPartitionsMaxSize;
   query_size += (partitions.size() % kQueryPartitionsMaxSize > 0) ? 1 : 0;
@@ -38,10 +38,12 @@ class PrefetchPartitionsHelper {
   using QueryFunc = QueryItemsFunc<std::string, std::vector<std::string>,
                                    PartitionsDataHandleExtendedResponse>;
 
-  static void Prefetch(std::shared_ptr<DownloadJob> download_job,
-                       std::vector<std::string> partitions, QueryFunc query,
-                       TaskSink& task_sink, uint32_t priority,
-                       client::CancellationContext execution_context);
+  static void Prefetch(
+      std::shared_ptr<DownloadJob> download_job,
+      std::vector<std::string> partitions, QueryFunc query,
+      CachedItemsFunc<PartitionDataHandleResult> cached_items,
+      TaskSink& task_sink, uint32_t priority,
+      client::CancellationContext execution_context);
 };
 
 }  // namespace read
@@ -53,13 +53,14 @@ class PrefetchTilesHelper {
   static void Prefetch(std::shared_ptr<DownloadJob> download_job,
                        const std::vector<geo::TileKey>& roots, QueryFunc query,
                        FilterItemsFunc<repository::SubQuadsResult> filter,
+                       CachedItemsFunc<repository::SubQuadsResult> cached_items,
                        TaskSink& task_sink, uint32_t priority,
                        client::CancellationContext execution_context) {
     auto query_job = std::make_shared<
         QueryMetadataJob<geo::TileKey, geo::TileKey, PrefetchTilesResult,
                          repository::SubQuadsResponse, PrefetchStatus>>(
         std::move(query), std::move(filter), download_job, task_sink,
-        execution_context, priority);
+        execution_context, priority, std::move(cached_items));
 
     query_job->Initialize(roots.size());
 
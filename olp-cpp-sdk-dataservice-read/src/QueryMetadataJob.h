@@ -19,6 +19,7 @@
 
 #pragma once
 
+#include <algorithm>
 #include <iterator>
 #include <string>
 #include <utility>
@@ -42,6 +43,12 @@ using QueryItemsFunc =
 template <typename QueryResponseType>
 using FilterItemsFunc = std::function<QueryResponseType(QueryResponseType)>;
 
+// Checks which of the queried items are already cached, returns a flag for
+// every item in the iteration order. The cached items are not downloaded.
+template <typename QueryResultType>
+using CachedItemsFunc =
+    std::function<std::vector<bool>(const QueryResultType&)>;
+
 using VectorOfTokens = std::vector<olp::client::CancellationToken>;
 
 static olp::client::CancellationToken CreateToken(VectorOfTokens tokens) {
@@ -66,9 +73,12 @@ class QueryMetadataJob {
           DownloadItemsJob<ItemType, PrefetchResult, PrefetchStatusType>>
           download_job,
       TaskSink& task_sink, client::CancellationContext execution_context,
-      uint32_t priority)
+      uint32_t priority,
+      CachedItemsFunc<typename QueryResponseType::ResultType> cached_items =
+          nullptr)
       : query_(std::move(query)),
         filter_(std::move(filter)),
+        cached_items_(std::move(cached_items)),
         download_job_(std::move(download_job)),
         task_sink_(task_sink),
         execution_context_(execution_context),
@@ -131,8 +141,17 @@ class QueryMetadataJob {
         return;
       }
 
-      OLP_SDK_LOG_DEBUG_F("QueryMetadataJob", "Starting download, requests=%zu",
-                          query_result_.size());
+      // Checks the whole result in one batch, so only the misses are
+      // scheduled for download.
+      std::vector<bool> cached;
+      if (cached_items_) {
+        cached = cached_items_(query_result_);
+      }
+
+      OLP_SDK_LOG_DEBUG_F(
+          "QueryMetadataJob", "Starting download, requests=%zu, cached=%zu",
+          query_result_.size(),
+          static_cast<size_t>(std::count(cached.begin(), cached.end(), true)));
 
       download_job_->Initialize(query_result_.size(), accumulated_statistics_);
 
@@ -143,31 +162,32 @@ class QueryMetadataJob {
       execution_context_.ExecuteOrCancelled(
           [&]() {
             VectorOfTokens tokens;
-            std::transform(
-                std::begin(query_result_), std::end(query_result_),
-                std::back_inserter(tokens),
-                [&](const typename QueryResponseType::ResultType::value_type&
-                        item) {
-                  const std::string& data_handle = item.second;
-                  const auto& item_key = item.first;
-
-                  auto result = task_sink_.AddTaskChecked(
-                      [=](client::CancellationContext context) {
-                        return download_job->Download(data_handle, context);
-                      },
-                      [=](ExtendedDataResponse response) {
-                        download_job->CompleteItem(item_key,
-                                                   std::move(response));
-                      },
-                      priority_);
-
-                  if (result) {
-                    return *result;
-                  }
-
-                  all_download_tasks_triggered = false;
-                  return client::CancellationToken();
-                });
+            size_t index = 0;
+            for (const auto& item : query_result_) {
+              const std::string& data_handle = item.second;
+              const auto& item_key = item.first;
+
+              if (index < cached.size() && cached[index++]) {
+                download_job->CompleteItem(item_key,
+                                           ExtendedDataResponse(nullptr));
+                continue;
+              }
+
+              auto result = task_sink_.AddTaskChecked(
+                  [=](client::CancellationContext context) {
+                    return download_job->Download(data_handle, context);
+                  },
+                  [=](ExtendedDataResponse response) {
+                    download_job->CompleteItem(item_key, std::move(response));
+                  },
+                  priority_);
+
+              if (result) {
+                tokens.push_back(*result);
+              } else {
+                all_download_tasks_triggered = false;
+              }
+            }
             return CreateToken(std::move(tokens));
           },
           [&]() {
@@ -186,6 +206,7 @@ class QueryMetadataJob {
  protected:
   QueryItemsFunc<ItemType, QueryType, QueryResponseType> query_;
   FilterItemsFunc<typename QueryResponseType::ResultType> filter_;
+  CachedItemsFunc<typename QueryResponseType::ResultType> cached_items_;
   size_t query_count_{0};
   size_t query_size_{0};
   bool canceled_{false};
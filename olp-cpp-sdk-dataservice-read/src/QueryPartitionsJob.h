@@ -56,10 +56,11 @@ class QueryPartitionsJob
                                        PrefetchPartitionsStatus>>
           download_job,
       TaskSink& task_sink, client::CancellationContext execution_context,
-      uint32_t priority)
+      uint32_t priority,
+      CachedItemsFunc<PartitionDataHandleResult> cached_items = nullptr)
       : QueryMetadataJob(std::move(query), std::move(filter),
                          std::move(download_job), task_sink, execution_context,
-                         priority) {}
+                         priority, std::move(cached_items)) {}
 
   virtual bool CheckIfFail() {
     // Return error only if all fails
@@ -56,6 +56,13 @@ client::CancellableFuture<DataResponse> VersionedLayerClient::GetData(
   return impl_->GetData(std::move(data_request));
 }
 
+client::CancellationToken VersionedLayerClient::GetData(
+    DataRequest data_request, DataChunkCallback chunk_callback,
+    StreamDataResponseCallback callback) {
+  return impl_->GetData(std::move(data_request), std::move(chunk_callback),
+                        std::move(callback));
+}
+
 client::CancellationToken VersionedLayerClient::GetPartitions(
     PartitionsRequest partitions_request, PartitionsResponseCallback callback) {
   return impl_->GetPartitions(std::move(partitions_request),
@@ -80,6 +87,12 @@ VersionedLayerClient::PrefetchTiles(PrefetchTilesRequest request,
   return impl_->PrefetchTiles(std::move(request), std::move(status_callback));
 }
 
+boost::optional<PrefetchTilesProgress>
+VersionedLayerClient::GetPrefetchTilesProgress(
+    const PrefetchTilesRequest& request) {
+  return impl_->GetPrefetchTilesProgress(request);
+}
+
 client::CancellationToken VersionedLayerClient::PrefetchPartitions(
     PrefetchPartitionsRequest request,
     PrefetchPartitionsResponseCallback callback,
@@ -22,6 +22,7 @@
 #include <algorithm>
 #include <iterator>
 #include <map>
+#include <mutex>
 #include <string>
 #include <utility>
 #include <vector>
@@ -37,6 +38,7 @@
 #include <olp/dataservice/read/CatalogVersionRequest.h>
 #include "Common.h"
 #include "ExtendedApiResponseHelpers.h"
+#include "PrefetchJournal.h"
 #include "PrefetchPartitionsHelper.h"
 #include "PrefetchTilesHelper.h"
 #include "ProtectDependencyResolver.h"
@@ -56,6 +58,21 @@ namespace {
 constexpr auto kLogTag = "VersionedLayerClientImpl";
 constexpr int64_t kInvalidVersion = -1;
 constexpr auto kQuadTreeDepth = 4;
+
+// Whether the same request fails again with this error, so a prefetch that
+// failed with it is not resumed.
+bool IsPermanentError(const client::ApiError& error) {
+  switch (error.GetErrorCode()) {
+    case client::ErrorCode::InvalidArgument:
+    case client::ErrorCode::AccessDenied:
+    case client::ErrorCode::BadRequest:
+    case client::ErrorCode::PreconditionFailed:
+    case client::ErrorCode::NotFound:
+      return true;
+    default:
+      return false;
+  }
+}
 }  // namespace
 
 VersionedLayerClientImpl::VersionedLayerClientImpl(
@@ -72,6 +89,12 @@ VersionedLayerClientImpl::VersionedLayerClientImpl(
   if (!settings_.cache) {
     settings_.cache = client::OlpClientSettingsFactory::CreateDefaultCache({});
   }
+
+  // The trees kept in memory do not expire, so they are only used when the
+  // cached trees do not expire either.
+  if (settings_.default_cache_expiration == std::chrono::seconds::max()) {
+    quad_tree_cache_ = std::make_shared<repository::QuadTreeIndexCache>();
+  }
 }
 
 bool VersionedLayerClientImpl::CancelPendingRequests() {
@@ -162,6 +185,86 @@ client::CancellableFuture<DataResponse> VersionedLayerClientImpl::GetData(
                                                  std::move(promise));
 }
 
+client::CancellationToken VersionedLayerClientImpl::GetData(
+    DataRequest request, DataChunkCallback chunk_callback,
+    StreamDataResponseCallback callback) {
+  auto data_task =
+      [=](client::CancellationContext context) mutable -> StreamDataResponse {
+    if (!chunk_callback) {
+      return {{client::ErrorCode::InvalidArgument,
+               "Data chunk callback is empty"}};
+    }
+
+    if (request.GetFetchOption() == CacheWithUpdate) {
+      return {{client::ErrorCode::InvalidArgument,
+               "CacheWithUpdate option can not be used for versioned "
+               "layer"}};
+    }
+
+    int64_t version = -1;
+    if (!request.GetDataHandle()) {
+      auto version_response = GetVersion(request.GetBillingTag(),
+                                         request.GetFetchOption(), context);
+      if (!version_response.IsSuccessful()) {
+        return version_response.GetError();
+      }
+      version = version_response.GetResult().GetVersion();
+    }
+
+    // The chunks arrive on the network thread. The state is shared, so no
+    // chunk is delivered after the request is finished, e.g. on timeout.
+    struct StreamState {
+      std::mutex mutex;
+      bool finished{false};
+      std::uint64_t size{0u};
+    };
+    auto state = std::make_shared<StreamState>();
+
+    auto data_callback = [=](const std::uint8_t* data, std::uint64_t offset,
+                             std::size_t length) {
+      std::lock_guard<std::mutex> lock(state->mutex);
+      if (!state->finished) {
+        state->size = offset + length;
+        chunk_callback(data, offset, length);
+      }
+    };
+
+    repository::DataRepository repository(catalog_, settings_, lookup_client_,
+                                          mutex_storage_);
+    auto response = repository.GetVersionedData(
+        layer_id_, request, version, context, false, std::move(data_callback));
+
+    std::lock_guard<std::mutex> lock(state->mutex);
+    state->finished = true;
+    if (!response.IsSuccessful()) {
+      return response.GetError();
+    }
+    return state->size;
+  };
+
+  return task_sink_.AddTask(std::move(data_task), std::move(callback),
+                            request.GetPriority());
+}
+
+boost::optional<PrefetchTilesProgress>
+VersionedLayerClientImpl::GetPrefetchTilesProgress(
+    const PrefetchTilesRequest& request) {
+  if (!settings_.cache) {
+    return boost::none;
+  }
+
+  auto response = GetVersion(request.GetBillingTag(), CacheOnly,
+                             client::CancellationContext{});
+  if (!response.IsSuccessful()) {
+    return boost::none;
+  }
+
+  const auto version = response.GetResult().GetVersion();
+  return PrefetchJournal::ReadProgress(
+      *settings_.cache,
+      PrefetchJournal::CreateKey(catalog_, layer_id_, version, request));
+}
+
 client::CancellationToken VersionedLayerClientImpl::PrefetchPartitions(
     PrefetchPartitionsRequest request,
     PrefetchPartitionsResponseCallback callback,
@@ -249,17 +352,24 @@ client::CancellationToken VersionedLayerClientImpl::PrefetchPartitions(
       return {result, response.GetPayload()};
     };
 
+    auto cached_items = [=](const PartitionDataHandleResult& partitions) {
+      std::vector<std::string> data_handles;
+      data_handles.reserve(partitions.size());
+      for (const auto& partition : partitions) {
+        data_handles.push_back(partition.second);
+      }
+
+      repository::DataCacheRepository data_cache_repository(catalog_,
+                                                            settings_.cache);
+      return data_cache_repository.IsCached(layer_id_, data_handles);
+    };
+
     auto download = [=](std::string data_handle,
                         client::CancellationContext inner_context) mutable {
       if (data_handle.empty()) {
         return BlobApi::DataResponse(
             client::ApiError(client::ErrorCode::NotFound, "Not found"));
       }
-      repository::DataCacheRepository data_cache_repository(catalog_,
-                                                            settings_.cache);
-      if (data_cache_repository.IsCached(layer_id_, data_handle)) {
-        return BlobApi::DataResponse(nullptr);
-      }
 
       repository::DataRepository repository(catalog_, settings_, lookup_client_,
                                             mutex_storage_);
@@ -293,7 +403,8 @@ client::CancellationToken VersionedLayerClientImpl::PrefetchPartitions(
         std::move(call_user_callback), std::move(status_callback));
     return PrefetchPartitionsHelper::Prefetch(
         std::move(download_job), request.GetPartitionIds(), std::move(query),
-        task_sink_, request.GetPriority(), std::move(context));
+        std::move(cached_items), task_sink_, request.GetPriority(),
+        std::move(context));
   };
   const auto priority = request.GetPriority();
   return task_sink_.AddTask(
@@ -401,9 +512,24 @@ client::CancellationToken VersionedLayerClientImpl::PrefetchTiles(
         OLP_SDK_LOG_DEBUG_F(kLogTag, "PrefetchTiles, subquads=%zu, key=%s",
                             sliced_tiles.size(), key.c_str());
 
+        std::vector<geo::TileKey> roots;
+        roots.reserve(sliced_tiles.size());
+
+        std::transform(
+            sliced_tiles.begin(), sliced_tiles.end(), std::back_inserter(roots),
+            [](const repository::RootTilesForRequest::value_type& root) {
+              return root.first;
+            });
+
+        // The journal lets a restarted prefetch skip the finished work.
+        auto journal = std::make_shared<PrefetchJournal>(
+            settings_.cache,
+            PrefetchJournal::CreateKey(catalog_, layer_id_, version, request));
+        journal->Load(roots);
+
         const bool aggregation_enabled = request.GetDataAggregationEnabled();
 
-        auto filter = [=](repository::SubQuadsResult tiles) mutable
+        auto filter_tiles = [=](repository::SubQuadsResult tiles) mutable
             -> repository::SubQuadsResult {
           if (request_only_input_tiles) {
             return repository.FilterTilesByList(request, std::move(tiles));
@@ -412,13 +538,25 @@ client::CancellationToken VersionedLayerClientImpl::PrefetchTiles(
           }
         };
 
+        auto filter = [=](repository::SubQuadsResult tiles) mutable
+            -> repository::SubQuadsResult {
+          auto result = filter_tiles(std::move(tiles));
+          journal->SetTiles(result);
+          return result;
+        };
+
         auto query = [=](geo::TileKey root,
                          client::CancellationContext inner_context) mutable {
+          auto stored_result = journal->GetQuery(root);
+          if (stored_result) {
+            return repository::SubQuadsResponse(std::move(*stored_result));
+          }
+
           auto response = repository.GetVersionedSubQuads(
               root, kQuadTreeDepth, version, inner_context);
 
           if (response.IsSuccessful() && aggregation_enabled) {
-            auto subquads = filter(response.GetResult());
+            auto subquads = filter_tiles(response.GetResult());
             auto network_stats = repository.LoadAggregatedSubQuads(
                 root, std::move(subquads), version, inner_context);
 
@@ -427,9 +565,31 @@ client::CancellationToken VersionedLayerClientImpl::PrefetchTiles(
             response = {response.GetResult(), network_stats};
           }
 
+          if (response.IsSuccessful()) {
+            journal->AddQuery(root, response.GetResult());
+          }
+
           return response;
         };
 
+        auto cached_items = [=](const repository::SubQuadsResult& tiles) {
+          std::vector<std::string> data_handles;
+          data_handles.reserve(tiles.size());
+          for (const auto& tile : tiles) {
+            data_handles.push_back(tile.second);
+          }
+
+          repository::DataCacheRepository data_cache_repository(
+              catalog_, settings_.cache);
+          auto cached = data_cache_repository.IsCached(layer_id_, data_handles);
+          for (size_t index = 0; index < cached.size(); ++index) {
+            if (cached[index]) {
+              journal->AddCompleted(data_handles[index]);
+            }
+          }
+          return cached;
+        };
+
         auto& billing_tag = request.GetBillingTag();
         auto download = [=](std::string data_handle,
                             client::CancellationContext inner_context) mutable {
@@ -437,31 +597,43 @@ client::CancellationToken VersionedLayerClientImpl::PrefetchTiles(
             return BlobApi::DataResponse(
                 ApiError(ErrorCode::NotFound, "Not found"));
           }
-          repository::DataCacheRepository data_cache_repository(
-              catalog_, settings_.cache);
-          if (data_cache_repository.IsCached(layer_id_, data_handle)) {
-            return BlobApi::DataResponse(nullptr);
-          }
 
           repository::DataRepository repository(catalog_, settings_,
                                                 lookup_client_, mutex_storage_);
           // Fetch from online
-          return repository.GetVersionedData(
+          auto response = repository.GetVersionedData(
               layer_id_,
-              DataRequest()
-                  .WithDataHandle(std::move(data_handle))
-                  .WithBillingTag(billing_tag),
+              DataRequest().WithDataHandle(data_handle).WithBillingTag(
+                  billing_tag),
               version, std::move(inner_context), true);
+          if (response.IsSuccessful()) {
+            journal->AddCompleted(data_handle);
+          }
+          return response;
         };
 
-        std::vector<geo::TileKey> roots;
-        roots.reserve(sliced_tiles.size());
-
-        std::transform(
-            sliced_tiles.begin(), sliced_tiles.end(), std::back_inserter(roots),
-            [](const repository::RootTilesForRequest::value_type& root) {
-              return root.first;
-            });
+        // The journal is kept for the next attempt while a restarted prefetch
+        // can do more, and is removed once every tile is either prefetched or
+        // failed for good.
+        auto prefetch_callback = [=](PrefetchTilesResponse response) {
+          const auto& result = response.GetResult();
+          const bool finished =
+              response.IsSuccessful()
+                  ? std::all_of(
+                        result.begin(), result.end(),
+                        [](const std::shared_ptr<PrefetchTileResult>& tile) {
+                          return tile &&
+                                 (tile->IsSuccessful() ||
+                                  IsPermanentError(tile->GetError()));
+                        })
+                  : IsPermanentError(response.GetError());
+          if (finished) {
+            journal->Remove();
+          } else {
+            journal->Flush();
+          }
+          callback(std::move(response));
+        };
 
         auto append_result = [](ExtendedDataResponse response,
                                 geo::TileKey item,
@@ -476,13 +648,13 @@ client::CancellationToken VersionedLayerClientImpl::PrefetchTiles(
         };
 
         auto download_job = std::make_shared<PrefetchTilesHelper::DownloadJob>(
-            std::move(download), std::move(append_result), std::move(callback),
-            std::move(status_callback));
+            std::move(download), std::move(append_result),
+            std::move(prefetch_callback), std::move(status_callback));
 
         return PrefetchTilesHelper::Prefetch(
             std::move(download_job), std::move(roots), std::move(query),
-            std::move(filter), task_sink_, request.GetPriority(),
-            std::move(context));
+            std::move(filter), std::move(cached_items), task_sink_,
+            request.GetPriority(), std::move(context));
       },
       request.GetPriority(), execution_context);
 }
@@ -550,7 +722,7 @@ client::CancellationToken VersionedLayerClientImpl::GetData(
     }
 
     repository::DataRepository repository(catalog_, settings_, lookup_client_,
-                                          mutex_storage_);
+                                          mutex_storage_, quad_tree_cache_);
     return repository.GetVersionedTile(
         layer_id_, request, version_response.GetResult().GetVersion(),
         std::move(context));
@@ -601,7 +773,8 @@ bool VersionedLayerClientImpl::RemoveFromCache(
 bool VersionedLayerClientImpl::RemoveFromCache(const geo::TileKey& tile) {
   read::QuadTreeIndex cached_tree;
   repository::PartitionsCacheRepository partitions_cache_repository(
-      catalog_, layer_id_, settings_.cache);
+      catalog_, layer_id_, settings_.cache, settings_.default_cache_expiration,
+      quad_tree_cache_);
   auto version = catalog_version_.load();
   if (version == kInvalidVersion) {
     OLP_SDK_LOG_WARNING(
@@ -667,8 +840,9 @@ bool VersionedLayerClientImpl::IsCached(const geo::TileKey& tile,
 
   auto cache = settings_.cache;
 
-  repository::PartitionsCacheRepository partitions_repo(catalog_, layer_id_,
-                                                        cache);
+  repository::PartitionsCacheRepository partitions_repo(
+      catalog_, layer_id_, cache, settings_.default_cache_expiration,
+      quad_tree_cache_);
 
   if (partitions_repo.FindQuadTree(tile, version, cached_tree)) {
     auto data = cached_tree.Find(tile, aggregated);
@@ -704,7 +878,8 @@ client::CancellationToken VersionedLayerClientImpl::GetAggregatedData(
 
     auto version = version_response.GetResult().GetVersion();
     repository::PartitionsRepository repository(catalog_, layer_id_, settings_,
-                                                lookup_client_, mutex_storage_);
+                                                lookup_client_, mutex_storage_,
+                                                quad_tree_cache_);
     auto partition_response =
         repository.GetAggregatedTile(std::move(request), version, context);
     if (!partition_response.IsSuccessful()) {
@@ -37,6 +37,7 @@
 #include <boost/optional.hpp>
 #include "TaskSink.h"
 #include "repositories/NamedMutex.h"
+#include "repositories/QuadTreeIndexCache.h"
 
 namespace olp {
 namespace thread {
@@ -65,6 +66,10 @@ class VersionedLayerClientImpl {
   virtual client::CancellableFuture<DataResponse> GetData(
       DataRequest data_request);
 
+  virtual client::CancellationToken GetData(
+      DataRequest request, DataChunkCallback chunk_callback,
+      StreamDataResponseCallback callback);
+
   virtual client::CancellationToken GetData(TileRequest request,
                                             DataResponseCallback callback);
 
@@ -83,6 +88,9 @@ class VersionedLayerClientImpl {
   virtual client::CancellableFuture<PrefetchTilesResponse> PrefetchTiles(
       PrefetchTilesRequest request, PrefetchStatusCallback status_callback);
 
+  virtual boost::optional<PrefetchTilesProgress> GetPrefetchTilesProgress(
+      const PrefetchTilesRequest& request);
+
   virtual client::CancellationToken PrefetchPartitions(
       PrefetchPartitionsRequest request,
       PrefetchPartitionsResponseCallback callback,
@@ -125,6 +133,7 @@ class VersionedLayerClientImpl {
   std::atomic<int64_t> catalog_version_;
   client::ApiLookupClient lookup_client_;
   repository::NamedMutexStorage mutex_storage_;
+  std::shared_ptr<repository::QuadTreeIndexCache> quad_tree_cache_;
   TaskSink task_sink_;
 };
 
@@ -229,6 +229,18 @@ client::CancellationToken VolatileLayerClientImpl::PrefetchTiles(
           }
         };
 
+        auto cached_items = [=](const repository::SubQuadsResult& tiles) {
+          std::vector<std::string> data_handles;
+          data_handles.reserve(tiles.size());
+          for (const auto& tile : tiles) {
+            data_handles.push_back(tile.second);
+          }
+
+          repository::DataCacheRepository data_cache_repository(
+              catalog_, settings_.cache);
+          return data_cache_repository.IsCached(layer_id_, data_handles);
+        };
+
         auto billing_tag = request.GetBillingTag();
         auto download = [=](std::string data_handle,
                             client::CancellationContext inner_context) mutable {
@@ -236,11 +248,6 @@ client::CancellationToken VolatileLayerClientImpl::PrefetchTiles(
             return BlobApi::DataResponse(
                 client::ApiError(client::ErrorCode::NotFound, "Not found"));
           }
-          repository::DataCacheRepository data_cache_repository(
-              catalog_, settings_.cache);
-          if (data_cache_repository.IsCached(layer_id_, data_handle)) {
-            return BlobApi::DataResponse(nullptr);
-          }
 
           repository::DataRepository repository(catalog_, settings_,
                                                 lookup_client_, mutex_storage_);
@@ -279,7 +286,8 @@ client::CancellationToken VolatileLayerClientImpl::PrefetchTiles(
             nullptr);
         return PrefetchTilesHelper::Prefetch(
             std::move(download_job), std::move(roots), std::move(query),
-            std::move(filter), task_sink_, request.GetPriority(), context);
+            std::move(filter), std::move(cached_items), task_sink_,
+            request.GetPriority(), context);
       },
       request.GetPriority(), execution_context);
 }
@@ -19,12 +19,20 @@
 
 #include "BlobApi.h"
 
+#include <algorithm>
+#include <cctype>
+#include <condition_variable>
 #include <map>
 #include <memory>
+#include <mutex>
 #include <sstream>
+#include <vector>
 
+#include <olp/core/client/CancellationContext.h>
 #include <olp/core/client/HttpResponse.h>
 #include <olp/core/client/OlpClient.h>
+#include <olp/core/http/HttpStatusCode.h>
+#include <olp/core/http/NetworkConstants.h>
 
 namespace olp {
 namespace dataservice {
@@ -32,11 +40,225 @@ namespace read {
 
 namespace client = olp::client;
 
+namespace {
+// The number of attempts for a single range, on top of the client retries.
+constexpr int kMaxRangeAttempts = 3;
+
+std::string ByteRange(std::uint64_t offset, std::uint64_t length) {
+  return std::to_string(offset) + "-" + std::to_string(offset + length - 1);
+}
+
+/// Whether the `Content-Range` header of a partial response matches the
+/// requested range.
+bool HasContentRange(const http::Headers& headers, std::uint64_t offset,
+                     std::uint64_t length) {
+  const std::string name = http::kContentRangeHeader;
+  const auto expected = "bytes " + ByteRange(offset, length) + "/";
+  for (const auto& header : headers) {
+    const bool same_name =
+        header.first.size() == name.size() &&
+        std::equal(name.begin(), name.end(), header.first.begin(),
+                   [](char lhs, char rhs) {
+                     return std::tolower(lhs) == std::tolower(rhs);
+                   });
+    if (same_name) {
+      return header.second.compare(0, expected.size(), expected) == 0;
+    }
+  }
+  return false;
+}
+
+std::uint64_t BodySize(std::stringstream& body) {
+  const auto size = body.seekg(0, std::ios::end).tellg();
+  body.seekg(0, std::ios::beg);
+  return size > 0 ? static_cast<std::uint64_t>(size) : 0u;
+}
+
+bool IsRangeRetryable(int status) {
+  if (status == static_cast<int>(http::ErrorCode::CANCELLED_ERROR)) {
+    return false;
+  }
+  return status < 0 || status == http::HttpStatusCode::TOO_MANY_REQUESTS ||
+         status >= http::HttpStatusCode::INTERNAL_SERVER_ERROR;
+}
+
+/// Downloads the byte ranges of a blob concurrently into one buffer.
+class RangeDownload : public std::enable_shared_from_this<RangeDownload> {
+ public:
+  RangeDownload(client::OlpClient client, std::string path,
+                std::multimap<std::string, std::string> query_params,
+                std::uint64_t data_size, std::size_t range_count)
+      : client_(std::move(client)),
+        path_(std::move(path)),
+        query_params_(std::move(query_params)),
+        buffer_(std::make_shared<std::vector<unsigned char>>(
+            static_cast<std::size_t>(data_size))) {
+    const auto range_size = (data_size + range_count - 1) / range_count;
+    for (std::uint64_t offset = 0; offset < data_size; offset += range_size) {
+      ranges_.push_back({offset, std::min(range_size, data_size - offset), 0});
+    }
+    pending_ = ranges_.size();
+  }
+
+  void Start() {
+    for (std::size_t index = 0; index < ranges_.size(); ++index) {
+      Request(index);
+    }
+  }
+
+  void Cancel() {
+    std::vector<client::CancellationToken> tokens;
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      cancelled_ = true;
+      tokens.swap(tokens_);
+    }
+    for (auto& token : tokens) {
+      token.Cancel();
+    }
+  }
+
+  /// Waits until all ranges are downloaded or one of them fails, and no
+  /// request is in flight.
+  BlobApi::DataResponse Wait() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    condition_.wait(lock, [&] {
+      return in_flight_ == 0 && (pending_ == 0 || cancelled_ || failed_);
+    });
+
+    if (cancelled_) {
+      return {client::ApiError::Cancelled(), statistics_};
+    }
+    if (failed_) {
+      return {{client::ErrorCode::Unknown, "Range request failed"},
+              statistics_};
+    }
+    return {std::move(buffer_), statistics_};
+  }
+
+  /// Whether a range failed, e.g. the server does not honor the ranges.
+  bool Failed() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return failed_;
+  }
+
+ private:
+  struct Range {
+    std::uint64_t offset;
+    std::uint64_t length;
+    int attempts;
+  };
+
+  void Request(std::size_t index) {
+    const auto& range = ranges_[index];
+    const std::multimap<std::string, std::string> header_params = {
+        {"Accept", "application/json"},
+        {http::kRangeHeader, "bytes=" + ByteRange(range.offset, range.length)}};
+
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      if (cancelled_ || failed_) {
+        return;
+      }
+      ++in_flight_;
+    }
+
+    // The client does not merge the requests with a range, although they
+    // have the same URL.
+    auto self = shared_from_this();
+    auto token = client_.CallApi(
+        path_, "GET", query_params_, header_params, {}, nullptr, "",
+        [self, index](client::HttpResponse response) {
+          self->OnResponse(index, std::move(response));
+        });
+
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      if (!cancelled_ && !failed_) {
+        tokens_.push_back(std::move(token));
+        return;
+      }
+    }
+    token.Cancel();
+  }
+
+  void OnResponse(std::size_t index, client::HttpResponse response) {
+    auto& range = ranges_[index];
+    const auto status = response.GetStatus();
+
+    // The body is read straight into its place in the buffer. The ranges do
+    // not overlap, and the buffer is kept while a request is in flight.
+    bool succeeded =
+        status == http::HttpStatusCode::PARTIAL_CONTENT &&
+        BodySize(response.response) == range.length &&
+        HasContentRange(response.GetHeaders(), range.offset, range.length);
+    if (succeeded) {
+      succeeded = static_cast<bool>(response.response.read(
+          reinterpret_cast<char*>(buffer_->data() + range.offset),
+          static_cast<std::streamsize>(range.length)));
+    }
+
+    std::vector<client::CancellationToken> tokens;
+    bool retry = false;
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      statistics_ += response.GetNetworkStatistics();
+      if (--in_flight_ == 0) {
+        condition_.notify_one();
+      }
+      if (pending_ == 0 || cancelled_ || failed_) {
+        return;
+      }
+
+      if (succeeded) {
+        --pending_;
+        return;
+      }
+
+      // The server can ignore the range, send another one, or reject it with
+      // 416. Any failure that is not retried falls back to a single request.
+      if (IsRangeRetryable(status) && ++range.attempts < kMaxRangeAttempts) {
+        retry = true;
+      } else {
+        failed_ = true;
+      }
+
+      if (!retry) {
+        tokens.swap(tokens_);
+      }
+    }
+
+    if (retry) {
+      Request(index);
+    }
+    for (auto& token : tokens) {
+      token.Cancel();
+    }
+  }
+
+  client::OlpClient client_;
+  const std::string path_;
+  const std::multimap<std::string, std::string> query_params_;
+  std::vector<Range> ranges_;
+
+  mutable std::mutex mutex_;
+  std::condition_variable condition_;
+  std::shared_ptr<std::vector<unsigned char>> buffer_;
+  std::size_t pending_{0};
+  std::size_t in_flight_{0};
+  bool failed_{false};
+  bool cancelled_{false};
+  client::NetworkStatistics statistics_;
+  std::vector<client::CancellationToken> tokens_;
+};
+}  // namespace
+
 BlobApi::DataResponse BlobApi::GetBlob(
     const client::OlpClient& client, const std::string& layer_id,
     const std::string& data_handle, boost::optional<std::string> billing_tag,
     boost::optional<std::string> range,
-    const client::CancellationContext& context) {
+    const client::CancellationContext& context,
+    http::Network::DataCallback data_callback) {
   std::multimap<std::string, std::string> header_params;
   header_params.emplace("Accept", "application/json");
   if (range) {
@@ -49,17 +271,52 @@ BlobApi::DataResponse BlobApi::GetBlob(
   }
 
   std::string metadata_uri = "/layers/" + layer_id + "/data/" + data_handle;
-  auto api_response = client.CallApi(metadata_uri, "GET", query_params,
-                                     header_params, {}, nullptr, "", context);
+  // The blobs can be large, so the body is either streamed to the data
+  // callback, or collected into a buffer that is returned without copying.
+  const bool buffer_response = !data_callback;
+  auto api_response = client.CallApi(
+      metadata_uri, "GET", query_params, header_params, {}, nullptr, "",
+      context, buffer_response, std::move(data_callback));
 
   if (api_response.status != http::HttpStatusCode::OK) {
     return {{api_response.status, api_response.response.str()},
             api_response.GetNetworkStatistics()};
   }
 
-  auto result = std::make_shared<std::vector<unsigned char>>();
-  api_response.GetResponse(*result);
-  return {result, api_response.GetNetworkStatistics()};
+  return {api_response.MoveResponseData(),
+          api_response.GetNetworkStatistics()};
+}
+
+BlobApi::DataResponse BlobApi::GetBlobInRanges(
+    const client::OlpClient& client, const std::string& layer_id,
+    const std::string& data_handle, boost::optional<std::string> billing_tag,
+    std::uint64_t data_size, std::size_t range_count,
+    const client::CancellationContext& context) {
+  std::multimap<std::string, std::string> query_params;
+  if (billing_tag) {
+    query_params.emplace("billingTag", *billing_tag);
+  }
+
+  auto download = std::make_shared<RangeDownload>(
+      client, "/layers/" + layer_id + "/data/" + data_handle,
+      std::move(query_params), data_size,
+      std::max<std::size_t>(range_count, 1u));
+
+  client::CancellationContext execution_context = context;
+  const bool started = execution_context.ExecuteOrCancelled([&]() {
+    download->Start();
+    return client::CancellationToken([download]() { download->Cancel(); });
+  });
+  if (!started) {
+    return {client::ApiError::Cancelled()};
+  }
+
+  auto response = download->Wait();
+  if (!response.IsSuccessful() && download->Failed()) {
+    return GetBlob(client, layer_id, data_handle, std::move(billing_tag),
+                   boost::none, context);
+  }
+  return response;
 }
 }  // namespace read
 }  // namespace dataservice
@@ -19,11 +19,13 @@
 
 #pragma once
 
+#include <cstdint>
 #include <string>
 
 #include <olp/core/client/ApiError.h>
 #include <olp/core/client/ApiResponse.h>
 #include <olp/core/client/HttpResponse.h>
+#include <olp/core/http/Network.h>
 #include <boost/optional.hpp>
 #include "ExtendedApiResponse.h"
 #include "olp/dataservice/read/model/Data.h"
@@ -61,15 +63,46 @@ class BlobApi {
    * use the pagination links returned in the response body.
    * @param context A CancellationContext, which can be used to cancel the
    * pending request.
+   * @param data_callback An optional callback that receives the blob in
+   * chunks as they arrive. If set, the blob is not stored in the response.
    *
    * @return Data response.
    */
-  static DataResponse GetBlob(const client::OlpClient& client,
-                              const std::string& layer_id,
-                              const std::string& data_handle,
-                              boost::optional<std::string> billing_tag,
-                              boost::optional<std::string> range,
-                              const client::CancellationContext& context);
+  static DataResponse GetBlob(
+      const client::OlpClient& client, const std::string& layer_id,
+      const std::string& data_handle, boost::optional<std::string> billing_tag,
+      boost::optional<std::string> range,
+      const client::CancellationContext& context,
+      http::Network::DataCallback data_callback = nullptr);
+
+  /**
+   * @brief Retrieves a data blob for specified handle using concurrent range
+   * requests.
+   *
+   * Splits the blob into `range_count` byte ranges that are downloaded in
+   * parallel and written into one buffer. The range is sent in the `Range`
+   * header. A range that fails with a retryable error is requested again
+   * without restarting the other ranges. If a range fails otherwise, e.g. the
+   * server sends the whole blob, another `Content-Range`, or rejects the range
+   * with 416, the blob is downloaded with a single request.
+   *
+   * @param client Instance of OlpClient used to make REST request.
+   * @param layer_id Layer id.
+   * @param data_handle Indentifies a specific blob.
+   * @param billing_tag An optional free-form tag which is used for grouping
+   * billing records together.
+   * @param data_size The size of the blob in bytes.
+   * @param range_count The number of the concurrent range requests.
+   * @param context A CancellationContext, which can be used to cancel the
+   * pending requests.
+   *
+   * @return Data response.
+   */
+  static DataResponse GetBlobInRanges(
+      const client::OlpClient& client, const std::string& layer_id,
+      const std::string& data_handle, boost::optional<std::string> billing_tag,
+      std::uint64_t data_size, std::size_t range_count,
+      const client::CancellationContext& context);
 };
 
 }  // namespace read
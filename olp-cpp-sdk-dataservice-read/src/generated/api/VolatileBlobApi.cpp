@@ -46,16 +46,15 @@ VolatileBlobApi::DataResponse VolatileBlobApi::GetVolatileBlob(
   std::string metadata_uri = "/layers/" + layer_id + "/data/" + data_handle;
   auto api_response =
       client.CallApi(metadata_uri, "GET", query_params, header_params,
-                     form_params, nullptr, "", context);
+                     form_params, nullptr, "", context, true);
 
   if (api_response.status != http::HttpStatusCode::OK) {
     return {{api_response.status, api_response.response.str()},
             api_response.GetNetworkStatistics()};
   }
 
-  auto result = std::make_shared<std::vector<unsigned char>>();
-  api_response.GetResponse(*result);
-  return {result, api_response.GetNetworkStatistics()};
+  return {api_response.MoveResponseData(),
+          api_response.GetNetworkStatistics()};
 }
 }  // namespace read
 }  // namespace dataservice
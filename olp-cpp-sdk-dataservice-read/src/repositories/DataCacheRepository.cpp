@@ -21,6 +21,7 @@
 
 #include <limits>
 #include <string>
+#include <vector>
 
 #include <olp/core/cache/KeyValueCache.h>
 #include <olp/core/logging/Log.h>
@@ -80,6 +81,35 @@ bool DataCacheRepository::IsCached(const std::string& layer_id,
   return cache_->Contains(data_key);
 }
 
+std::vector<bool> DataCacheRepository::IsCached(
+    const std::string& layer_id,
+    const std::vector<std::string>& data_handles) const {
+  std::vector<bool> result(data_handles.size(), false);
+
+  std::vector<size_t> indices;
+  cache::KeyValueCache::KeyListType keys;
+  indices.reserve(data_handles.size());
+  keys.reserve(data_handles.size());
+  for (size_t index = 0; index < data_handles.size(); ++index) {
+    if (!data_handles[index].empty()) {
+      indices.push_back(index);
+      keys.push_back(CreateKey(layer_id, data_handles[index]));
+    }
+  }
+
+  if (keys.empty()) {
+    return result;
+  }
+
+  const auto contains = cache_->ContainsBatch(keys);
+  for (size_t index = 0; index < indices.size(); ++index) {
+    result[indices[index]] = contains[index];
+  }
+
+  OLP_SDK_LOG_DEBUG_F(kLogTag, "IsCached batch -> keys=%zu", keys.size());
+  return result;
+}
+
 bool DataCacheRepository::Clear(const std::string& layer_id,
                                 const std::string& data_handle) {
   auto key = CreateKey(layer_id, data_handle);
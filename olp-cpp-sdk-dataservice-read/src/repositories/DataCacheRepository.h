@@ -21,6 +21,8 @@
 
 #include <chrono>
 #include <memory>
+#include <string>
+#include <vector>
 
 #include <olp/core/client/ApiNoResult.h>
 #include <olp/core/client/HRN.h>
@@ -52,6 +54,12 @@ class DataCacheRepository final {
   bool IsCached(const std::string& layer_id,
                 const std::string& data_handle) const;
 
+  /// Checks the data handles in one batched cache lookup, returns a flag for
+  /// every handle. Empty data handles are never cached.
+  std::vector<bool> IsCached(
+      const std::string& layer_id,
+      const std::vector<std::string>& data_handles) const;
+
   bool Clear(const std::string& layer_id, const std::string& data_handle);
 
   std::string CreateKey(const std::string& layer_id,
@@ -46,22 +46,29 @@ namespace {
 constexpr auto kLogTag = "DataRepository";
 constexpr auto kBlobService = "blob";
 constexpr auto kVolatileBlobService = "volatile-blob";
+
+// Blobs of at least two ranges are downloaded with concurrent range requests.
+constexpr int64_t kMinRangeSize = 4 * 1024 * 1024;
+constexpr int64_t kMaxRangeCount = 4;
 }  // namespace
 
 DataRepository::DataRepository(client::HRN catalog,
                                client::OlpClientSettings settings,
                                client::ApiLookupClient client,
-                               NamedMutexStorage storage)
+                               NamedMutexStorage storage,
+                               std::shared_ptr<QuadTreeIndexCache>
+                                   quad_tree_cache)
     : catalog_(std::move(catalog)),
       settings_(std::move(settings)),
       lookup_client_(std::move(client)),
-      storage_(std::move(storage)) {}
+      storage_(std::move(storage)),
+      quad_tree_cache_(std::move(quad_tree_cache)) {}
 
 DataResponse DataRepository::GetVersionedTile(
     const std::string& layer_id, const TileRequest& request, int64_t version,
     client::CancellationContext context) {
   PartitionsRepository repository(catalog_, layer_id, settings_, lookup_client_,
-                                  storage_);
+                                  storage_, quad_tree_cache_);
   auto response = repository.GetTile(request, version, context);
 
   if (!response.IsSuccessful()) {
@@ -84,19 +91,24 @@ DataResponse DataRepository::GetVersionedTile(
 
 BlobApi::DataResponse DataRepository::GetVersionedData(
     const std::string& layer_id, const DataRequest& request, int64_t version,
-    client::CancellationContext context, const bool fail_on_cache_error) {
+    client::CancellationContext context, const bool fail_on_cache_error,
+    DataChunkCallback data_callback) {
   if (request.GetDataHandle() && request.GetPartitionId()) {
     return {{client::ErrorCode::PreconditionFailed,
              "Both data handle and partition id specified"}};
   }
 
   auto blob_request = request;
+  boost::optional<int64_t> data_size;
   if (!request.GetDataHandle()) {
     // get data handle for a partition to be queried
     PartitionsRepository repository(catalog_, layer_id, settings_,
                                     lookup_client_, storage_);
-    auto partitions_response =
-        repository.GetPartitionById(request, version, context);
+    // The data size decides whether the blob is downloaded in ranges, the
+    // compressed blobs are not split.
+    auto partitions_response = repository.GetPartitionById(
+        request, version, context,
+        {PartitionsRequest::kDataSize, PartitionsRequest::kCompressedDataSize});
 
     if (!partitions_response.IsSuccessful()) {
       return partitions_response.GetError();
@@ -115,19 +127,27 @@ BlobApi::DataResponse DataRepository::GetVersionedData(
       return {{client::ErrorCode::NotFound, "Partition not found"}};
     }
 
-    blob_request.WithDataHandle(partitions.front().GetDataHandle());
+    const auto& partition = partitions.front();
+    blob_request.WithDataHandle(partition.GetDataHandle());
+
+    // A compressed blob is not split, its data size does not match the
+    // transferred bytes.
+    if (!partition.GetCompressedDataSize()) {
+      data_size = partition.GetDataSize();
+    }
   }
 
   // finally get the data using a data handle
   return repository::DataRepository::GetBlobData(
       layer_id, kBlobService, blob_request, std::move(context),
-      fail_on_cache_error);
+      fail_on_cache_error, std::move(data_callback), data_size);
 }
 
 BlobApi::DataResponse DataRepository::GetBlobData(
     const std::string& layer, const std::string& service,
     const DataRequest& request, client::CancellationContext context,
-    const bool fail_on_cache_error) {
+    const bool fail_on_cache_error, DataChunkCallback data_callback,
+    boost::optional<int64_t> data_size) {
   auto fetch_option = request.GetFetchOption();
   const auto& data_handle = request.GetDataHandle();
 
@@ -152,7 +172,11 @@ BlobApi::DataResponse DataRepository::GetBlobData(
       OLP_SDK_LOG_DEBUG_F(
           kLogTag, "GetBlobData found in cache, hrn='%s', key='%s'",
           catalog_.ToCatalogHRNString().c_str(), data_handle->c_str());
-      return cached_data.value();
+      const auto& data = cached_data.value();
+      if (data_callback && data && !data->empty()) {
+        data_callback(data->data(), 0u, data->size());
+      }
+      return data;
     } else if (fetch_option == CacheOnly) {
       OLP_SDK_LOG_INFO_F(
           kLogTag, "GetBlobData not found in cache, hrn='%s', key='%s'",
@@ -172,14 +196,52 @@ BlobApi::DataResponse DataRepository::GetBlobData(
   BlobApi::DataResponse storage_response;
 
   if (service == kBlobService) {
-    storage_response = BlobApi::GetBlob(
-        storage_api_lookup.GetResult(), layer, data_handle.value(),
-        request.GetBillingTag(), boost::none, context);
+    // The streamed chunks are collected only if the blob goes to the cache.
+    std::shared_ptr<std::vector<unsigned char>> cache_buffer;
+    http::Network::DataCallback blob_callback = data_callback;
+    if (data_callback && fetch_option != OnlineOnly) {
+      cache_buffer = std::make_shared<std::vector<unsigned char>>();
+      blob_callback = [=](const std::uint8_t* data, std::uint64_t offset,
+                          std::size_t length) {
+        // A retry delivers the blob again from the zero offset.
+        cache_buffer->resize(static_cast<std::size_t>(offset));
+        cache_buffer->insert(cache_buffer->end(), data, data + length);
+        data_callback(data, offset, length);
+      };
+    }
+
+    const auto range_count =
+        data_size && !data_callback
+            ? std::min(kMaxRangeCount, *data_size / kMinRangeSize)
+            : int64_t{0};
+
+    if (range_count > 1) {
+      storage_response = BlobApi::GetBlobInRanges(
+          storage_api_lookup.GetResult(), layer, data_handle.value(),
+          request.GetBillingTag(), static_cast<uint64_t>(*data_size),
+          static_cast<size_t>(range_count), context);
+    } else {
+      storage_response = BlobApi::GetBlob(
+          storage_api_lookup.GetResult(), layer, data_handle.value(),
+          request.GetBillingTag(), boost::none, context,
+          std::move(blob_callback));
+    }
+
+    if (storage_response.IsSuccessful() && cache_buffer) {
+      storage_response = BlobApi::DataResponse(
+          std::move(cache_buffer), storage_response.GetPayload());
+    }
   } else {
     auto volatile_blob = VolatileBlobApi::GetVolatileBlob(
         storage_api_lookup.GetResult(), layer, data_handle.value(),
         request.GetBillingTag(), context);
     storage_response = BlobApi::DataResponse(volatile_blob.MoveResult());
+
+    const auto& data = storage_response.GetResult();
+    if (storage_response.IsSuccessful() && data_callback && data &&
+        !data->empty()) {
+      data_callback(data->data(), 0u, data->size());
+    }
   }
 
   if (storage_response.IsSuccessful() && fetch_option != OnlineOnly) {
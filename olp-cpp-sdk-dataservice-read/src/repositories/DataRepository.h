@@ -28,6 +28,7 @@
 #include "olp/dataservice/read/Types.h"
 
 #include "NamedMutex.h"
+#include "QuadTreeIndexCache.h"
 #include "generated/api/BlobApi.h"
 
 namespace olp {
@@ -40,17 +41,18 @@ class DataRepository final {
  public:
   DataRepository(client::HRN catalog, client::OlpClientSettings settings,
                  client::ApiLookupClient client,
-                 NamedMutexStorage storage = NamedMutexStorage());
+                 NamedMutexStorage storage = NamedMutexStorage(),
+                 std::shared_ptr<QuadTreeIndexCache> quad_tree_cache = nullptr);
 
   DataResponse GetVersionedTile(const std::string& layer_id,
                                 const TileRequest& request, int64_t version,
                                 client::CancellationContext context);
 
-  BlobApi::DataResponse GetVersionedData(const std::string& layer_id,
-                                         const DataRequest& request,
-                                         int64_t version,
-                                         client::CancellationContext context,
-                                         bool fail_on_cache_error = false);
+  BlobApi::DataResponse GetVersionedData(
+      const std::string& layer_id, const DataRequest& request,
+      int64_t version, client::CancellationContext context,
+      bool fail_on_cache_error = false,
+      DataChunkCallback data_callback = nullptr);
 
   BlobApi::DataResponse GetVolatileData(const std::string& layer_id,
                                         const DataRequest& request,
@@ -61,13 +63,17 @@ class DataRepository final {
                                     const std::string& service,
                                     const DataRequest& request,
                                     client::CancellationContext context,
-                                    bool fail_on_cache_error = false);
+                                    bool fail_on_cache_error = false,
+                                    DataChunkCallback data_callback = nullptr,
+                                    boost::optional<int64_t> data_size =
+                                        boost::none);
 
  private:
   client::HRN catalog_;
   client::OlpClientSettings settings_;
   client::ApiLookupClient lookup_client_;
   NamedMutexStorage storage_;
+  std::shared_ptr<QuadTreeIndexCache> quad_tree_cache_;
 };
 
 }  // namespace repository
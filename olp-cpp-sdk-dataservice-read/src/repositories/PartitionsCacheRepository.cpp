@@ -77,33 +77,36 @@ namespace repository {
 PartitionsCacheRepository::PartitionsCacheRepository(
     const client::HRN& catalog, const std::string& layer_id,
     std::shared_ptr<cache::KeyValueCache> cache,
-    std::chrono::seconds default_expiry)
+    std::chrono::seconds default_expiry,
+    std::shared_ptr<QuadTreeIndexCache> quad_tree_cache)
     : catalog_(catalog.ToCatalogHRNString()),
       layer_id_(layer_id),
       cache_(std::move(cache)),
-      default_expiry_(ConvertTime(default_expiry)) {}
+      default_expiry_(ConvertTime(default_expiry)),
+      quad_tree_cache_(std::move(quad_tree_cache)) {}
 
 client::ApiNoResponse PartitionsCacheRepository::Put(
     const model::Partitions& partitions,
     const boost::optional<int64_t>& version,
     const boost::optional<time_t>& expiry, bool layer_metadata) {
   const auto& partitions_list = partitions.GetPartitions();
+  const auto expiry_time = expiry.get_value_or(default_expiry_);
   std::vector<std::string> partition_ids;
-  partition_ids.reserve(partitions_list.size());
+  cache::KeyValueCache::BatchItemListType items;
+  items.reserve(partitions_list.size() + 1);
+
+  if (layer_metadata) {
+    partition_ids.reserve(partitions_list.size());
+  }
 
   for (const auto& partition : partitions_list) {
     auto key =
         CreateKey(catalog_, layer_id_, partition.GetPartition(), version);
     OLP_SDK_LOG_DEBUG_F(kLogTag, "Put -> '%s'", key.c_str());
 
-    const auto put_result = cache_->Put(
-        key, partition, [&]() { return serializer::serialize(partition); },
-        expiry.get_value_or(default_expiry_));
-
-    if (!put_result) {
-      OLP_SDK_LOG_ERROR_F(kLogTag, "Failed to write -> '%s'", key.c_str());
-      return {{client::ErrorCode::CacheIO, "Put to cache failed"}};
-    }
+    items.push_back({std::move(key), partition,
+                     [&]() { return serializer::serialize(partition); },
+                     expiry_time});
 
     if (layer_metadata) {
       partition_ids.push_back(partition.GetPartition());
@@ -114,15 +117,15 @@ client::ApiNoResponse PartitionsCacheRepository::Put(
     auto key = CreateKey(catalog_, layer_id_, version);
     OLP_SDK_LOG_DEBUG_F(kLogTag, "Put -> '%s'", key.c_str());
 
-    const auto put_result =
-        cache_->Put(key, partition_ids,
-                    [&]() { return serializer::serialize(partition_ids); },
-                    expiry.get_value_or(default_expiry_));
+    items.push_back({std::move(key), partition_ids,
+                     [&]() { return serializer::serialize(partition_ids); },
+                     expiry_time});
+  }
 
-    if (!put_result) {
-      OLP_SDK_LOG_ERROR_F(kLogTag, "Failed to write -> '%s'", key.c_str());
-      return {{client::ErrorCode::CacheIO, "Put to cache failed"}};
-    }
+  if (!cache_->PutBatch(items)) {
+    OLP_SDK_LOG_ERROR_F(kLogTag, "Failed to write %zu partitions, layer='%s'",
+                        partitions_list.size(), layer_id_.c_str());
+    return {{client::ErrorCode::CacheIO, "Put to cache failed"}};
   }
 
   return {client::ApiNoResult{}};
@@ -135,15 +138,19 @@ model::Partitions PartitionsCacheRepository::Get(
   auto& cached_partitions = cached_partitions_model.GetMutablePartitions();
   cached_partitions.reserve(partition_ids.size());
 
+  cache::KeyValueCache::KeyListType keys;
+  keys.reserve(partition_ids.size());
   for (const auto& partition_id : partition_ids) {
-    auto key = CreateKey(catalog_, layer_id_, partition_id, version);
-    OLP_SDK_LOG_DEBUG_F(kLogTag, "Get '%s'", key.c_str());
+    keys.push_back(CreateKey(catalog_, layer_id_, partition_id, version));
+    OLP_SDK_LOG_DEBUG_F(kLogTag, "Get '%s'", keys.back().c_str());
+  }
 
-    auto cached_partition =
-        cache_->Get(key, [](const std::string& serialized_object) {
-          return parser::parse<model::Partition>(serialized_object);
-        });
+  auto cached_values =
+      cache_->GetBatch(keys, [](const std::string& serialized_object) {
+        return parser::parse<model::Partition>(serialized_object);
+      });
 
+  for (const auto& cached_partition : cached_values) {
     if (!cached_partition.empty()) {
       cached_partitions.emplace_back(
           boost::any_cast<model::Partition>(cached_partition));
@@ -231,6 +238,11 @@ client::ApiNoResponse PartitionsCacheRepository::Put(
     return {{client::ErrorCode::CacheIO, "Put to cache failed"}};
   }
 
+  if (quad_tree_cache_ && version &&
+      depth == static_cast<int32_t>(kMaxQuadTreeIndexDepth)) {
+    quad_tree_cache_->Put(tile_key, *version, quad_tree.GetRawData());
+  }
+
   return {client::ApiNoResult{}};
 }
 
@@ -251,6 +263,9 @@ bool PartitionsCacheRepository::Get(geo::TileKey tile_key, int32_t depth,
 void PartitionsCacheRepository::Clear() {
   auto key = catalog_ + "::" + layer_id_ + "::";
   OLP_SDK_LOG_INFO_F(kLogTag, "Clear -> '%s'", key.c_str());
+  if (quad_tree_cache_) {
+    quad_tree_cache_->Clear();
+  }
   cache_->RemoveKeysWithPrefix(key);
 }
 
@@ -274,6 +289,9 @@ bool PartitionsCacheRepository::ClearQuadTree(
     const boost::optional<int64_t>& version) {
   const auto key = CreateQuadKey(tile_key, depth, version);
   OLP_SDK_LOG_DEBUG_F(kLogTag, "ClearQuadTree -> '%s'", key.c_str());
+  if (quad_tree_cache_ && version) {
+    quad_tree_cache_->Remove(tile_key, *version);
+  }
   return cache_->RemoveKeysWithPrefix(key);
 }
 
@@ -326,6 +344,12 @@ std::string PartitionsCacheRepository::CreateQuadKey(
 bool PartitionsCacheRepository::FindQuadTree(geo::TileKey key,
                                              boost::optional<int64_t> version,
                                              read::QuadTreeIndex& tree) {
+  const bool use_quad_tree_cache = quad_tree_cache_ && version;
+  if (use_quad_tree_cache &&
+      quad_tree_cache_->Find(key, *version, kMaxQuadTreeIndexDepth, tree)) {
+    return true;
+  }
+
   auto max_depth = std::min<std::uint32_t>(key.Level(), kMaxQuadTreeIndexDepth);
   for (auto i = 0u; i <= max_depth; ++i) {
     const auto& root_tile_key = key.ChangedLevelBy(-i);
@@ -337,6 +361,10 @@ bool PartitionsCacheRepository::FindQuadTree(geo::TileKey key,
                           key.ToHereTile().c_str(),
                           root_tile_key.ToHereTile().c_str(),
                           kMaxQuadTreeIndexDepth);
+      if (use_quad_tree_cache) {
+        quad_tree_cache_->Put(root_tile_key, *version,
+                              cached_tree.GetRawData());
+      }
       tree = std::move(cached_tree);
 
       return true;
@@ -28,6 +28,7 @@
 #include <olp/dataservice/read/model/Partitions.h>
 #include <boost/optional.hpp>
 #include "QuadTreeIndex.h"
+#include "QuadTreeIndexCache.h"
 #include "generated/model/LayerVersions.h"
 
 namespace olp {
@@ -43,7 +44,8 @@ class PartitionsCacheRepository final {
   PartitionsCacheRepository(
       const client::HRN& catalog, const std::string& layer_id,
       std::shared_ptr<cache::KeyValueCache> cache,
-      std::chrono::seconds default_expiry = std::chrono::seconds::max());
+      std::chrono::seconds default_expiry = std::chrono::seconds::max(),
+      std::shared_ptr<QuadTreeIndexCache> quad_tree_cache = nullptr);
 
   ~PartitionsCacheRepository() = default;
 
@@ -109,6 +111,7 @@ class PartitionsCacheRepository final {
   const std::string layer_id_;
   std::shared_ptr<cache::KeyValueCache> cache_;
   time_t default_expiry_;
+  std::shared_ptr<QuadTreeIndexCache> quad_tree_cache_;
 };
 }  // namespace repository
 }  // namespace read
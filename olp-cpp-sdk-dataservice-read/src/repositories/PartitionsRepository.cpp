@@ -113,13 +113,15 @@ PartitionsRepository::PartitionsRepository(client::HRN catalog,
                                            std::string layer,
                                            client::OlpClientSettings settings,
                                            client::ApiLookupClient client,
-                                           NamedMutexStorage storage)
+                                           NamedMutexStorage storage,
+                                           std::shared_ptr<QuadTreeIndexCache>
+                                               quad_tree_cache)
     : catalog_(std::move(catalog)),
       layer_id_(std::move(layer)),
       settings_(std::move(settings)),
       lookup_client_(std::move(client)),
       cache_(catalog_, layer_id_, settings_.cache,
-             settings_.default_cache_expiration),
+             settings_.default_cache_expiration, std::move(quad_tree_cache)),
       storage_(std::move(storage)) {}
 
 QueryApi::PartitionsExtendedResponse
@@ -267,7 +269,8 @@ PartitionsResponse PartitionsRepository::GetPartitions(
 
 PartitionsResponse PartitionsRepository::GetPartitionById(
     const DataRequest& request, boost::optional<int64_t> version,
-    client::CancellationContext context) {
+    client::CancellationContext context,
+    const std::vector<std::string>& additional_fields) {
   const auto& partition_id = request.GetPartitionId();
   if (!partition_id) {
     return {{client::ErrorCode::PreconditionFailed, "Partition Id is missing"}};
@@ -317,8 +320,9 @@ PartitionsResponse PartitionsRepository::GetPartitionById(
   const client::OlpClient& client = query_api.GetResult();
 
   PartitionsResponse query_response =
-      QueryApi::GetPartitionsbyId(client, layer_id_, partitions, version, {},
-                                  request.GetBillingTag(), context);
+      QueryApi::GetPartitionsbyId(client, layer_id_, partitions, version,
+                                  additional_fields, request.GetBillingTag(),
+                                  context);
 
   if (query_response.IsSuccessful() && fetch_option != OnlineOnly) {
     OLP_SDK_LOG_DEBUG_F(kLogTag,
@@ -29,6 +29,7 @@
 #include <olp/core/client/OlpClientSettings.h>
 #include "ExtendedApiResponse.h"
 #include "QuadTreeIndex.h"
+#include "QuadTreeIndexCache.h"
 #include "generated/api/QueryApi.h"
 #include "generated/model/Index.h"
 #include "olp/dataservice/read/DataRequest.h"
@@ -55,7 +56,9 @@ class PartitionsRepository {
   PartitionsRepository(client::HRN catalog, std::string layer,
                        client::OlpClientSettings settings,
                        client::ApiLookupClient client,
-                       NamedMutexStorage storage = NamedMutexStorage());
+                       NamedMutexStorage storage = NamedMutexStorage(),
+                       std::shared_ptr<QuadTreeIndexCache> quad_tree_cache =
+                           nullptr);
 
   PartitionsResponse GetVersionedPartitions(
       const read::PartitionsRequest& request, std::int64_t version,
@@ -69,9 +72,10 @@ class PartitionsRepository {
       const read::PartitionsRequest& request, std::int64_t version,
       client::CancellationContext context, bool fail_on_cache_error = false);
 
-  PartitionsResponse GetPartitionById(const DataRequest& request,
-                                      boost::optional<int64_t> version,
-                                      client::CancellationContext context);
+  PartitionsResponse GetPartitionById(
+      const DataRequest& request, boost::optional<int64_t> version,
+      client::CancellationContext context,
+      const std::vector<std::string>& additional_fields = {});
 
   static model::Partition PartitionFromSubQuad(const model::SubQuad& sub_quad,
                                                const std::string& partition);
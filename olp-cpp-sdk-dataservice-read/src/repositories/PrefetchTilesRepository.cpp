@@ -76,40 +76,53 @@ void PrefetchTilesRepository::SplitSubtree(
     RootTilesForRequest& root_tiles_depth,
     RootTilesForRequest::iterator subtree_to_split,
     const geo::TileKey& tile_key, std::uint32_t min) {
-  unsigned int depth = subtree_to_split->second;
-  auto tileKey = subtree_to_split->first;
+  std::uint32_t depth = subtree_to_split->second;
+  const auto root_level = subtree_to_split->first.Level();
   if (depth <= kMaxQuadTreeIndexDepth) {
     return;
   }
+  // Slice the subtree from the bottom, so every slice except the top one
+  // uses the full depth.
   while (depth > kMaxQuadTreeIndexDepth) {
-    unsigned int level = depth - kMaxQuadTreeIndexDepth;
-    int childCount = geo::QuadKey64Helper::ChildrenAtLevel(level);
-
-    const geo::TileKey firstChild =
-        tileKey.ChangedLevelTo(tileKey.Level() + level);
-    const std::uint64_t beginTileKey = firstChild.ToQuadKey64();
-
-    const std::uint64_t endTileKey = beginTileKey + childCount;
-
-    for (std::uint64_t key = beginTileKey; key < endTileKey; ++key) {
-      auto child = geo::TileKey::FromQuadKey64(key);
-      // skip child, if it is not a parent, or a child of prefetched tile
-      if ((!tile_key.IsParentOf(child) && !child.IsParentOf(tile_key) &&
-           child != tile_key) ||
-          (child.Level() + kMaxQuadTreeIndexDepth < min)) {
-        continue;
-      }
-      root_tiles_depth.insert({child, kMaxQuadTreeIndexDepth});
+    const auto level = root_level + depth - kMaxQuadTreeIndexDepth;
+    // skip the slice, if it is above the min level
+    if (level + kMaxQuadTreeIndexDepth >= min) {
+      AddSliceRoots(root_tiles_depth, tile_key, level);
     }
     depth -= (kMaxQuadTreeIndexDepth + 1);
   }
-  if (tileKey.Level() + depth < min) {
+  if (root_level + depth < min) {
     root_tiles_depth.erase(subtree_to_split);
   } else {
     subtree_to_split->second = depth;
   }
 }
 
+void PrefetchTilesRepository::AddSliceRoots(
+    RootTilesForRequest& root_tiles_depth, const geo::TileKey& tile_key,
+    std::uint32_t level) {
+  auto add_root = [&](const geo::TileKey& root) {
+    auto it = root_tiles_depth.insert({root, kMaxQuadTreeIndexDepth});
+    if (!it.second) {
+      it.first->second = std::max(it.first->second, kMaxQuadTreeIndexDepth);
+    }
+  };
+
+  // Only the tiles that are a parent or a child of the prefetched tile are
+  // needed, the children of a tile are consecutive quad keys.
+  if (level <= tile_key.Level()) {
+    add_root(tile_key.ChangedLevelTo(level));
+    return;
+  }
+
+  const std::uint64_t begin_key = tile_key.ChangedLevelTo(level).ToQuadKey64();
+  const std::uint64_t end_key =
+      begin_key + (std::uint64_t{1} << (2 * (level - tile_key.Level())));
+  for (auto key = begin_key; key < end_key; ++key) {
+    add_root(geo::TileKey::FromQuadKey64(key));
+  }
+}
+
 RootTilesForRequest PrefetchTilesRepository::GetSlicedTiles(
     const std::vector<geo::TileKey>& tile_keys, std::uint32_t min,
     std::uint32_t max) {
@@ -116,6 +116,11 @@ class PrefetchTilesRepository {
                            RootTilesForRequest::iterator subtree_to_split,
                            const geo::TileKey& tile_key, std::uint32_t min);
 
+  /// Adds the roots of the slice starting at the `level`, which cover the
+  /// `tile_key` or its children with the full quad tree depth.
+  static void AddSliceRoots(RootTilesForRequest& root_tiles_depth,
+                            const geo::TileKey& tile_key, std::uint32_t level);
+
   using QuadTreeResponse = ExtendedApiResponse<QuadTreeIndex, client::ApiError,
                                                client::NetworkStatistics>;
 
@@ -43,6 +43,29 @@ constexpr auto kCompressedDataSize = "compressedDataSize";
 
 constexpr auto kLogTag = "QuadTreeIndex";
 
+// The sub quad keys are 16 bit, so the deepest level of a sub entry is 7
+// levels below the root.
+constexpr std::uint32_t kMaxSubEntryDepth = 7u;
+
+// Lower bound search without branches in the loop, the number of iterations
+// depends on the size only, and the comparison compiles to a conditional
+// move. `get_key` returns the key of an entry.
+template <typename Entry, typename Key, typename GetKey>
+const Entry* LowerBound(const Entry* begin, const Entry* end, Key key,
+                        GetKey get_key) {
+  auto size = static_cast<size_t>(end - begin);
+  if (size == 0) {
+    return end;
+  }
+
+  while (size > 1) {
+    const auto half = size / 2;
+    begin = get_key(begin[half]) < key ? begin + half : begin;
+    size -= half;
+  }
+  return get_key(*begin) < key ? begin + 1 : begin;
+}
+
 olp::dataservice::read::QuadTreeIndex::IndexData ParseCommonIndexData(
     rapidjson::Value& value) {
   olp::dataservice::read::QuadTreeIndex::IndexData data;
@@ -262,10 +285,8 @@ boost::optional<QuadTreeIndex::IndexData> QuadTreeIndex::Find(
     std::uint16_t sub = std::uint16_t(
         tile_key.GetSubkey64(tile_key.Level() - root_tile_key.Level()));
 
-    const SubEntry* end = SubEntryEnd();
-    const SubEntry* entry =
-        std::lower_bound(SubEntryBegin(), end, SubEntry{sub, 0});
-    if (entry == end || entry->sub_quadkey != sub) {
+    const SubEntry* entry = FindSubEntry(sub);
+    if (entry == nullptr) {
       return aggregated ? FindNearestParent(tile_key) : boost::none;
     }
     if (!ReadIndexData(data, entry->tag_offset)) {
@@ -276,10 +297,8 @@ boost::optional<QuadTreeIndex::IndexData> QuadTreeIndex::Find(
   } else {
     std::uint64_t key = tile_key.ToQuadKey64();
 
-    const ParentEntry* end = ParentEntryEnd();
-    const ParentEntry* entry =
-        std::lower_bound(ParentEntryBegin(), end, ParentEntry{key, 0});
-    if (entry == end || entry->key != key) {
+    const ParentEntry* entry = FindParentEntry(key);
+    if (entry == nullptr) {
       return aggregated ? FindNearestParent(tile_key) : boost::none;
     }
     if (!ReadIndexData(data, entry->tag_offset)) {
@@ -289,18 +308,45 @@ boost::optional<QuadTreeIndex::IndexData> QuadTreeIndex::Find(
     return data;
   }
 }
+
+const QuadTreeIndex::SubEntry* QuadTreeIndex::FindSubEntry(
+    std::uint16_t sub_quadkey) const {
+  const SubEntry* end = SubEntryEnd();
+  const SubEntry* entry =
+      LowerBound(SubEntryBegin(), end, sub_quadkey,
+                 [](const SubEntry& entry) { return entry.sub_quadkey; });
+  return entry != end && entry->sub_quadkey == sub_quadkey ? entry : nullptr;
+}
+
+const QuadTreeIndex::ParentEntry* QuadTreeIndex::FindParentEntry(
+    std::uint64_t key) const {
+  const ParentEntry* end = ParentEntryEnd();
+  const ParentEntry* entry =
+      LowerBound(ParentEntryBegin(), end, key,
+                 [](const ParentEntry& entry) { return entry.key; });
+  return entry != end && entry->key == key ? entry : nullptr;
+}
+
 boost::optional<QuadTreeIndex::IndexData> QuadTreeIndex::FindNearestParent(
     geo::TileKey tile_key) const {
   const olp::geo::TileKey& root_tile_key =
       olp::geo::TileKey::FromQuadKey64(data_->root_tilekey);
+  const auto root_level = root_tile_key.Level();
+  const auto tile_level = tile_key.Level();
 
-  if (tile_key.Level() >= root_tile_key.Level()) {
-    for (auto it = SubEntryEnd(); it-- != SubEntryBegin();) {
-      auto key = root_tile_key.AddedSubkey64(it->sub_quadkey);
-      if (tile_key.IsChildOf(key)) {
-        IndexData data;
-        data.tile_key = key;
-        if (!ReadIndexData(data, it->tag_offset)) {
+  // Look up the ancestors level by level starting from the nearest one,
+  // every level has at most one ancestor of the tile.
+  IndexData data;
+  if (tile_level > root_level) {
+    const auto max_depth =
+        std::min<std::uint32_t>(tile_level - root_level - 1, kMaxSubEntryDepth);
+    for (auto depth = max_depth + 1; depth-- > 0;) {
+      const auto parent = tile_key.ChangedLevelTo(root_level + depth);
+      const SubEntry* entry =
+          FindSubEntry(std::uint16_t(parent.GetSubkey64(depth)));
+      if (entry != nullptr) {
+        data.tile_key = parent;
+        if (!ReadIndexData(data, entry->tag_offset)) {
           return boost::none;
         }
         return data;
@@ -308,12 +354,13 @@ boost::optional<QuadTreeIndex::IndexData> QuadTreeIndex::FindNearestParent(
     }
   }
 
-  for (auto it = ParentEntryEnd(); it-- != ParentEntryBegin();) {
-    auto key = geo::TileKey::FromQuadKey64(it->key);
-    if (tile_key.IsChildOf(key)) {
-      IndexData data;
-      data.tile_key = key;
-      if (!ReadIndexData(data, it->tag_offset)) {
+  const auto max_parent_level = std::min(tile_level, root_level);
+  for (auto level = max_parent_level; level-- > 0;) {
+    const auto parent = tile_key.ChangedLevelTo(level);
+    const ParentEntry* entry = FindParentEntry(parent.ToQuadKey64());
+    if (entry != nullptr) {
+      data.tile_key = parent;
+      if (!ReadIndexData(data, entry->tag_offset)) {
         return boost::none;
       }
       return data;
@@ -328,6 +375,8 @@ std::vector<QuadTreeIndex::IndexData> QuadTreeIndex::GetIndexData() const {
     return result;
   }
   result.reserve(data_->parent_count + data_->subkey_count);
+  const olp::geo::TileKey& root_tile_key =
+      olp::geo::TileKey::FromQuadKey64(data_->root_tilekey);
   for (auto it = ParentEntryEnd(); it-- != ParentEntryBegin();) {
     QuadTreeIndex::IndexData data;
     data.tile_key = geo::TileKey::FromQuadKey64(it->key);
@@ -337,8 +386,6 @@ std::vector<QuadTreeIndex::IndexData> QuadTreeIndex::GetIndexData() const {
   }
   for (auto it = SubEntryEnd(); it-- != SubEntryBegin();) {
     QuadTreeIndex::IndexData data;
-    const olp::geo::TileKey& root_tile_key =
-        olp::geo::TileKey::FromQuadKey64(data_->root_tilekey);
     auto subtile = root_tile_key.AddedSubkey64(std::uint64_t(it->sub_quadkey));
     data.tile_key = subtile;
     if (ReadIndexData(data, it->tag_offset)) {
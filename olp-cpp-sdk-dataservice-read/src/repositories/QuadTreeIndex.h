@@ -107,6 +107,10 @@ class QuadTreeIndex {
   boost::optional<QuadTreeIndex::IndexData> FindNearestParent(
       geo::TileKey tile_key) const;
 
+  // Return nullptr if the entry is not found.
+  const SubEntry* FindSubEntry(std::uint16_t sub_quadkey) const;
+  const ParentEntry* FindParentEntry(std::uint64_t key) const;
+
   const SubEntry* SubEntryBegin() const { return data_->entries; }
   const SubEntry* SubEntryEnd() const {
     return SubEntryBegin() + data_->subkey_count;
@@ -0,0 +1,76 @@
+/*
+ * Copyright (C) 2021 HERE Europe B.V.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ * License-Filename: LICENSE
+ */
+
+#include "QuadTreeIndexCache.h"
+
+#include <algorithm>
+#include <utility>
+
+namespace olp {
+namespace dataservice {
+namespace read {
+namespace repository {
+
+constexpr std::size_t QuadTreeIndexCache::kDefaultMaxSize;
+
+QuadTreeIndexCache::QuadTreeIndexCache(std::size_t max_size)
+    : trees_(max_size) {}
+
+void QuadTreeIndexCache::Put(const geo::TileKey& root, std::int64_t version,
+                             cache::KeyValueCache::ValueTypePtr data) {
+  if (!data || data->empty()) {
+    return;
+  }
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  trees_.InsertOrAssign(Key{version, root.ToQuadKey64()}, std::move(data));
+}
+
+bool QuadTreeIndexCache::Find(const geo::TileKey& tile, std::int64_t version,
+                              std::uint32_t max_depth, QuadTreeIndex& tree) {
+  const auto depth = std::min(tile.Level(), max_depth);
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  for (auto i = 0u; i <= depth; ++i) {
+    const auto root = tile.ChangedLevelBy(-static_cast<int>(i));
+    const auto it = trees_.Find(Key{version, root.ToQuadKey64()});
+    if (it != trees_.end()) {
+      tree = QuadTreeIndex(it.value());
+      return true;
+    }
+  }
+
+  return false;
+}
+
+void QuadTreeIndexCache::Remove(const geo::TileKey& root,
+                                std::int64_t version) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  trees_.Erase(Key{version, root.ToQuadKey64()});
+}
+
+void QuadTreeIndexCache::Clear() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  trees_.Clear();
+}
+
+}  // namespace repository
+}  // namespace read
+}  // namespace dataservice
+}  // namespace olp
@@ -0,0 +1,95 @@
+/*
+ * Copyright (C) 2021 HERE Europe B.V.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ * License-Filename: LICENSE
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <mutex>
+
+#include <olp/core/cache/KeyValueCache.h>
+#include <olp/core/geo/tiling/TileKey.h>
+#include <olp/core/utils/HashedLruCache.h>
+#include "QuadTreeIndex.h"
+
+namespace olp {
+namespace dataservice {
+namespace read {
+namespace repository {
+
+/**
+ * @brief An in-memory LRU of the quad trees of a layer, keyed by the version
+ * and the root tile.
+ *
+ * Resolves the tree that covers a tile without reading it from the
+ * `KeyValueCache`, so the neighboring tiles of a tree are looked up in
+ * process. Only the versioned trees are stored, as they never change.
+ */
+class QuadTreeIndexCache final {
+ public:
+  /// The default maximum size of the stored trees in bytes.
+  static constexpr std::size_t kDefaultMaxSize = 8u * 1024u * 1024u;
+
+  explicit QuadTreeIndexCache(std::size_t max_size = kDefaultMaxSize);
+
+  void Put(const geo::TileKey& root, std::int64_t version,
+           cache::KeyValueCache::ValueTypePtr data);
+
+  /// Finds the tree covering the tile, probing the roots from the tile up to
+  /// `max_depth` levels above it, the nearest first.
+  bool Find(const geo::TileKey& tile, std::int64_t version,
+            std::uint32_t max_depth, QuadTreeIndex& tree);
+
+  void Remove(const geo::TileKey& root, std::int64_t version);
+
+  void Clear();
+
+ private:
+  struct Key {
+    std::int64_t version;
+    std::uint64_t root;
+
+    bool operator==(const Key& other) const {
+      return version == other.version && root == other.root;
+    }
+  };
+
+  struct KeyHash {
+    std::size_t operator()(const Key& key) const {
+      return std::hash<std::uint64_t>()(
+          key.root ^ (static_cast<std::uint64_t>(key.version) << 40));
+    }
+  };
+
+  struct DataCost {
+    std::size_t operator()(
+        const cache::KeyValueCache::ValueTypePtr& data) const {
+      return data->size();
+    }
+  };
+
+  std::mutex mutex_;
+  utils::HashedLruCache<Key, cache::KeyValueCache::ValueTypePtr, DataCost,
+                        KeyHash>
+      trees_;
+};
+
+}  // namespace repository
+}  // namespace read
+}  // namespace dataservice
+}  // namespace olp
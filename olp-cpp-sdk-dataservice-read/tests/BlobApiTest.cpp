@@ -0,0 +1,187 @@
+/*
+ * Copyright (C) 2021 HERE Europe B.V.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ * License-Filename: LICENSE
+ */
+
+#include <atomic>
+#include <chrono>
+#include <climits>
+#include <regex>
+#include <string>
+#include <thread>
+
+#include <gmock/gmock.h>
+#include <mocks/NetworkMock.h>
+#include <olp/core/client/OlpClient.h>
+#include <olp/core/client/OlpClientFactory.h>
+#include <olp/core/http/NetworkConstants.h>
+#include "generated/api/BlobApi.h"
+
+namespace {
+constexpr auto kLayerId = "test-layer";
+constexpr auto kDataHandle = "4eed6ed1-0d32-43b9-ae79-043cb4256432";
+constexpr auto kBaseUrl =
+    "https://blob-ireland.data.api.platform.here.com/blobstore/v1/catalogs/"
+    "hereos-internal-test-v2";
+
+using ::testing::_;
+namespace client = olp::client;
+namespace http = olp::http;
+namespace read = olp::dataservice::read;
+
+// Responds with the requested range of the data, or with `status` and no
+// body for the first `failures` requests of the range at `failed_offset`.
+// With `status` 200 the range is ignored, with 206 the response has a wrong
+// `Content-Range`. A request without a range gets the whole data.
+NetworkCallback ReturnRange(const std::string& data, int status = 0,
+                            uint64_t failed_offset = UINT64_MAX,
+                            int failures = INT_MAX) {
+  auto remaining_failures = std::make_shared<std::atomic<int>>(failures);
+  auto request_id = std::make_shared<std::atomic<http::RequestId>>(1u);
+  return [=](http::NetworkRequest request, http::Network::Payload payload,
+             http::Network::Callback callback,
+             http::Network::HeaderCallback header_callback,
+             http::Network::DataCallback /*data_callback*/) {
+    std::smatch match;
+    bool found = false;
+    for (const auto& header : request.GetHeaders()) {
+      if (header.first == http::kRangeHeader) {
+        found = std::regex_match(header.second, match,
+                                 std::regex("bytes=(\\d+)-(\\d+)"));
+      }
+    }
+    const auto begin = found ? std::stoull(match[1]) : 0u;
+    const auto end = found ? std::stoull(match[2]) : 0u;
+    const auto id = (*request_id)++;
+
+    std::thread([=]() {
+      // Lets the client store the request id before the response.
+      std::this_thread::sleep_for(std::chrono::milliseconds(10));
+
+      auto response = http::NetworkResponse().WithRequestId(id);
+      if (!found || (status == http::HttpStatusCode::OK &&
+                     begin != failed_offset)) {
+        *payload << data;
+        response.WithStatus(http::HttpStatusCode::OK);
+      } else if (begin == failed_offset && (*remaining_failures)-- > 0) {
+        response.WithStatus(status);
+      } else {
+        const auto content_begin =
+            status == http::HttpStatusCode::PARTIAL_CONTENT ? begin + 1u
+                                                            : begin;
+        header_callback(http::kContentRangeHeader,
+                        "bytes " + std::to_string(content_begin) + "-" +
+                            std::to_string(end) + "/" +
+                            std::to_string(data.size()));
+        *payload << data.substr(begin, end - begin + 1);
+        response.WithStatus(http::HttpStatusCode::PARTIAL_CONTENT);
+      }
+      callback(response);
+    })
+        .detach();
+
+    return http::SendOutcome(id);
+  };
+}
+
+class BlobApiTest : public testing::Test {
+ protected:
+  void SetUp() override {
+    network_mock_ = std::make_shared<testing::NiceMock<NetworkMock>>();
+
+    client::OlpClientSettings settings;
+    settings.network_request_handler = network_mock_;
+    settings.retry_settings.max_attempts = 0;
+
+    client_ = client::OlpClientFactory::Create(settings);
+    client_->SetBaseUrl(kBaseUrl);
+  }
+
+  void TearDown() override { network_mock_.reset(); }
+
+  std::shared_ptr<client::OlpClient> client_;
+  std::shared_ptr<NetworkMock> network_mock_;
+};
+
+TEST_F(BlobApiTest, GetBlobInRanges) {
+  const std::string data = "0123456789abcdefghij";
+
+  {
+    SCOPED_TRACE("Ranges are reassembled");
+
+    EXPECT_CALL(*network_mock_, Send(_, _, _, _, _))
+        .Times(3)
+        .WillRepeatedly(ReturnRange(data));
+
+    auto response = read::BlobApi::GetBlobInRanges(
+        *client_, kLayerId, kDataHandle, boost::none, data.size(), 3u,
+        client::CancellationContext{});
+
+    ASSERT_TRUE(response.IsSuccessful());
+    const auto& result = response.GetResult();
+    EXPECT_EQ(data, std::string(result->begin(), result->end()));
+    testing::Mock::VerifyAndClearExpectations(network_mock_.get());
+  }
+
+  {
+    SCOPED_TRACE("Failed range is requested again");
+
+    // The range that starts at 7 fails once
+    EXPECT_CALL(*network_mock_, Send(_, _, _, _, _))
+        .Times(4)
+        .WillRepeatedly(ReturnRange(
+            data, static_cast<int>(http::ErrorCode::IO_ERROR), 7u, 1));
+
+    auto response = read::BlobApi::GetBlobInRanges(
+        *client_, kLayerId, kDataHandle, boost::none, data.size(), 3u,
+        client::CancellationContext{});
+
+    ASSERT_TRUE(response.IsSuccessful());
+    const auto& result = response.GetResult();
+    EXPECT_EQ(data, std::string(result->begin(), result->end()));
+    testing::Mock::VerifyAndClearExpectations(network_mock_.get());
+  }
+
+  for (const auto status :
+       {http::HttpStatusCode::OK, http::HttpStatusCode::PARTIAL_CONTENT,
+        http::HttpStatusCode::REQUESTED_RANGE_NOT_SATISFIABLE,
+        http::HttpStatusCode::FORBIDDEN}) {
+    SCOPED_TRACE(testing::Message() << "Range fails, status=" << status);
+
+    // The blob is downloaded again with a single request without a range.
+    EXPECT_CALL(*network_mock_, Send(_, _, _, _, _))
+        .WillRepeatedly(ReturnRange(data, status, 0u));
+    EXPECT_CALL(*network_mock_,
+                Send(testing::Property(&http::NetworkRequest::GetHeaders,
+                                       testing::Not(testing::Contains(
+                                           testing::Key(http::kRangeHeader)))),
+                     _, _, _, _))
+        .Times(1)
+        .WillOnce(ReturnRange(data));
+
+    auto response = read::BlobApi::GetBlobInRanges(
+        *client_, kLayerId, kDataHandle, boost::none, data.size(), 3u,
+        client::CancellationContext{});
+
+    ASSERT_TRUE(response.IsSuccessful());
+    const auto& result = response.GetResult();
+    EXPECT_EQ(data, std::string(result->begin(), result->end()));
+    testing::Mock::VerifyAndClearExpectations(network_mock_.get());
+  }
+}
+
+}  // namespace
@@ -102,4 +102,23 @@ TEST(PartitionsCacheRepositoryTest, IsCached) {
   }
 }
 
+TEST(PartitionsCacheRepositoryTest, IsCachedBatch) {
+  const auto hrn = client::HRN::FromString(kCatalog);
+  const auto layer = "layer";
+  const auto model_data =
+      std::make_shared<std::vector<unsigned char>>(3, 'a');
+
+  std::shared_ptr<cache::KeyValueCache> cache =
+      olp::client::OlpClientSettingsFactory::CreateDefaultCache({});
+  repository::DataCacheRepository repository(hrn, cache);
+
+  repository.Put(model_data, layer, kDataHandle);
+  repository.Put(model_data, layer, "other-handle");
+
+  const auto result = repository.IsCached(
+      layer, {"missing-handle", kDataHandle, "", "other-handle"});
+
+  EXPECT_EQ(result, std::vector<bool>({false, true, false, true}));
+}
+
 }  // namespace
@@ -212,6 +212,48 @@ TEST_F(DataRepositoryTest, GetBlobDataCache) {
   ASSERT_TRUE(response.IsSuccessful());
 }
 
+TEST_F(DataRepositoryTest, GetBlobDataChunks) {
+  EXPECT_CALL(*network_mock_, Send(IsGetRequest(kUrlLookup), _, _, _, _))
+      .WillOnce(ReturnHttpResponse(olp::http::NetworkResponse().WithStatus(
+                                       olp::http::HttpStatusCode::OK),
+                                   kUrlResponseLookup));
+
+  EXPECT_CALL(*network_mock_, Send(IsGetRequest(kUrlBlobData269), _, _, _, _))
+      .WillOnce(ReturnHttpResponse(olp::http::NetworkResponse().WithStatus(
+                                       olp::http::HttpStatusCode::OK),
+                                   "someData"));
+
+  olp::client::CancellationContext context;
+
+  olp::dataservice::read::DataRequest request;
+  request.WithDataHandle(kUrlBlobDataHandle);
+
+  std::string chunks;
+  auto chunk_callback = [&](const uint8_t* data, uint64_t offset,
+                            size_t length) {
+    EXPECT_EQ(offset, chunks.size());
+    chunks.append(reinterpret_cast<const char*>(data), length);
+  };
+
+  olp::client::HRN hrn(GetTestCatalog());
+  ApiLookupClient lookup_client(hrn, *settings_);
+  DataRepository repository(hrn, *settings_, lookup_client);
+
+  // The chunks are delivered from the network and collected for the cache
+  auto response = repository.GetBlobData(kLayerId, kService, request, context,
+                                         false, chunk_callback);
+  ASSERT_TRUE(response.IsSuccessful());
+  EXPECT_EQ(chunks, "someData");
+
+  // The cached data is delivered in one chunk
+  chunks.clear();
+  request.WithFetchOption(olp::dataservice::read::CacheOnly);
+  response = repository.GetBlobData(kLayerId, kService, request, context,
+                                    false, chunk_callback);
+  ASSERT_TRUE(response.IsSuccessful());
+  EXPECT_EQ(chunks, "someData");
+}
+
 TEST_F(DataRepositoryTest, GetBlobDataImmediateCancel) {
   ON_CALL(*network_mock_, Send(IsGetRequest(kUrlLookup), _, _, _, _))
       .WillByDefault(ReturnHttpResponse(olp::http::NetworkResponse().WithStatus(
@@ -0,0 +1,191 @@
+/*
+ * Copyright (C) 2021 HERE Europe B.V.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ * License-Filename: LICENSE
+ */
+
+#include "PrefetchJournal.h"
+
+#include <gmock/gmock.h>
+#include <mocks/CacheMock.h>
+#include <olp/core/cache/CacheSettings.h>
+#include <olp/core/cache/KeyValueCache.h>
+#include <olp/core/client/OlpClientSettingsFactory.h>
+
+namespace {
+namespace read = olp::dataservice::read;
+namespace client = olp::client;
+namespace cache = olp::cache;
+namespace geo = olp::geo;
+
+constexpr auto kCatalog = "hrn:here:data::olp-here-test:catalog";
+constexpr auto kLayer = "layer";
+constexpr int64_t kVersion = 4;
+
+read::PrefetchTilesRequest CreateRequest() {
+  return read::PrefetchTilesRequest()
+      .WithTileKeys({geo::TileKey::FromHereTile("23618364"),
+                     geo::TileKey::FromHereTile("23618365")})
+      .WithMinLevel(12)
+      .WithMaxLevel(14);
+}
+
+TEST(PrefetchJournalTest, CreateKey) {
+  const auto hrn = client::HRN::FromString(kCatalog);
+  const auto request = CreateRequest();
+  const auto key =
+      read::PrefetchJournal::CreateKey(hrn, kLayer, kVersion, request);
+
+  {
+    SCOPED_TRACE("Stable for the same request");
+
+    auto reordered = CreateRequest().WithTileKeys(
+        {geo::TileKey::FromHereTile("23618365"),
+         geo::TileKey::FromHereTile("23618364")});
+    EXPECT_EQ(key, read::PrefetchJournal::CreateKey(hrn, kLayer, kVersion,
+                                                    reordered));
+    EXPECT_EQ(key.find("hrn:here:data::olp-here-test:catalog::layer::4::"), 0u);
+  }
+
+  {
+    SCOPED_TRACE("Differs for another request");
+
+    EXPECT_NE(key, read::PrefetchJournal::CreateKey(
+                       hrn, kLayer, kVersion,
+                       CreateRequest().WithMaxLevel(13)));
+    EXPECT_NE(key, read::PrefetchJournal::CreateKey(hrn, kLayer, kVersion + 1,
+                                                    request));
+  }
+}
+
+TEST(PrefetchJournalTest, Resume) {
+  std::shared_ptr<cache::KeyValueCache> cache =
+      client::OlpClientSettingsFactory::CreateDefaultCache({});
+  const auto key = read::PrefetchJournal::CreateKey(
+      client::HRN::FromString(kCatalog), kLayer, kVersion, CreateRequest());
+
+  const auto root1 = geo::TileKey::FromHereTile("5904591");
+  const auto root2 = geo::TileKey::FromHereTile("1476147");
+  const read::PrefetchJournal::TilesResult query_result = {
+      {geo::TileKey::FromHereTile("23618364"), "handle-1"},
+      {geo::TileKey::FromHereTile("23618365"), "handle-2"},
+      {geo::TileKey::FromHereTile("23618366"), ""}};
+
+  EXPECT_FALSE(read::PrefetchJournal::ReadProgress(*cache, key));
+
+  {
+    SCOPED_TRACE("Interrupted prefetch");
+
+    read::PrefetchJournal journal(cache, key);
+    EXPECT_FALSE(journal.Load({root1, root2}));
+    EXPECT_FALSE(journal.GetQuery(root1));
+
+    journal.AddQuery(root1, query_result);
+    journal.SetTiles(query_result);
+    journal.AddCompleted("handle-1");
+    journal.Flush();
+  }
+
+  {
+    SCOPED_TRACE("Progress");
+
+    const auto progress = read::PrefetchJournal::ReadProgress(*cache, key);
+    ASSERT_TRUE(progress);
+    EXPECT_EQ(progress->prefetched_tiles, 1u);
+    EXPECT_EQ(progress->total_tiles_to_prefetch, 2u);
+    EXPECT_EQ(progress->queried_roots, 1u);
+    EXPECT_EQ(progress->total_roots, 2u);
+  }
+
+  {
+    SCOPED_TRACE("Restarted prefetch");
+
+    read::PrefetchJournal journal(cache, key);
+    EXPECT_TRUE(journal.Load({root1, root2}));
+
+    const auto stored_result = journal.GetQuery(root1);
+    ASSERT_TRUE(stored_result);
+    EXPECT_EQ(*stored_result, query_result);
+    EXPECT_FALSE(journal.GetQuery(root2));
+
+    // The restarted prefetch continues the stored progress.
+    journal.AddCompleted("handle-1");
+    journal.AddCompleted("handle-2");
+    journal.Flush();
+
+    const auto progress = read::PrefetchJournal::ReadProgress(*cache, key);
+    ASSERT_TRUE(progress);
+    EXPECT_EQ(progress->prefetched_tiles, 2u);
+    EXPECT_EQ(progress->total_tiles_to_prefetch, 2u);
+
+    journal.Remove();
+  }
+
+  EXPECT_FALSE(read::PrefetchJournal::ReadProgress(*cache, key));
+}
+
+TEST(PrefetchJournalTest, WritesFullSegments) {
+  std::shared_ptr<cache::KeyValueCache> cache =
+      client::OlpClientSettingsFactory::CreateDefaultCache({});
+  const auto key = read::PrefetchJournal::CreateKey(
+      client::HRN::FromString(kCatalog), kLayer, kVersion, CreateRequest());
+  const auto count = read::PrefetchJournal::kSegmentSize + 1;
+
+  read::PrefetchJournal::TilesResult tiles;
+  for (size_t i = 0; i < count; ++i) {
+    tiles.emplace(geo::TileKey::FromRowColumnLevel(0, i, 14),
+                  "handle-" + std::to_string(i));
+  }
+
+  {
+    read::PrefetchJournal journal(cache, key);
+    journal.Load({});
+    journal.SetTiles(tiles);
+    for (const auto& tile : tiles) {
+      journal.AddCompleted(tile.second);
+    }
+    // Not flushed, only the full segment is stored.
+  }
+
+  const auto progress = read::PrefetchJournal::ReadProgress(*cache, key);
+  ASSERT_TRUE(progress);
+  EXPECT_EQ(progress->prefetched_tiles, read::PrefetchJournal::kSegmentSize);
+  EXPECT_EQ(progress->total_tiles_to_prefetch, count);
+}
+
+TEST(PrefetchJournalTest, Expiry) {
+  auto cache = std::make_shared<testing::StrictMock<CacheMock>>();
+  const auto key = read::PrefetchJournal::CreateKey(
+      client::HRN::FromString(kCatalog), kLayer, kVersion, CreateRequest());
+  const auto root = geo::TileKey::FromHereTile("5904591");
+
+  // Every entry expires, so an abandoned journal is evicted eventually.
+  EXPECT_CALL(*cache, Get(key)).WillOnce(testing::Return(nullptr));
+  EXPECT_CALL(*cache, Put(testing::StartsWith(key),
+                          testing::A<cache::KeyValueCache::ValueTypePtr>(),
+                          read::PrefetchJournal::kExpiry))
+      .Times(5)
+      .WillRepeatedly(testing::Return(true));
+
+  read::PrefetchJournal journal(cache, key);
+  journal.Load({root});
+  journal.AddQuery(root, {{root, "handle"}});
+  journal.SetTiles({{root, "handle"}});
+  journal.AddCompleted("handle");
+  journal.Flush();
+}
+
+}  // namespace
@@ -291,4 +291,49 @@ TEST(PrefetchRepositoryTest, GetSlicedTilesLowLevels) {
   }
 }
 
+TEST(PrefetchRepositoryTest, GetSlicedTilesRequestCount) {
+  // The tiles of a bounding box on level 10, rows and columns are inclusive.
+  auto bounding_box = [](std::uint32_t row_begin, std::uint32_t row_end,
+                         std::uint32_t column_begin,
+                         std::uint32_t column_end) {
+    std::vector<olp::geo::TileKey> tiles;
+    for (auto row = row_begin; row <= row_end; ++row) {
+      for (auto column = column_begin; column <= column_end; ++column) {
+        tiles.push_back(olp::geo::TileKey::FromRowColumnLevel(row, column, 10));
+      }
+    }
+    return tiles;
+  };
+
+  // Every request covers 5 levels, so the slices are aligned to the max
+  // level, and the deepest slice needs a request per tile on its top level.
+  PrefetchRepositoryTestable repository;
+  const auto box = bounding_box(300, 303, 500, 503);
+  const auto unaligned_box = bounding_box(301, 305, 499, 503);
+  {
+    SCOPED_TRACE("Single level, tiles share the root on level 6");
+    EXPECT_EQ(repository.GetSlicedTiles(box, 10, 10).size(), 1u);
+  }
+  {
+    SCOPED_TRACE("Five levels, one request per tile");
+    EXPECT_EQ(repository.GetSlicedTiles(box, 10, 14).size(), 16u);
+  }
+  {
+    SCOPED_TRACE("Nine levels, one root on level 7, 16 * 4^2 on level 12");
+    EXPECT_EQ(repository.GetSlicedTiles(box, 8, 16).size(), 1u + 16u * 16u);
+  }
+  {
+    SCOPED_TRACE("Levels below the tiles, 2x2 roots on level 8");
+    EXPECT_EQ(repository.GetSlicedTiles(unaligned_box, 12, 12).size(), 4u);
+  }
+  {
+    SCOPED_TRACE("Deep range, 4^8 roots on level 10, 4^3 on 5, and 1 on 0");
+    const auto tile = olp::geo::TileKey::FromRowColumnLevel(1, 2, 2);
+    const auto root_tiles_depth = repository.GetSlicedTiles({tile}, 2, 14);
+    EXPECT_EQ(root_tiles_depth.size(), 65536u + 64u + 1u);
+    EXPECT_EQ(root_tiles_depth.begin()->first, tile.ChangedLevelTo(0));
+    EXPECT_EQ(root_tiles_depth.rbegin()->first.Level(), 10u);
+  }
+}
+
 }  // namespace
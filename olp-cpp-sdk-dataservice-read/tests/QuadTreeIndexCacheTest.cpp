@@ -0,0 +1,108 @@
+/*
+ * Copyright (C) 2021 HERE Europe B.V.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ * License-Filename: LICENSE
+ */
+
+#include <gtest/gtest.h>
+
+#include "repositories/QuadTreeIndexCache.h"
+
+namespace {
+namespace cache = olp::cache;
+namespace geo = olp::geo;
+namespace read = olp::dataservice::read;
+namespace repository = olp::dataservice::read::repository;
+
+constexpr std::int64_t kVersion = 4;
+constexpr std::uint32_t kDepth = 4;
+
+cache::KeyValueCache::ValueTypePtr CreateData(std::size_t size) {
+  return std::make_shared<cache::KeyValueCache::ValueType>(size, 1);
+}
+
+TEST(QuadTreeIndexCacheTest, Find) {
+  repository::QuadTreeIndexCache cache;
+  const auto root = geo::TileKey::FromRowColumnLevel(300, 500, 10);
+  const auto data = CreateData(100);
+  cache.Put(root, kVersion, data);
+
+  {
+    SCOPED_TRACE("Tiles covered by the tree");
+
+    for (auto depth = 0u; depth <= kDepth; ++depth) {
+      read::QuadTreeIndex tree;
+      const auto tile = root.ChangedLevelBy(depth).AddedSubkey64(1);
+      ASSERT_TRUE(cache.Find(tile, kVersion, kDepth, tree));
+      EXPECT_EQ(tree.GetRawData(), data);
+    }
+  }
+
+  {
+    SCOPED_TRACE("Tiles not covered by the tree");
+
+    read::QuadTreeIndex tree;
+    EXPECT_FALSE(cache.Find(root.ChangedLevelBy(kDepth + 1), kVersion, kDepth,
+                            tree));
+    EXPECT_FALSE(cache.Find(root.Parent(), kVersion, kDepth, tree));
+    EXPECT_FALSE(cache.Find(root, kVersion + 1, kDepth, tree));
+    EXPECT_TRUE(tree.IsNull());
+  }
+
+  {
+    SCOPED_TRACE("Nearest root first");
+
+    const auto nearest_root = root.ChangedLevelBy(2);
+    const auto nearest_data = CreateData(100);
+    cache.Put(nearest_root, kVersion, nearest_data);
+
+    read::QuadTreeIndex tree;
+    ASSERT_TRUE(
+        cache.Find(nearest_root.ChangedLevelBy(1), kVersion, kDepth, tree));
+    EXPECT_EQ(tree.GetRawData(), nearest_data);
+  }
+
+  {
+    SCOPED_TRACE("Removed tree");
+
+    cache.Remove(root, kVersion);
+    read::QuadTreeIndex tree;
+    EXPECT_FALSE(cache.Find(root, kVersion, kDepth, tree));
+
+    cache.Clear();
+    EXPECT_FALSE(cache.Find(root.ChangedLevelBy(2), kVersion, kDepth, tree));
+  }
+}
+
+TEST(QuadTreeIndexCacheTest, EvictsLeastRecentlyUsed) {
+  repository::QuadTreeIndexCache cache(250);
+  const auto root = geo::TileKey::FromRowColumnLevel(300, 500, 10);
+  const auto sibling = root.NextColumn();
+  const auto other = sibling.NextColumn();
+
+  cache.Put(root, kVersion, CreateData(100));
+  cache.Put(sibling, kVersion, CreateData(100));
+
+  read::QuadTreeIndex tree;
+  EXPECT_TRUE(cache.Find(root, kVersion, kDepth, tree));
+
+  cache.Put(other, kVersion, CreateData(100));
+  EXPECT_TRUE(cache.Find(root, kVersion, kDepth, tree));
+  EXPECT_FALSE(cache.Find(sibling, kVersion, kDepth, tree));
+  EXPECT_TRUE(cache.Find(other, kVersion, kDepth, tree));
+}
+
+}  // namespace
@@ -142,4 +142,63 @@ TEST(QuadTreeIndexTest, ParseBlob) {
   }
 }
 
+TEST(QuadTreeIndexTest, FindNearestParentInFullTree) {
+  const auto root = olp::geo::TileKey::FromRowColumnLevel(300, 500, 10);
+  const auto root_level = root.Level();
+
+  // Data on the levels 0, 2 and 4 of the tree, and on two parents of the root.
+  std::ostringstream json;
+  json << R"({"subQuads": [)";
+  const char* separator = "";
+  for (auto depth : {0u, 2u, 4u}) {
+    const std::uint64_t first_sub = std::uint64_t{1} << (2 * depth);
+    for (auto sub = first_sub; sub < 2 * first_sub; ++sub) {
+      json << separator << R"({"subQuadKey": ")" << sub
+           << R"(", "version": 4, "dataHandle": "handle-)" << sub << R"("})";
+      separator = ",";
+    }
+  }
+  json << R"(], "parentQuads": [)";
+  json << R"({"partition": ")" << root.ChangedLevelTo(3).ToHereTile()
+       << R"(", "version": 4, "dataHandle": "parent-3"},)";
+  json << R"({"partition": ")" << root.ChangedLevelTo(7).ToHereTile()
+       << R"(", "version": 4, "dataHandle": "parent-7"}]})";
+
+  std::stringstream stream(json.str());
+  read::QuadTreeIndex index(root, 4, stream);
+  ASSERT_FALSE(index.IsNull());
+
+  // Every tile of the tree, and two levels below it.
+  for (auto depth = 0u; depth <= 6u; ++depth) {
+    const auto expected_depth = std::min(depth - depth % 2, 4u);
+    const auto first_key = root.ChangedLevelBy(depth).ToQuadKey64();
+    const auto count = std::uint64_t{1} << (2 * depth);
+    for (auto key = first_key; key < first_key + count; ++key) {
+      const auto tile = olp::geo::TileKey::FromQuadKey64(key);
+      const auto expected_tile =
+          tile.ChangedLevelTo(root_level + expected_depth);
+
+      const auto data = index.Find(tile, true);
+      ASSERT_TRUE(data) << tile.ToHereTile();
+      EXPECT_EQ(data->tile_key, expected_tile);
+      EXPECT_EQ(data->data_handle,
+                "handle-" + std::to_string(expected_tile.GetSubkey64(
+                                static_cast<int>(expected_depth))));
+      const bool has_data = depth % 2 == 0 && depth <= 4u;
+      EXPECT_EQ(static_cast<bool>(index.Find(tile, false)), has_data);
+    }
+  }
+
+  // The tiles above the root.
+  auto data = index.Find(root.ChangedLevelTo(9), true);
+  ASSERT_TRUE(data);
+  EXPECT_EQ(data->data_handle, "parent-7");
+
+  data = index.Find(root.ChangedLevelTo(5), true);
+  ASSERT_TRUE(data);
+  EXPECT_EQ(data->data_handle, "parent-3");
+
+  EXPECT_FALSE(index.Find(root.ChangedLevelTo(2), true));
+}
+
 }  // namespace
@@ -133,6 +133,12 @@ class DATASERVICE_WRITE_API StreamLayerClient {
   /**
    * @brief Flush PublishDataRequests that were queued via the Queue
    * API.
+   *
+   * Up to \c StreamLayerClientSettings::maximum_concurrent_flush_requests
+   * requests are published concurrently. The response of each request is
+   * reported in the queue order, the failed requests are not queued back.
+   * When cancelled, the requests that are not published are queued back.
+   *
    * @param request \c FlushRequest object that represents the parameters for
    * this \c Flush method call.
    * @param callback The callback that is called when all the flush
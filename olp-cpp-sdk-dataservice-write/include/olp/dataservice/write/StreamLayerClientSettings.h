@@ -1,5 +1,5 @@
 /*
- * Copyright (C) 2019 HERE Europe B.V.
+ * Copyright (C) 2019-2021 HERE Europe B.V.
  *
  * Licensed under the Apache License, Version 2.0 (the "License");
  * you may not use this file except in compliance with the License.
@@ -37,6 +37,18 @@ struct DATASERVICE_WRITE_API StreamLayerClientSettings {
    * @brief The maximum number of requests that can be stored. Must be positive.
    */
   size_t maximum_requests = std::numeric_limits<size_t>::max();
+
+  /**
+   * @brief The maximum number of queued requests that \c Flush publishes
+   * concurrently. Must be positive.
+   *
+   * The requests are published on the threads of the \c TaskScheduler set in
+   * the client settings, so the limit is only reached when the scheduler has
+   * enough threads. When it is greater than one, the requests may reach the
+   * stream layer in a different order than they were queued. The responses
+   * are always returned in the queue order.
+   */
+  size_t maximum_concurrent_flush_requests = 1;
 };
 
 }  // namespace write
@@ -1,5 +1,5 @@
 /*
- * Copyright (C) 2019-2020 HERE Europe B.V.
+ * Copyright (C) 2019-2021 HERE Europe B.V.
  *
  * Licensed under the Apache License, Version 2.0 (the "License");
  * you may not use this file except in compliance with the License.
@@ -19,6 +19,16 @@
 
 #include "StreamLayerClientImpl.h"
 
+#include <algorithm>
+#include <cinttypes>
+#include <condition_variable>
+#include <cstdlib>
+#include <iterator>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
 #include <boost/uuid/uuid.hpp>
 #include <boost/uuid/uuid_generators.hpp>
 #include <boost/uuid/uuid_io.hpp>
@@ -57,6 +67,36 @@ namespace write {
 namespace {
 constexpr auto kLogTag = "StreamLayerClientImpl";
 constexpr int64_t kTwentyMib = 20971520;  // 20 MiB
+constexpr int kFlushBatchSize = 100;
+
+boost::any ParsePublishDataRequest(const std::string& serialized) {
+  return olp::parser::parse<model::PublishDataRequest>(serialized);
+}
+
+void PutPublishDataRequest(cache::KeyValueCache& cache, const std::string& key,
+                           const model::PublishDataRequest& request) {
+  cache.Put(key, request, [&request]() {
+    return olp::serializer::serialize<model::PublishDataRequest>(request);
+  });
+}
+
+/// The requests of a flush batch shared by the threads publishing them.
+struct FlushBatch {
+  explicit FlushBatch(const std::vector<model::PublishDataRequest>& requests)
+      : requests(requests), responses(requests.size()) {}
+
+  const std::vector<model::PublishDataRequest> requests;
+  std::vector<PublishDataResponse> responses;
+  std::mutex mutex;
+  std::condition_variable finished;
+  size_t next{0};
+  size_t in_flight{0};
+};
+
+bool IsCancelled(const PublishDataResponse& response) {
+  return !response.IsSuccessful() &&
+         response.GetError().GetErrorCode() == client::ErrorCode::Cancelled;
+}
 
 void ExecuteOrSchedule(const std::shared_ptr<thread::TaskScheduler>& scheduler,
                        thread::TaskScheduler::CallFuncType&& func) {
@@ -99,18 +139,90 @@ std::string StreamLayerClientImpl::GetUuidListKey() const {
   return uuid_list_key;
 }
 
-size_t StreamLayerClientImpl::QueueSize() const {
-  std::lock_guard<std::mutex> lock(cache_mutex_);
+std::string StreamLayerClientImpl::GetQueueRangeKey() const {
+  return catalog_.ToCatalogHRNString() + "-stream-queue::range";
+}
+
+std::string StreamLayerClientImpl::GetQueueItemKey(
+    std::int64_t sequence) const {
+  return catalog_.ToCatalogHRNString() + "-stream-queue::" +
+         std::to_string(sequence);
+}
+
+StreamLayerClientImpl::QueueRange StreamLayerClientImpl::LoadQueueRange()
+    const {
+  QueueRange range;
+  const auto range_any =
+      cache_->Get(GetQueueRangeKey(), [](const std::string& s) { return s; });
+  if (range_any.empty()) {
+    MigrateUuidList(range);
+    return range;
+  }
+
+  const auto value = boost::any_cast<std::string>(range_any);
+  char* end = nullptr;
+  range.head = std::strtoll(value.c_str(), &end, 10);
+  range.tail = *end == ',' ? std::strtoll(end + 1, nullptr, 10) : range.head;
+  if (range.tail < range.head) {
+    OLP_SDK_LOG_ERROR_F(kLogTag, "Invalid queue range in cache, range='%s'",
+                        value.c_str());
+    return QueueRange{};
+  }
+
+  return range;
+}
+
+void StreamLayerClientImpl::StoreQueueRange(const QueueRange& range) const {
+  // Restarts the sequence numbers once the queue is drained.
+  const auto value =
+      range.head == range.tail
+          ? std::string("0,0")
+          : std::to_string(range.head) + "," + std::to_string(range.tail);
+  cache_->Put(GetQueueRangeKey(), value, [&value]() { return value; });
+}
 
+void StreamLayerClientImpl::MigrateUuidList(QueueRange& range) const {
+  // Requests queued by the previous versions are kept in a comma separated
+  // list of UUID keys, move them to the sequence numbered keys.
   const auto uuid_list_any =
       cache_->Get(GetUuidListKey(), [](const std::string& s) { return s; });
-  std::string uuid_list = "";
-  if (!uuid_list_any.empty()) {
-    uuid_list = boost::any_cast<std::string>(uuid_list_any);
-    return std::count(uuid_list.cbegin(), uuid_list.cend(), ',');
+  if (uuid_list_any.empty()) {
+    return;
+  }
+
+  const auto uuid_list = boost::any_cast<std::string>(uuid_list_any);
+  std::string::size_type begin = 0;
+  for (auto pos = uuid_list.find(','); pos != std::string::npos;
+       begin = pos + 1, pos = uuid_list.find(',', begin)) {
+    const auto publish_data_key = uuid_list.substr(begin, pos - begin);
+    const auto publish_data_any =
+        cache_->Get(publish_data_key, ParsePublishDataRequest);
+    cache_->Remove(publish_data_key);
+    if (publish_data_any.empty()) {
+      OLP_SDK_LOG_ERROR(kLogTag,
+                        "Unable to Restore PublishData Request from Cache");
+      continue;
+    }
+
+    PutPublishDataRequest(
+        *cache_, GetQueueItemKey(range.tail++),
+        boost::any_cast<model::PublishDataRequest>(publish_data_any));
   }
 
-  return 0;
+  StoreQueueRange(range);
+  cache_->Remove(GetUuidListKey());
+  OLP_SDK_LOG_INFO_F(kLogTag, "Migrated %" PRId64 " queued publish requests",
+                     range.tail - range.head);
+}
+
+size_t StreamLayerClientImpl::QueueSize() const {
+  if (!cache_) {
+    return 0;
+  }
+
+  std::lock_guard<std::mutex> lock(cache_mutex_);
+  const auto range = LoadQueueRange();
+  return static_cast<size_t>(range.tail - range.head);
 }
 
 boost::optional<std::string> StreamLayerClientImpl::Queue(
@@ -130,71 +242,101 @@ boost::optional<std::string> StreamLayerClientImpl::Queue(
         "PublishDataRequest does not contain a Layer ID");
   }
 
-  if (!(StreamLayerClientImpl::QueueSize() <
+  std::lock_guard<std::mutex> lock(cache_mutex_);
+  auto range = LoadQueueRange();
+  if (!(static_cast<size_t>(range.tail - range.head) <
         stream_client_settings_.maximum_requests)) {
     return boost::make_optional<std::string>(
         "Maximum number of requests has reached");
   }
 
-  {
-    std::lock_guard<std::mutex> lock(cache_mutex_);
-    const auto publish_data_key = GenerateUuid();
-    cache_->Put(publish_data_key, request, [=]() {
-      return olp::serializer::serialize<model::PublishDataRequest>(request);
-    });
+  PutPublishDataRequest(*cache_, GetQueueItemKey(range.tail), request);
+  ++range.tail;
+  StoreQueueRange(range);
 
-    const auto uuid_list_any =
-        cache_->Get(GetUuidListKey(), [](const std::string& s) { return s; });
-    std::string uuid_list = "";
-    if (!uuid_list_any.empty()) {
-      uuid_list = boost::any_cast<std::string>(uuid_list_any);
-    }
-    uuid_list += publish_data_key + ",";
+  return boost::none;
+}
 
-    cache_->Put(GetUuidListKey(), uuid_list,
-                [&uuid_list]() { return uuid_list; });
+StreamLayerClientImpl::QueueBatch StreamLayerClientImpl::PeekQueue(
+    size_t count) const {
+  if (!cache_) {
+    return {};
   }
 
-  return boost::none;
+  std::lock_guard<std::mutex> lock(cache_mutex_);
+  return ReadQueueFront(LoadQueueRange(), count);
 }
 
-boost::optional<model::PublishDataRequest>
-StreamLayerClientImpl::PopFromQueue() {
+void StreamLayerClientImpl::RemoveFromQueue(
+    const QueueBatch& batch, std::int64_t end,
+    const std::vector<model::PublishDataRequest>& cancelled) {
+  if (!cache_) {
+    return;
+  }
+
   std::lock_guard<std::mutex> lock(cache_mutex_);
+  auto range = LoadQueueRange();
+  if (range.head != batch.head) {
+    OLP_SDK_LOG_WARNING_F(kLogTag,
+                          "The flushed requests are already removed from the "
+                          "queue, head=%" PRId64 ", expected=%" PRId64,
+                          range.head, batch.head);
+    return;
+  }
 
-  const auto uuid_list_any =
-      cache_->Get(GetUuidListKey(), [](const std::string& s) { return s; });
+  RemoveQueueFront(range, end);
+  RequeueFront(range, cancelled);
+  StoreQueueRange(range);
+}
 
-  if (uuid_list_any.empty()) {
-    OLP_SDK_LOG_ERROR(kLogTag, "Unable to Restore UUID list from Cache");
-    return boost::none;
+StreamLayerClientImpl::QueueBatch StreamLayerClientImpl::ReadQueueFront(
+    const QueueRange& range, size_t count) const {
+  QueueBatch batch;
+  batch.head = range.head;
+  batch.tail =
+      range.head + static_cast<std::int64_t>(std::min(
+                       static_cast<size_t>(range.tail - range.head), count));
+  if (batch.head == batch.tail) {
+    return batch;
   }
 
-  auto uuid_list = boost::any_cast<std::string>(uuid_list_any);
-
-  auto pos = uuid_list.find(",");
-  if (pos == std::string::npos) {
-    return boost::none;
+  cache::KeyValueCache::KeyListType keys;
+  keys.reserve(static_cast<size_t>(batch.tail - batch.head));
+  for (auto sequence = batch.head; sequence < batch.tail; ++sequence) {
+    keys.push_back(GetQueueItemKey(sequence));
   }
 
-  const auto publish_data_key = uuid_list.substr(0, pos);
-  auto publish_data_any =
-      cache_->Get(publish_data_key, [](const std::string& s) {
-        return olp::parser::parse<model::PublishDataRequest>(s);
-      });
+  auto values = cache_->GetBatch(keys, ParsePublishDataRequest);
+  batch.sequences.reserve(values.size());
+  batch.requests.reserve(values.size());
+  for (size_t i = 0; i < values.size(); ++i) {
+    if (values[i].empty()) {
+      OLP_SDK_LOG_ERROR(kLogTag,
+                        "Unable to Restore PublishData Request from Cache");
+      continue;
+    }
 
-  cache_->Remove(publish_data_key);
-  uuid_list.erase(0, pos + 1);
-  cache_->Put(GetUuidListKey(), uuid_list,
-              [&uuid_list]() { return uuid_list; });
+    batch.sequences.push_back(batch.head + static_cast<std::int64_t>(i));
+    batch.requests.push_back(
+        boost::any_cast<model::PublishDataRequest>(std::move(values[i])));
+  }
+
+  return batch;
+}
 
-  if (publish_data_any.empty()) {
-    OLP_SDK_LOG_ERROR(kLogTag,
-                      "Unable to Restore PublishData Request from Cache");
-    return boost::none;
+void StreamLayerClientImpl::RemoveQueueFront(QueueRange& range,
+                                             std::int64_t end) const {
+  for (; range.head < end; ++range.head) {
+    cache_->Remove(GetQueueItemKey(range.head));
   }
+}
 
-  return boost::any_cast<model::PublishDataRequest>(publish_data_any);
+void StreamLayerClientImpl::RequeueFront(
+    QueueRange& range,
+    const std::vector<model::PublishDataRequest>& requests) const {
+  for (auto it = requests.rbegin(); it != requests.rend(); ++it) {
+    PutPublishDataRequest(*cache_, GetQueueItemKey(--range.head), *it);
+  }
 }
 
 olp::client::CancellableFuture<StreamLayerClient::FlushResponse>
@@ -236,21 +378,39 @@ olp::client::CancellationToken StreamLayerClientImpl::Flush(
         int counter = 0;
         while ((!maximum_events_number || counter < maximum_events_number) &&
                (this->QueueSize() > 0) && !context.IsCancelled()) {
-          auto publish_request = this->PopFromQueue();
-          if (publish_request == boost::none) {
-            continue;
-          }
-
-          auto publish_response = PublishDataTask(*publish_request, context);
-          responses.emplace_back(std::move(publish_response));
-
-          // If cancelled queue back task
-          if (context.IsCancelled()) {
-            this->Queue(*publish_request);
+          const auto batch_size =
+              maximum_events_number
+                  ? std::min(kFlushBatchSize, maximum_events_number - counter)
+                  : kFlushBatchSize;
+          // The batch stays queued until it is published, so the requests
+          // are not lost if the process ends meanwhile. The batches are
+          // flushed one at a time, so no request is published twice.
+          std::lock_guard<std::mutex> flush_lock(this->flush_mutex_);
+          const auto batch = this->PeekQueue(static_cast<size_t>(batch_size));
+          if (batch.head == batch.tail) {
             break;
           }
 
-          counter++;
+          auto publish_responses = PublishBatch(batch.requests, context);
+
+          // Remove the published requests and queue back the cancelled ones,
+          // the requests that were not started stay queued.
+          std::vector<model::PublishDataRequest> cancelled_requests;
+          for (size_t i = 0; i < publish_responses.size(); ++i) {
+            if (IsCancelled(publish_responses[i])) {
+              cancelled_requests.push_back(batch.requests[i]);
+            } else {
+              counter++;
+            }
+          }
+          const auto started_count = publish_responses.size();
+          const auto end = started_count < batch.sequences.size()
+                               ? batch.sequences[started_count]
+                               : batch.tail;
+          this->RemoveFromQueue(batch, end, cancelled_requests);
+
+          std::move(publish_responses.begin(), publish_responses.end(),
+                    std::back_inserter(responses));
         }
 
         OLP_SDK_LOG_INFO_F(kLogTag, "Flushed %d publish requests", counter);
@@ -276,6 +436,52 @@ olp::client::CancellationToken StreamLayerClientImpl::Flush(
   return task_context.CancelToken();
 }
 
+std::vector<PublishDataResponse> StreamLayerClientImpl::PublishBatch(
+    const std::vector<model::PublishDataRequest>& requests,
+    client::CancellationContext context) {
+  auto batch = std::make_shared<FlushBatch>(requests);
+
+  // Publishes the requests one by one until none is left or the flush is
+  // cancelled. The batch outlives the flush when a helper task starts late,
+  // but such a task finds no request to publish and does not touch `this`.
+  auto publish = [=]() {
+    std::unique_lock<std::mutex> lock(batch->mutex);
+    while (batch->next < batch->requests.size() && !context.IsCancelled()) {
+      const auto index = batch->next++;
+      ++batch->in_flight;
+      lock.unlock();
+
+      auto response = PublishDataTask(batch->requests[index], context);
+
+      lock.lock();
+      batch->responses[index] = std::move(response);
+      if (--batch->in_flight == 0) {
+        batch->finished.notify_one();
+      }
+    }
+  };
+
+  const auto max_concurrency = std::max<size_t>(
+      stream_client_settings_.maximum_concurrent_flush_requests, 1u);
+  const auto concurrency = std::min(max_concurrency, requests.size());
+  if (task_scheduler_) {
+    for (size_t i = 1; i < concurrency; ++i) {
+      task_scheduler_->ScheduleTask(publish);
+    }
+  }
+
+  // The flushing thread publishes too, so the flush completes even when the
+  // scheduler has no free thread for the helper tasks.
+  publish();
+
+  std::unique_lock<std::mutex> lock(batch->mutex);
+  batch->finished.wait(lock, [&] { return batch->in_flight == 0; });
+
+  auto responses = std::move(batch->responses);
+  responses.resize(std::min(batch->next, responses.size()));
+  return responses;
+}
+
 olp::client::CancellableFuture<PublishDataResponse>
 StreamLayerClientImpl::PublishData(model::PublishDataRequest request) {
   auto promise = std::make_shared<std::promise<PublishDataResponse>>();
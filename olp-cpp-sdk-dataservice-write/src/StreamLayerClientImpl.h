@@ -19,7 +19,10 @@
 
 #pragma once
 
+#include <cstdint>
 #include <mutex>
+#include <string>
+#include <vector>
 
 #include <boost/optional.hpp>
 
@@ -60,7 +63,26 @@ class StreamLayerClientImpl {
   olp::client::CancellationToken Flush(
       model::FlushRequest request, StreamLayerClient::FlushCallback callback);
   size_t QueueSize() const;
-  boost::optional<model::PublishDataRequest> PopFromQueue();
+
+  /// The requests read from the front of the queue, in [head, tail). The
+  /// entries that fail to parse are left out, so every request comes with its
+  /// sequence number.
+  struct QueueBatch {
+    std::int64_t head{0};
+    std::int64_t tail{0};
+    std::vector<std::int64_t> sequences;
+    std::vector<model::PublishDataRequest> requests;
+  };
+
+  /// Reads up to `count` requests from the front of the queue without
+  /// removing them.
+  QueueBatch PeekQueue(size_t count) const;
+
+  /// Removes the batch entries before the sequence number `end`, and queues
+  /// the cancelled requests back in front. Nothing is removed if the batch is
+  /// not at the front of the queue anymore.
+  void RemoveFromQueue(const QueueBatch& batch, std::int64_t end,
+                       const std::vector<model::PublishDataRequest>& cancelled);
 
   client::CancellableFuture<PublishSdiiResponse> PublishSdii(
       model::PublishSdiiRequest request);
@@ -87,7 +109,34 @@ class StreamLayerClientImpl {
   virtual std::string GenerateUuid() const;
 
  private:
+  /// The persistent queue holds the requests under consecutive sequence
+  /// numbers in [head, tail), so the requests are added and removed without
+  /// rewriting the rest of the queue.
+  struct QueueRange {
+    std::int64_t head{0};
+    std::int64_t tail{0};
+  };
+
   std::string GetUuidListKey() const;
+  std::string GetQueueRangeKey() const;
+  std::string GetQueueItemKey(std::int64_t sequence) const;
+
+  /// Publishes the requests with up to `maximum_concurrent_flush_requests` of
+  /// them in flight. No request is started once the context is cancelled, so
+  /// the responses are for the leading requests, in the same order.
+  std::vector<PublishDataResponse> PublishBatch(
+      const std::vector<model::PublishDataRequest>& requests,
+      client::CancellationContext context);
+
+  // The methods below expect cache_mutex_ to be locked.
+  QueueRange LoadQueueRange() const;
+  void StoreQueueRange(const QueueRange& range) const;
+  void MigrateUuidList(QueueRange& range) const;
+  QueueBatch ReadQueueFront(const QueueRange& range, size_t count) const;
+  void RemoveQueueFront(QueueRange& range, std::int64_t end) const;
+  void RequeueFront(
+      QueueRange& range,
+      const std::vector<model::PublishDataRequest>& requests) const;
 
  private:
   client::HRN catalog_;
@@ -97,6 +146,7 @@ class StreamLayerClientImpl {
 
   std::shared_ptr<cache::KeyValueCache> cache_;
   mutable std::mutex cache_mutex_;
+  std::mutex flush_mutex_;
   StreamLayerClientSettings stream_client_settings_;
 
   std::shared_ptr<client::PendingRequests> pending_requests_;
@@ -23,8 +23,15 @@
 #include <mocks/NetworkMock.h>
 #include <olp/core/cache/CacheSettings.h>
 #include <olp/core/client/OlpClientSettingsFactory.h>
+#include <condition_variable>
+#include <future>
+#include <mutex>
 #include <unordered_set>
 #include "StreamLayerClientImpl.h"
+// clang-format off
+#include <generated/serializer/PublishDataRequestSerializer.h>
+#include <generated/serializer/JsonSerializer.h>
+// clang-format on
 
 namespace {
 
@@ -734,7 +741,6 @@ TEST_F(StreamLayerClientImplTest, QueueAndFlush) {
   auto client = std::make_shared<MockStreamLayerClientImpl>(
       kHrn, write::StreamLayerClientSettings{}, settings_);
 
-  size_t uuid_call_count = 1;
   // Forward trace ID from request to response
   ON_CALL(*client, PublishDataTask(_, _))
       .WillByDefault([](model::PublishDataRequest request,
@@ -744,13 +750,8 @@ TEST_F(StreamLayerClientImplTest, QueueAndFlush) {
         result.SetTraceID(request.GetTraceId().get());
         return write::PublishDataResponse{result};
       });
-  ON_CALL(*client, GenerateUuid)
-      .WillByDefault([&uuid_call_count]() -> std::string {
-        return std::to_string(uuid_call_count++);
-      });
 
   EXPECT_CALL(*client, PublishDataTask(_, _)).Times(kBatchSize);
-  EXPECT_CALL(*client, GenerateUuid()).Times(kBatchSize);
 
   // queues all  requests:
   for (size_t i = 0; i < kBatchSize; ++i) {
@@ -778,4 +779,253 @@ TEST_F(StreamLayerClientImplTest, QueueAndFlush) {
   EXPECT_EQ(kBatchSize, trace_ids.size());
 }
 
+model::PublishDataRequest CreateQueueRequest(const std::string& trace_id) {
+  return model::PublishDataRequest()
+      .WithTraceId(trace_id)
+      .WithData(std::make_shared<std::vector<unsigned char>>(1, 'z'))
+      .WithLayerId(kLayerName);
+}
+
+// Reads and removes up to `count` requests from the front of the queue.
+std::vector<model::PublishDataRequest> TakeFromQueue(
+    write::StreamLayerClientImpl& client, size_t count) {
+  const auto batch = client.PeekQueue(count);
+  client.RemoveFromQueue(batch, batch.tail, {});
+  return batch.requests;
+}
+
+TEST_F(StreamLayerClientImplTest, QueueIsSharedAndOrdered) {
+  settings_.cache =
+      olp::client::OlpClientSettingsFactory::CreateDefaultCache({});
+
+  write::StreamLayerClientImpl client{kHrn, write::StreamLayerClientSettings{},
+                                      settings_};
+  for (const auto trace_id : {"0", "1", "2"}) {
+    EXPECT_FALSE(client.Queue(CreateQueueRequest(trace_id)));
+  }
+
+  // Another client for the same catalog continues the same queue.
+  write::StreamLayerClientImpl other_client{
+      kHrn, write::StreamLayerClientSettings{}, settings_};
+  EXPECT_EQ(other_client.QueueSize(), 3u);
+
+  const auto requests = TakeFromQueue(other_client, 2);
+  ASSERT_EQ(requests.size(), 2u);
+  EXPECT_EQ(requests[0].GetTraceId().get(), "0");
+  EXPECT_EQ(requests[1].GetTraceId().get(), "1");
+  EXPECT_EQ(client.QueueSize(), 1u);
+
+  EXPECT_FALSE(client.Queue(CreateQueueRequest("3")));
+  const auto request = TakeFromQueue(client, 1);
+  ASSERT_EQ(request.size(), 1u);
+  EXPECT_EQ(request[0].GetTraceId().get(), "2");
+
+  EXPECT_EQ(TakeFromQueue(client, 5).size(), 1u);
+  EXPECT_EQ(client.QueueSize(), 0u);
+  EXPECT_TRUE(TakeFromQueue(client, 1).empty());
+}
+
+TEST_F(StreamLayerClientImplTest, QueueLimit) {
+  settings_.cache =
+      olp::client::OlpClientSettingsFactory::CreateDefaultCache({});
+
+  write::StreamLayerClientSettings stream_settings;
+  stream_settings.maximum_requests = 2;
+  write::StreamLayerClientImpl client{kHrn, stream_settings, settings_};
+
+  EXPECT_FALSE(client.Queue(CreateQueueRequest("0")));
+  EXPECT_FALSE(client.Queue(CreateQueueRequest("1")));
+  EXPECT_TRUE(client.Queue(CreateQueueRequest("2")));
+  EXPECT_EQ(client.QueueSize(), 2u);
+
+  ASSERT_EQ(TakeFromQueue(client, 1).size(), 1u);
+  EXPECT_FALSE(client.Queue(CreateQueueRequest("2")));
+}
+
+TEST_F(StreamLayerClientImplTest, MigrateQueuedUuidList) {
+  std::shared_ptr<olp::cache::KeyValueCache> cache =
+      olp::client::OlpClientSettingsFactory::CreateDefaultCache({});
+  settings_.cache = cache;
+
+  // The queue layout of the previous versions.
+  for (const auto uuid : {"uuid-1", "uuid-2"}) {
+    const auto request = CreateQueueRequest(uuid);
+    cache->Put(uuid, request, [&request]() {
+      return olp::serializer::serialize<model::PublishDataRequest>(request);
+    });
+  }
+  const std::string uuid_list = "uuid-1,uuid-2,";
+  cache->Put(kHrn.ToCatalogHRNString() + "-stream-queue-cache", uuid_list,
+             [&uuid_list]() { return uuid_list; });
+
+  write::StreamLayerClientImpl client{kHrn, write::StreamLayerClientSettings{},
+                                      settings_};
+  EXPECT_EQ(client.QueueSize(), 2u);
+  EXPECT_FALSE(client.Queue(CreateQueueRequest("uuid-3")));
+
+  const auto requests = TakeFromQueue(client, 3);
+  ASSERT_EQ(requests.size(), 3u);
+  EXPECT_EQ(requests[0].GetTraceId().get(), "uuid-1");
+  EXPECT_EQ(requests[1].GetTraceId().get(), "uuid-2");
+  EXPECT_EQ(requests[2].GetTraceId().get(), "uuid-3");
+  EXPECT_FALSE(cache->Contains("uuid-1"));
+  EXPECT_FALSE(
+      cache->Contains(kHrn.ToCatalogHRNString() + "-stream-queue-cache"));
+}
+
+TEST_F(StreamLayerClientImplTest, FlushConcurrently) {
+  const size_t kRequestsCount = 20;
+  const size_t kConcurrency = 3;
+  settings_.cache =
+      olp::client::OlpClientSettingsFactory::CreateDefaultCache({});
+  settings_.task_scheduler =
+      olp::client::OlpClientSettingsFactory::CreateDefaultTaskScheduler(
+          kConcurrency);
+
+  write::StreamLayerClientSettings stream_settings;
+  stream_settings.maximum_concurrent_flush_requests = kConcurrency;
+  auto client = std::make_shared<MockStreamLayerClientImpl>(
+      kHrn, stream_settings, settings_);
+
+  std::mutex mutex;
+  std::condition_variable started;
+  size_t in_flight = 0;
+  size_t max_in_flight = 0;
+
+  ON_CALL(*client, PublishDataTask(_, _))
+      .WillByDefault([&](model::PublishDataRequest request,
+                         client::CancellationContext /*context*/)
+                         -> write::PublishDataResponse {
+        {
+          // Hold the request until the other ones are in flight.
+          std::unique_lock<std::mutex> lock(mutex);
+          max_in_flight = std::max(max_in_flight, ++in_flight);
+          started.notify_all();
+          started.wait_for(lock, std::chrono::seconds(1),
+                           [&] { return max_in_flight == kConcurrency; });
+          --in_flight;
+        }
+
+        if (request.GetTraceId().get() == "5") {
+          return client::ApiError(client::ErrorCode::ServiceUnavailable,
+                                  "Service unavailable");
+        }
+
+        write::PublishDataResult result;
+        result.SetTraceID(request.GetTraceId().get());
+        return write::PublishDataResponse{result};
+      });
+
+  EXPECT_CALL(*client, PublishDataTask(_, _)).Times(kRequestsCount);
+
+  for (size_t i = 0; i < kRequestsCount; ++i) {
+    EXPECT_FALSE(client->Queue(CreateQueueRequest(std::to_string(i))));
+  }
+
+  auto response = client->Flush(model::FlushRequest()).GetFuture().get();
+  EXPECT_EQ(max_in_flight, kConcurrency);
+  EXPECT_EQ(client->QueueSize(), 0u);
+
+  // The responses are in the queue order, the failed request is reported and
+  // not queued back.
+  ASSERT_EQ(response.size(), kRequestsCount);
+  for (size_t i = 0; i < kRequestsCount; ++i) {
+    if (i == 5) {
+      ASSERT_FALSE(response[i].IsSuccessful());
+      EXPECT_EQ(response[i].GetError().GetErrorCode(),
+                client::ErrorCode::ServiceUnavailable);
+    } else {
+      ASSERT_TRUE(response[i].IsSuccessful());
+      EXPECT_EQ(response[i].GetResult().GetTraceID(), std::to_string(i));
+    }
+  }
+}
+
+TEST_F(StreamLayerClientImplTest, FlushKeepsBatchQueued) {
+  settings_.cache =
+      olp::client::OlpClientSettingsFactory::CreateDefaultCache({});
+
+  auto client = std::make_shared<MockStreamLayerClientImpl>(
+      kHrn, write::StreamLayerClientSettings{}, settings_);
+
+  // The requests are removed from the queue only after they are published.
+  ON_CALL(*client, PublishDataTask(_, _))
+      .WillByDefault([&](model::PublishDataRequest request,
+                         client::CancellationContext /*context*/)
+                         -> write::PublishDataResponse {
+        EXPECT_EQ(client->QueueSize(), 3u);
+
+        write::PublishDataResult result;
+        result.SetTraceID(request.GetTraceId().get());
+        return write::PublishDataResponse{result};
+      });
+
+  EXPECT_CALL(*client, PublishDataTask(_, _)).Times(3);
+
+  for (const auto trace_id : {"0", "1", "2"}) {
+    EXPECT_FALSE(client->Queue(CreateQueueRequest(trace_id)));
+  }
+
+  auto response = client->Flush(model::FlushRequest()).GetFuture().get();
+  ASSERT_EQ(response.size(), 3u);
+  EXPECT_EQ(client->QueueSize(), 0u);
+
+  // The next requests are queued after the flushed ones.
+  EXPECT_FALSE(client->Queue(CreateQueueRequest("3")));
+  const auto requests = client->PeekQueue(2).requests;
+  ASSERT_EQ(requests.size(), 1u);
+  EXPECT_EQ(requests[0].GetTraceId().get(), "3");
+}
+
+TEST_F(StreamLayerClientImplTest, CancelFlush) {
+  settings_.cache =
+      olp::client::OlpClientSettingsFactory::CreateDefaultCache({});
+
+  auto client = std::make_shared<MockStreamLayerClientImpl>(
+      kHrn, write::StreamLayerClientSettings{}, settings_);
+
+  std::promise<void> publish_started;
+  std::promise<void> flush_cancelled;
+  auto flush_cancelled_future = flush_cancelled.get_future();
+
+  ON_CALL(*client, PublishDataTask(_, _))
+      .WillByDefault([&](model::PublishDataRequest request,
+                         client::CancellationContext /*context*/)
+                         -> write::PublishDataResponse {
+        if (request.GetTraceId().get() == "1") {
+          publish_started.set_value();
+          flush_cancelled_future.wait();
+          return client::ApiError::Cancelled();
+        }
+
+        write::PublishDataResult result;
+        result.SetTraceID(request.GetTraceId().get());
+        return write::PublishDataResponse{result};
+      });
+
+  EXPECT_CALL(*client, PublishDataTask(_, _)).Times(2);
+
+  for (const auto trace_id : {"0", "1", "2", "3"}) {
+    EXPECT_FALSE(client->Queue(CreateQueueRequest(trace_id)));
+  }
+
+  auto future = client->Flush(model::FlushRequest());
+  publish_started.get_future().wait();
+  future.GetCancellationToken().Cancel();
+  flush_cancelled.set_value();
+
+  // The cancelled request is queued back in front of the ones not started.
+  auto response = future.GetFuture().get();
+  ASSERT_EQ(response.size(), 2u);
+  EXPECT_TRUE(response[0].IsSuccessful());
+  EXPECT_FALSE(response[1].IsSuccessful());
+  EXPECT_EQ(client->QueueSize(), 3u);
+
+  const auto requests = client->PeekQueue(4).requests;
+  ASSERT_EQ(requests.size(), 3u);
+  EXPECT_EQ(requests[0].GetTraceId().get(), "1");
+  EXPECT_EQ(requests[1].GetTraceId().get(), "2");
+  EXPECT_EQ(requests[2].GetTraceId().get(), "3");
+}
+
 }  // namespace
@@ -114,7 +114,7 @@ NetworkCallback ReturnHttpResponse(http::NetworkResponse response,
   return [=](http::NetworkRequest, http::Network::Payload payload,
              http::Network::Callback callback,
              http::Network::HeaderCallback header_callback,
-             http::Network::DataCallback) mutable {
+             http::Network::DataCallback data_callback) mutable {
     std::thread([=]() {
       std::this_thread::sleep_for(delay);
 
@@ -122,6 +122,12 @@ NetworkCallback ReturnHttpResponse(http::NetworkResponse response,
         header_callback(header.first, header.second);
       }
 
+      if (data_callback && !response_body.empty()) {
+        data_callback(
+            reinterpret_cast<const std::uint8_t*>(response_body.data()), 0,
+            response_body.size());
+      }
+
       payload->seekp(0, std::ios_base::end);
       payload->write(response_body.c_str(), response_body.size());
       payload->seekp(0);
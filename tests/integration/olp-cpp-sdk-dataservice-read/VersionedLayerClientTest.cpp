@@ -20,6 +20,7 @@
 #include <gmock/gmock.h>
 
 #include <algorithm>
+#include <atomic>
 #include <chrono>
 #include <memory>
 #include <numeric>
@@ -34,6 +35,7 @@
 #include <olp/core/cache/KeyValueCache.h>
 #include <olp/core/client/OlpClientSettings.h>
 #include <olp/core/client/OlpClientSettingsFactory.h>
+#include <olp/core/http/NetworkConstants.h>
 #include <olp/core/porting/warning_disable.h>
 #include <olp/core/utils/Dir.h>
 #include <olp/dataservice/read/VersionedLayerClient.h>
@@ -297,6 +299,129 @@ TEST_F(DataserviceReadVersionedLayerClientTest, GetDataFromPartitionAsync) {
   ASSERT_NE(response.GetResult()->size(), 0u);
 }
 
+TEST_F(DataserviceReadVersionedLayerClientTest, GetDataInRanges) {
+  // Large enough for two concurrent ranges.
+  const auto data_size = 8u * 1024u * 1024u;
+  std::string data(data_size, '\0');
+  for (size_t idx = 0; idx < data.size(); ++idx) {
+    data[idx] = static_cast<char>('a' + idx % 26);
+  }
+
+  const std::string partition_response =
+      R"jsonString({ "partitions": [{"version":4,"partition":"269","layer":"testlayer","dataHandle":"4eed6ed1-0d32-43b9-ae79-043cb4256432","dataSize":)jsonString" +
+      std::to_string(data_size) + "}]}";
+
+  // The partition is requested with its data size.
+  EXPECT_CALL(*network_mock_,
+              Send(IsGetRequest(URL_QUERY_PARTITION_269), _, _, _, _))
+      .WillOnce(ReturnHttpResponse(GetResponse(http::HttpStatusCode::OK),
+                                   partition_response));
+
+  std::atomic<http::RequestId> request_id{10u};
+  EXPECT_CALL(*network_mock_, Send(IsGetRequest(URL_BLOB_DATA_269), _, _, _, _))
+      .Times(2)
+      .WillRepeatedly([&](http::NetworkRequest request,
+                          http::Network::Payload payload,
+                          http::Network::Callback callback,
+                          http::Network::HeaderCallback header_callback,
+                          http::Network::DataCallback /*data_callback*/) {
+        std::string range;
+        for (const auto& header : request.GetHeaders()) {
+          if (header.first == http::kRangeHeader) {
+            range = header.second;
+          }
+        }
+        EXPECT_EQ(range.rfind("bytes=", 0), 0u);
+
+        const auto begin = std::stoull(range.substr(6));
+        const auto end = std::stoull(range.substr(range.find('-') + 1));
+        const auto id = request_id++;
+        const auto bytes = data.data();
+
+        std::thread([=]() {
+          header_callback(http::kContentRangeHeader,
+                          "bytes " + range.substr(6) + "/" +
+                              std::to_string(data_size));
+          payload->write(bytes + begin, end - begin + 1);
+          callback(http::NetworkResponse()
+                       .WithRequestId(id)
+                       .WithStatus(http::HttpStatusCode::PARTIAL_CONTENT));
+        })
+            .detach();
+        return http::SendOutcome(id);
+      });
+
+  read::VersionedLayerClient client(kCatalog, kTestLayer, 4, settings_);
+
+  std::promise<DataResponse> promise;
+  client.GetData(read::DataRequest()
+                     .WithPartitionId(kTestPartition)
+                     .WithFetchOption(FetchOptions::OnlineOnly),
+                 [&](DataResponse response) {
+                   promise.set_value(std::move(response));
+                 });
+
+  auto future = promise.get_future();
+  ASSERT_NE(future.wait_for(kWaitTimeout), std::future_status::timeout);
+  auto response = future.get();
+
+  ASSERT_TRUE(response.IsSuccessful()) << ApiErrorToString(response.GetError());
+  ASSERT_NE(response.GetResult(), nullptr);
+  ASSERT_EQ(response.GetResult()->size(), data.size());
+  EXPECT_TRUE(std::equal(data.begin(), data.end(),
+                         response.GetResult()->begin()));
+}
+
+TEST_F(DataserviceReadVersionedLayerClientTest, GetDataCompressedNotInRanges) {
+  // Large enough for two concurrent ranges, if it was not compressed.
+  const auto data_size = 8u * 1024u * 1024u;
+  const std::string data(data_size, 'z');
+
+  const std::string partition_response =
+      R"jsonString({ "partitions": [{"version":4,"partition":"269","layer":"testlayer","dataHandle":"4eed6ed1-0d32-43b9-ae79-043cb4256432","dataSize":)jsonString" +
+      std::to_string(data_size) + R"jsonString(,"compressedDataSize":1024}]})jsonString";
+
+  EXPECT_CALL(*network_mock_,
+              Send(IsGetRequest(URL_QUERY_PARTITION_269), _, _, _, _))
+      .WillOnce(ReturnHttpResponse(GetResponse(http::HttpStatusCode::OK),
+                                   partition_response));
+
+  // The compressed blob is downloaded with a single request.
+  EXPECT_CALL(*network_mock_, Send(IsGetRequest(URL_BLOB_DATA_269), _, _, _, _))
+      .WillOnce([&](http::NetworkRequest request,
+                    http::Network::Payload payload,
+                    http::Network::Callback callback,
+                    http::Network::HeaderCallback /*header_callback*/,
+                    http::Network::DataCallback /*data_callback*/) {
+        for (const auto& header : request.GetHeaders()) {
+          EXPECT_NE(header.first, http::kRangeHeader);
+        }
+
+        payload->write(data.data(), data.size());
+        callback(http::NetworkResponse().WithRequestId(10u).WithStatus(
+            http::HttpStatusCode::OK));
+        return http::SendOutcome(10u);
+      });
+
+  read::VersionedLayerClient client(kCatalog, kTestLayer, 4, settings_);
+
+  std::promise<DataResponse> promise;
+  client.GetData(read::DataRequest()
+                     .WithPartitionId(kTestPartition)
+                     .WithFetchOption(FetchOptions::OnlineOnly),
+                 [&](DataResponse response) {
+                   promise.set_value(std::move(response));
+                 });
+
+  auto future = promise.get_future();
+  ASSERT_NE(future.wait_for(kWaitTimeout), std::future_status::timeout);
+  auto response = future.get();
+
+  ASSERT_TRUE(response.IsSuccessful()) << ApiErrorToString(response.GetError());
+  ASSERT_NE(response.GetResult(), nullptr);
+  EXPECT_EQ(response.GetResult()->size(), data.size());
+}
+
 template <typename T>
 std::function<void(T)> placeholder(std::promise<T>& promise) {
   return [&promise](T result) { promise.set_value(result); };
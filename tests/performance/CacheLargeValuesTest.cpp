@@ -0,0 +1,210 @@
+/*
+ * Copyright (C) 2021 HERE Europe B.V.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ * License-Filename: LICENSE
+ */
+
+#include <chrono>
+#include <cinttypes>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+#include <olp/core/cache/CacheSettings.h>
+#include <olp/core/cache/DefaultCache.h>
+#include <olp/core/logging/Log.h>
+#include <olp/core/utils/Dir.h>
+
+namespace {
+struct TestConfiguration {
+  std::string configuration_name;
+  // 0 keeps all values in the database.
+  std::size_t large_value_threshold{0u};
+  std::uint32_t value_count{512};
+  std::uint32_t value_size{512 * 1024};
+  std::uint64_t max_disk_storage{64ull * 1024ull * 1024ull};
+};
+
+std::ostream& operator<<(std::ostream& os, const TestConfiguration& config) {
+  return os << "TestConfiguration("
+            << ".configuration_name=" << config.configuration_name
+            << ", .large_value_threshold=" << config.large_value_threshold
+            << ", .value_count=" << config.value_count
+            << ", .value_size=" << config.value_size
+            << ", .max_disk_storage=" << config.max_disk_storage << ")";
+}
+
+constexpr auto kLogTag = "CacheLargeValuesTest";
+const auto kCachePath =
+    olp::utils::Dir::TempDirectory() + "/cache_large_values_test";
+
+std::string CreateKey(std::uint32_t index) {
+  return "hrn:here:data::olp-here-test:testhrn::layer::" +
+         std::to_string(index) + "::Data";
+}
+
+std::int64_t ElapsedMicroseconds(std::chrono::steady_clock::time_point start) {
+  return std::chrono::duration_cast<std::chrono::microseconds>(
+             std::chrono::steady_clock::now() - start)
+      .count();
+}
+
+class CacheLargeValuesTest
+    : public ::testing::TestWithParam<TestConfiguration> {
+ public:
+  void SetUp() override { olp::utils::Dir::Remove(kCachePath); }
+  void TearDown() override { olp::utils::Dir::Remove(kCachePath); }
+};
+
+/*
+ * Writes large values until the cache is evicted several times, then compacts
+ * the cache. Reports the write throughput and the compaction time, compare the
+ * runs with and without the value log.
+ */
+TEST_P(CacheLargeValuesTest, WriteAndCompact) {
+  olp::logging::Log::setLevel(olp::logging::Level::Warning);
+
+  const auto& parameter = GetParam();
+
+  olp::cache::CacheSettings settings;
+  settings.disk_path_mutable = kCachePath;
+  settings.max_memory_cache_size = 0u;
+  settings.max_disk_storage = parameter.max_disk_storage;
+  settings.large_value_threshold = parameter.large_value_threshold;
+  // Measure the storage layout, not fsync.
+  settings.enforce_immediate_flush = false;
+
+  olp::cache::DefaultCache cache(settings);
+  ASSERT_EQ(cache.Open(), olp::cache::DefaultCache::Success);
+
+  const auto value = std::make_shared<olp::cache::KeyValueCache::ValueType>(
+      parameter.value_size, 'x');
+
+  const auto write_start = std::chrono::steady_clock::now();
+  for (std::uint32_t index = 0; index < parameter.value_count; ++index) {
+    // Vary the content, so the compression does not hide the data size.
+    (*value)[index % value->size()] = static_cast<unsigned char>(index);
+    ASSERT_TRUE(cache.Put(CreateKey(index), value,
+                          olp::cache::KeyValueCache::kDefaultExpiry));
+  }
+  const auto write_time = ElapsedMicroseconds(write_start);
+
+  const auto compact_start = std::chrono::steady_clock::now();
+  cache.Compact();
+  const auto compact_time = ElapsedMicroseconds(compact_start);
+
+  const auto written = static_cast<std::uint64_t>(parameter.value_count) *
+                       parameter.value_size;
+  const auto megabytes_per_second =
+      write_time > 0 ? written / static_cast<std::uint64_t>(write_time) : 0u;
+
+  OLP_SDK_LOG_CRITICAL_INFO_F(
+      kLogTag,
+      "%s: written=%" PRIu64 " bytes, write time=%" PRId64
+      " us, MB/sec=%" PRIu64 ", compaction time=%" PRId64
+      " us, size on disk=%" PRIu64,
+      parameter.configuration_name.c_str(), written, write_time,
+      megabytes_per_second, compact_time, olp::utils::Dir::Size(kCachePath));
+
+  EXPECT_TRUE(cache.Get(CreateKey(parameter.value_count - 1)));
+  cache.Close();
+}
+
+/*
+ * Reads the values of a cache which holds all of them with `Get(key)`, the
+ * memory cache is disabled. Reports the read throughput, compare the runs with
+ * and without the value log.
+ */
+TEST_P(CacheLargeValuesTest, Read) {
+  olp::logging::Log::setLevel(olp::logging::Level::Warning);
+
+  const auto& parameter = GetParam();
+  constexpr auto kReadRounds = 4u;
+
+  olp::cache::CacheSettings settings;
+  settings.disk_path_mutable = kCachePath;
+  settings.max_memory_cache_size = 0u;
+  settings.max_disk_storage = parameter.max_disk_storage;
+  settings.large_value_threshold = parameter.large_value_threshold;
+  settings.enforce_immediate_flush = false;
+
+  olp::cache::DefaultCache cache(settings);
+  ASSERT_EQ(cache.Open(), olp::cache::DefaultCache::Success);
+
+  // Half of the cache size, so nothing is evicted.
+  const auto value_count = static_cast<std::uint32_t>(
+      parameter.max_disk_storage / 2u / parameter.value_size);
+  const auto value = std::make_shared<olp::cache::KeyValueCache::ValueType>(
+      parameter.value_size, 'x');
+  for (std::uint32_t index = 0; index < value_count; ++index) {
+    (*value)[index % value->size()] = static_cast<unsigned char>(index);
+    ASSERT_TRUE(cache.Put(CreateKey(index), value,
+                          olp::cache::KeyValueCache::kDefaultExpiry));
+  }
+
+  std::uint64_t read = 0u;
+  const auto read_start = std::chrono::steady_clock::now();
+  for (auto round = 0u; round < kReadRounds; ++round) {
+    for (std::uint32_t index = 0; index < value_count; ++index) {
+      const auto result = cache.Get(CreateKey(index));
+      ASSERT_TRUE(result);
+      read += result->size();
+    }
+  }
+  const auto read_time = ElapsedMicroseconds(read_start);
+
+  const auto megabytes_per_second =
+      read_time > 0 ? read / static_cast<std::uint64_t>(read_time) : 0u;
+
+  OLP_SDK_LOG_CRITICAL_INFO_F(
+      kLogTag,
+      "%s: read=%" PRIu64 " bytes, read time=%" PRId64 " us, MB/sec=%" PRIu64,
+      parameter.configuration_name.c_str(), read, read_time,
+      megabytes_per_second);
+
+  EXPECT_EQ(read, std::uint64_t{kReadRounds} * value_count *
+                      parameter.value_size);
+  cache.Close();
+}
+
+std::vector<TestConfiguration> Configurations() {
+  std::vector<TestConfiguration> configurations;
+  for (std::uint32_t value_size : {64 * 1024, 512 * 1024, 2 * 1024 * 1024}) {
+    for (auto with_value_log : {false, true}) {
+      TestConfiguration configuration;
+      configuration.value_size = value_size;
+      // Write four times the cache size.
+      configuration.value_count = static_cast<std::uint32_t>(
+          configuration.max_disk_storage * 4u / value_size);
+      configuration.large_value_threshold =
+          with_value_log ? 32u * 1024u : 0u;
+      configuration.configuration_name =
+          std::string(with_value_log ? "value_log" : "database") + "_" +
+          std::to_string(value_size / 1024) + "KB";
+      configurations.emplace_back(std::move(configuration));
+    }
+  }
+  return configurations;
+}
+
+std::string TestName(const testing::TestParamInfo<TestConfiguration>& info) {
+  return info.param.configuration_name;
+}
+
+INSTANTIATE_TEST_SUITE_P(LargeValues, CacheLargeValuesTest,
+                         ::testing::ValuesIn(Configurations()), TestName);
+}  // namespace
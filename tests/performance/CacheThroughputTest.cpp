@@ -0,0 +1,185 @@
+/*
+ * Copyright (C) 2021 HERE Europe B.V.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ * License-Filename: LICENSE
+ */
+
+#include <atomic>
+#include <chrono>
+#include <cinttypes>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>
+#include <olp/core/cache/CacheSettings.h>
+#include <olp/core/cache/DefaultCache.h>
+#include <olp/core/logging/Log.h>
+#include <olp/core/utils/Dir.h>
+
+namespace {
+struct TestConfiguration {
+  std::string configuration_name;
+  bool with_disk_cache{false};
+  std::uint8_t calling_thread_count{1};
+  std::uint32_t operations_per_thread{20000};
+  std::uint32_t key_count{1024};
+  std::uint32_t value_size{4 * 1024};
+  // Every Nth operation is a Put, the rest are Get.
+  std::uint32_t put_every{10};
+};
+
+std::ostream& operator<<(std::ostream& os, const TestConfiguration& config) {
+  return os << "TestConfiguration("
+            << ".configuration_name=" << config.configuration_name
+            << ", .with_disk_cache=" << config.with_disk_cache
+            << ", .calling_thread_count="
+            << static_cast<int>(config.calling_thread_count)
+            << ", .operations_per_thread=" << config.operations_per_thread
+            << ", .key_count=" << config.key_count
+            << ", .value_size=" << config.value_size << ")";
+}
+
+constexpr auto kLogTag = "CacheThroughputTest";
+const auto kCachePath =
+    olp::utils::Dir::TempDirectory() + "/cache_throughput_test";
+
+std::string CreateKey(std::uint32_t index) {
+  return "hrn:here:data::olp-here-test:testhrn::layer::" +
+         std::to_string(index) + "::Data";
+}
+
+class CacheThroughputTest
+    : public ::testing::TestWithParam<TestConfiguration> {
+ public:
+  void SetUp() override {
+    const auto& parameter = GetParam();
+
+    olp::cache::CacheSettings settings;
+    // Keep all keys in memory for memory only runs, and force disk reads for
+    // the disk runs.
+    settings.max_memory_cache_size =
+        parameter.with_disk_cache
+            ? 0u
+            : parameter.key_count * parameter.value_size * 2u;
+    if (parameter.with_disk_cache) {
+      olp::utils::Dir::Remove(kCachePath);
+      settings.disk_path_mutable = kCachePath;
+      settings.max_disk_storage = 1024ull * 1024ull * 1024ull;
+      // Measure the locking, not fsync.
+      settings.enforce_immediate_flush = false;
+    }
+
+    cache_ = std::make_shared<olp::cache::DefaultCache>(settings);
+    ASSERT_EQ(cache_->Open(), olp::cache::DefaultCache::Success);
+
+    const auto value = std::make_shared<olp::cache::KeyValueCache::ValueType>(
+        parameter.value_size, 'x');
+    for (std::uint32_t index = 0; index < parameter.key_count; ++index) {
+      ASSERT_TRUE(cache_->Put(CreateKey(index), value,
+                              olp::cache::KeyValueCache::kDefaultExpiry));
+    }
+  }
+
+  void TearDown() override {
+    cache_->Close();
+    cache_.reset();
+    olp::utils::Dir::Remove(kCachePath);
+  }
+
+ protected:
+  std::shared_ptr<olp::cache::DefaultCache> cache_;
+};
+
+/*
+ * Runs a mixed Get/Put workload from N threads and reports the total number
+ * of operations per second. Compare the runs with different thread count to
+ * get the scaling curve.
+ */
+TEST_P(CacheThroughputTest, MixedGetPut) {
+  olp::logging::Log::setLevel(olp::logging::Level::Warning);
+
+  const auto& parameter = GetParam();
+  const auto value = std::make_shared<olp::cache::KeyValueCache::ValueType>(
+      parameter.value_size, 'y');
+
+  std::atomic_size_t misses{0};
+  std::vector<std::thread> threads;
+
+  const auto start = std::chrono::steady_clock::now();
+
+  for (std::uint8_t thread_id = 0; thread_id < parameter.calling_thread_count;
+       ++thread_id) {
+    threads.emplace_back([&, thread_id]() {
+      std::uint32_t index = thread_id * 7919u;
+      for (std::uint32_t op = 0; op < parameter.operations_per_thread; ++op) {
+        index = (index + 104729u) % parameter.key_count;
+        const auto key = CreateKey(index);
+        if (op % parameter.put_every == 0) {
+          cache_->Put(key, value, olp::cache::KeyValueCache::kDefaultExpiry);
+        } else if (!cache_->Get(key)) {
+          misses.fetch_add(1);
+        }
+      }
+    });
+  }
+
+  for (auto& thread : threads) {
+    thread.join();
+  }
+
+  const auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(
+                           std::chrono::steady_clock::now() - start)
+                           .count();
+  const auto total_operations = static_cast<std::uint64_t>(
+      parameter.operations_per_thread * parameter.calling_thread_count);
+  const auto operations_per_second =
+      elapsed > 0 ? total_operations * 1000000u / elapsed : total_operations;
+
+  OLP_SDK_LOG_CRITICAL_INFO_F(
+      kLogTag, "%s: threads=%d, operations=%" PRIu64 ", time=%" PRId64
+      " us, ops/sec=%" PRIu64,
+      parameter.configuration_name.c_str(),
+      static_cast<int>(parameter.calling_thread_count), total_operations,
+      static_cast<std::int64_t>(elapsed), operations_per_second);
+
+  EXPECT_EQ(misses.load(), 0u);
+}
+
+std::vector<TestConfiguration> Configurations() {
+  std::vector<TestConfiguration> configurations;
+  for (auto with_disk_cache : {false, true}) {
+    for (std::uint8_t threads : {1, 2, 4, 8, 16, 32}) {
+      TestConfiguration configuration;
+      configuration.with_disk_cache = with_disk_cache;
+      configuration.calling_thread_count = threads;
+      configuration.configuration_name =
+          std::string(with_disk_cache ? "disk" : "memory") + "_" +
+          std::to_string(threads) + "_threads";
+      configurations.emplace_back(std::move(configuration));
+    }
+  }
+  return configurations;
+}
+
+std::string TestName(const testing::TestParamInfo<TestConfiguration>& info) {
+  return info.param.configuration_name;
+}
+
+INSTANTIATE_TEST_SUITE_P(Throughput, CacheThroughputTest,
+                         ::testing::ValuesIn(Configurations()), TestName);
+}  // namespace
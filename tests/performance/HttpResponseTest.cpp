@@ -0,0 +1,181 @@
+/*
+ * Copyright (C) 2021 HERE Europe B.V.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ * License-Filename: LICENSE
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cinttypes>
+#include <cstdlib>
+#include <new>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+#include <olp/core/client/OlpClient.h>
+#include <olp/core/client/OlpClientSettings.h>
+#include <olp/core/http/HttpStatusCode.h>
+#include <olp/core/http/Network.h>
+#include <olp/core/logging/Log.h>
+
+namespace {
+// Counts the bytes allocated by the large allocations, each of them is filled
+// by a copy of the body or of its part. The global operator new is replaced,
+// so the test is built into its own executable.
+std::atomic<bool> g_count_allocations{false};
+std::atomic<std::uint64_t> g_allocated_bytes{0u};
+constexpr std::size_t kMinCountedAllocation = 4096u;
+}  // namespace
+
+void* operator new(std::size_t size) {
+  if (size >= kMinCountedAllocation && g_count_allocations.load()) {
+    g_allocated_bytes += size;
+  }
+  if (void* ptr = std::malloc(size == 0u ? 1u : size)) {
+    return ptr;
+  }
+  throw std::bad_alloc();
+}
+
+void operator delete(void* ptr) noexcept { std::free(ptr); }
+
+void operator delete(void* ptr, std::size_t) noexcept { std::free(ptr); }
+
+namespace {
+struct TestConfiguration {
+  std::string configuration_name;
+  bool buffer_response{false};
+  std::size_t body_size{1024u * 1024u};
+};
+
+std::ostream& operator<<(std::ostream& os, const TestConfiguration& config) {
+  return os << "TestConfiguration("
+            << ".configuration_name=" << config.configuration_name
+            << ", .buffer_response=" << config.buffer_response
+            << ", .body_size=" << config.body_size << ")";
+}
+
+constexpr auto kLogTag = "HttpResponseTest";
+constexpr std::uint32_t kRequestCount = 50u;
+// The size of the chunks the network writes the body in, like libcurl does.
+constexpr std::size_t kChunkSize = 16u * 1024u;
+
+/// Serves the body from memory, so only the body handling is measured.
+class InMemoryNetwork : public olp::http::Network {
+ public:
+  explicit InMemoryNetwork(std::size_t body_size) : body_(body_size, 'x') {}
+
+  olp::http::SendOutcome Send(olp::http::NetworkRequest /*request*/,
+                              Payload payload, Callback callback,
+                              HeaderCallback header_callback,
+                              DataCallback /*data_callback*/) override {
+    const auto id = ++request_id_;
+    header_callback("Content-Length", std::to_string(body_.size()));
+    for (std::size_t offset = 0; offset < body_.size(); offset += kChunkSize) {
+      payload->write(body_.data() + offset,
+                     std::min(kChunkSize, body_.size() - offset));
+    }
+    callback(olp::http::NetworkResponse()
+                 .WithRequestId(id)
+                 .WithStatus(olp::http::HttpStatusCode::OK));
+    return olp::http::SendOutcome(id);
+  }
+
+  void Cancel(olp::http::RequestId /*id*/) override {}
+
+ private:
+  const std::string body_;
+  olp::http::RequestId request_id_{0u};
+};
+
+class HttpResponseTest : public ::testing::TestWithParam<TestConfiguration> {};
+
+/*
+ * Compares the body collected into the std::stringstream and copied out with
+ * the body collected into the contiguous buffer and moved out, the way the
+ * blobs are fetched by GetData. Reports the time and the bytes allocated per
+ * request relative to the body size.
+ */
+TEST_P(HttpResponseTest, GetBody) {
+  olp::logging::Log::setLevel(olp::logging::Level::Warning);
+  const auto& parameter = GetParam();
+
+  olp::client::OlpClientSettings settings;
+  settings.network_request_handler =
+      std::make_shared<InMemoryNetwork>(parameter.body_size);
+  olp::client::OlpClient client(settings, "https://localhost");
+
+  std::int64_t total_time = 0;
+  g_allocated_bytes = 0u;
+
+  for (std::uint32_t i = 0; i < kRequestCount; ++i) {
+    const auto start = std::chrono::steady_clock::now();
+    g_count_allocations = true;
+
+    auto response = client.CallApi("/data", "GET", {}, {}, {}, nullptr, "", {},
+                                   parameter.buffer_response);
+    ASSERT_EQ(response.GetStatus(), olp::http::HttpStatusCode::OK);
+
+    std::shared_ptr<std::vector<unsigned char>> data;
+    if (parameter.buffer_response) {
+      data = response.MoveResponseData();
+    } else {
+      data = std::make_shared<std::vector<unsigned char>>();
+      response.GetResponse(*data);
+    }
+
+    g_count_allocations = false;
+    total_time += std::chrono::duration_cast<std::chrono::microseconds>(
+                      std::chrono::steady_clock::now() - start)
+                      .count();
+    ASSERT_EQ(data->size(), parameter.body_size);
+  }
+
+  const auto allocated_per_request = g_allocated_bytes / kRequestCount;
+  OLP_SDK_LOG_CRITICAL_INFO_F(
+      kLogTag,
+      "%s: body=%zu bytes, time=%" PRId64 " us/request, allocated=%" PRIu64
+      " bytes/request (%.2f x body)",
+      parameter.configuration_name.c_str(), parameter.body_size,
+      total_time / kRequestCount, allocated_per_request,
+      static_cast<double>(allocated_per_request) / parameter.body_size);
+}
+
+std::vector<TestConfiguration> Configurations() {
+  std::vector<TestConfiguration> configurations;
+  for (std::size_t size_mb : {1u, 4u, 16u, 64u}) {
+    for (auto buffer_response : {false, true}) {
+      TestConfiguration configuration;
+      configuration.buffer_response = buffer_response;
+      configuration.body_size = size_mb * 1024u * 1024u;
+      configuration.configuration_name =
+          std::string(buffer_response ? "buffer" : "stream") + "_" +
+          std::to_string(size_mb) + "MB";
+      configurations.emplace_back(std::move(configuration));
+    }
+  }
+  return configurations;
+}
+
+std::string TestName(const testing::TestParamInfo<TestConfiguration>& info) {
+  return info.param.configuration_name;
+}
+
+INSTANTIATE_TEST_SUITE_P(HttpResponse, HttpResponseTest,
+                         ::testing::ValuesIn(Configurations()), TestName);
+}  // namespace
@@ -0,0 +1,163 @@
+/*
+ * Copyright (C) 2021 HERE Europe B.V.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ * License-Filename: LICENSE
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cinttypes>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+#include <olp/core/logging/Log.h>
+#include <olp/core/utils/HashedLruCache.h>
+#include <olp/core/utils/LruCache.h>
+
+namespace {
+struct TestConfiguration {
+  std::string configuration_name;
+  bool hashed{false};
+  std::uint32_t entry_count{10000};
+};
+
+std::ostream& operator<<(std::ostream& os, const TestConfiguration& config) {
+  return os << "TestConfiguration("
+            << ".configuration_name=" << config.configuration_name
+            << ", .hashed=" << config.hashed
+            << ", .entry_count=" << config.entry_count << ")";
+}
+
+constexpr auto kLogTag = "LruCacheTest";
+constexpr std::uint32_t kOperationCount = 1000000u;
+
+// Every entry costs 1, so the cache holds exactly `entry_count` entries.
+struct EntryCost {
+  std::size_t operator()(const std::uint64_t&) const { return 1u; }
+};
+
+std::string CreateKey(std::uint32_t index) {
+  return "hrn:here:data::olp-here-test:testhrn::layer::" +
+         std::to_string(index) + "::Data";
+}
+
+std::int64_t ElapsedNanoseconds(std::chrono::steady_clock::time_point start) {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+             std::chrono::steady_clock::now() - start)
+      .count();
+}
+
+class LruCacheTest : public ::testing::TestWithParam<TestConfiguration> {};
+
+template <typename Cache>
+void Measure(const TestConfiguration& parameter) {
+  Cache cache(parameter.entry_count);
+
+  // Keys are created upfront to measure the container only.
+  std::vector<std::string> keys;
+  keys.reserve(parameter.entry_count);
+  for (std::uint32_t index = 0; index < parameter.entry_count; ++index) {
+    keys.emplace_back(CreateKey(index));
+  }
+
+  const auto insert_start = std::chrono::steady_clock::now();
+  for (std::uint32_t index = 0; index < parameter.entry_count; ++index) {
+    cache.Insert(keys[index], index);
+  }
+  const auto insert_time = ElapsedNanoseconds(insert_start);
+
+  std::mt19937 generator(42u);
+  std::uniform_int_distribution<std::uint32_t> distribution(
+      0u, parameter.entry_count - 1u);
+  std::vector<std::uint32_t> lookups(kOperationCount);
+  std::generate(lookups.begin(), lookups.end(),
+                [&]() { return distribution(generator); });
+
+  std::uint64_t found = 0u;
+  const auto find_start = std::chrono::steady_clock::now();
+  for (const auto index : lookups) {
+    found += cache.FindNoPromote(keys[index]) != cache.end() ? 1u : 0u;
+  }
+  const auto find_time = ElapsedNanoseconds(find_start);
+
+  const auto promote_start = std::chrono::steady_clock::now();
+  for (const auto index : lookups) {
+    found += cache.Find(keys[index]) != cache.end() ? 1u : 0u;
+  }
+  const auto promote_time = ElapsedNanoseconds(promote_start);
+
+  // Every insert of a new key evicts the least recently used one.
+  const auto evict_start = std::chrono::steady_clock::now();
+  for (std::uint32_t index = 0; index < kOperationCount; ++index) {
+    cache.Insert(keys[index % parameter.entry_count] + "::new", index);
+  }
+  const auto evict_time = ElapsedNanoseconds(evict_start);
+
+  OLP_SDK_LOG_CRITICAL_INFO_F(
+      kLogTag,
+      "%s: insert=%" PRId64 " ns/op, find=%" PRId64 " ns/op, promote=%" PRId64
+      " ns/op, insert with eviction=%" PRId64 " ns/op",
+      parameter.configuration_name.c_str(),
+      insert_time / parameter.entry_count, find_time / kOperationCount,
+      promote_time / kOperationCount, evict_time / kOperationCount);
+
+  EXPECT_EQ(found, 2u * kOperationCount);
+  EXPECT_EQ(cache.Size(), parameter.entry_count);
+}
+
+/*
+ * Compares the map based LruCache with the HashedLruCache. Reports the cost of
+ * the insert, find, promote and evicting insert operations for the growing
+ * number of entries.
+ */
+TEST_P(LruCacheTest, Operations) {
+  olp::logging::Log::setLevel(olp::logging::Level::Warning);
+  const auto& parameter = GetParam();
+
+  if (parameter.hashed) {
+    Measure<olp::utils::HashedLruCache<std::string, std::uint64_t, EntryCost>>(
+        parameter);
+  } else {
+    Measure<olp::utils::LruCache<std::string, std::uint64_t, EntryCost>>(
+        parameter);
+  }
+}
+
+std::vector<TestConfiguration> Configurations() {
+  std::vector<TestConfiguration> configurations;
+  for (std::uint32_t entry_count : {10000u, 100000u, 1000000u, 10000000u}) {
+    for (auto hashed : {false, true}) {
+      TestConfiguration configuration;
+      configuration.hashed = hashed;
+      configuration.entry_count = entry_count;
+      configuration.configuration_name =
+          std::string(hashed ? "hashed" : "map") + "_" +
+          std::to_string(entry_count);
+      configurations.emplace_back(std::move(configuration));
+    }
+  }
+  return configurations;
+}
+
+std::string TestName(const testing::TestParamInfo<TestConfiguration>& info) {
+  return info.param.configuration_name;
+}
+
+INSTANTIATE_TEST_SUITE_P(LruCache, LruCacheTest,
+                         ::testing::ValuesIn(Configurations()), TestName);
+}  // namespace
@@ -0,0 +1,179 @@
+/*
+ * Copyright (C) 2021 HERE Europe B.V.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ * License-Filename: LICENSE
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cinttypes>
+#include <ctime>
+#include <future>
+#include <mutex>
+#include <numeric>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>
+#include <olp/core/http/HttpStatusCode.h>
+#include <olp/core/http/Network.h>
+#include <olp/core/http/NetworkSettings.h>
+#include <olp/core/logging/Log.h>
+
+namespace {
+struct TestConfiguration {
+  std::string configuration_name;
+  std::uint32_t calling_thread_count{1};
+  std::uint32_t requests_per_thread{2000};
+};
+
+std::ostream& operator<<(std::ostream& os, const TestConfiguration& config) {
+  return os << "TestConfiguration("
+            << ".configuration_name=" << config.configuration_name
+            << ", .calling_thread_count=" << config.calling_thread_count
+            << ", .requests_per_thread=" << config.requests_per_thread << ")";
+}
+
+constexpr auto kLogTag = "NetworkLatencyTest";
+constexpr auto kWarmUpRequestCount = 10u;
+constexpr auto kIdleTime = std::chrono::seconds(1);
+
+// A small response served by the local OLP server, see tests/utils/olp_server.
+const std::string kUrl =
+    "http://api-lookup.data.api.platform.here.com/lookup/v1/platform/apis";
+
+olp::http::NetworkSettings LocalhostSettings() {
+  return olp::http::NetworkSettings().WithProxySettings(
+      olp::http::NetworkProxySettings()
+          .WithHostname("localhost")
+          .WithPort(3000)
+          .WithType(olp::http::NetworkProxySettings::Type::HTTP));
+}
+
+class NetworkLatencyTest : public ::testing::TestWithParam<TestConfiguration> {
+ protected:
+  // Sends the requests one by one, stores the latency of every request.
+  void SendRequests(olp::http::Network& network, std::uint32_t count,
+                    std::vector<std::int64_t>* latencies) {
+    const auto request =
+        olp::http::NetworkRequest(kUrl).WithSettings(LocalhostSettings());
+
+    for (std::uint32_t i = 0; i < count; ++i) {
+      std::promise<int> promise;
+      auto future = promise.get_future();
+
+      const auto start = std::chrono::steady_clock::now();
+      const auto outcome = network.Send(
+          request, std::make_shared<std::stringstream>(),
+          [&](olp::http::NetworkResponse response) {
+            promise.set_value(response.GetStatus());
+          });
+      ASSERT_TRUE(outcome.IsSuccessful());
+      ASSERT_EQ(future.get(), olp::http::HttpStatusCode::OK);
+      const auto latency =
+          std::chrono::duration_cast<std::chrono::microseconds>(
+              std::chrono::steady_clock::now() - start)
+              .count();
+
+      if (latencies) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        latencies->push_back(latency);
+      }
+    }
+  }
+
+  std::mutex mutex_;
+};
+
+/*
+ * Measures the time from sending a request to its callback against the local
+ * server, and the CPU time the network consumes while idle.
+ */
+TEST_P(NetworkLatencyTest, SendRequests) {
+  olp::logging::Log::setLevel(olp::logging::Level::Warning);
+  const auto& parameter = GetParam();
+
+  auto network = olp::http::CreateDefaultNetwork(32);
+  ASSERT_TRUE(network);
+
+  // Initializes the network and opens the connection.
+  SendRequests(*network, kWarmUpRequestCount, nullptr);
+
+  std::vector<std::int64_t> latencies;
+  latencies.reserve(parameter.calling_thread_count *
+                    parameter.requests_per_thread);
+
+  const auto start = std::chrono::steady_clock::now();
+  std::vector<std::thread> threads;
+  for (std::uint32_t i = 0; i < parameter.calling_thread_count; ++i) {
+    threads.emplace_back([&]() {
+      SendRequests(*network, parameter.requests_per_thread, &latencies);
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  const auto total_time = std::chrono::duration_cast<std::chrono::milliseconds>(
+                              std::chrono::steady_clock::now() - start)
+                              .count();
+
+  ASSERT_FALSE(latencies.empty());
+  std::sort(latencies.begin(), latencies.end());
+  const auto average =
+      std::accumulate(latencies.begin(), latencies.end(), std::int64_t{0}) /
+      static_cast<std::int64_t>(latencies.size());
+
+  const auto idle_start = std::clock();
+  std::this_thread::sleep_for(kIdleTime);
+  const auto idle_cpu_time_ms =
+      static_cast<std::int64_t>(1000 * (std::clock() - idle_start) /
+                                CLOCKS_PER_SEC);
+
+  OLP_SDK_LOG_CRITICAL_INFO_F(
+      kLogTag,
+      "%s: requests=%zu, time=%" PRId64 " ms, average=%" PRId64
+      " us, p50=%" PRId64 " us, p99=%" PRId64 " us, idle CPU time=%" PRId64
+      " ms",
+      parameter.configuration_name.c_str(), latencies.size(),
+      static_cast<std::int64_t>(total_time), average,
+      latencies[latencies.size() / 2], latencies[latencies.size() * 99 / 100],
+      idle_cpu_time_ms);
+}
+
+std::vector<TestConfiguration> Configurations() {
+  std::vector<TestConfiguration> configurations;
+
+  TestConfiguration configuration;
+  configuration.configuration_name = "sequential";
+  configurations.emplace_back(configuration);
+
+  configuration.configuration_name = "concurrent";
+  configuration.calling_thread_count = 8;
+  configuration.requests_per_thread = 500;
+  configurations.emplace_back(configuration);
+
+  return configurations;
+}
+
+std::string TestName(const testing::TestParamInfo<TestConfiguration>& info) {
+  return info.param.configuration_name;
+}
+
+INSTANTIATE_TEST_SUITE_P(Network, NetworkLatencyTest,
+                         ::testing::ValuesIn(Configurations()), TestName);
+}  // namespace
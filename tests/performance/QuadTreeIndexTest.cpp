@@ -0,0 +1,130 @@
+/*
+ * Copyright (C) 2021 HERE Europe B.V.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ * License-Filename: LICENSE
+ */
+
+#include <chrono>
+#include <cinttypes>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+#include <olp/core/geo/tiling/TileKey.h>
+#include <olp/core/logging/Log.h>
+#include "repositories/QuadTreeIndex.h"
+
+namespace {
+namespace read = olp::dataservice::read;
+namespace geo = olp::geo;
+
+constexpr auto kLogTag = "QuadTreeIndexTest";
+constexpr auto kDepth = 4u;
+constexpr auto kIterations = 2000u;
+
+std::int64_t ElapsedNanoseconds(std::chrono::steady_clock::time_point start) {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+             std::chrono::steady_clock::now() - start)
+      .count();
+}
+
+// A full tree of `kDepth` levels with the data on the even levels, and the
+// parents on the odd levels above the root.
+std::string CreateIndexJson(const geo::TileKey& root) {
+  std::ostringstream json;
+  json << R"({"subQuads": [)";
+  const char* separator = "";
+  for (auto depth = 0u; depth <= kDepth; depth += 2) {
+    const std::uint64_t first_sub = std::uint64_t{1} << (2 * depth);
+    for (auto sub = first_sub; sub < 2 * first_sub; ++sub) {
+      json << separator << R"({"subQuadKey": ")" << sub
+           << R"(", "version": 4, "dataHandle": "4eed6ed1-0d32-43b9-ae79-)"
+           << sub << R"(", "checksum": "checksum"})";
+      separator = ",";
+    }
+  }
+  json << R"(], "parentQuads": [)";
+  separator = "";
+  for (auto level = 1u; level < root.Level(); level += 2) {
+    json << separator << R"({"partition": ")"
+         << root.ChangedLevelTo(level).ToHereTile()
+         << R"(", "version": 4, "dataHandle": "parent-)" << level << R"("})";
+    separator = ",";
+  }
+  json << "]}";
+  return json.str();
+}
+
+/*
+ * Reports the cost of the exact lookups of every tile in the tree, and of the
+ * aggregated lookups of the tiles two levels below it and of the root
+ * ancestors, which resolve to the nearest parent with data.
+ */
+TEST(QuadTreeIndexTest, Find) {
+  olp::logging::Log::setLevel(olp::logging::Level::Warning);
+
+  const auto root = geo::TileKey::FromRowColumnLevel(300, 500, 10);
+  std::stringstream stream(CreateIndexJson(root));
+  read::QuadTreeIndex index(root, kDepth, stream);
+  ASSERT_FALSE(index.IsNull());
+
+  std::vector<geo::TileKey> tiles;
+  std::vector<geo::TileKey> aggregated_tiles;
+  for (auto depth = 0u; depth <= kDepth; ++depth) {
+    const auto first_key = root.ChangedLevelBy(depth).ToQuadKey64();
+    const auto count = std::uint64_t{1} << (2 * depth);
+    for (auto key = first_key; key < first_key + count; ++key) {
+      const auto tile = geo::TileKey::FromQuadKey64(key);
+      tiles.push_back(tile);
+      aggregated_tiles.push_back(tile.ChangedLevelBy(2));
+    }
+  }
+  for (auto level = 0u; level < root.Level(); ++level) {
+    aggregated_tiles.push_back(root.ChangedLevelTo(level));
+  }
+
+  std::uint64_t found = 0u;
+  const auto find_start = std::chrono::steady_clock::now();
+  for (auto i = 0u; i < kIterations; ++i) {
+    for (const auto& tile : tiles) {
+      found += index.Find(tile, false) ? 1u : 0u;
+    }
+  }
+  const auto find_time = ElapsedNanoseconds(find_start);
+
+  std::uint64_t aggregated_found = 0u;
+  const auto aggregated_start = std::chrono::steady_clock::now();
+  for (auto i = 0u; i < kIterations; ++i) {
+    for (const auto& tile : aggregated_tiles) {
+      aggregated_found += index.Find(tile, true) ? 1u : 0u;
+    }
+  }
+  const auto aggregated_time = ElapsedNanoseconds(aggregated_start);
+
+  OLP_SDK_LOG_CRITICAL_INFO_F(
+      kLogTag, "find=%" PRId64 " ns/op, aggregated find=%" PRId64 " ns/op",
+      find_time / static_cast<std::int64_t>(kIterations * tiles.size()),
+      aggregated_time /
+          static_cast<std::int64_t>(kIterations * aggregated_tiles.size()));
+
+  // The levels 1 and 3 of the tree have no data, the root ancestor on the
+  // level 0 has no parent.
+  EXPECT_EQ(found, kIterations * (1u + 16u + 256u));
+  EXPECT_EQ(aggregated_found, kIterations * (aggregated_tiles.size() - 1u));
+}
+
+}  // namespace
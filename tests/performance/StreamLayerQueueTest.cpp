@@ -0,0 +1,213 @@
+/*
+ * Copyright (C) 2021 HERE Europe B.V.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ * License-Filename: LICENSE
+ */
+
+#include <atomic>
+#include <chrono>
+#include <cinttypes>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+#include <olp/core/cache/CacheSettings.h>
+#include <olp/core/cache/DefaultCache.h>
+#include <olp/core/client/HRN.h>
+#include <olp/core/client/OlpClientSettings.h>
+#include <olp/core/http/HttpStatusCode.h>
+#include <olp/core/http/Network.h>
+#include <olp/core/logging/Log.h>
+#include <olp/core/utils/Dir.h>
+#include <olp/dataservice/write/StreamLayerClient.h>
+#include <olp/dataservice/write/model/PublishDataRequest.h>
+
+namespace {
+struct TestConfiguration {
+  std::string configuration_name;
+  bool with_disk_cache{false};
+  std::uint32_t request_count{100000};
+  std::uint32_t data_size{256};
+};
+
+std::ostream& operator<<(std::ostream& os, const TestConfiguration& config) {
+  return os << "TestConfiguration("
+            << ".configuration_name=" << config.configuration_name
+            << ", .with_disk_cache=" << config.with_disk_cache
+            << ", .request_count=" << config.request_count
+            << ", .data_size=" << config.data_size << ")";
+}
+
+constexpr auto kLogTag = "StreamLayerQueueTest";
+constexpr auto kLayer = "layer";
+const auto kCachePath =
+    olp::utils::Dir::TempDirectory() + "/stream_layer_queue_test";
+const std::string kCatalog = "hrn:here:data::olp-here-test:catalog";
+const std::string kConfigUrl = "https://config.local/config/v1";
+const std::string kIngestUrl =
+    "https://ingest.local/ingest/v1/catalogs/" + kCatalog;
+
+/*
+ * Answers the lookup, config and ingest requests in process, so only the
+ * client and its queue are measured.
+ */
+class IngestNetwork : public olp::http::Network {
+ public:
+  olp::http::SendOutcome Send(olp::http::NetworkRequest request,
+                              Payload payload, Callback callback,
+                              HeaderCallback /*header_callback*/,
+                              DataCallback /*data_callback*/) override {
+    const auto& url = request.GetUrl();
+    std::string body;
+    if (url.find("/apis/config/v1") != std::string::npos) {
+      body = R"([{"api":"config","version":"v1","baseURL":")" + kConfigUrl +
+             R"(","parameters":{}}])";
+    } else if (url.find("/apis/ingest/v1") != std::string::npos) {
+      body = R"([{"api":"ingest","version":"v1","baseURL":")" + kIngestUrl +
+             R"(","parameters":{}}])";
+    } else if (url.find(kConfigUrl) == 0) {
+      body = R"({"id":"catalog","hrn":")" + kCatalog +
+             R"(","layers":[{"id":"layer","hrn":")" + kCatalog +
+             R"(:layer","contentType":"text/plain","layerType":"stream"}],)"
+             R"("version":1})";
+    } else {
+      body = R"({"TraceID":"trace"})";
+    }
+
+    const auto id = ++request_id_;
+    payload->write(body.data(), body.size());
+    callback(olp::http::NetworkResponse()
+                 .WithRequestId(id)
+                 .WithStatus(olp::http::HttpStatusCode::OK));
+    return olp::http::SendOutcome(id);
+  }
+
+  void Cancel(olp::http::RequestId /*id*/) override {}
+
+ private:
+  std::atomic<olp::http::RequestId> request_id_{
+      static_cast<olp::http::RequestId>(
+          olp::http::RequestIdConstants::RequestIdMin)};
+};
+
+class StreamLayerQueueTest
+    : public ::testing::TestWithParam<TestConfiguration> {
+ public:
+  void SetUp() override {
+    const auto& parameter = GetParam();
+
+    olp::cache::CacheSettings cache_settings;
+    // The queued requests must not be evicted.
+    cache_settings.max_memory_cache_size =
+        parameter.with_disk_cache
+            ? 1024u * 1024u
+            : parameter.request_count * parameter.data_size * 4u;
+    if (parameter.with_disk_cache) {
+      olp::utils::Dir::Remove(kCachePath);
+      cache_settings.disk_path_mutable = kCachePath;
+      cache_settings.max_disk_storage = 1024ull * 1024ull * 1024ull;
+      cache_settings.enforce_immediate_flush = false;
+    }
+
+    cache_ = std::make_shared<olp::cache::DefaultCache>(cache_settings);
+    ASSERT_EQ(cache_->Open(), olp::cache::DefaultCache::Success);
+
+    settings_.cache = cache_;
+    settings_.network_request_handler = std::make_shared<IngestNetwork>();
+  }
+
+  void TearDown() override {
+    cache_->Close();
+    cache_.reset();
+    olp::utils::Dir::Remove(kCachePath);
+  }
+
+ protected:
+  std::shared_ptr<olp::cache::DefaultCache> cache_;
+  olp::client::OlpClientSettings settings_;
+};
+
+/*
+ * Queues the requests one by one and flushes them all, reports the time of
+ * both phases. The time per request must not grow with the queue length.
+ */
+TEST_P(StreamLayerQueueTest, QueueAndFlush) {
+  olp::logging::Log::setLevel(olp::logging::Level::Warning);
+  const auto& parameter = GetParam();
+
+  olp::dataservice::write::StreamLayerClient client(
+      olp::client::HRN::FromString(kCatalog),
+      olp::dataservice::write::StreamLayerClientSettings{}, settings_);
+
+  const auto data = std::make_shared<std::vector<unsigned char>>(
+      parameter.data_size, 'x');
+
+  const auto queue_start = std::chrono::steady_clock::now();
+  for (std::uint32_t i = 0; i < parameter.request_count; ++i) {
+    auto error = client.Queue(
+        olp::dataservice::write::model::PublishDataRequest()
+            .WithData(data)
+            .WithLayerId(kLayer)
+            .WithTraceId(std::to_string(i)));
+    ASSERT_FALSE(error) << *error;
+  }
+  const auto queue_time =
+      std::chrono::duration_cast<std::chrono::milliseconds>(
+          std::chrono::steady_clock::now() - queue_start)
+          .count();
+
+  const auto flush_start = std::chrono::steady_clock::now();
+  const auto responses =
+      client.Flush(olp::dataservice::write::model::FlushRequest())
+          .GetFuture()
+          .get();
+  const auto flush_time =
+      std::chrono::duration_cast<std::chrono::milliseconds>(
+          std::chrono::steady_clock::now() - flush_start)
+          .count();
+
+  OLP_SDK_LOG_CRITICAL_INFO_F(
+      kLogTag, "%s: requests=%" PRIu32 ", queue time=%" PRId64
+      " ms, flush time=%" PRId64 " ms",
+      parameter.configuration_name.c_str(), parameter.request_count,
+      static_cast<std::int64_t>(queue_time),
+      static_cast<std::int64_t>(flush_time));
+
+  ASSERT_EQ(responses.size(), parameter.request_count);
+  for (const auto& response : responses) {
+    EXPECT_TRUE(response.IsSuccessful());
+  }
+}
+
+std::vector<TestConfiguration> Configurations() {
+  std::vector<TestConfiguration> configurations;
+  for (auto with_disk_cache : {false, true}) {
+    TestConfiguration configuration;
+    configuration.with_disk_cache = with_disk_cache;
+    configuration.configuration_name = with_disk_cache ? "disk" : "memory";
+    configurations.emplace_back(std::move(configuration));
+  }
+  return configurations;
+}
+
+std::string TestName(const testing::TestParamInfo<TestConfiguration>& info) {
+  return info.param.configuration_name;
+}
+
+INSTANTIATE_TEST_SUITE_P(StreamLayer, StreamLayerQueueTest,
+                         ::testing::ValuesIn(Configurations()), TestName);
+}  // namespace
@@ -0,0 +1,159 @@
+/*
+ * Copyright (C) 2021 HERE Europe B.V.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ * License-Filename: LICENSE
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cinttypes>
+#include <future>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>
+#include <olp/core/logging/Log.h>
+#include <olp/core/thread/ThreadPoolTaskScheduler.h>
+#include <olp/core/thread/WorkStealingTaskScheduler.h>
+
+namespace {
+struct TestConfiguration {
+  std::string configuration_name;
+  bool work_stealing{false};
+  std::uint32_t thread_count{1};
+};
+
+std::ostream& operator<<(std::ostream& os, const TestConfiguration& config) {
+  return os << "TestConfiguration("
+            << ".configuration_name=" << config.configuration_name
+            << ", .work_stealing=" << config.work_stealing
+            << ", .thread_count=" << config.thread_count << ")";
+}
+
+constexpr auto kLogTag = "TaskSchedulerTest";
+constexpr std::uint32_t kProducerCount = 4u;
+// Every scheduled task schedules one more, like the prefetch callbacks do.
+constexpr std::uint32_t kTasksPerProducer = 50000u;
+constexpr std::uint32_t kTaskCount = 2u * kProducerCount * kTasksPerProducer;
+constexpr auto kMaxWait = std::chrono::minutes(1);
+
+using Clock = std::chrono::steady_clock;
+
+class TaskSchedulerTest : public ::testing::TestWithParam<TestConfiguration> {
+ protected:
+  // Schedules a task that stores the time from scheduling to execution.
+  void Schedule(olp::thread::TaskScheduler& scheduler, std::uint32_t index,
+                bool nested) {
+    const auto scheduled = Clock::now();
+    scheduler.ScheduleTask([=, &scheduler]() {
+      latencies_[index] = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                              Clock::now() - scheduled)
+                              .count();
+      if (nested) {
+        Schedule(scheduler, index + 1u, false);
+      }
+      if (++completed_ == kTaskCount) {
+        done_.set_value();
+      }
+    });
+  }
+
+  std::vector<std::int64_t> latencies_ = std::vector<std::int64_t>(kTaskCount);
+  std::atomic<std::uint32_t> completed_{0u};
+  std::promise<void> done_;
+};
+
+/*
+ * Compares the single queue ThreadPoolTaskScheduler with the
+ * WorkStealingTaskScheduler. Several threads schedule small tasks, every task
+ * schedules one more task. Reports the throughput and the time from scheduling
+ * a task to its execution.
+ */
+TEST_P(TaskSchedulerTest, ScheduleTasks) {
+  olp::logging::Log::setLevel(olp::logging::Level::Warning);
+  const auto& parameter = GetParam();
+
+  std::unique_ptr<olp::thread::TaskScheduler> scheduler;
+  if (parameter.work_stealing) {
+    scheduler.reset(
+        new olp::thread::WorkStealingTaskScheduler(parameter.thread_count));
+  } else {
+    scheduler.reset(
+        new olp::thread::ThreadPoolTaskScheduler(parameter.thread_count));
+  }
+
+  auto future = done_.get_future();
+  const auto start = Clock::now();
+
+  std::vector<std::thread> producers;
+  for (std::uint32_t producer = 0; producer < kProducerCount; ++producer) {
+    producers.emplace_back([&, producer]() {
+      const auto first = 2u * producer * kTasksPerProducer;
+      for (std::uint32_t task = 0; task < kTasksPerProducer; ++task) {
+        Schedule(*scheduler, first + 2u * task, true);
+      }
+    });
+  }
+  for (auto& producer : producers) {
+    producer.join();
+  }
+
+  ASSERT_EQ(future.wait_for(kMaxWait), std::future_status::ready);
+  const auto total_time = std::chrono::duration_cast<std::chrono::microseconds>(
+                              Clock::now() - start)
+                              .count();
+  scheduler.reset();
+
+  std::sort(latencies_.begin(), latencies_.end());
+  OLP_SDK_LOG_CRITICAL_INFO_F(
+      kLogTag,
+      "%s: tasks=%" PRIu32 ", time=%" PRId64 " ms, tasks/sec=%" PRId64
+      ", p50=%" PRId64 " us, p99=%" PRId64 " us, p99.9=%" PRId64 " us",
+      parameter.configuration_name.c_str(), kTaskCount,
+      static_cast<std::int64_t>(total_time / 1000),
+      static_cast<std::int64_t>(kTaskCount * 1000000ll /
+                                std::max<std::int64_t>(total_time, 1)),
+      latencies_[kTaskCount / 2] / 1000,
+      latencies_[kTaskCount * 99ull / 100] / 1000,
+      latencies_[kTaskCount * 999ull / 1000] / 1000);
+}
+
+std::vector<TestConfiguration> Configurations() {
+  std::vector<TestConfiguration> configurations;
+  for (std::uint32_t thread_count : {1u, 2u, 4u, 8u, 16u, 32u, 64u}) {
+    for (auto work_stealing : {false, true}) {
+      TestConfiguration configuration;
+      configuration.work_stealing = work_stealing;
+      configuration.thread_count = thread_count;
+      configuration.configuration_name =
+          std::string(work_stealing ? "work_stealing" : "thread_pool") + "_" +
+          std::to_string(thread_count);
+      configurations.emplace_back(std::move(configuration));
+    }
+  }
+  return configurations;
+}
+
+std::string TestName(const testing::TestParamInfo<TestConfiguration>& info) {
+  return info.param.configuration_name;
+}
+
+INSTANTIATE_TEST_SUITE_P(TaskScheduler, TaskSchedulerTest,
+                         ::testing::ValuesIn(Configurations()), TestName);
+}  // namespace